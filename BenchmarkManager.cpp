@@ -0,0 +1,2194 @@
+///////////////////////////////////////////////////////////////////////////////
+// benchmarkmanager.cpp
+// ============
+// run the rendering performance benchmarks from the command line
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "BenchmarkManager.h"
+#include "ShapeMeshes.h"
+#include "RenderList.h"
+#include "LODSelector.h"
+#include "ClusterCuller.h"
+#include "JobSystem.h"
+#include "StreamBuffer.h"
+#include "WorldBounds.h"
+#include "FrustumCuller.h"
+#include "BoundsHierarchy.h"
+#include "TextureLoader.h"
+#include "TextureCache.h"
+#include "TagInterner.h"
+#include "stb_image.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <psapi.h>
+#endif
+
+// declaration of global variables
+namespace
+{
+	// number of frames replayed by the uniform benchmark
+	const int g_UniformBenchmarkFrames = 10000;
+	// objects drawn per frame by the default 3D scene
+	const int g_ObjectsPerFrame = 7;
+	// boxes and frames drawn by the instancing stress scene
+	const int g_StressBoxCount = 100000;
+	const int g_StressFrames = 20;
+	// objects drawn by the multi-draw stress scene
+	const int g_MultiDrawObjectCount = 50000;
+	// storage block binding of the render list draw values
+	const GLuint g_DrawBlockBinding = 0;
+	// draws of every mesh measured by the mesh optimizer benchmark
+	const int g_MeshDrawRepeats = 1000;
+	// curved meshes drawn by the level of detail scene, spread
+	// over rows running away from the camera
+	const int g_LODObjectCount = 20000;
+	const int g_LODRowLength = 100;
+	const int g_LODViewportHeight = 800;
+	// curved meshes drawn by the meshlet scene, on a square grid
+	// centered on the camera
+	const int g_MeshletObjectCount = 10000;
+	const int g_MeshletGridSize = 100;
+	// frames the residency benchmark leaves a mesh undrawn before
+	// evicting it, and the meshes the default 3D scene draws
+	const GLuint g_ResidencyEvictionFrames = 60;
+	const ShapeMeshes::MESH_ID g_SceneMeshes[] = {
+		ShapeMeshes::BOX_MESH, ShapeMeshes::SPHERE_MESH, ShapeMeshes::PLANE_MESH
+	};
+	// times every mesh is generated by the startup benchmark, for
+	// each number of worker threads
+	const int g_StartupRepeats = 10;
+	// moving boxes drawn one at a time by the stream benchmark
+	const int g_StreamObjectCount = 10000;
+	// objects scattered around the camera by the frustum benchmark,
+	// within this distance along every axis
+	const int g_FrustumObjectCount = 100000;
+	const float g_FrustumSceneExtent = 100.0f;
+	// object counts of the bounding volume tree benchmark, which
+	// keeps the objects as dense as in the frustum benchmark, and
+	// the frames of movement and the queries timed at each count
+	const int g_HierarchyObjectCounts[] = { 10000, 100000, 1000000 };
+	const int g_HierarchyMoveFrames = 10;
+	const int g_HierarchyQueryCount = 100;
+	const float g_HierarchyQueryDistance = 5.0f;
+	// images written and loaded by the texture benchmark, and the
+	// times each number of workers loads them all
+	const int g_TextureImageCount = 16;
+	const int g_TextureImageSize = 1024;
+	const int g_TextureRepeats = 3;
+	// large images decoded one after another by the ingestion
+	// benchmark
+	const int g_IngestImageCount = 8;
+	const int g_IngestImageSize = 2048;
+	// texture and material tags looked up by the tag benchmark,
+	// and the draws of each frame selecting one of each
+	const int g_TagCount = 10000;
+	const int g_TagDrawCount = 10000;
+	const int g_TagFrames = 5;
+	// names of the shape meshes, in MESH_ID order
+	const char* g_MeshNames[] = {
+		"box", "cone", "cylinder", "plane", "prism", "pyramid3",
+		"pyramid4", "sphere", "tapered cylinder", "torus"
+	};
+
+	/***********************************************************
+	 *  LoadAllMeshes()
+	 *
+	 *  Load every basic shape into the passed in meshes.
+	 ***********************************************************/
+	void LoadAllMeshes(ShapeMeshes& meshes)
+	{
+		meshes.LoadBoxMesh();
+		meshes.LoadConeMesh();
+		meshes.LoadCylinderMesh();
+		meshes.LoadPlaneMesh();
+		meshes.LoadPrismMesh();
+		meshes.LoadPyramid3Mesh();
+		meshes.LoadPyramid4Mesh();
+		meshes.LoadSphereMesh();
+		meshes.LoadTaperedCylinderMesh();
+		meshes.LoadTorusMesh();
+	}
+
+	/***********************************************************
+	 *  ElapsedSeconds()
+	 *
+	 *  Seconds since the passed in start time.
+	 ***********************************************************/
+	double ElapsedSeconds(std::chrono::high_resolution_clock::time_point start)
+	{
+		std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+		return(elapsed.count());
+	}
+
+	/***********************************************************
+	 *  WriteBigEndian()
+	 *
+	 *  Append a 32 bit value to the bytes, most significant
+	 *  byte first as PNG files store it.
+	 ***********************************************************/
+	void WriteBigEndian(std::vector<unsigned char>& bytes, uint32_t value)
+	{
+		bytes.push_back((unsigned char)(value >> 24));
+		bytes.push_back((unsigned char)(value >> 16));
+		bytes.push_back((unsigned char)(value >> 8));
+		bytes.push_back((unsigned char)value);
+	}
+
+	/***********************************************************
+	 *  WritePNGChunk()
+	 *
+	 *  Append a PNG chunk with its length and checksum.
+	 ***********************************************************/
+	void WritePNGChunk(std::vector<unsigned char>& bytes, const char* type, const std::vector<unsigned char>& data)
+	{
+		WriteBigEndian(bytes, (uint32_t)data.size());
+		size_t typeStart = bytes.size();
+		bytes.insert(bytes.end(), type, type + 4);
+		bytes.insert(bytes.end(), data.begin(), data.end());
+
+		uint32_t crc = 0xFFFFFFFF;
+		for (size_t i = typeStart; i < bytes.size(); i++)
+		{
+			crc ^= bytes[i];
+			for (int bit = 0; bit < 8; bit++)
+			{
+				crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+			}
+		}
+		WriteBigEndian(bytes, crc ^ 0xFFFFFFFF);
+	}
+
+	/***********************************************************
+	 *  WriteTestImage()
+	 *
+	 *  Write a square RGB PNG file of noisy gradients.  The rows
+	 *  are Paeth filtered, so decoding does the same per pixel
+	 *  work as a real image, but the deflate blocks are stored
+	 *  rather than compressed, as there is no compressor here.
+	 ***********************************************************/
+	bool WriteTestImage(const std::string& filename, int size, uint32_t seed)
+	{
+		std::mt19937 random(seed);
+		int rowBytes = size * 3;
+		std::vector<unsigned char> pixels((size_t)rowBytes * size);
+		for (int y = 0; y < size; y++)
+		{
+			for (int x = 0; x < rowBytes; x++)
+			{
+				pixels[(size_t)y * rowBytes + x] = (unsigned char)(((x / 3) + y * (x % 3 + 1)) + (random() % 16));
+			}
+		}
+
+		// every row starts with its filter type
+		std::vector<unsigned char> filtered;
+		filtered.reserve(((size_t)rowBytes + 1) * size);
+		for (int y = 0; y < size; y++)
+		{
+			filtered.push_back(4);
+			for (int x = 0; x < rowBytes; x++)
+			{
+				int left = (x >= 3) ? pixels[(size_t)y * rowBytes + x - 3] : 0;
+				int up = (y > 0) ? pixels[(size_t)(y - 1) * rowBytes + x] : 0;
+				int upLeft = ((x >= 3) && (y > 0)) ? pixels[(size_t)(y - 1) * rowBytes + x - 3] : 0;
+				int estimate = left + up - upLeft;
+				int predicted = upLeft;
+				if ((abs(estimate - left) <= abs(estimate - up)) && (abs(estimate - left) <= abs(estimate - upLeft)))
+				{
+					predicted = left;
+				}
+				else if (abs(estimate - up) <= abs(estimate - upLeft))
+				{
+					predicted = up;
+				}
+				filtered.push_back((unsigned char)(pixels[(size_t)y * rowBytes + x] - predicted));
+			}
+		}
+
+		// zlib stream of stored blocks
+		std::vector<unsigned char> compressed;
+		compressed.push_back(0x78);
+		compressed.push_back(0x01);
+		size_t offset = 0;
+		while (offset < filtered.size())
+		{
+			size_t blockSize = std::min(filtered.size() - offset, (size_t)65535);
+			bool bLast = (offset + blockSize == filtered.size());
+			compressed.push_back((bLast == true) ? 1 : 0);
+			compressed.push_back((unsigned char)blockSize);
+			compressed.push_back((unsigned char)(blockSize >> 8));
+			compressed.push_back((unsigned char)~blockSize);
+			compressed.push_back((unsigned char)(~blockSize >> 8));
+			compressed.insert(compressed.end(), filtered.begin() + offset, filtered.begin() + offset + blockSize);
+			offset += blockSize;
+		}
+		uint32_t sumA = 1;
+		uint32_t sumB = 0;
+		for (size_t i = 0; i < filtered.size(); i++)
+		{
+			sumA = (sumA + filtered[i]) % 65521;
+			sumB = (sumB + sumA) % 65521;
+		}
+		WriteBigEndian(compressed, (sumB << 16) | sumA);
+
+		std::vector<unsigned char> header;
+		WriteBigEndian(header, (uint32_t)size);
+		WriteBigEndian(header, (uint32_t)size);
+		header.push_back(8);	// bits per channel
+		header.push_back(2);	// RGB
+		header.push_back(0);
+		header.push_back(0);
+		header.push_back(0);
+
+		const unsigned char signature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+		std::vector<unsigned char> bytes(signature, signature + sizeof(signature));
+		WritePNGChunk(bytes, "IHDR", header);
+		WritePNGChunk(bytes, "IDAT", compressed);
+		WritePNGChunk(bytes, "IEND", std::vector<unsigned char>());
+
+		FILE* pFile = fopen(filename.c_str(), "wb");
+		if (NULL == pFile)
+		{
+			return(false);
+		}
+		bool bWritten = (fwrite(bytes.data(), 1, bytes.size(), pFile) == bytes.size());
+		fclose(pFile);
+		return(bWritten);
+	}
+
+	/***********************************************************
+	 *  WriteTestImages()
+	 *
+	 *  Write the images of the texture benchmarks into the
+	 *  working directory.
+	 ***********************************************************/
+	bool WriteTestImages(const char* prefix, int count, int size, std::vector<std::string>& filenames)
+	{
+		for (int image = 0; image < count; image++)
+		{
+			std::string filename = prefix + std::to_string(image) + ".png";
+			if (WriteTestImage(filename, size, (uint32_t)image) == false)
+			{
+				std::cout << "Could not write image:" << filename << std::endl;
+				return(false);
+			}
+			filenames.push_back(filename);
+		}
+		return(true);
+	}
+
+	/***********************************************************
+	 *  GetResidentBytes()
+	 *
+	 *  Bytes of memory the process has resident now, and the
+	 *  most it has had since the peak was last reset.
+	 ***********************************************************/
+	void GetResidentBytes(size_t& current, size_t& peak)
+	{
+		current = 0;
+		peak = 0;
+#ifdef _WIN32
+		PROCESS_MEMORY_COUNTERS counters;
+		if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)) != FALSE)
+		{
+			current = counters.WorkingSetSize;
+			peak = counters.PeakWorkingSetSize;
+		}
+#else
+		FILE* pFile = fopen("/proc/self/status", "r");
+		if (NULL == pFile)
+		{
+			return;
+		}
+		char line[256];
+		while (fgets(line, sizeof(line), pFile) != NULL)
+		{
+			unsigned long kilobytes = 0;
+			if (sscanf(line, "VmRSS: %lu kB", &kilobytes) == 1)
+			{
+				current = (size_t)kilobytes * 1024;
+			}
+			else if (sscanf(line, "VmHWM: %lu kB", &kilobytes) == 1)
+			{
+				peak = (size_t)kilobytes * 1024;
+			}
+		}
+		fclose(pFile);
+#endif
+	}
+
+	/***********************************************************
+	 *  ResetPeakResidentBytes()
+	 *
+	 *  Start the resident peak again from the current bytes -
+	 *  returns false where the peak can not be reset, which
+	 *  includes Windows.
+	 ***********************************************************/
+	bool ResetPeakResidentBytes()
+	{
+#ifdef _WIN32
+		return(false);
+#else
+		FILE* pFile = fopen("/proc/self/clear_refs", "w");
+		if (NULL == pFile)
+		{
+			return(false);
+		}
+		bool bReset = (fputs("5", pFile) >= 0);
+		bReset = (fclose(pFile) == 0) && (bReset == true);
+		return(bReset);
+#endif
+	}
+
+	/***********************************************************
+	 *  PrintUniformStats()
+	 *
+	 *  Print the per-frame uniform traffic for one benchmark pass.
+	 ***********************************************************/
+	void PrintUniformStats(
+		const char* passName,
+		const ShaderManager::UNIFORM_STATS& stats,
+		double elapsedSeconds,
+		int frames)
+	{
+		std::cout << passName
+			<< ": driver lookups/frame:" << (double)stats.locationQueries / frames
+			<< ", table lookups/frame:" << (double)stats.tableLookups / frames
+			<< ", uploads/frame:" << (double)stats.uniformUploads / frames
+			<< ", CPU us/frame:" << (elapsedSeconds * 1000000.0) / frames
+			<< std::endl;
+	}
+}
+
+/***********************************************************
+ *  BenchmarkManager()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+BenchmarkManager::BenchmarkManager(ShaderManager* pShaderManager)
+{
+	m_pShaderManager = pShaderManager;
+}
+
+/***********************************************************
+ *  RunBenchmark()
+ *
+ *  This method is used for running the benchmark with the
+ *  passed in name.
+ ***********************************************************/
+bool BenchmarkManager::RunBenchmark(const char* benchmarkName)
+{
+	if (strcmp(benchmarkName, "uniforms") == 0)
+	{
+		RunUniformBenchmark();
+		return(true);
+	}
+	if (strcmp(benchmarkName, "instancing") == 0)
+	{
+		RunInstancingBenchmark();
+		return(true);
+	}
+
+	if (strcmp(benchmarkName, "multidraw") == 0)
+	{
+		RunMultiDrawBenchmark();
+		return(true);
+	}
+
+	if (strcmp(benchmarkName, "meshopt") == 0)
+	{
+		RunMeshOptimizerBenchmark();
+		return(true);
+	}
+
+	if (strcmp(benchmarkName, "lod") == 0)
+	{
+		RunLODBenchmark();
+		return(true);
+	}
+
+	if (strcmp(benchmarkName, "vertexformat") == 0)
+	{
+		RunVertexFormatBenchmark();
+		return(true);
+	}
+
+	if (strcmp(benchmarkName, "meshlets") == 0)
+	{
+		RunMeshletBenchmark();
+		return(true);
+	}
+
+	if (strcmp(benchmarkName, "residency") == 0)
+	{
+		RunResidencyBenchmark();
+		return(true);
+	}
+
+	if (strcmp(benchmarkName, "startup") == 0)
+	{
+		RunStartupBenchmark();
+		return(true);
+	}
+
+	if (strcmp(benchmarkName, "stream") == 0)
+	{
+		RunStreamBenchmark();
+		return(true);
+	}
+
+	if (strcmp(benchmarkName, "frustum") == 0)
+	{
+		RunFrustumBenchmark();
+		return(true);
+	}
+
+	if (strcmp(benchmarkName, "bvh") == 0)
+	{
+		RunHierarchyBenchmark();
+		return(true);
+	}
+
+	if (strcmp(benchmarkName, "textures") == 0)
+	{
+		RunTextureBenchmark();
+		return(true);
+	}
+
+	if (strcmp(benchmarkName, "texcache") == 0)
+	{
+		RunTextureCacheBenchmark();
+		return(true);
+	}
+
+	if (strcmp(benchmarkName, "ingest") == 0)
+	{
+		RunIngestBenchmark();
+		return(true);
+	}
+
+	if (strcmp(benchmarkName, "tags") == 0)
+	{
+		RunTagBenchmark();
+		return(true);
+	}
+
+	std::cout << "Unknown benchmark:" << benchmarkName << std::endl;
+	return(false);
+}
+
+/***********************************************************
+ *  RunUniformBenchmark()
+ *
+ *  This method is used for replaying the uniform traffic of
+ *  the default scene - the view uniforms plus the per-object
+ *  transform, texture, UV scale and material uniforms - through
+ *  the driver lookup path used before the uniform table, the
+ *  cached name path, and the handle path.
+ ***********************************************************/
+void BenchmarkManager::RunUniformBenchmark()
+{
+	if (NULL == m_pShaderManager)
+	{
+		return;
+	}
+
+	const glm::mat4 matrix(1.0f);
+	const glm::vec3 color(0.5f, 0.5f, 0.5f);
+
+	// replays one frame of uniform traffic through the name based setters
+	auto replayByName = [&]()
+	{
+		m_pShaderManager->setMat4Value("view", matrix);
+		m_pShaderManager->setMat4Value("projection", matrix);
+		m_pShaderManager->setVec3Value("viewPosition", color);
+		for (int object = 0; object < g_ObjectsPerFrame; object++)
+		{
+			m_pShaderManager->setIntValue("bUseTexture", true);
+			m_pShaderManager->setSampler2DValue("objectTexture", object);
+			m_pShaderManager->setVec3Value("material.ambientColor", color);
+			m_pShaderManager->setFloatValue("material.ambientStrength", 0.5f);
+			m_pShaderManager->setVec3Value("material.diffuseColor", color);
+			m_pShaderManager->setVec3Value("material.specularColor", color);
+			m_pShaderManager->setFloatValue("material.shininess", 32.0f);
+			m_pShaderManager->setVec2Value("UVscale", glm::vec2(1.0f, 1.0f));
+			m_pShaderManager->setMat4Value("model", matrix);
+		}
+	};
+
+	// the same traffic through handles resolved once up front
+	UniformHandle view = m_pShaderManager->GetUniformHandle("view");
+	UniformHandle projection = m_pShaderManager->GetUniformHandle("projection");
+	UniformHandle viewPosition = m_pShaderManager->GetUniformHandle("viewPosition");
+	UniformHandle useTexture = m_pShaderManager->GetUniformHandle("bUseTexture");
+	UniformHandle objectTexture = m_pShaderManager->GetUniformHandle("objectTexture");
+	UniformHandle ambientColor = m_pShaderManager->GetUniformHandle("material.ambientColor");
+	UniformHandle ambientStrength = m_pShaderManager->GetUniformHandle("material.ambientStrength");
+	UniformHandle diffuseColor = m_pShaderManager->GetUniformHandle("material.diffuseColor");
+	UniformHandle specularColor = m_pShaderManager->GetUniformHandle("material.specularColor");
+	UniformHandle shininess = m_pShaderManager->GetUniformHandle("material.shininess");
+	UniformHandle UVscale = m_pShaderManager->GetUniformHandle("UVscale");
+	UniformHandle model = m_pShaderManager->GetUniformHandle("model");
+	auto replayByHandle = [&]()
+	{
+		m_pShaderManager->setMat4Value(view, matrix);
+		m_pShaderManager->setMat4Value(projection, matrix);
+		m_pShaderManager->setVec3Value(viewPosition, color);
+		for (int object = 0; object < g_ObjectsPerFrame; object++)
+		{
+			m_pShaderManager->setIntValue(useTexture, true);
+			m_pShaderManager->setSampler2DValue(objectTexture, object);
+			m_pShaderManager->setVec3Value(ambientColor, color);
+			m_pShaderManager->setFloatValue(ambientStrength, 0.5f);
+			m_pShaderManager->setVec3Value(diffuseColor, color);
+			m_pShaderManager->setVec3Value(specularColor, color);
+			m_pShaderManager->setFloatValue(shininess, 32.0f);
+			m_pShaderManager->setVec2Value(UVscale, glm::vec2(1.0f, 1.0f));
+			m_pShaderManager->setMat4Value(model, matrix);
+		}
+	};
+
+	std::cout << "Uniform benchmark - " << g_UniformBenchmarkFrames << " frames of "
+		<< g_ObjectsPerFrame << " objects" << std::endl;
+
+	// before: every setter asks the driver for the location
+	m_pShaderManager->SetLegacyUniformLookups(true);
+	m_pShaderManager->ResetUniformStats();
+	auto start = std::chrono::high_resolution_clock::now();
+	for (int frame = 0; frame < g_UniformBenchmarkFrames; frame++)
+	{
+		replayByName();
+	}
+	glFinish();
+	std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+	PrintUniformStats("  glGetUniformLocation per call", m_pShaderManager->GetUniformStats(), elapsed.count(), g_UniformBenchmarkFrames);
+	m_pShaderManager->SetLegacyUniformLookups(false);
+
+	// names resolved through the uniform table
+	m_pShaderManager->ResetUniformStats();
+	start = std::chrono::high_resolution_clock::now();
+	for (int frame = 0; frame < g_UniformBenchmarkFrames; frame++)
+	{
+		replayByName();
+	}
+	glFinish();
+	elapsed = std::chrono::high_resolution_clock::now() - start;
+	PrintUniformStats("  uniform table by name        ", m_pShaderManager->GetUniformStats(), elapsed.count(), g_UniformBenchmarkFrames);
+
+	// after: handles resolved once
+	m_pShaderManager->ResetUniformStats();
+	start = std::chrono::high_resolution_clock::now();
+	for (int frame = 0; frame < g_UniformBenchmarkFrames; frame++)
+	{
+		replayByHandle();
+	}
+	glFinish();
+	elapsed = std::chrono::high_resolution_clock::now() - start;
+	PrintUniformStats("  uniform handles              ", m_pShaderManager->GetUniformStats(), elapsed.count(), g_UniformBenchmarkFrames);
+
+	m_pShaderManager->ResetUniformStats();
+}
+
+/***********************************************************
+ *  RunInstancingBenchmark()
+ *
+ *  This method is used for drawing a stress scene of many
+ *  boxes, first with one model uniform and draw call per box
+ *  and then with a single instanced draw call, and printing
+ *  the frame time and box throughput of both.
+ ***********************************************************/
+void BenchmarkManager::RunInstancingBenchmark()
+{
+	if (NULL == m_pShaderManager)
+	{
+		return;
+	}
+
+	ShapeMeshes meshes;
+	meshes.LoadBoxMesh();
+
+	// lay the boxes out on a square grid
+	std::vector<ShapeMeshes::INSTANCE_DATA> instances(g_StressBoxCount);
+	int gridSize = (int)ceil(sqrt((double)g_StressBoxCount));
+	for (int i = 0; i < g_StressBoxCount; i++)
+	{
+		glm::vec3 position((i % gridSize) - gridSize * 0.5f, 0.0f, -(float)(i / gridSize));
+		instances[i].model = glm::translate(position) * glm::scale(glm::vec3(0.5f, 0.5f, 0.5f));
+		instances[i].UVscale = glm::vec2(1.0f, 1.0f);
+		instances[i].materialIndex = i % 4;
+		instances[i].padding = 0;
+	}
+
+	UniformHandle model = m_pShaderManager->GetUniformHandle("model");
+	UniformHandle useInstancing = m_pShaderManager->GetUniformHandle("bUseInstancing");
+
+	std::cout << "Instancing benchmark - " << g_StressBoxCount << " boxes, "
+		<< g_StressFrames << " frames" << std::endl;
+
+	// one model uniform and one draw call per box
+	m_pShaderManager->setBoolValue(useInstancing, false);
+	glFinish();
+	auto start = std::chrono::high_resolution_clock::now();
+	for (int frame = 0; frame < g_StressFrames; frame++)
+	{
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		for (int i = 0; i < g_StressBoxCount; i++)
+		{
+			m_pShaderManager->setMat4Value(model, instances[i].model);
+			meshes.DrawBoxMesh();
+		}
+	}
+	glFinish();
+	double perObjectSeconds = ElapsedSeconds(start);
+
+	// one instanced draw call for all of the boxes
+	m_pShaderManager->setBoolValue(useInstancing, true);
+	glFinish();
+	start = std::chrono::high_resolution_clock::now();
+	for (int frame = 0; frame < g_StressFrames; frame++)
+	{
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		meshes.DrawBoxMeshInstanced(instances.data(), g_StressBoxCount);
+	}
+	glFinish();
+	double instancedSeconds = ElapsedSeconds(start);
+	m_pShaderManager->setBoolValue(useInstancing, false);
+
+	std::cout << "  per-object: " << (perObjectSeconds * 1000.0) / g_StressFrames << " ms/frame, "
+		<< (g_StressBoxCount * (double)g_StressFrames) / perObjectSeconds << " boxes/s, "
+		<< g_StressBoxCount << " draw calls/frame" << std::endl;
+	std::cout << "  instanced:  " << (instancedSeconds * 1000.0) / g_StressFrames << " ms/frame, "
+		<< (g_StressBoxCount * (double)g_StressFrames) / instancedSeconds << " boxes/s, "
+		<< "1 draw call/frame" << std::endl;
+}
+
+/***********************************************************
+ *  RunMultiDrawBenchmark()
+ *
+ *  This method is used for drawing a stress scene of mixed
+ *  shape meshes, first with the uniforms and a draw call per
+ *  object and then with a compiled render list, and printing
+ *  the CPU time spent submitting each frame next to the full
+ *  frame time.  Run it with LIBGL_ALWAYS_SOFTWARE=1 to measure
+ *  under Mesa llvmpipe.
+ ***********************************************************/
+void BenchmarkManager::RunMultiDrawBenchmark()
+{
+	if (NULL == m_pShaderManager)
+	{
+		return;
+	}
+
+	ShapeMeshes meshes;
+	LoadAllMeshes(meshes);
+
+	// only meshes with indices can be drawn by the render list
+	std::vector<ShapeMeshes::MESH_ID> meshIDs;
+	for (int meshID = 0; meshID < ShapeMeshes::MESH_COUNT; meshID++)
+	{
+		ShapeMeshes::INDEXED_RANGE range;
+		if (meshes.GetIndexedRange((ShapeMeshes::MESH_ID)meshID, range) == true)
+		{
+			meshIDs.push_back((ShapeMeshes::MESH_ID)meshID);
+		}
+	}
+	if (meshIDs.empty() == true)
+	{
+		return;
+	}
+
+	RenderList renderList(m_pShaderManager, &meshes, g_DrawBlockBinding);
+	if (renderList.Initialize() == false)
+	{
+		std::cout << "  shader does not declare the draw block - only the submission cost is meaningful" << std::endl;
+	}
+
+	// cycle the meshes over a square grid
+	std::vector<ShapeMeshes::MESH_ID> objectMeshes(g_MultiDrawObjectCount);
+	std::vector<RenderList::DRAW_DATA> draws(g_MultiDrawObjectCount);
+	int gridSize = (int)ceil(sqrt((double)g_MultiDrawObjectCount));
+	for (int i = 0; i < g_MultiDrawObjectCount; i++)
+	{
+		glm::vec3 position((i % gridSize) - gridSize * 0.5f, 0.0f, -(float)(i / gridSize));
+		objectMeshes[i] = meshIDs[i % meshIDs.size()];
+		draws[i].model = glm::translate(position) * glm::scale(glm::vec3(0.5f, 0.5f, 0.5f));
+		draws[i].objectColor = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);
+		draws[i].UVscale = glm::vec2(1.0f, 1.0f);
+		draws[i].materialIndex = i % 4;
+		draws[i].textureSlot = -1;
+	}
+
+	UniformHandle model = m_pShaderManager->GetUniformHandle("model");
+	UniformHandle materialIndex = m_pShaderManager->GetUniformHandle("materialIndex");
+
+	std::cout << "Multi-draw benchmark - " << g_MultiDrawObjectCount << " objects of "
+		<< meshIDs.size() << " indexed meshes, " << g_StressFrames << " frames" << std::endl;
+
+	// one set of uniforms and one draw call per object
+	double submitSeconds = 0.0;
+	glFinish();
+	auto start = std::chrono::high_resolution_clock::now();
+	for (int frame = 0; frame < g_StressFrames; frame++)
+	{
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		auto submitStart = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < g_MultiDrawObjectCount; i++)
+		{
+			m_pShaderManager->setMat4Value(model, draws[i].model);
+			m_pShaderManager->setIntValue(materialIndex, draws[i].materialIndex);
+			meshes.DrawMesh(objectMeshes[i]);
+		}
+		submitSeconds += ElapsedSeconds(submitStart);
+	}
+	glFinish();
+	double perObjectSeconds = ElapsedSeconds(start);
+	double perObjectSubmitSeconds = submitSeconds;
+
+	// compile the list once, then draw it with one call per frame
+	start = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < g_MultiDrawObjectCount; i++)
+	{
+		renderList.AddDraw(objectMeshes[i], draws[i]);
+	}
+	renderList.Compile();
+	glFinish();
+	double compileSeconds = ElapsedSeconds(start);
+
+	submitSeconds = 0.0;
+	start = std::chrono::high_resolution_clock::now();
+	for (int frame = 0; frame < g_StressFrames; frame++)
+	{
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		auto submitStart = std::chrono::high_resolution_clock::now();
+		renderList.Submit();
+		submitSeconds += ElapsedSeconds(submitStart);
+	}
+	glFinish();
+	double multiDrawSeconds = ElapsedSeconds(start);
+
+	std::cout << "  per-object: submit " << (perObjectSubmitSeconds * 1000.0) / g_StressFrames << " ms/frame, total "
+		<< (perObjectSeconds * 1000.0) / g_StressFrames << " ms/frame, "
+		<< g_MultiDrawObjectCount << " draw calls/frame" << std::endl;
+	std::cout << "  multi-draw: submit " << (submitSeconds * 1000.0) / g_StressFrames << " ms/frame, total "
+		<< (multiDrawSeconds * 1000.0) / g_StressFrames << " ms/frame, "
+		<< "1 draw call/frame, compiled once in " << compileSeconds * 1000.0 << " ms" << std::endl;
+}
+
+/***********************************************************
+ *  RunMeshOptimizerBenchmark()
+ *
+ *  This method is used for loading the meshes once as they
+ *  are generated and once reordered by the mesh optimizer,
+ *  printing the simulated vertex cache use of both, and
+ *  counting the vertex shader invocations the GPU reports
+ *  when drawing each of them.
+ ***********************************************************/
+void BenchmarkManager::RunMeshOptimizerBenchmark()
+{
+	if (NULL == m_pShaderManager)
+	{
+		return;
+	}
+
+	ShapeMeshes generatedMeshes;
+	generatedMeshes.SetMeshOptimization(false);
+	LoadAllMeshes(generatedMeshes);
+
+	ShapeMeshes optimizedMeshes;
+	optimizedMeshes.SetMeshOptimization(true, true);
+	LoadAllMeshes(optimizedMeshes);
+
+	GLuint query = 0;
+	glGenQueries(1, &query);
+
+	// vertex shader invocations for drawing one mesh many times
+	auto countInvocations = [&](ShapeMeshes& meshes, ShapeMeshes::MESH_ID meshID)
+	{
+		GLuint64 invocations = 0;
+		glBeginQuery(GL_VERTEX_SHADER_INVOCATIONS, query);
+		for (int draw = 0; draw < g_MeshDrawRepeats; draw++)
+		{
+			meshes.DrawMesh(meshID);
+		}
+		glEndQuery(GL_VERTEX_SHADER_INVOCATIONS);
+		glGetQueryObjectui64v(query, GL_QUERY_RESULT, &invocations);
+		return((double)invocations / g_MeshDrawRepeats);
+	};
+
+	std::cout << "Mesh optimizer benchmark - ACMR/ATVR with a "
+		<< "16 entry FIFO cache, vertex shader invocations per draw" << std::endl;
+
+	for (int meshID = 0; meshID < ShapeMeshes::MESH_COUNT; meshID++)
+	{
+		MeshOptimizer::CACHE_STATS before;
+		MeshOptimizer::CACHE_STATS after;
+		if (optimizedMeshes.GetCacheStats((ShapeMeshes::MESH_ID)meshID, before, after) == false)
+		{
+			continue;
+		}
+
+		double generatedInvocations = countInvocations(generatedMeshes, (ShapeMeshes::MESH_ID)meshID);
+		double optimizedInvocations = countInvocations(optimizedMeshes, (ShapeMeshes::MESH_ID)meshID);
+
+		std::cout << "  " << g_MeshNames[meshID]
+			<< ": ACMR " << before.ACMR << " -> " << after.ACMR
+			<< ", ATVR " << before.ATVR << " -> " << after.ATVR
+			<< ", VS invocations " << generatedInvocations << " -> " << optimizedInvocations
+			<< std::endl;
+	}
+
+	glDeleteQueries(1, &query);
+}
+
+/***********************************************************
+ *  RunLODBenchmark()
+ *
+ *  This method is used for drawing a field of spheres, tori
+ *  and cylinders reaching far from the camera, first with
+ *  every mesh at full tessellation and then at the levels
+ *  chosen from their size on the screen, and printing the
+ *  triangles and frame time of both.
+ ***********************************************************/
+void BenchmarkManager::RunLODBenchmark()
+{
+	if (NULL == m_pShaderManager)
+	{
+		return;
+	}
+
+	ShapeMeshes meshes;
+	meshes.LoadCylinderMesh();
+	meshes.LoadSphereMesh();
+	meshes.LoadTaperedCylinderMesh();
+	meshes.LoadTorusMesh();
+
+	const ShapeMeshes::MESH_ID curvedMeshes[] = {
+		ShapeMeshes::SPHERE_MESH, ShapeMeshes::TORUS_MESH,
+		ShapeMeshes::CYLINDER_MESH, ShapeMeshes::TAPERED_CYLINDER_MESH
+	};
+	const int curvedMeshCount = sizeof(curvedMeshes) / sizeof(curvedMeshes[0]);
+
+	// rows of objects from just in front of the camera to the
+	// far plane
+	std::vector<ShapeMeshes::MESH_ID> objectMeshes(g_LODObjectCount);
+	std::vector<glm::mat4> models(g_LODObjectCount);
+	int rowCount = g_LODObjectCount / g_LODRowLength;
+	for (int i = 0; i < g_LODObjectCount; i++)
+	{
+		float depth = 2.0f + 95.0f * (float)(i / g_LODRowLength) / rowCount;
+		glm::vec3 position(((i % g_LODRowLength) - g_LODRowLength * 0.5f) * 0.5f, -1.0f, -depth);
+		objectMeshes[i] = curvedMeshes[i % curvedMeshCount];
+		models[i] = glm::translate(position) * glm::scale(glm::vec3(0.2f, 0.2f, 0.2f));
+	}
+
+	glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	glm::mat4 projection = glm::perspective(glm::radians(45.0f), 1.25f, 0.1f, 100.0f);
+	UniformHandle viewHandle = m_pShaderManager->GetUniformHandle("view");
+	UniformHandle projectionHandle = m_pShaderManager->GetUniformHandle("projection");
+	UniformHandle model = m_pShaderManager->GetUniformHandle("model");
+	m_pShaderManager->setMat4Value(viewHandle, view);
+	m_pShaderManager->setMat4Value(projectionHandle, projection);
+
+	LODSelector selector(&meshes);
+	selector.SetViewTransform(view, projection, g_LODViewportHeight);
+
+	std::cout << "Level of detail benchmark - " << g_LODObjectCount << " curved meshes, "
+		<< g_StressFrames << " frames" << std::endl;
+
+	// draw every object at full tessellation, then at the
+	// selected levels
+	for (int pass = 0; pass < 2; pass++)
+	{
+		selector.SetEnabled(pass == 1);
+
+		glFinish();
+		auto start = std::chrono::high_resolution_clock::now();
+		for (int frame = 0; frame < g_StressFrames; frame++)
+		{
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			selector.BeginFrame();
+			for (int i = 0; i < g_LODObjectCount; i++)
+			{
+				m_pShaderManager->setMat4Value(model, models[i]);
+				meshes.DrawMeshLevel(objectMeshes[i], selector.SelectLevel(objectMeshes[i], models[i]));
+			}
+		}
+		glFinish();
+		double seconds = ElapsedSeconds(start);
+
+		const LODSelector::LOD_STATS& stats = selector.GetFrameStats();
+		std::cout << ((pass == 0) ? "  full detail: " : "  selected:    ")
+			<< (seconds * 1000.0) / g_StressFrames << " ms/frame, "
+			<< stats.trianglesDrawn << " triangles/frame, "
+			<< stats.trianglesSaved << " saved, "
+			<< stats.coarserDraws << " of " << stats.draws << " draws at a coarser level" << std::endl;
+	}
+}
+
+/***********************************************************
+ *  RunVertexFormatBenchmark()
+ *
+ *  This method is used for loading the meshes once with
+ *  float vertices and once with validated packed vertices,
+ *  printing the packing error and vertex bytes, and timing
+ *  on the GPU the drawing of every mesh in both formats.
+ ***********************************************************/
+void BenchmarkManager::RunVertexFormatBenchmark()
+{
+	if (NULL == m_pShaderManager)
+	{
+		return;
+	}
+
+	ShapeMeshes floatMeshes(ShapeMeshes::FLOAT_VERTEX_FORMAT);
+	LoadAllMeshes(floatMeshes);
+
+	ShapeMeshes packedMeshes(ShapeMeshes::PACKED_VERTEX_FORMAT);
+	packedMeshes.SetPackingValidation(true);
+	LoadAllMeshes(packedMeshes);
+
+	GLuint query = 0;
+	glGenQueries(1, &query);
+
+	// GPU milliseconds for drawing every mesh many times
+	auto timeDraws = [&](ShapeMeshes& meshes)
+	{
+		GLuint64 nanoseconds = 0;
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		glBeginQuery(GL_TIME_ELAPSED, query);
+		for (int draw = 0; draw < g_MeshDrawRepeats; draw++)
+		{
+			for (int meshID = 0; meshID < ShapeMeshes::MESH_COUNT; meshID++)
+			{
+				meshes.DrawMesh((ShapeMeshes::MESH_ID)meshID);
+			}
+		}
+		glEndQuery(GL_TIME_ELAPSED);
+		glGetQueryObjectui64v(query, GL_QUERY_RESULT, &nanoseconds);
+		return((double)nanoseconds / 1000000.0);
+	};
+
+	std::cout << "Vertex format benchmark - largest packing error, "
+		<< g_MeshDrawRepeats << " draws of every mesh" << std::endl;
+
+	for (int meshID = 0; meshID < ShapeMeshes::MESH_COUNT; meshID++)
+	{
+		ShapeMeshes::PACKING_ERROR error;
+		if (packedMeshes.GetPackingError((ShapeMeshes::MESH_ID)meshID, error) == false)
+		{
+			continue;
+		}
+
+		std::cout << "  " << g_MeshNames[meshID]
+			<< ": position " << error.position
+			<< ", normal " << error.normal
+			<< ", UV " << error.UV
+			<< ", " << error.failedVertices << " of " << error.checkedVertices << " vertices outside the tolerance"
+			<< std::endl;
+	}
+
+	double floatMilliseconds = timeDraws(floatMeshes);
+	double packedMilliseconds = timeDraws(packedMeshes);
+
+	std::cout << "  float:  " << floatMeshes.GetVertexBytes() << " vertex bytes, "
+		<< floatMilliseconds << " GPU ms" << std::endl;
+	std::cout << "  packed: " << packedMeshes.GetVertexBytes() << " vertex bytes, "
+		<< packedMilliseconds << " GPU ms" << std::endl;
+
+	glDeleteQueries(1, &query);
+}
+
+/***********************************************************
+ *  RunMeshletBenchmark()
+ *
+ *  This method is used for drawing a field of spheres, tori
+ *  and cylinders all around the camera through a render list
+ *  built every frame, first with every mesh added whole and
+ *  then with only the meshlets that pass the culling tests,
+ *  and printing the triangles submitted along with the CPU
+ *  time of building and submitting the list and the GPU time
+ *  of drawing it.
+ ***********************************************************/
+void BenchmarkManager::RunMeshletBenchmark()
+{
+	if (NULL == m_pShaderManager)
+	{
+		return;
+	}
+
+	ShapeMeshes meshes;
+	meshes.SetMeshletGeneration(true);
+	meshes.LoadCylinderMesh();
+	meshes.LoadSphereMesh();
+	meshes.LoadTaperedCylinderMesh();
+	meshes.LoadTorusMesh();
+
+	const ShapeMeshes::MESH_ID curvedMeshes[] = {
+		ShapeMeshes::SPHERE_MESH, ShapeMeshes::TORUS_MESH,
+		ShapeMeshes::CYLINDER_MESH, ShapeMeshes::TAPERED_CYLINDER_MESH
+	};
+	const int curvedMeshCount = sizeof(curvedMeshes) / sizeof(curvedMeshes[0]);
+
+	RenderList renderList(m_pShaderManager, &meshes, g_DrawBlockBinding);
+	if (renderList.Initialize() == false)
+	{
+		std::cout << "  shader does not declare the draw block - only the submission cost is meaningful" << std::endl;
+	}
+
+	// a grid on the ground around the camera, turned so the
+	// meshlets are seen from every side
+	std::vector<ShapeMeshes::MESH_ID> objectMeshes(g_MeshletObjectCount);
+	std::vector<RenderList::DRAW_DATA> draws(g_MeshletObjectCount);
+	for (int i = 0; i < g_MeshletObjectCount; i++)
+	{
+		glm::vec3 position(
+			((i % g_MeshletGridSize) - g_MeshletGridSize * 0.5f) * 0.5f,
+			-1.0f,
+			((i / g_MeshletGridSize) - g_MeshletGridSize * 0.5f) * 0.5f);
+		objectMeshes[i] = curvedMeshes[i % curvedMeshCount];
+		draws[i].model = glm::translate(position) *
+			glm::rotate((float)i, glm::vec3(0.0f, 1.0f, 0.0f)) *
+			glm::scale(glm::vec3(0.2f, 0.2f, 0.2f));
+		draws[i].objectColor = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);
+		draws[i].UVscale = glm::vec2(1.0f, 1.0f);
+		draws[i].materialIndex = i % 4;
+		draws[i].textureSlot = -1;
+	}
+
+	glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, -0.3f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	glm::mat4 projection = glm::perspective(glm::radians(45.0f), 1.25f, 0.1f, 100.0f);
+	UniformHandle viewHandle = m_pShaderManager->GetUniformHandle("view");
+	UniformHandle projectionHandle = m_pShaderManager->GetUniformHandle("projection");
+	m_pShaderManager->setMat4Value(viewHandle, view);
+	m_pShaderManager->setMat4Value(projectionHandle, projection);
+
+	ClusterCuller culler(&meshes);
+	culler.SetViewTransform(view, projection);
+
+	GLuint query = 0;
+	glGenQueries(1, &query);
+
+	std::cout << "Meshlet benchmark - " << g_MeshletObjectCount << " curved meshes around the camera, "
+		<< g_StressFrames << " frames" << std::endl;
+
+	// add every mesh whole, then only the visible meshlets
+	for (int pass = 0; pass < 2; pass++)
+	{
+		culler.SetEnabled(pass == 1);
+
+		double cpuSeconds = 0.0;
+		double gpuMilliseconds = 0.0;
+		glFinish();
+		for (int frame = 0; frame < g_StressFrames; frame++)
+		{
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			auto start = std::chrono::high_resolution_clock::now();
+			culler.BeginFrame();
+			renderList.Clear();
+			for (int i = 0; i < g_MeshletObjectCount; i++)
+			{
+				culler.AddVisibleMeshlets(objectMeshes[i], draws[i], renderList);
+			}
+			renderList.Compile();
+
+			glBeginQuery(GL_TIME_ELAPSED, query);
+			renderList.Submit();
+			glEndQuery(GL_TIME_ELAPSED);
+			cpuSeconds += ElapsedSeconds(start);
+
+			GLuint64 nanoseconds = 0;
+			glGetQueryObjectui64v(query, GL_QUERY_RESULT, &nanoseconds);
+			gpuMilliseconds += (double)nanoseconds / 1000000.0;
+		}
+
+		const ClusterCuller::CULL_STATS& stats = culler.GetFrameStats();
+		std::cout << ((pass == 0) ? "  whole meshes: " : "  meshlets:     ")
+			<< (cpuSeconds * 1000.0) / g_StressFrames << " CPU ms/frame, "
+			<< gpuMilliseconds / g_StressFrames << " GPU ms/frame, "
+			<< stats.trianglesSubmitted << " triangles in "
+			<< stats.draws << " draws/frame" << std::endl;
+		if (pass == 1)
+		{
+			std::cout << "    " << stats.instancesCulled << " of " << stats.instances << " instances outside the view, "
+				<< stats.frustumCulled << " of " << stats.meshlets << " meshlets outside the view, "
+				<< stats.backfaceCulled << " facing away, "
+				<< stats.trianglesCulled << " triangles culled" << std::endl;
+		}
+	}
+
+	glDeleteQueries(1, &query);
+}
+
+/***********************************************************
+ *  RunResidencyBenchmark()
+ *
+ *  This method is used for comparing the load time and the
+ *  arena memory of loading every mesh up front with loading
+ *  only the meshes the default scene draws, and for printing
+ *  the memory given back when the meshes a scene stopped
+ *  drawing are evicted.
+ ***********************************************************/
+void BenchmarkManager::RunResidencyBenchmark()
+{
+	const int sceneMeshCount = sizeof(g_SceneMeshes) / sizeof(g_SceneMeshes[0]);
+
+	std::cout << "Residency benchmark - " << ShapeMeshes::MESH_COUNT << " meshes, "
+		<< sceneMeshCount << " drawn by the scene" << std::endl;
+
+	// every mesh loaded before the first frame
+	ShapeMeshes eagerMeshes;
+	glFinish();
+	auto start = std::chrono::high_resolution_clock::now();
+	LoadAllMeshes(eagerMeshes);
+	glFinish();
+	double eagerSeconds = ElapsedSeconds(start);
+	std::cout << "  eager: " << eagerSeconds * 1000.0 << " ms, "
+		<< eagerMeshes.GetVertexBytes() << " vertex bytes in "
+		<< eagerMeshes.GetArenaBufferBytes() << " arena buffer bytes" << std::endl;
+
+	// only the meshes the scene draws, loaded when first used
+	ShapeMeshes lazyMeshes;
+	glFinish();
+	start = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < sceneMeshCount; i++)
+	{
+		lazyMeshes.PrefetchMesh(g_SceneMeshes[i]);
+	}
+	glFinish();
+	double lazySeconds = ElapsedSeconds(start);
+	std::cout << "  lazy:  " << lazySeconds * 1000.0 << " ms, "
+		<< lazyMeshes.GetVertexBytes() << " vertex bytes in "
+		<< lazyMeshes.GetArenaBufferBytes() << " arena buffer bytes" << std::endl;
+
+	// the eagerly loaded meshes, once the scene has drawn only
+	// its own meshes for long enough
+	int meshesEvicted = 0;
+	for (GLuint frame = 0; frame <= g_ResidencyEvictionFrames; frame++)
+	{
+		eagerMeshes.BeginFrame();
+		meshesEvicted += eagerMeshes.EvictUnusedMeshes(g_ResidencyEvictionFrames);
+		for (int i = 0; i < sceneMeshCount; i++)
+		{
+			eagerMeshes.MarkMeshUsed(g_SceneMeshes[i]);
+		}
+	}
+	std::cout << "  eager after " << g_ResidencyEvictionFrames << " frames: "
+		<< meshesEvicted << " meshes evicted, "
+		<< eagerMeshes.GetVertexBytes() << " vertex bytes in "
+		<< eagerMeshes.GetArenaBufferBytes() << " arena buffer bytes" << std::endl;
+}
+
+/***********************************************************
+ *  RunStartupBenchmark()
+ *
+ *  This method is used for timing the generation and upload
+ *  of every mesh with all its levels, as the scene meshes
+ *  are set up before the first frame - first on the GL
+ *  thread alone, then on 1, 2, 4 and up to one worker
+ *  thread per core.
+ ***********************************************************/
+void BenchmarkManager::RunStartupBenchmark()
+{
+	std::vector<ShapeMeshes::MESH_ID> allMeshes;
+	for (int meshID = 0; meshID < ShapeMeshes::MESH_COUNT; meshID++)
+	{
+		allMeshes.push_back((ShapeMeshes::MESH_ID)meshID);
+	}
+
+	unsigned int cores = std::thread::hardware_concurrency();
+	if (cores == 0)
+	{
+		cores = 1;
+	}
+
+	std::cout << "Startup benchmark - " << ShapeMeshes::MESH_COUNT << " meshes with "
+		<< ShapeMeshes::LOD_LEVEL_COUNT << " levels, packed and split into meshlets, "
+		<< g_StartupRepeats << " times, " << cores << " cores" << std::endl;
+
+	// every mesh generated and uploaded by the GL thread
+	double serialSeconds = 0.0;
+	for (int repeat = 0; repeat < g_StartupRepeats; repeat++)
+	{
+		ShapeMeshes meshes(ShapeMeshes::PACKED_VERTEX_FORMAT);
+		meshes.SetMeshletGeneration(true);
+		glFinish();
+		auto start = std::chrono::high_resolution_clock::now();
+		LoadAllMeshes(meshes);
+		glFinish();
+		serialSeconds += ElapsedSeconds(start);
+	}
+	std::cout << "  GL thread only: " << (serialSeconds * 1000.0) / g_StartupRepeats << " ms" << std::endl;
+
+	// the workers generate while the GL thread uploads
+	unsigned int workerCount = 1;
+	while (true)
+	{
+		JobSystem jobSystem(workerCount);
+		double seconds = 0.0;
+		for (int repeat = 0; repeat < g_StartupRepeats; repeat++)
+		{
+			ShapeMeshes meshes(ShapeMeshes::PACKED_VERTEX_FORMAT);
+			meshes.SetMeshletGeneration(true);
+			glFinish();
+			auto start = std::chrono::high_resolution_clock::now();
+			meshes.LoadMeshes(allMeshes.data(), (int)allMeshes.size(), jobSystem);
+			glFinish();
+			seconds += ElapsedSeconds(start);
+		}
+		std::cout << "  " << workerCount << ((workerCount == 1) ? " worker:  " : " workers: ")
+			<< (seconds * 1000.0) / g_StartupRepeats << " ms, "
+			<< serialSeconds / seconds << "x" << std::endl;
+
+		if (workerCount >= cores)
+		{
+			break;
+		}
+		workerCount = std::min(workerCount * 2, cores);
+	}
+}
+
+/***********************************************************
+ *  RunStreamBenchmark()
+ *
+ *  This method is used for drawing a field of boxes that
+ *  move every frame one draw call at a time, passing the
+ *  values of each draw first through the uniforms, then
+ *  through a small storage buffer updated before every draw,
+ *  and then through the persistently mapped stream buffer,
+ *  and printing the CPU submit time and the full frame time
+ *  of each pass.
+ ***********************************************************/
+void BenchmarkManager::RunStreamBenchmark()
+{
+	if (NULL == m_pShaderManager)
+	{
+		return;
+	}
+
+	ShapeMeshes meshes;
+	meshes.LoadBoxMesh();
+
+	if (m_pShaderManager->BindStorageBlock("DrawBlock", g_DrawBlockBinding) == false)
+	{
+		std::cout << "  shader does not declare the draw block - only the submission cost is meaningful" << std::endl;
+	}
+
+	GLint alignment = 1;
+	glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+	GLsizeiptr drawSize = sizeof(RenderList::DRAW_DATA);
+	GLsizeiptr alignedSize = (alignment > 1) ? ((drawSize + alignment - 1) / alignment) * alignment : drawSize;
+
+	StreamBuffer stream(alignedSize * g_StreamObjectCount);
+	if (stream.Initialize() == false)
+	{
+		std::cout << "Stream benchmark - persistent mapping is not supported" << std::endl;
+		return;
+	}
+
+	// lay the boxes out on a square grid
+	std::vector<glm::vec3> positions(g_StreamObjectCount);
+	std::vector<RenderList::DRAW_DATA> draws(g_StreamObjectCount);
+	int gridSize = (int)ceil(sqrt((double)g_StreamObjectCount));
+	for (int i = 0; i < g_StreamObjectCount; i++)
+	{
+		positions[i] = glm::vec3((i % gridSize) - gridSize * 0.5f, 0.0f, -(float)(i / gridSize));
+		draws[i].objectColor = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);
+		draws[i].UVscale = glm::vec2(1.0f, 1.0f);
+		draws[i].materialIndex = i % 4;
+		draws[i].textureSlot = -1;
+	}
+
+	// every box spins at its own rate
+	auto moveBoxes = [&](int frame)
+	{
+		for (int i = 0; i < g_StreamObjectCount; i++)
+		{
+			float angle = 0.01f * (float)(frame * (1 + i % 7));
+			draws[i].model = glm::translate(positions[i]) *
+				glm::rotate(angle, glm::vec3(0.0f, 1.0f, 0.0f)) * glm::scale(glm::vec3(0.5f, 0.5f, 0.5f));
+		}
+	};
+
+	UniformHandle model = m_pShaderManager->GetUniformHandle("model");
+	UniformHandle materialIndex = m_pShaderManager->GetUniformHandle("materialIndex");
+	UniformHandle useTexture = m_pShaderManager->GetUniformHandle("bUseTexture");
+	UniformHandle objectColor = m_pShaderManager->GetUniformHandle("objectColor");
+	UniformHandle useDrawList = m_pShaderManager->GetUniformHandle("bUseDrawList");
+
+	std::cout << "Stream benchmark - " << g_StreamObjectCount << " moving boxes, "
+		<< g_StressFrames << " frames, " << StreamBuffer::REGION_COUNT << " stream regions of "
+		<< stream.GetRegionSize() / 1024 << " KB" << std::endl;
+
+	// one set of uniforms per box
+	double submitSeconds = 0.0;
+	glFinish();
+	auto start = std::chrono::high_resolution_clock::now();
+	for (int frame = 0; frame < g_StressFrames; frame++)
+	{
+		moveBoxes(frame);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		auto submitStart = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < g_StreamObjectCount; i++)
+		{
+			m_pShaderManager->setMat4Value(model, draws[i].model);
+			m_pShaderManager->setIntValue(useTexture, false);
+			m_pShaderManager->setVec4Value(objectColor, draws[i].objectColor);
+			m_pShaderManager->setIntValue(materialIndex, draws[i].materialIndex);
+			meshes.DrawBoxMesh();
+		}
+		submitSeconds += ElapsedSeconds(submitStart);
+	}
+	glFinish();
+	double uniformSeconds = ElapsedSeconds(start);
+	double uniformSubmitSeconds = submitSeconds;
+
+	// one buffer update per box, which the driver has to keep
+	// apart from the values earlier draws still read
+	GLuint drawBuffer = 0;
+	glCreateBuffers(1, &drawBuffer);
+	glNamedBufferData(drawBuffer, drawSize, NULL, GL_DYNAMIC_DRAW);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, g_DrawBlockBinding, drawBuffer);
+	m_pShaderManager->setBoolValue(useDrawList, true);
+
+	submitSeconds = 0.0;
+	glFinish();
+	start = std::chrono::high_resolution_clock::now();
+	for (int frame = 0; frame < g_StressFrames; frame++)
+	{
+		moveBoxes(frame);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		auto submitStart = std::chrono::high_resolution_clock::now();
+		for (int i = 0; i < g_StreamObjectCount; i++)
+		{
+			glNamedBufferSubData(drawBuffer, 0, drawSize, &draws[i]);
+			meshes.DrawBoxMesh();
+		}
+		submitSeconds += ElapsedSeconds(submitStart);
+	}
+	glFinish();
+	double subDataSeconds = ElapsedSeconds(start);
+	double subDataSubmitSeconds = submitSeconds;
+	glDeleteBuffers(1, &drawBuffer);
+
+	// one bound range of the frame region per box
+	GLuint fenceWaits = 0;
+	GLuint overflows = 0;
+	submitSeconds = 0.0;
+	glFinish();
+	start = std::chrono::high_resolution_clock::now();
+	for (int frame = 0; frame < g_StressFrames; frame++)
+	{
+		moveBoxes(frame);
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		auto submitStart = std::chrono::high_resolution_clock::now();
+		stream.BeginFrame();
+		for (int i = 0; i < g_StreamObjectCount; i++)
+		{
+			GLintptr offset = stream.Write(&draws[i], drawSize, alignment);
+			if (offset >= 0)
+			{
+				stream.BindRange(GL_SHADER_STORAGE_BUFFER, g_DrawBlockBinding, offset, drawSize);
+				meshes.DrawBoxMesh();
+			}
+		}
+		stream.EndFrame();
+		submitSeconds += ElapsedSeconds(submitStart);
+		fenceWaits += stream.GetFrameStats().fenceWaits;
+		overflows += stream.GetFrameStats().overflows;
+	}
+	glFinish();
+	double streamSeconds = ElapsedSeconds(start);
+	m_pShaderManager->setBoolValue(useDrawList, false);
+
+	std::cout << "  uniforms: submit " << (uniformSubmitSeconds * 1000.0) / g_StressFrames << " ms/frame, total "
+		<< (uniformSeconds * 1000.0) / g_StressFrames << " ms/frame, 4 uniform calls/draw" << std::endl;
+	std::cout << "  sub-data: submit " << (subDataSubmitSeconds * 1000.0) / g_StressFrames << " ms/frame, total "
+		<< (subDataSeconds * 1000.0) / g_StressFrames << " ms/frame, 1 buffer update/draw" << std::endl;
+	std::cout << "  streamed: submit " << (submitSeconds * 1000.0) / g_StressFrames << " ms/frame, total "
+		<< (streamSeconds * 1000.0) / g_StressFrames << " ms/frame, 1 bound range/draw, "
+		<< fenceWaits << " fence waits, " << overflows << " overflows" << std::endl;
+}
+
+/***********************************************************
+ *  RunFrustumBenchmark()
+ *
+ *  This method is used for scattering many objects all
+ *  around the camera and timing the frustum test of their
+ *  world boxes, four at a time and one at a time, before
+ *  drawing every object and then only the objects in the
+ *  view, and printing the CPU time each culled object costs
+ *  and saves.
+ ***********************************************************/
+void BenchmarkManager::RunFrustumBenchmark()
+{
+	if (NULL == m_pShaderManager)
+	{
+		return;
+	}
+
+	ShapeMeshes meshes;
+	LoadAllMeshes(meshes);
+
+	// random meshes at random places, turns and sizes
+	std::mt19937 random(330);
+	std::uniform_real_distribution<float> place(-g_FrustumSceneExtent, g_FrustumSceneExtent);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	std::vector<ShapeMeshes::MESH_ID> objectMeshes(g_FrustumObjectCount);
+	std::vector<glm::mat4> models(g_FrustumObjectCount);
+	for (int i = 0; i < g_FrustumObjectCount; i++)
+	{
+		objectMeshes[i] = (ShapeMeshes::MESH_ID)(i % ShapeMeshes::MESH_COUNT);
+		float x = place(random);
+		float y = place(random);
+		float z = place(random);
+		float angle = unit(random) * 6.2831853f;
+		models[i] = glm::translate(glm::vec3(x, y, z)) *
+			glm::rotate(angle, glm::vec3(0.0f, 1.0f, 0.0f)) *
+			glm::scale(glm::vec3(0.5f + unit(random)));
+	}
+
+	glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	glm::mat4 projection = glm::perspective(glm::radians(45.0f), 1.25f, 0.1f, 100.0f);
+	m_pShaderManager->setMat4Value("view", view);
+	m_pShaderManager->setMat4Value("projection", projection);
+
+	std::cout << "Frustum benchmark - " << g_FrustumObjectCount << " objects within "
+		<< g_FrustumSceneExtent << " units of the camera, " << g_StressFrames << " frames" << std::endl;
+
+	// move the mesh bounds into world space
+	WorldBounds bounds;
+	auto start = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < g_FrustumObjectCount; i++)
+	{
+		ShapeMeshes::MESH_BOUNDS meshBounds;
+		if (meshes.GetMeshBounds(objectMeshes[i], meshBounds) == true)
+		{
+			bounds.Add(meshBounds, models[i]);
+		}
+	}
+	double boundsSeconds = ElapsedSeconds(start);
+	if ((int)bounds.GetCount() != g_FrustumObjectCount)
+	{
+		return;
+	}
+
+	FrustumCuller culler;
+	culler.SetViewTransform(view, projection);
+	std::vector<uint8_t> visible;
+
+	// four boxes per test
+	GLuint visibleCount = 0;
+	start = std::chrono::high_resolution_clock::now();
+	for (int frame = 0; frame < g_StressFrames; frame++)
+	{
+		culler.BeginFrame();
+		visibleCount = culler.CullObjects(bounds, visible);
+	}
+	double groupedSeconds = ElapsedSeconds(start) / g_StressFrames;
+	FrustumCuller::CULL_STATS stats = culler.GetFrameStats();
+
+	// one box per test
+	GLuint singleVisibleCount = 0;
+	start = std::chrono::high_resolution_clock::now();
+	for (int frame = 0; frame < g_StressFrames; frame++)
+	{
+		culler.BeginFrame();
+		singleVisibleCount = 0;
+		for (GLuint object = 0; object < bounds.GetCount(); object++)
+		{
+			singleVisibleCount += (culler.IsObjectVisible(bounds, object) == true) ? 1 : 0;
+		}
+	}
+	double singleSeconds = ElapsedSeconds(start) / g_StressFrames;
+
+	UniformHandle model = m_pShaderManager->GetUniformHandle("model");
+
+	// every object, then only the objects in the view
+	double submitSeconds[2] = { 0.0, 0.0 };
+	double frameSeconds[2] = { 0.0, 0.0 };
+	for (int pass = 0; pass < 2; pass++)
+	{
+		glFinish();
+		auto passStart = std::chrono::high_resolution_clock::now();
+		for (int frame = 0; frame < g_StressFrames; frame++)
+		{
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			auto submitStart = std::chrono::high_resolution_clock::now();
+			if (pass == 1)
+			{
+				culler.CullObjects(bounds, visible);
+			}
+			for (int i = 0; i < g_FrustumObjectCount; i++)
+			{
+				if ((pass == 1) && (visible[i] == 0))
+				{
+					continue;
+				}
+				m_pShaderManager->setMat4Value(model, models[i]);
+				meshes.DrawMesh(objectMeshes[i]);
+			}
+			submitSeconds[pass] += ElapsedSeconds(submitStart);
+		}
+		glFinish();
+		frameSeconds[pass] = ElapsedSeconds(passStart);
+	}
+
+	double culledCount = (double)stats.culled;
+	std::cout << "  " << stats.tested << " objects tested, " << stats.culled << " culled, "
+		<< visibleCount << " in the view" << std::endl;
+	std::cout << "  world bounds: " << (boundsSeconds * 1000000000.0) / g_FrustumObjectCount << " ns/object" << std::endl;
+	std::cout << "  4 per test:   " << groupedSeconds * 1000.0 << " ms/frame, "
+		<< (groupedSeconds * 1000000000.0) / g_FrustumObjectCount << " ns/object" << std::endl;
+	std::cout << "  1 per test:   " << singleSeconds * 1000.0 << " ms/frame, "
+		<< (singleSeconds * 1000000000.0) / g_FrustumObjectCount << " ns/object, "
+		<< ((singleVisibleCount == visibleCount) ? "same" : "different") << " result" << std::endl;
+	std::cout << "  draw all:     submit " << (submitSeconds[0] * 1000.0) / g_StressFrames << " ms/frame, total "
+		<< (frameSeconds[0] * 1000.0) / g_StressFrames << " ms/frame" << std::endl;
+	std::cout << "  draw culled:  submit " << (submitSeconds[1] * 1000.0) / g_StressFrames << " ms/frame, total "
+		<< (frameSeconds[1] * 1000.0) / g_StressFrames << " ms/frame" << std::endl;
+	if (culledCount > 0.0)
+	{
+		std::cout << "  per culled object: test " << (groupedSeconds * 1000000000.0) / culledCount
+			<< " ns, submit saved " << ((submitSeconds[0] - submitSeconds[1]) * 1000000000.0) / (g_StressFrames * culledCount)
+			<< " ns" << std::endl;
+	}
+}
+
+/***********************************************************
+ *  RunHierarchyBenchmark()
+ *
+ *  This method is used for building the bounding volume tree
+ *  over 10k, 100k and 1M scattered objects, moving them for
+ *  some frames with the tree refit after each, and timing
+ *  frustum culling, ray picking and distance queries through
+ *  the tree against testing every object.
+ ***********************************************************/
+void BenchmarkManager::RunHierarchyBenchmark()
+{
+	ShapeMeshes meshes;
+	LoadAllMeshes(meshes);
+
+	ShapeMeshes::MESH_BOUNDS meshBounds[ShapeMeshes::MESH_COUNT];
+	for (int meshID = 0; meshID < ShapeMeshes::MESH_COUNT; meshID++)
+	{
+		if (meshes.GetMeshBounds((ShapeMeshes::MESH_ID)meshID, meshBounds[meshID]) == false)
+		{
+			return;
+		}
+	}
+
+	glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	glm::mat4 projection = glm::perspective(glm::radians(45.0f), 1.25f, 0.1f, 100.0f);
+	FrustumCuller culler;
+	culler.SetViewTransform(view, projection);
+
+	std::cout << "Bounding volume tree benchmark - " << g_HierarchyMoveFrames << " frames of movement, "
+		<< g_HierarchyQueryCount << " queries of each kind" << std::endl;
+
+	for (size_t size = 0; size < sizeof(g_HierarchyObjectCounts) / sizeof(g_HierarchyObjectCounts[0]); size++)
+	{
+		int objectCount = g_HierarchyObjectCounts[size];
+		float extent = g_FrustumSceneExtent * (float)cbrt((double)objectCount / g_FrustumObjectCount);
+
+		std::mt19937 random(330);
+		std::uniform_real_distribution<float> place(-extent, extent);
+		std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+		std::vector<glm::vec3> positions(objectCount);
+		std::vector<glm::mat4> shapes(objectCount);
+		for (int i = 0; i < objectCount; i++)
+		{
+			positions[i] = glm::vec3(place(random), place(random), place(random));
+			shapes[i] = glm::rotate(unit(random) * 6.2831853f, glm::vec3(0.0f, 1.0f, 0.0f)) *
+				glm::scale(glm::vec3(0.5f + unit(random)));
+		}
+
+		WorldBounds bounds;
+		auto addObjects = [&]()
+		{
+			bounds.Clear();
+			for (int i = 0; i < objectCount; i++)
+			{
+				bounds.Add(meshBounds[i % ShapeMeshes::MESH_COUNT], glm::translate(positions[i]) * shapes[i]);
+			}
+		};
+		addObjects();
+
+		BoundsHierarchy hierarchy;
+		auto start = std::chrono::high_resolution_clock::now();
+		hierarchy.Build(bounds);
+		double buildSeconds = ElapsedSeconds(start);
+		float buildCost = hierarchy.GetBuildCost();
+
+		// every object drifts a little each frame
+		std::uniform_real_distribution<float> drift(-0.5f, 0.5f);
+		double updateSeconds = 0.0;
+		GLuint buildsBefore = hierarchy.GetBuildCount();
+		for (int frame = 0; frame < g_HierarchyMoveFrames; frame++)
+		{
+			for (int i = 0; i < objectCount; i++)
+			{
+				positions[i] += glm::vec3(drift(random), drift(random), drift(random));
+			}
+			addObjects();
+			start = std::chrono::high_resolution_clock::now();
+			hierarchy.Update(bounds);
+			updateSeconds += ElapsedSeconds(start);
+		}
+		GLuint rebuilds = hierarchy.GetBuildCount() - buildsBefore;
+
+		// the view, every object and then through the tree
+		std::vector<uint8_t> visible;
+		culler.BeginFrame();
+		start = std::chrono::high_resolution_clock::now();
+		GLuint linearVisible = culler.CullObjects(bounds, visible);
+		double linearCullSeconds = ElapsedSeconds(start);
+		culler.BeginFrame();
+		start = std::chrono::high_resolution_clock::now();
+		GLuint treeVisible = culler.CullObjects(bounds, hierarchy, visible);
+		double treeCullSeconds = ElapsedSeconds(start);
+		GLuint nodesTested = culler.GetFrameStats().nodesTested;
+
+		// rays from the middle of the scene, every object and then
+		// through the tree
+		std::vector<glm::vec3> directions(g_HierarchyQueryCount);
+		std::vector<glm::vec3> points(g_HierarchyQueryCount);
+		for (int query = 0; query < g_HierarchyQueryCount; query++)
+		{
+			directions[query] = glm::normalize(glm::vec3(place(random), place(random), place(random)));
+			points[query] = glm::vec3(place(random), place(random), place(random));
+		}
+
+		int rayMismatches = 0;
+		std::vector<GLuint> linearHits(g_HierarchyQueryCount, (GLuint)-1);
+		start = std::chrono::high_resolution_clock::now();
+		for (int query = 0; query < g_HierarchyQueryCount; query++)
+		{
+			glm::vec3 inverseDirection = 1.0f / directions[query];
+			float nearest = extent * 4.0f;
+			for (GLuint object = 0; object < bounds.GetCount(); object++)
+			{
+				float distance = 0.0f;
+				if ((BoundsHierarchy::IntersectRayBox(glm::vec3(0.0f), inverseDirection, nearest,
+					bounds.GetBoxMin(object), bounds.GetBoxMax(object), distance) == true) && (distance < nearest))
+				{
+					nearest = distance;
+					linearHits[query] = object;
+				}
+			}
+		}
+		double linearRaySeconds = ElapsedSeconds(start);
+
+		start = std::chrono::high_resolution_clock::now();
+		for (int query = 0; query < g_HierarchyQueryCount; query++)
+		{
+			GLuint object = (GLuint)-1;
+			float distance = 0.0f;
+			hierarchy.Raycast(bounds, glm::vec3(0.0f), directions[query], extent * 4.0f, object, distance);
+			if (object != linearHits[query])
+			{
+				rayMismatches++;
+			}
+		}
+		double treeRaySeconds = ElapsedSeconds(start);
+
+		// objects near random points, every object and then
+		// through the tree
+		std::vector<GLuint> nearObjects;
+		float distanceSquared = g_HierarchyQueryDistance * g_HierarchyQueryDistance;
+		GLuint linearNear = 0;
+		start = std::chrono::high_resolution_clock::now();
+		for (int query = 0; query < g_HierarchyQueryCount; query++)
+		{
+			for (GLuint object = 0; object < bounds.GetCount(); object++)
+			{
+				if (BoundsHierarchy::DistanceToBoxSquared(points[query], bounds.GetBoxMin(object), bounds.GetBoxMax(object)) <= distanceSquared)
+				{
+					linearNear++;
+				}
+			}
+		}
+		double linearNearSeconds = ElapsedSeconds(start);
+
+		GLuint treeNear = 0;
+		start = std::chrono::high_resolution_clock::now();
+		for (int query = 0; query < g_HierarchyQueryCount; query++)
+		{
+			nearObjects.clear();
+			treeNear += hierarchy.FindWithinDistance(bounds, points[query], g_HierarchyQueryDistance, nearObjects);
+		}
+		double treeNearSeconds = ElapsedSeconds(start);
+
+		start = std::chrono::high_resolution_clock::now();
+		for (int query = 0; query < g_HierarchyQueryCount; query++)
+		{
+			GLuint object = 0;
+			float distance = 0.0f;
+			hierarchy.FindNearest(bounds, points[query], object, distance);
+		}
+		double treeNearestSeconds = ElapsedSeconds(start);
+
+		std::cout << "  " << objectCount << " objects: " << hierarchy.GetNodes().size() << " nodes, build "
+			<< buildSeconds * 1000.0 << " ms, cost " << buildCost << ", update "
+			<< (updateSeconds * 1000.0) / g_HierarchyMoveFrames << " ms/frame, "
+			<< rebuilds << " rebuilds, cost after moving " << hierarchy.GetCost() << std::endl;
+		std::cout << "    frustum: every object " << linearCullSeconds * 1000.0 << " ms, tree "
+			<< treeCullSeconds * 1000.0 << " ms with " << nodesTested << " nodes tested, "
+			<< treeVisible << " visible" << ((treeVisible == linearVisible) ? "" : " (different)") << std::endl;
+		std::cout << "    rays:    every object " << (linearRaySeconds * 1000000.0) / g_HierarchyQueryCount << " us, tree "
+			<< (treeRaySeconds * 1000000.0) / g_HierarchyQueryCount << " us per ray, "
+			<< rayMismatches << " different hits" << std::endl;
+		std::cout << "    near:    every object " << (linearNearSeconds * 1000000.0) / g_HierarchyQueryCount << " us, tree "
+			<< (treeNearSeconds * 1000000.0) / g_HierarchyQueryCount << " us per query, "
+			<< treeNear << " of " << linearNear << " objects found, nearest object "
+			<< (treeNearestSeconds * 1000000.0) / g_HierarchyQueryCount << " us per query" << std::endl;
+	}
+}
+
+/***********************************************************
+ *  RunTextureBenchmark()
+ *
+ *  This method is used for writing a set of test images and
+ *  timing how long the scene waits for its first frame and
+ *  for every texture to show its image - first with each
+ *  image decoded and uploaded on the GL thread before the
+ *  first frame, as the textures were loaded before, then
+ *  with the images decoded on 1, 2, 4 and up to one worker
+ *  thread per core while the frames are drawn.
+ ***********************************************************/
+void BenchmarkManager::RunTextureBenchmark()
+{
+	std::vector<std::string> filenames;
+	if (WriteTestImages("benchmark_texture_", g_TextureImageCount, g_TextureImageSize, filenames) == false)
+	{
+		return;
+	}
+
+	unsigned int cores = std::thread::hardware_concurrency();
+	if (cores == 0)
+	{
+		cores = 1;
+	}
+
+	std::cout << "Texture benchmark - " << g_TextureImageCount << " RGB images of "
+		<< g_TextureImageSize << "x" << g_TextureImageSize << ", " << g_TextureRepeats
+		<< " times, " << cores << " cores" << std::endl;
+
+	std::vector<GLuint> textures(filenames.size());
+
+	// every image loaded on the GL thread, so the first frame
+	// waits for all of them
+	double serialSeconds = 0.0;
+	for (int repeat = 0; repeat < g_TextureRepeats; repeat++)
+	{
+		glFinish();
+		auto start = std::chrono::high_resolution_clock::now();
+		{
+			TextureLoader loader(NULL);
+			for (size_t image = 0; image < filenames.size(); image++)
+			{
+				textures[image] = loader.RequestTexture(filenames[image].c_str());
+			}
+		}
+		glFinish();
+		serialSeconds += ElapsedSeconds(start);
+		glDeleteTextures((GLsizei)textures.size(), textures.data());
+	}
+	std::cout << "  GL thread only: first frame and all textures " << (serialSeconds * 1000.0) / g_TextureRepeats << " ms" << std::endl;
+
+	// the first frame is drawn with the placeholders once the
+	// scene meshes are generated on the same workers, as in
+	// PrepareScene(), and every later frame uploads the images
+	// decoded so far
+	unsigned int workerCount = 1;
+	while (true)
+	{
+		JobSystem jobSystem(workerCount);
+
+		// the meshes alone, for the first frame to compare with
+		double meshSeconds = 0.0;
+		for (int repeat = 0; repeat < g_TextureRepeats; repeat++)
+		{
+			glFinish();
+			auto start = std::chrono::high_resolution_clock::now();
+			ShapeMeshes meshes;
+			meshes.LoadMeshes(g_SceneMeshes, sizeof(g_SceneMeshes) / sizeof(g_SceneMeshes[0]), jobSystem);
+			glFinish();
+			meshSeconds += ElapsedSeconds(start);
+		}
+
+		double firstFrameSeconds = 0.0;
+		double residentSeconds = 0.0;
+		double decodeSeconds = 0.0;
+		double uploadSeconds = 0.0;
+		for (int repeat = 0; repeat < g_TextureRepeats; repeat++)
+		{
+			glFinish();
+			auto start = std::chrono::high_resolution_clock::now();
+			TextureLoader loader(&jobSystem);
+			for (size_t image = 0; image < filenames.size(); image++)
+			{
+				textures[image] = loader.RequestTexture(filenames[image].c_str());
+			}
+			ShapeMeshes meshes;
+			meshes.LoadMeshes(g_SceneMeshes, sizeof(g_SceneMeshes) / sizeof(g_SceneMeshes[0]), jobSystem);
+			loader.UploadDecodedTextures();
+			glFinish();
+			firstFrameSeconds += ElapsedSeconds(start);
+
+			loader.FinishAll();
+			glFinish();
+			residentSeconds += ElapsedSeconds(start);
+			decodeSeconds += loader.GetStats().decodeSeconds;
+			uploadSeconds += loader.GetStats().uploadSeconds;
+			glDeleteTextures((GLsizei)textures.size(), textures.data());
+		}
+		std::cout << "  " << workerCount << ((workerCount == 1) ? " worker:  " : " workers: ")
+			<< "first frame " << (firstFrameSeconds * 1000.0) / g_TextureRepeats << " ms (meshes alone "
+			<< (meshSeconds * 1000.0) / g_TextureRepeats << " ms), all textures "
+			<< (residentSeconds * 1000.0) / g_TextureRepeats << " ms, "
+			<< serialSeconds / residentSeconds << "x, decode "
+			<< (decodeSeconds * 1000.0) / g_TextureRepeats << " ms, upload "
+			<< (uploadSeconds * 1000.0) / g_TextureRepeats << " ms" << std::endl;
+
+		if (workerCount >= cores)
+		{
+			break;
+		}
+		workerCount = std::min(workerCount * 2, cores);
+	}
+
+	for (size_t image = 0; image < filenames.size(); image++)
+	{
+		remove(filenames[image].c_str());
+	}
+}
+
+/***********************************************************
+ *  RunTextureCacheBenchmark()
+ *
+ *  This method is used for loading the test images on every
+ *  core three ways - decoded with mipmaps generated by the
+ *  driver, cooked into an empty texture cache, and mapped
+ *  from the cache as compressed levels - and printing the
+ *  time until every texture is resident and its bytes.
+ ***********************************************************/
+void BenchmarkManager::RunTextureCacheBenchmark()
+{
+	if (GLEW_EXT_texture_compression_s3tc == false)
+	{
+		std::cout << "S3TC texture compression is not supported" << std::endl;
+		return;
+	}
+
+	std::vector<std::string> filenames;
+	if (WriteTestImages("benchmark_texture_", g_TextureImageCount, g_TextureImageSize, filenames) == false)
+	{
+		return;
+	}
+
+	// the cache files are written next to the images
+	TextureCache cache(".");
+	JobSystem jobSystem;
+	std::cout << "Texture cache benchmark - " << g_TextureImageCount << " RGB images of "
+		<< g_TextureImageSize << "x" << g_TextureImageSize << ", "
+		<< jobSystem.GetWorkerCount() << " workers" << std::endl;
+
+	std::vector<GLuint> textures(filenames.size());
+	const char* passNames[] = { "  decoded:      ", "  cooked:       ", "  from cache:   " };
+	double decodedSeconds = 0.0;
+	size_t decodedBytes = 0;
+	for (int pass = 0; pass < 3; pass++)
+	{
+		glFinish();
+		auto start = std::chrono::high_resolution_clock::now();
+		TextureLoader loader(&jobSystem);
+		loader.SetTextureCache((pass == 0) ? NULL : &cache);
+		for (size_t image = 0; image < filenames.size(); image++)
+		{
+			textures[image] = loader.RequestTexture(filenames[image].c_str());
+		}
+		loader.FinishAll();
+		glFinish();
+		double seconds = ElapsedSeconds(start);
+		glDeleteTextures((GLsizei)textures.size(), textures.data());
+
+		const TextureLoader::LOAD_STATS& stats = loader.GetStats();
+		if (pass == 0)
+		{
+			decodedSeconds = seconds;
+			decodedBytes = stats.textureBytes;
+		}
+		std::cout << passNames[pass] << seconds * 1000.0 << " ms, " << decodedSeconds / seconds << "x, "
+			<< stats.textureBytes / (1024 * 1024) << " MB of textures, "
+			<< (double)decodedBytes / stats.textureBytes << "x smaller, "
+			<< stats.cacheHits << " from the cache, " << stats.failed << " failed" << std::endl;
+	}
+
+	for (size_t image = 0; image < filenames.size(); image++)
+	{
+		remove(cache.GetCachePath(filenames[image].c_str()).c_str());
+		remove(filenames[image].c_str());
+	}
+}
+
+/***********************************************************
+ *  RunIngestBenchmark()
+ *
+ *  This method is used for writing a directory worth of
+ *  large images and reading them one after another three
+ *  ways - through stb_image reading the file with stdio,
+ *  decoded from the mapped file, and mapped from the texture
+ *  cache as compressed levels without decoding - and printing
+ *  the time and the growth of the resident memory of each.
+ ***********************************************************/
+void BenchmarkManager::RunIngestBenchmark()
+{
+	std::vector<std::string> filenames;
+	if (WriteTestImages("benchmark_ingest_", g_IngestImageCount, g_IngestImageSize, filenames) == false)
+	{
+		return;
+	}
+
+	// the cache files are written next to the images, before the
+	// passes are timed
+	TextureCache cache(".");
+	for (size_t image = 0; image < filenames.size(); image++)
+	{
+		TextureCache::COMPRESSED_TEXTURE texture;
+		bool bCacheHit = false;
+		cache.LoadTexture(filenames[image].c_str(), texture, bCacheHit);
+		TextureCache::ReleaseTexture(texture);
+	}
+
+	bool bPeakReset = ResetPeakResidentBytes();
+	std::cout << "Ingestion benchmark - " << g_IngestImageCount << " RGB images of "
+		<< g_IngestImageSize << "x" << g_IngestImageSize
+		<< ((bPeakReset == true) ? "" : ", peak resident bytes since launch") << std::endl;
+
+	// only this thread decodes the images
+	stbi_set_flip_vertically_on_load_thread(1);
+	const char* passNames[] = { "  stdio:         ", "  mapped:        ", "  mapped cache:  " };
+	for (int pass = 0; pass < 3; pass++)
+	{
+		ResetPeakResidentBytes();
+		size_t startBytes = 0;
+		size_t peakBytes = 0;
+		GetResidentBytes(startBytes, peakBytes);
+
+		size_t bytesRead = 0;
+		auto start = std::chrono::high_resolution_clock::now();
+		for (size_t image = 0; image < filenames.size(); image++)
+		{
+			int width = 0;
+			int height = 0;
+			int channels = 0;
+			unsigned char* pPixels = NULL;
+			if (pass == 0)
+			{
+				pPixels = stbi_load(filenames[image].c_str(), &width, &height, &channels, 0);
+			}
+			else if (pass == 1)
+			{
+				pPixels = TextureCache::DecodeImageFile(filenames[image].c_str(), width, height, channels, 0);
+			}
+			else
+			{
+				// every level is read, as the upload would read it
+				TextureCache::COMPRESSED_TEXTURE texture;
+				bool bCacheHit = false;
+				if (cache.LoadTexture(filenames[image].c_str(), texture, bCacheHit) == true)
+				{
+					const unsigned char* pData = texture.GetLevelData();
+					unsigned int sum = 0;
+					for (size_t byte = 0; byte < texture.GetDataSize(); byte += 64)
+					{
+						sum += pData[byte];
+					}
+					bytesRead += texture.GetDataSize() + (sum & 1);
+				}
+				TextureCache::ReleaseTexture(texture);
+				continue;
+			}
+			bytesRead += (size_t)width * height * channels;
+			stbi_image_free(pPixels);
+		}
+		double seconds = ElapsedSeconds(start);
+
+		size_t endBytes = 0;
+		GetResidentBytes(endBytes, peakBytes);
+		std::cout << passNames[pass] << seconds * 1000.0 << " ms, "
+			<< (bytesRead / (1024 * 1024)) / seconds << " MB/s out, peak resident growth "
+			<< (double)(peakBytes - std::min(peakBytes, startBytes)) / (1024.0 * 1024.0) << " MB" << std::endl;
+	}
+
+	for (size_t image = 0; image < filenames.size(); image++)
+	{
+		remove(cache.GetCachePath(filenames[image].c_str()).c_str());
+		remove(filenames[image].c_str());
+	}
+}
+
+/***********************************************************
+ *  RunTagBenchmark()
+ *
+ *  This method is used for measuring how the draws find their
+ *  texture and material among 10k of each - by comparing the
+ *  tag string with every loaded tag as the scene manager used
+ *  to, by hashing the tag string into the tag interner, and
+ *  by the tag IDs interned when the scene is prepared.  No GL
+ *  calls are made, so only the lookups are timed.
+ ***********************************************************/
+void BenchmarkManager::RunTagBenchmark()
+{
+	// loaded tags with the slot or index of each, as the scene
+	// manager keeps them
+	struct LOADED_TAG
+	{
+		std::string tag;
+		int value;
+	};
+
+	std::vector<LOADED_TAG> textures(g_TagCount);
+	std::vector<LOADED_TAG> materials(g_TagCount);
+	char tag[32];
+	for (int i = 0; i < g_TagCount; i++)
+	{
+		snprintf(tag, sizeof(tag), "texture_%05d", i);
+		textures[i].tag = tag;
+		textures[i].value = i;
+		snprintf(tag, sizeof(tag), "material_%05d", i);
+		materials[i].tag = tag;
+		materials[i].value = i;
+	}
+
+	// the tags of every draw, written in the scene as literals
+	std::mt19937 random(330);
+	std::uniform_int_distribution<int> pick(0, g_TagCount - 1);
+	std::vector<const char*> drawTextures(g_TagDrawCount);
+	std::vector<const char*> drawMaterials(g_TagDrawCount);
+	for (int draw = 0; draw < g_TagDrawCount; draw++)
+	{
+		drawTextures[draw] = textures[pick(random)].tag.c_str();
+		drawMaterials[draw] = materials[pick(random)].tag.c_str();
+	}
+
+	std::cout << "Tag lookup benchmark - " << g_TagCount << " textures and " << g_TagCount
+		<< " materials, " << g_TagDrawCount << " draws, " << g_TagFrames << " frames" << std::endl;
+
+	// every tag compared in turn, with the tag passed by value
+	auto findLinear = [](const std::vector<LOADED_TAG>& loaded, std::string tag)
+	{
+		for (size_t index = 0; index < loaded.size(); index++)
+		{
+			if (loaded[index].tag.compare(tag) == 0)
+			{
+				return(loaded[index].value);
+			}
+		}
+		return(-1);
+	};
+
+	long long linearSum = 0;
+	auto start = std::chrono::high_resolution_clock::now();
+	for (int frame = 0; frame < g_TagFrames; frame++)
+	{
+		for (int draw = 0; draw < g_TagDrawCount; draw++)
+		{
+			linearSum += findLinear(textures, drawTextures[draw]);
+			linearSum += findLinear(materials, drawMaterials[draw]);
+		}
+	}
+	double linearSeconds = ElapsedSeconds(start) / g_TagFrames;
+
+	// intern the tags as they are loaded, mapping each ID to the
+	// slot or index of its tag
+	TagInterner interner;
+	std::vector<int> textureSlots;
+	std::vector<int> materialIndices;
+	start = std::chrono::high_resolution_clock::now();
+	for (int i = 0; i < g_TagCount; i++)
+	{
+		TagInterner::TAG_ID tagID = interner.Intern(textures[i].tag);
+		textureSlots.resize(interner.GetCount(), -1);
+		textureSlots[tagID] = textures[i].value;
+		tagID = interner.Intern(materials[i].tag);
+		materialIndices.resize(interner.GetCount(), -1);
+		materialIndices[tagID] = materials[i].value;
+	}
+	double internSeconds = ElapsedSeconds(start);
+	textureSlots.resize(interner.GetCount(), -1);
+	materialIndices.resize(interner.GetCount(), -1);
+
+	auto findValue = [](const std::vector<int>& values, TagInterner::TAG_ID tagID)
+	{
+		return((tagID < values.size()) ? values[tagID] : -1);
+	};
+
+	// the tag strings hashed on every draw
+	long long hashedSum = 0;
+	start = std::chrono::high_resolution_clock::now();
+	for (int frame = 0; frame < g_TagFrames; frame++)
+	{
+		for (int draw = 0; draw < g_TagDrawCount; draw++)
+		{
+			hashedSum += findValue(textureSlots, interner.Find(std::string(drawTextures[draw])));
+			hashedSum += findValue(materialIndices, interner.Find(std::string(drawMaterials[draw])));
+		}
+	}
+	double hashedSeconds = ElapsedSeconds(start) / g_TagFrames;
+
+	// the tag IDs resolved once, before the first frame
+	std::vector<TagInterner::TAG_ID> drawTextureIDs(g_TagDrawCount);
+	std::vector<TagInterner::TAG_ID> drawMaterialIDs(g_TagDrawCount);
+	for (int draw = 0; draw < g_TagDrawCount; draw++)
+	{
+		drawTextureIDs[draw] = interner.Intern(drawTextures[draw]);
+		drawMaterialIDs[draw] = interner.Intern(drawMaterials[draw]);
+	}
+
+	long long internedSum = 0;
+	start = std::chrono::high_resolution_clock::now();
+	for (int frame = 0; frame < g_TagFrames; frame++)
+	{
+		for (int draw = 0; draw < g_TagDrawCount; draw++)
+		{
+			internedSum += findValue(textureSlots, drawTextureIDs[draw]);
+			internedSum += findValue(materialIndices, drawMaterialIDs[draw]);
+		}
+	}
+	double internedSeconds = ElapsedSeconds(start) / g_TagFrames;
+
+	if ((hashedSum != linearSum) || (internedSum != linearSum))
+	{
+		std::cout << "  lookups disagree: " << linearSum << ", " << hashedSum << ", " << internedSum << std::endl;
+		return;
+	}
+
+	double lookupCount = 2.0 * g_TagDrawCount;
+	std::cout << "  intern at load: " << (internSeconds * 1000000000.0) / (2.0 * g_TagCount) << " ns/tag" << std::endl;
+	std::cout << "  linear scan:    " << linearSeconds * 1000.0 << " ms/frame, "
+		<< (linearSeconds * 1000000000.0) / lookupCount << " ns/lookup" << std::endl;
+	std::cout << "  hashed string:  " << hashedSeconds * 1000.0 << " ms/frame, "
+		<< (hashedSeconds * 1000000000.0) / lookupCount << " ns/lookup" << std::endl;
+	std::cout << "  interned ID:    " << internedSeconds * 1000.0 << " ms/frame, "
+		<< (internedSeconds * 1000000000.0) / lookupCount << " ns/lookup" << std::endl;
+	if (internedSeconds > 0.0)
+	{
+		std::cout << "  interned IDs are " << linearSeconds / internedSeconds << "x faster than the scan, "
+			<< hashedSeconds / internedSeconds << "x faster than hashing" << std::endl;
+	}
+}
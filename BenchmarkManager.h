@@ -0,0 +1,83 @@
+///////////////////////////////////////////////////////////////////////////////
+// benchmarkmanager.h
+// ============
+// run the rendering performance benchmarks from the command line
+//
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "ShaderManager.h"
+
+/***********************************************************
+ *  BenchmarkManager
+ *
+ *  This class contains the code for measuring the cost of
+ *  the rendering paths.  A benchmark is selected with the
+ *  "--bench <name>" command line argument.
+ ***********************************************************/
+class BenchmarkManager
+{
+public:
+    // constructor
+    BenchmarkManager(ShaderManager* pShaderManager);
+
+    // run the named benchmark - returns false when the
+    // benchmark name is not known
+    bool RunBenchmark(const char* benchmarkName);
+
+private:
+    // pointer to shader manager object
+    ShaderManager* m_pShaderManager;
+
+    // uniform lookups per frame through names versus handles
+    void RunUniformBenchmark();
+    // per-object versus instanced drawing of many boxes
+    void RunInstancingBenchmark();
+    // per-object versus multi-draw-indirect drawing of a mixed scene
+    void RunMultiDrawBenchmark();
+    // vertex cache use and vertex shader work of the meshes as
+    // generated versus optimized
+    void RunMeshOptimizerBenchmark();
+    // triangles and frame time of a deep field of curved meshes
+    // drawn at full tessellation versus at the selected levels
+    void RunLODBenchmark();
+    // packing error, vertex bytes and GPU draw time of the
+    // meshes in the float versus the packed vertex format
+    void RunVertexFormatBenchmark();
+    // triangles submitted and CPU and GPU frame time of a field
+    // of curved meshes drawn whole versus by visible meshlets
+    void RunMeshletBenchmark();
+    // load time and arena bytes of loading every mesh up front
+    // versus on first use, and the bytes freed by eviction
+    void RunResidencyBenchmark();
+    // time of generating and uploading every mesh and level on
+    // the GL thread versus on 1 to N worker threads
+    void RunStartupBenchmark();
+    // CPU and GPU frame time of moving objects drawn one at a
+    // time with their values in uniforms, in a buffer updated
+    // per draw, and in the persistently mapped stream buffer
+    void RunStreamBenchmark();
+    // CPU time of testing many scattered objects against the view
+    // frustum four at a time versus one at a time, and of drawing
+    // every object versus only the objects in the view
+    void RunFrustumBenchmark();
+    // build, refit and query time of the bounding volume tree
+    // over 10k, 100k and 1M objects, next to testing every object
+    void RunHierarchyBenchmark();
+    // time to the first frame and until every texture shows its
+    // image, loading the images on the GL thread versus decoding
+    // them on 1 to N worker threads while the scene meshes are
+    // generated on the same workers
+    void RunTextureBenchmark();
+    // time until every texture is resident and its bytes, with
+    // the images decoded versus cooked into the texture cache
+    // versus mapped from it as block compressed levels
+    void RunTextureCacheBenchmark();
+    // time and resident memory growth of reading a directory of
+    // large images through stdio, from mapped files, and as
+    // compressed levels mapped from the texture cache
+    void RunIngestBenchmark();
+    // time of finding the texture and material of every draw
+    // among 10k of each by scanning the tag strings, by hashing
+    // them, and by tag IDs interned at load time
+    void RunTagBenchmark();
+};
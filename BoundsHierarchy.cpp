@@ -0,0 +1,583 @@
+///////////////////////////////////////////////////////////////////////////////
+// boundshierarchy.cpp
+// ============
+// organize the world bounds of the scene objects into a bounding volume tree
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "BoundsHierarchy.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+// declaration of global variables
+namespace
+{
+	// center intervals tried along the split axis of a node
+	const int g_SplitBinCount = 16;
+	// cost of testing a node box, next to testing an object box
+	const float g_NodeTestCost = 1.0f;
+	// how much more a refit tree may cost than the built one
+	// before Update() builds it again
+	const float g_RebuildCostRatio = 1.5f;
+
+	/***********************************************************
+	 *  HalfArea()
+	 *
+	 *  Half the surface area of a box, which is proportional
+	 *  to the chance of a random ray or view hitting it.
+	 ***********************************************************/
+	float HalfArea(const glm::vec3& boxMin, const glm::vec3& boxMax)
+	{
+		glm::vec3 size = glm::max(boxMax - boxMin, glm::vec3(0.0f));
+		return(size.x * size.y + size.y * size.z + size.z * size.x);
+	}
+
+	// objects whose centers fall into one interval of the split
+	// axis, and the box around them
+	struct SPLIT_BIN
+	{
+		glm::vec3 boxMin;
+		glm::vec3 boxMax;
+		GLuint count;
+	};
+}
+
+/***********************************************************
+ *  BoundsHierarchy()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+BoundsHierarchy::BoundsHierarchy()
+{
+	m_buildCost = 0.0f;
+	m_cost = 0.0f;
+	m_buildCount = 0;
+	m_refitCount = 0;
+}
+
+/***********************************************************
+ *  Build()
+ *
+ *  This method is used for building the tree from nothing
+ *  over every object of the bounds.
+ ***********************************************************/
+void BoundsHierarchy::Build(const WorldBounds& bounds)
+{
+	GLuint count = bounds.GetCount();
+	m_nodes.clear();
+	m_objectOrder.resize(count);
+	m_centers.resize(count);
+	for (GLuint object = 0; object < count; object++)
+	{
+		m_objectOrder[object] = object;
+		m_centers[object] = (bounds.GetBoxMin(object) + bounds.GetBoxMax(object)) * 0.5f;
+	}
+
+	// a binary tree with a leaf per object at most
+	m_nodes.reserve((count > 0) ? count * 2 - 1 : 0);
+	if (count > 0)
+	{
+		BuildNode(bounds, 0, count);
+	}
+
+	m_buildCost = ComputeCost();
+	m_cost = m_buildCost;
+	m_buildCount++;
+}
+
+/***********************************************************
+ *  BuildNode()
+ *
+ *  This method is used for adding the node of a run of the
+ *  object order and building its subtree.  The object
+ *  centers are sorted into intervals along the axis they
+ *  spread the most on, and the boundary between intervals
+ *  with the lowest surface area cost splits the node.  The
+ *  node stays a leaf when testing its objects one by one is
+ *  cheaper than any split.
+ ***********************************************************/
+GLuint BoundsHierarchy::BuildNode(const WorldBounds& bounds, GLuint first, GLuint count)
+{
+	GLuint nodeIndex = (GLuint)m_nodes.size();
+	m_nodes.push_back(NODE());
+
+	glm::vec3 boxMin = bounds.GetBoxMin(m_objectOrder[first]);
+	glm::vec3 boxMax = bounds.GetBoxMax(m_objectOrder[first]);
+	glm::vec3 centerMin = m_centers[m_objectOrder[first]];
+	glm::vec3 centerMax = centerMin;
+	for (GLuint entry = first + 1; entry < first + count; entry++)
+	{
+		GLuint object = m_objectOrder[entry];
+		boxMin = glm::min(boxMin, bounds.GetBoxMin(object));
+		boxMax = glm::max(boxMax, bounds.GetBoxMax(object));
+		centerMin = glm::min(centerMin, m_centers[object]);
+		centerMax = glm::max(centerMax, m_centers[object]);
+	}
+	m_nodes[nodeIndex].boxMin = boxMin;
+	m_nodes[nodeIndex].boxMax = boxMax;
+
+	GLuint splitCount = 0;
+	if (count > 1)
+	{
+		glm::vec3 spread = centerMax - centerMin;
+		int axis = ((spread.x >= spread.y) && (spread.x >= spread.z)) ? 0 : ((spread.y >= spread.z) ? 1 : 2);
+
+		if (spread[axis] <= 0.0f)
+		{
+			// every center is at the same place, so any split is
+			// as good as another
+			if (count > MAX_LEAF_OBJECTS)
+			{
+				splitCount = count / 2;
+			}
+		}
+		else
+		{
+			SPLIT_BIN bins[g_SplitBinCount];
+			for (int bin = 0; bin < g_SplitBinCount; bin++)
+			{
+				bins[bin].boxMin = glm::vec3(std::numeric_limits<float>::max());
+				bins[bin].boxMax = glm::vec3(-std::numeric_limits<float>::max());
+				bins[bin].count = 0;
+			}
+
+			float binScale = (float)g_SplitBinCount / spread[axis];
+			auto binOf = [&](GLuint object)
+			{
+				int bin = (int)((m_centers[object][axis] - centerMin[axis]) * binScale);
+				return(std::min(bin, g_SplitBinCount - 1));
+			};
+			for (GLuint entry = first; entry < first + count; entry++)
+			{
+				GLuint object = m_objectOrder[entry];
+				SPLIT_BIN& bin = bins[binOf(object)];
+				bin.boxMin = glm::min(bin.boxMin, bounds.GetBoxMin(object));
+				bin.boxMax = glm::max(bin.boxMax, bounds.GetBoxMax(object));
+				bin.count++;
+			}
+
+			// cost of the bins right of each boundary, swept from
+			// the right
+			float rightCosts[g_SplitBinCount];
+			glm::vec3 sweepMin = bins[g_SplitBinCount - 1].boxMin;
+			glm::vec3 sweepMax = bins[g_SplitBinCount - 1].boxMax;
+			GLuint sweepCount = 0;
+			for (int bin = g_SplitBinCount - 1; bin > 0; bin--)
+			{
+				sweepMin = glm::min(sweepMin, bins[bin].boxMin);
+				sweepMax = glm::max(sweepMax, bins[bin].boxMax);
+				sweepCount += bins[bin].count;
+				rightCosts[bin] = (sweepCount > 0) ? HalfArea(sweepMin, sweepMax) * sweepCount : 0.0f;
+			}
+
+			float bestCost = std::numeric_limits<float>::max();
+			int bestBoundary = 0;
+			sweepMin = bins[0].boxMin;
+			sweepMax = bins[0].boxMax;
+			sweepCount = 0;
+			for (int boundary = 1; boundary < g_SplitBinCount; boundary++)
+			{
+				sweepMin = glm::min(sweepMin, bins[boundary - 1].boxMin);
+				sweepMax = glm::max(sweepMax, bins[boundary - 1].boxMax);
+				sweepCount += bins[boundary - 1].count;
+				if ((sweepCount == 0) || (sweepCount == count))
+				{
+					continue;
+				}
+				float cost = HalfArea(sweepMin, sweepMax) * sweepCount + rightCosts[boundary];
+				if (cost < bestCost)
+				{
+					bestCost = cost;
+					bestBoundary = boundary;
+				}
+			}
+
+			float nodeArea = HalfArea(boxMin, boxMax);
+			float leafCost = nodeArea * count;
+			float splitCost = nodeArea * g_NodeTestCost + bestCost;
+			if ((bestBoundary > 0) && ((count > MAX_LEAF_OBJECTS) || (splitCost < leafCost)))
+			{
+				GLuint* pMiddle = std::partition(
+					m_objectOrder.data() + first, m_objectOrder.data() + first + count,
+					[&](GLuint object) { return(binOf(object) < bestBoundary); });
+				splitCount = (GLuint)(pMiddle - (m_objectOrder.data() + first));
+			}
+		}
+	}
+
+	if (splitCount == 0)
+	{
+		m_nodes[nodeIndex].first = first;
+		m_nodes[nodeIndex].nObjects = count;
+		return(nodeIndex);
+	}
+
+	// the first child follows the node, and the node keeps the
+	// index of the second
+	BuildNode(bounds, first, splitCount);
+	GLuint secondChild = BuildNode(bounds, first + splitCount, count - splitCount);
+	m_nodes[nodeIndex].first = secondChild;
+	m_nodes[nodeIndex].nObjects = 0;
+	return(nodeIndex);
+}
+
+/***********************************************************
+ *  Refit()
+ *
+ *  This method is used for moving the boxes of the tree to
+ *  the current bounds of its objects.  The children of a
+ *  node come after it, so walking the nodes backwards sets
+ *  every child box before the box of its parent.
+ ***********************************************************/
+void BoundsHierarchy::Refit(const WorldBounds& bounds)
+{
+	for (size_t index = m_nodes.size(); index > 0; index--)
+	{
+		NODE& node = m_nodes[index - 1];
+		if (node.nObjects > 0)
+		{
+			GLuint object = m_objectOrder[node.first];
+			node.boxMin = bounds.GetBoxMin(object);
+			node.boxMax = bounds.GetBoxMax(object);
+			for (GLuint entry = node.first + 1; entry < node.first + node.nObjects; entry++)
+			{
+				object = m_objectOrder[entry];
+				node.boxMin = glm::min(node.boxMin, bounds.GetBoxMin(object));
+				node.boxMax = glm::max(node.boxMax, bounds.GetBoxMax(object));
+			}
+		}
+		else
+		{
+			const NODE& firstChild = m_nodes[index];
+			const NODE& secondChild = m_nodes[node.first];
+			node.boxMin = glm::min(firstChild.boxMin, secondChild.boxMin);
+			node.boxMax = glm::max(firstChild.boxMax, secondChild.boxMax);
+		}
+	}
+
+	m_cost = ComputeCost();
+	m_refitCount++;
+}
+
+/***********************************************************
+ *  Update()
+ *
+ *  This method is used for keeping the tree in step with
+ *  objects that move every frame.  Refitting is linear in
+ *  the number of nodes, while the boxes of moved objects
+ *  slowly spread the refit nodes apart, so the tree is built
+ *  again only once its cost has grown past the limit.
+ ***********************************************************/
+bool BoundsHierarchy::Update(const WorldBounds& bounds)
+{
+	if ((m_nodes.empty() == true) || (bounds.GetCount() != GetObjectCount()))
+	{
+		Build(bounds);
+		return(true);
+	}
+
+	Refit(bounds);
+	if (m_cost > m_buildCost * g_RebuildCostRatio)
+	{
+		Build(bounds);
+		return(true);
+	}
+	return(false);
+}
+
+/***********************************************************
+ *  ComputeCost()
+ *
+ *  This method is used for finding the surface area cost of
+ *  the tree - the expected number of box tests of a query,
+ *  relative to the area of the root.
+ ***********************************************************/
+float BoundsHierarchy::ComputeCost() const
+{
+	if (m_nodes.empty() == true)
+	{
+		return(0.0f);
+	}
+
+	float rootArea = HalfArea(m_nodes[0].boxMin, m_nodes[0].boxMax);
+	if (rootArea <= 0.0f)
+	{
+		return(0.0f);
+	}
+
+	float cost = 0.0f;
+	for (size_t index = 0; index < m_nodes.size(); index++)
+	{
+		const NODE& node = m_nodes[index];
+		float area = HalfArea(node.boxMin, node.boxMax);
+		cost += (node.nObjects > 0) ? area * node.nObjects : area * g_NodeTestCost;
+	}
+	return(cost / rootArea);
+}
+
+/***********************************************************
+ *  Raycast()
+ *
+ *  This method is used for finding the first object box a
+ *  ray enters, such as for picking the object under the
+ *  mouse.  The nearer child is visited first, and nodes the
+ *  ray enters beyond the nearest hit so far are skipped.
+ ***********************************************************/
+bool BoundsHierarchy::Raycast(
+	const WorldBounds& bounds,
+	const glm::vec3& origin, const glm::vec3& direction, float maxDistance,
+	GLuint& object, float& distance) const
+{
+	if (m_nodes.empty() == true)
+	{
+		return(false);
+	}
+
+	glm::vec3 inverseDirection = 1.0f / direction;
+	float nearest = maxDistance;
+	bool bHit = false;
+
+	std::vector<GLuint> stack;
+	stack.reserve(64);
+	stack.push_back(0);
+	while (stack.empty() == false)
+	{
+		GLuint nodeIndex = stack.back();
+		const NODE& node = m_nodes[nodeIndex];
+		stack.pop_back();
+
+		float nodeDistance = 0.0f;
+		if (IntersectRayBox(origin, inverseDirection, nearest, node.boxMin, node.boxMax, nodeDistance) == false)
+		{
+			continue;
+		}
+
+		if (node.nObjects > 0)
+		{
+			for (GLuint entry = node.first; entry < node.first + node.nObjects; entry++)
+			{
+				GLuint candidate = m_objectOrder[entry];
+				float hitDistance = 0.0f;
+				if ((IntersectRayBox(origin, inverseDirection, nearest,
+					bounds.GetBoxMin(candidate), bounds.GetBoxMax(candidate), hitDistance) == true) &&
+					((bHit == false) || (hitDistance < nearest)))
+				{
+					nearest = hitDistance;
+					object = candidate;
+					bHit = true;
+				}
+			}
+			continue;
+		}
+
+		// the nearer child is pushed last, so it is visited first
+		GLuint firstChild = nodeIndex + 1;
+		GLuint secondChild = node.first;
+		float firstDistance = 0.0f;
+		float secondDistance = 0.0f;
+		bool bFirstHit = IntersectRayBox(origin, inverseDirection, nearest,
+			m_nodes[firstChild].boxMin, m_nodes[firstChild].boxMax, firstDistance);
+		bool bSecondHit = IntersectRayBox(origin, inverseDirection, nearest,
+			m_nodes[secondChild].boxMin, m_nodes[secondChild].boxMax, secondDistance);
+		if ((bFirstHit == true) && (bSecondHit == true) && (firstDistance < secondDistance))
+		{
+			stack.push_back(secondChild);
+			stack.push_back(firstChild);
+		}
+		else
+		{
+			if (bFirstHit == true)
+			{
+				stack.push_back(firstChild);
+			}
+			if (bSecondHit == true)
+			{
+				stack.push_back(secondChild);
+			}
+		}
+	}
+
+	if (bHit == true)
+	{
+		distance = nearest;
+	}
+	return(bHit);
+}
+
+/***********************************************************
+ *  FindWithinDistance()
+ *
+ *  This method is used for finding every object box that
+ *  reaches within the distance of the point.
+ ***********************************************************/
+GLuint BoundsHierarchy::FindWithinDistance(
+	const WorldBounds& bounds,
+	const glm::vec3& point, float maxDistance,
+	std::vector<GLuint>& objects) const
+{
+	if (m_nodes.empty() == true)
+	{
+		return(0);
+	}
+
+	float maxDistanceSquared = maxDistance * maxDistance;
+	GLuint found = 0;
+
+	std::vector<GLuint> stack;
+	stack.reserve(64);
+	stack.push_back(0);
+	while (stack.empty() == false)
+	{
+		GLuint nodeIndex = stack.back();
+		const NODE& node = m_nodes[nodeIndex];
+		stack.pop_back();
+
+		if (DistanceToBoxSquared(point, node.boxMin, node.boxMax) > maxDistanceSquared)
+		{
+			continue;
+		}
+
+		if (node.nObjects > 0)
+		{
+			for (GLuint entry = node.first; entry < node.first + node.nObjects; entry++)
+			{
+				GLuint candidate = m_objectOrder[entry];
+				if (DistanceToBoxSquared(point, bounds.GetBoxMin(candidate), bounds.GetBoxMax(candidate)) <= maxDistanceSquared)
+				{
+					objects.push_back(candidate);
+					found++;
+				}
+			}
+			continue;
+		}
+
+		stack.push_back(node.first);
+		stack.push_back(nodeIndex + 1);
+	}
+	return(found);
+}
+
+/***********************************************************
+ *  FindNearest()
+ *
+ *  This method is used for finding the object box nearest
+ *  to the point.  The nearer child is visited first, and
+ *  nodes farther away than the nearest box so far are
+ *  skipped.
+ ***********************************************************/
+bool BoundsHierarchy::FindNearest(
+	const WorldBounds& bounds, const glm::vec3& point,
+	GLuint& object, float& distance) const
+{
+	if (m_nodes.empty() == true)
+	{
+		return(false);
+	}
+
+	float nearestSquared = std::numeric_limits<float>::max();
+
+	std::vector<GLuint> stack;
+	stack.reserve(64);
+	stack.push_back(0);
+	while (stack.empty() == false)
+	{
+		GLuint nodeIndex = stack.back();
+		const NODE& node = m_nodes[nodeIndex];
+		stack.pop_back();
+
+		if (DistanceToBoxSquared(point, node.boxMin, node.boxMax) >= nearestSquared)
+		{
+			continue;
+		}
+
+		if (node.nObjects > 0)
+		{
+			for (GLuint entry = node.first; entry < node.first + node.nObjects; entry++)
+			{
+				GLuint candidate = m_objectOrder[entry];
+				float candidateSquared = DistanceToBoxSquared(point, bounds.GetBoxMin(candidate), bounds.GetBoxMax(candidate));
+				if (candidateSquared < nearestSquared)
+				{
+					nearestSquared = candidateSquared;
+					object = candidate;
+				}
+			}
+			continue;
+		}
+
+		const NODE& firstChild = m_nodes[nodeIndex + 1];
+		const NODE& secondChild = m_nodes[node.first];
+		if (DistanceToBoxSquared(point, firstChild.boxMin, firstChild.boxMax) <
+			DistanceToBoxSquared(point, secondChild.boxMin, secondChild.boxMax))
+		{
+			stack.push_back(node.first);
+			stack.push_back(nodeIndex + 1);
+		}
+		else
+		{
+			stack.push_back(nodeIndex + 1);
+			stack.push_back(node.first);
+		}
+	}
+
+	distance = sqrtf(nearestSquared);
+	return(true);
+}
+
+/***********************************************************
+ *  IntersectRayBox()
+ *
+ *  This method is used for clipping a ray against the three
+ *  pairs of planes bounding a box.  The direction is passed
+ *  inverted, so a ray crossing many boxes divides once.  A
+ *  ray parallel to a pair of planes has an infinite inverse
+ *  on that axis, which would give 0 * infinity for an origin
+ *  on a plane - the ray misses the box when it starts outside
+ *  the pair, and the pair does not clip it otherwise.
+ ***********************************************************/
+bool BoundsHierarchy::IntersectRayBox(
+	const glm::vec3& origin, const glm::vec3& inverseDirection, float maxDistance,
+	const glm::vec3& boxMin, const glm::vec3& boxMax, float& distance)
+{
+	float entry = 0.0f;
+	float exit = maxDistance;
+	for (int axis = 0; axis < 3; axis++)
+	{
+		if (std::isinf(inverseDirection[axis]) == true)
+		{
+			if ((origin[axis] < boxMin[axis]) || (origin[axis] > boxMax[axis]))
+			{
+				return(false);
+			}
+			continue;
+		}
+
+		float toMin = (boxMin[axis] - origin[axis]) * inverseDirection[axis];
+		float toMax = (boxMax[axis] - origin[axis]) * inverseDirection[axis];
+		entry = std::max(entry, std::min(toMin, toMax));
+		exit = std::min(exit, std::max(toMin, toMax));
+	}
+
+	if (entry > exit)
+	{
+		return(false);
+	}
+
+	distance = entry;
+	return(true);
+}
+
+/***********************************************************
+ *  DistanceToBoxSquared()
+ *
+ *  This method is used for finding the squared distance from
+ *  a point to the nearest point of a box.
+ ***********************************************************/
+float BoundsHierarchy::DistanceToBoxSquared(
+	const glm::vec3& point, const glm::vec3& boxMin, const glm::vec3& boxMax)
+{
+	glm::vec3 outside = glm::max(glm::max(boxMin - point, point - boxMax), glm::vec3(0.0f));
+	return(glm::dot(outside, outside));
+}
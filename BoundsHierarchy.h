@@ -0,0 +1,115 @@
+///////////////////////////////////////////////////////////////////////////////
+// boundshierarchy.h
+// ============
+// organize the world bounds of the scene objects into a bounding volume tree
+//
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "WorldBounds.h"
+#include <glm/glm.hpp>
+#include <vector>
+#include <stdint.h>
+
+/***********************************************************
+ *  BoundsHierarchy
+ *
+ *  This class builds a binary tree of boxes over the world
+ *  boxes of a WorldBounds, splitting every node where the
+ *  surface area heuristic expects the fewest box tests.  The
+ *  nodes are stored depth first in one array, so the first
+ *  child of a node is the node after it, and a query walks
+ *  the array mostly forward.  When objects move the boxes
+ *  are refit in place, and the tree is only built again once
+ *  the refit boxes overlap too much.
+ ***********************************************************/
+class BoundsHierarchy
+{
+public:
+    // most objects a leaf holds before it has to be split
+    static const GLuint MAX_LEAF_OBJECTS = 8;
+
+    // one node of the tree, 32 bytes
+    struct NODE
+    {
+        glm::vec3 boxMin;
+        GLuint first;       // first entry of a leaf in the object
+                            // order, or the second child of an
+                            // inner node
+        glm::vec3 boxMax;
+        GLuint nObjects;    // 0 for an inner node, whose first
+                            // child is the next node
+    };
+
+    // constructor
+    BoundsHierarchy();
+
+    // build the tree over every object of the bounds
+    void Build(const WorldBounds& bounds);
+    // move the boxes of the tree to the current object bounds,
+    // keeping its shape
+    void Refit(const WorldBounds& bounds);
+    // refit the tree, or build it again when objects were added
+    // or removed or the refit tree costs too much more than the
+    // built one - returns true when it was built again
+    bool Update(const WorldBounds& bounds);
+
+    // nearest object whose box the ray hits within maxDistance -
+    // returns false when there is none
+    bool Raycast(
+        const WorldBounds& bounds,
+        const glm::vec3& origin, const glm::vec3& direction, float maxDistance,
+        GLuint& object, float& distance) const;
+    // objects whose boxes are within the distance of the point -
+    // returns the number of objects appended
+    GLuint FindWithinDistance(
+        const WorldBounds& bounds,
+        const glm::vec3& point, float maxDistance,
+        std::vector<GLuint>& objects) const;
+    // object whose box is nearest to the point - returns false
+    // when the tree is empty
+    bool FindNearest(
+        const WorldBounds& bounds, const glm::vec3& point,
+        GLuint& object, float& distance) const;
+
+    // distance along the ray to where it enters the box, 0 when
+    // it starts inside - returns false when it misses the box
+    // within maxDistance
+    static bool IntersectRayBox(
+        const glm::vec3& origin, const glm::vec3& inverseDirection, float maxDistance,
+        const glm::vec3& boxMin, const glm::vec3& boxMax, float& distance);
+    // squared distance from the point to the box, 0 inside it
+    static float DistanceToBoxSquared(
+        const glm::vec3& point, const glm::vec3& boxMin, const glm::vec3& boxMax);
+
+    // nodes depth first, the root first
+    const std::vector<NODE>& GetNodes() const { return m_nodes; }
+    // objects in leaf order - a leaf holds the entries
+    // [first, first + nObjects)
+    const std::vector<GLuint>& GetObjectOrder() const { return m_objectOrder; }
+    // number of objects the tree was built over
+    GLuint GetObjectCount() const { return (GLuint)m_objectOrder.size(); }
+    // surface area cost of the tree when it was last built, and
+    // after the last refit
+    float GetBuildCost() const { return m_buildCost; }
+    float GetCost() const { return m_cost; }
+    // builds and refits since the tree was created
+    GLuint GetBuildCount() const { return m_buildCount; }
+    GLuint GetRefitCount() const { return m_refitCount; }
+
+private:
+    std::vector<NODE> m_nodes;
+    std::vector<GLuint> m_objectOrder;
+    float m_buildCost;
+    float m_cost;
+    GLuint m_buildCount;
+    GLuint m_refitCount;
+
+    // box centers of the objects, used while building
+    std::vector<glm::vec3> m_centers;
+
+    // add the node of the order entries [first, first + count)
+    // and its subtree - returns the index of the node
+    GLuint BuildNode(const WorldBounds& bounds, GLuint first, GLuint count);
+    // surface area cost of the whole tree
+    float ComputeCost() const;
+};
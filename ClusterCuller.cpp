@@ -0,0 +1,211 @@
+///////////////////////////////////////////////////////////////////////////////
+// clusterculler.cpp
+// ============
+// add only the meshlets facing the camera inside the view to a render list
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ClusterCuller.h"
+
+#include <algorithm>
+
+/***********************************************************
+ *  ClusterCuller()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ClusterCuller::ClusterCuller(ShapeMeshes* pMeshes)
+{
+	m_pMeshes = pMeshes;
+	m_bEnabled = true;
+	m_cameraPosition = glm::vec3(0.0f);
+	m_frameStats = CULL_STATS();
+	SetViewTransform(glm::mat4(1.0f), glm::mat4(1.0f));
+}
+
+/***********************************************************
+ *  SetViewTransform()
+ *
+ *  This method is used for setting the camera of the frame.
+ *  The frustum planes are read from the rows of the combined
+ *  view and projection matrix and normalized, so the distance
+ *  of a point to each plane can be compared with a radius.
+ ***********************************************************/
+void ClusterCuller::SetViewTransform(const glm::mat4& view, const glm::mat4& projection)
+{
+	glm::mat4 viewProjection = projection * view;
+	glm::vec4 rows[4];
+	for (int row = 0; row < 4; row++)
+	{
+		rows[row] = glm::vec4(viewProjection[0][row], viewProjection[1][row], viewProjection[2][row], viewProjection[3][row]);
+	}
+
+	// left, right, bottom, top, near and far
+	m_frustumPlanes[0] = rows[3] + rows[0];
+	m_frustumPlanes[1] = rows[3] - rows[0];
+	m_frustumPlanes[2] = rows[3] + rows[1];
+	m_frustumPlanes[3] = rows[3] - rows[1];
+	m_frustumPlanes[4] = rows[3] + rows[2];
+	m_frustumPlanes[5] = rows[3] - rows[2];
+	for (int plane = 0; plane < 6; plane++)
+	{
+		float length = glm::length(glm::vec3(m_frustumPlanes[plane]));
+		if (length > 0.0f)
+		{
+			m_frustumPlanes[plane] /= length;
+		}
+	}
+
+	m_cameraPosition = glm::vec3(glm::inverse(view)[3]);
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for clearing the stats of the frame.
+ ***********************************************************/
+void ClusterCuller::BeginFrame()
+{
+	m_frameStats = CULL_STATS();
+}
+
+/***********************************************************
+ *  AddVisibleMeshlets()
+ *
+ *  This method is used for adding the meshlets of an instance
+ *  that can be seen to the render list.  The bounding sphere
+ *  of the whole instance is tested first.  The meshlet
+ *  spheres are then moved into world space for the frustum
+ *  test, while the camera is moved into mesh space for the
+ *  normal cone test - the side of a surface the camera is on
+ *  does not change under the model transform, even with a
+ *  scale that differs per axis.  The cone test is skipped
+ *  when the camera is inside the mesh, as every surface is
+ *  seen from behind there.
+ ***********************************************************/
+GLsizei ClusterCuller::AddVisibleMeshlets(
+	ShapeMeshes::MESH_ID meshID,
+	const RenderList::DRAW_DATA& draw,
+	RenderList& renderList)
+{
+	if (NULL == m_pMeshes)
+	{
+		return(0);
+	}
+
+	m_pMeshes->PrefetchMesh(meshID);
+	ShapeMeshes::INDEXED_RANGE meshRange;
+	if (m_pMeshes->GetIndexedRange(meshID, meshRange) == false)
+	{
+		return(0);
+	}
+
+	m_frameStats.instances++;
+
+	// the spheres grow with the largest scale of the model
+	const glm::mat4& model = draw.model;
+	float scale = std::max(glm::length(glm::vec3(model[0])),
+		std::max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+
+	const MeshletBuilder::MESHLET* pMeshlets = NULL;
+	GLuint nMeshlets = 0;
+	bool bHasMeshlets = m_pMeshes->GetMeshlets(meshID, pMeshlets, nMeshlets);
+
+	if (m_bEnabled == true)
+	{
+		float radius = m_pMeshes->GetBoundingRadius(meshID) * scale;
+		if (IsSphereInFrustum(glm::vec3(model[3]), radius) == false)
+		{
+			m_frameStats.instancesCulled++;
+			m_frameStats.trianglesCulled += meshRange.nIndices / 3;
+			return(0);
+		}
+	}
+
+	if ((m_bEnabled == false) || (bHasMeshlets == false))
+	{
+		renderList.AddDrawRange(meshID, meshRange, draw);
+		m_frameStats.draws++;
+		m_frameStats.trianglesSubmitted += meshRange.nIndices / 3;
+		return(1);
+	}
+
+	glm::vec3 meshCamera = glm::vec3(glm::inverse(model) * glm::vec4(m_cameraPosition, 1.0f));
+	bool bTestCones = glm::length(meshCamera) > m_pMeshes->GetBoundingRadius(meshID);
+
+	// visible meshlets that follow each other are drawn together
+	ShapeMeshes::INDEXED_RANGE pending;
+	pending.nIndices = 0;
+	pending.firstIndex = 0;
+	pending.baseVertex = meshRange.baseVertex;
+	GLsizei drawsAdded = 0;
+
+	for (GLuint i = 0; i < nMeshlets; i++)
+	{
+		const MeshletBuilder::MESHLET& meshlet = pMeshlets[i];
+		m_frameStats.meshlets++;
+
+		glm::vec3 center = glm::vec3(model * glm::vec4(meshlet.center, 1.0f));
+		if (IsSphereInFrustum(center, meshlet.radius * scale) == false)
+		{
+			m_frameStats.frustumCulled++;
+			m_frameStats.trianglesCulled += meshlet.nIndices / 3;
+			continue;
+		}
+
+		// every triangle faces away when the view direction is
+		// inside the cone of the normals, widened by the sphere
+		glm::vec3 toMeshlet = meshlet.center - meshCamera;
+		if ((bTestCones == true) &&
+			(glm::dot(toMeshlet, meshlet.coneAxis) >= meshlet.coneCutoff * glm::length(toMeshlet) + meshlet.radius))
+		{
+			m_frameStats.backfaceCulled++;
+			m_frameStats.trianglesCulled += meshlet.nIndices / 3;
+			continue;
+		}
+
+		GLuint firstIndex = meshRange.firstIndex + meshlet.firstIndex;
+		if ((pending.nIndices > 0) && (pending.firstIndex + pending.nIndices == firstIndex))
+		{
+			pending.nIndices += meshlet.nIndices;
+		}
+		else
+		{
+			if (pending.nIndices > 0)
+			{
+				renderList.AddDrawRange(meshID, pending, draw);
+				drawsAdded++;
+			}
+			pending.firstIndex = firstIndex;
+			pending.nIndices = meshlet.nIndices;
+		}
+		m_frameStats.trianglesSubmitted += meshlet.nIndices / 3;
+	}
+
+	if (pending.nIndices > 0)
+	{
+		renderList.AddDrawRange(meshID, pending, draw);
+		drawsAdded++;
+	}
+	m_frameStats.draws += drawsAdded;
+	return(drawsAdded);
+}
+
+/***********************************************************
+ *  IsSphereInFrustum()
+ *
+ *  This method is used for testing a world space sphere
+ *  against the planes of the view frustum.  The test keeps
+ *  some spheres near the corners that are just outside.
+ ***********************************************************/
+bool ClusterCuller::IsSphereInFrustum(const glm::vec3& center, float radius) const
+{
+	for (int plane = 0; plane < 6; plane++)
+	{
+		if (glm::dot(glm::vec3(m_frustumPlanes[plane]), center) + m_frustumPlanes[plane].w < -radius)
+		{
+			return(false);
+		}
+	}
+	return(true);
+}
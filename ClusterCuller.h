@@ -0,0 +1,75 @@
+///////////////////////////////////////////////////////////////////////////////
+// clusterculler.h
+// ============
+// add only the meshlets facing the camera inside the view to a render list
+//
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "ShapeMeshes.h"
+#include "RenderList.h"
+#include <glm/glm.hpp>
+#include <stdint.h>
+
+/***********************************************************
+ *  ClusterCuller
+ *
+ *  This class tests the meshlets of every drawn instance
+ *  against the view frustum and against the direction the
+ *  camera sees them from, and adds draws for the meshlets
+ *  that pass to a render list.  Meshlets next to each other
+ *  in the index buffer are merged into one draw.  Meshes
+ *  that were not split into meshlets are added whole when
+ *  their bounding sphere is in the view.
+ ***********************************************************/
+class ClusterCuller
+{
+public:
+    // meshlets and triangles tested since BeginFrame()
+    struct CULL_STATS
+    {
+        uint32_t instances;             // instances tested
+        uint32_t instancesCulled;       // instances outside the view
+        uint32_t meshlets;              // meshlets tested
+        uint32_t frustumCulled;         // meshlets outside the view
+        uint32_t backfaceCulled;        // meshlets facing away
+        uint32_t draws;                 // draws added to the list
+        uint32_t trianglesSubmitted;    // triangles of the added draws
+        uint32_t trianglesCulled;       // triangles of the rejected meshlets
+    };
+
+    // constructor
+    ClusterCuller(ShapeMeshes* pMeshes);
+
+    // when false, every instance is added whole without tests
+    void SetEnabled(bool bEnabled) { m_bEnabled = bEnabled; }
+    bool IsEnabled() const { return m_bEnabled; }
+
+    // set the camera the meshlets are tested against
+    void SetViewTransform(const glm::mat4& view, const glm::mat4& projection);
+
+    // clear the stats for a new frame
+    void BeginFrame();
+    // add the visible meshlets of one instance of the mesh to the
+    // render list - returns the number of draws added
+    GLsizei AddVisibleMeshlets(
+        ShapeMeshes::MESH_ID meshID,
+        const RenderList::DRAW_DATA& draw,
+        RenderList& renderList);
+
+    // stats of the instances tested since BeginFrame()
+    const CULL_STATS& GetFrameStats() const { return m_frameStats; }
+
+private:
+    // pointer to the meshes the instances refer to
+    ShapeMeshes* m_pMeshes;
+    bool m_bEnabled;
+
+    // world space planes of the view frustum, pointing inside
+    glm::vec4 m_frustumPlanes[6];
+    glm::vec3 m_cameraPosition;
+
+    CULL_STATS m_frameStats;
+
+    // true when the sphere is at least partly inside the frustum
+    bool IsSphereInFrustum(const glm::vec3& center, float radius) const;
+};
@@ -0,0 +1,305 @@
+///////////////////////////////////////////////////////////////////////////////
+// frustumculler.cpp
+// ============
+// reject the objects outside the view before their draws are issued
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FrustumCuller.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 1))
+#include <xmmintrin.h>
+#define FRUSTUM_CULLER_SSE
+#endif
+
+/***********************************************************
+ *  FrustumCuller()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+FrustumCuller::FrustumCuller()
+{
+	m_bEnabled = true;
+	m_frameStats = CULL_STATS();
+	SetViewTransform(glm::mat4(1.0f), glm::mat4(1.0f));
+}
+
+/***********************************************************
+ *  SetViewTransform()
+ *
+ *  This method is used for setting the camera of the frame.
+ *  The frustum planes are read from the rows of the combined
+ *  view and projection matrix.  They are not normalized, as
+ *  only the side of each plane a corner is on is tested.
+ ***********************************************************/
+void FrustumCuller::SetViewTransform(const glm::mat4& view, const glm::mat4& projection)
+{
+	glm::mat4 viewProjection = projection * view;
+	glm::vec4 rows[4];
+	for (int row = 0; row < 4; row++)
+	{
+		rows[row] = glm::vec4(viewProjection[0][row], viewProjection[1][row], viewProjection[2][row], viewProjection[3][row]);
+	}
+
+	// left, right, bottom, top, near and far
+	glm::vec4 planes[6];
+	planes[0] = rows[3] + rows[0];
+	planes[1] = rows[3] - rows[0];
+	planes[2] = rows[3] + rows[1];
+	planes[3] = rows[3] - rows[1];
+	planes[4] = rows[3] + rows[2];
+	planes[5] = rows[3] - rows[2];
+	for (int plane = 0; plane < 6; plane++)
+	{
+		m_planeX[plane] = planes[plane].x;
+		m_planeY[plane] = planes[plane].y;
+		m_planeZ[plane] = planes[plane].z;
+		m_planeW[plane] = planes[plane].w;
+	}
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for clearing the stats of the frame.
+ ***********************************************************/
+void FrustumCuller::BeginFrame()
+{
+	m_frameStats = CULL_STATS();
+}
+
+/***********************************************************
+ *  CullObjects()
+ *
+ *  This method is used for testing every object of the
+ *  bounds.  The corner tested against a plane takes each
+ *  component from the box minimum or maximum by the sign of
+ *  the plane normal, which is the same for every box, so the
+ *  whole array of that component is chosen once per plane
+ *  and four boxes are tested without any per-box choice.
+ ***********************************************************/
+GLuint FrustumCuller::CullObjects(const WorldBounds& bounds, std::vector<uint8_t>& visible)
+{
+	GLuint count = bounds.GetCount();
+	visible.assign(count, 1);
+	m_frameStats.tested += count;
+	if (m_bEnabled == false)
+	{
+		return(count);
+	}
+
+	// the corner components to test against each plane
+	const GLfloat* pCornerX[6];
+	const GLfloat* pCornerY[6];
+	const GLfloat* pCornerZ[6];
+	for (int plane = 0; plane < 6; plane++)
+	{
+		pCornerX[plane] = (m_planeX[plane] >= 0.0f) ? bounds.GetMaxX() : bounds.GetMinX();
+		pCornerY[plane] = (m_planeY[plane] >= 0.0f) ? bounds.GetMaxY() : bounds.GetMinY();
+		pCornerZ[plane] = (m_planeZ[plane] >= 0.0f) ? bounds.GetMaxZ() : bounds.GetMinZ();
+	}
+
+	GLuint object = 0;
+	GLuint visibleCount = 0;
+#ifdef FRUSTUM_CULLER_SSE
+	const __m128 zero = _mm_setzero_ps();
+	for (; object + 4 <= count; object += 4)
+	{
+		__m128 outside = _mm_setzero_ps();
+		for (int plane = 0; plane < 6; plane++)
+		{
+			__m128 distance = _mm_add_ps(
+				_mm_add_ps(
+					_mm_mul_ps(_mm_set1_ps(m_planeX[plane]), _mm_loadu_ps(pCornerX[plane] + object)),
+					_mm_mul_ps(_mm_set1_ps(m_planeY[plane]), _mm_loadu_ps(pCornerY[plane] + object))),
+				_mm_add_ps(
+					_mm_mul_ps(_mm_set1_ps(m_planeZ[plane]), _mm_loadu_ps(pCornerZ[plane] + object)),
+					_mm_set1_ps(m_planeW[plane])));
+			outside = _mm_or_ps(outside, _mm_cmplt_ps(distance, zero));
+		}
+
+		int outsideMask = _mm_movemask_ps(outside);
+		for (int lane = 0; lane < 4; lane++)
+		{
+			visible[object + lane] = (uint8_t)(((outsideMask >> lane) & 1) ^ 1);
+		}
+		visibleCount += 4 - ((outsideMask & 1) + ((outsideMask >> 1) & 1) + ((outsideMask >> 2) & 1) + ((outsideMask >> 3) & 1));
+	}
+#endif
+
+	// the objects after the last group of four
+	for (; object < count; object++)
+	{
+		bool bOutside = false;
+		for (int plane = 0; plane < 6; plane++)
+		{
+			float distance = m_planeX[plane] * pCornerX[plane][object] + m_planeY[plane] * pCornerY[plane][object] +
+				m_planeZ[plane] * pCornerZ[plane][object] + m_planeW[plane];
+			if (distance < 0.0f)
+			{
+				bOutside = true;
+			}
+		}
+		visible[object] = (bOutside == true) ? 0 : 1;
+		visibleCount += visible[object];
+	}
+
+	m_frameStats.culled += count - visibleCount;
+	return(visibleCount);
+}
+
+/***********************************************************
+ *  CullObjects()
+ *
+ *  This method is used for testing every object of the
+ *  bounds through a tree built over them.  A node outside
+ *  the view rejects all of its objects and a node inside it
+ *  accepts them, so only the objects of the leaves crossing
+ *  the edge of the view are tested one by one.
+ ***********************************************************/
+GLuint FrustumCuller::CullObjects(
+	const WorldBounds& bounds, const BoundsHierarchy& hierarchy,
+	std::vector<uint8_t>& visible)
+{
+	GLuint count = bounds.GetCount();
+	if ((m_bEnabled == false) || (hierarchy.GetObjectCount() != count))
+	{
+		return(CullObjects(bounds, visible));
+	}
+
+	visible.assign(count, 0);
+	m_frameStats.tested += count;
+	if (count == 0)
+	{
+		return(0);
+	}
+
+	const std::vector<BoundsHierarchy::NODE>& nodes = hierarchy.GetNodes();
+	const std::vector<GLuint>& objectOrder = hierarchy.GetObjectOrder();
+	GLuint visibleCount = 0;
+
+	// nodes still to visit, and whether they are known to be
+	// inside the view
+	std::vector<GLuint> stack;
+	std::vector<uint8_t> insideStack;
+	stack.reserve(64);
+	insideStack.reserve(64);
+	stack.push_back(0);
+	insideStack.push_back(0);
+	while (stack.empty() == false)
+	{
+		GLuint nodeIndex = stack.back();
+		bool bInside = (insideStack.back() != 0);
+		stack.pop_back();
+		insideStack.pop_back();
+		const BoundsHierarchy::NODE& node = nodes[nodeIndex];
+
+		if (bInside == false)
+		{
+			m_frameStats.nodesTested++;
+			BOX_PLACE place = PlaceBox(node.boxMin, node.boxMax);
+			if (place == BOX_OUTSIDE)
+			{
+				continue;
+			}
+			bInside = (place == BOX_INSIDE);
+		}
+
+		if (node.nObjects > 0)
+		{
+			for (GLuint entry = node.first; entry < node.first + node.nObjects; entry++)
+			{
+				GLuint object = objectOrder[entry];
+				if ((bInside == true) || (IsBoxInFrustum(bounds.GetBoxMin(object), bounds.GetBoxMax(object)) == true))
+				{
+					visible[object] = 1;
+					visibleCount++;
+				}
+			}
+			continue;
+		}
+
+		stack.push_back(node.first);
+		insideStack.push_back((bInside == true) ? 1 : 0);
+		stack.push_back(nodeIndex + 1);
+		insideStack.push_back((bInside == true) ? 1 : 0);
+	}
+
+	m_frameStats.culled += count - visibleCount;
+	return(visibleCount);
+}
+
+/***********************************************************
+ *  IsObjectVisible()
+ *
+ *  This method is used for testing one object, for the
+ *  objects that are drawn as soon as they are described.
+ ***********************************************************/
+bool FrustumCuller::IsObjectVisible(const WorldBounds& bounds, GLuint object)
+{
+	m_frameStats.tested++;
+	if ((m_bEnabled == false) ||
+		(IsBoxInFrustum(bounds.GetBoxMin(object), bounds.GetBoxMax(object)) == true))
+	{
+		return(true);
+	}
+
+	m_frameStats.culled++;
+	return(false);
+}
+
+/***********************************************************
+ *  IsBoxInFrustum()
+ *
+ *  This method is used for testing a world box against the
+ *  planes of the view frustum.  The test keeps some boxes
+ *  near the corners that are just outside.
+ ***********************************************************/
+bool FrustumCuller::IsBoxInFrustum(const glm::vec3& boxMin, const glm::vec3& boxMax) const
+{
+	for (int plane = 0; plane < 6; plane++)
+	{
+		float x = (m_planeX[plane] >= 0.0f) ? boxMax.x : boxMin.x;
+		float y = (m_planeY[plane] >= 0.0f) ? boxMax.y : boxMin.y;
+		float z = (m_planeZ[plane] >= 0.0f) ? boxMax.z : boxMin.z;
+		if (m_planeX[plane] * x + m_planeY[plane] * y + m_planeZ[plane] * z + m_planeW[plane] < 0.0f)
+		{
+			return(false);
+		}
+	}
+	return(true);
+}
+
+/***********************************************************
+ *  PlaceBox()
+ *
+ *  This method is used for finding whether a box is outside,
+ *  crossing or inside the frustum.  The box is inside when
+ *  even its corner nearest to each plane is on the inner
+ *  side of the plane.
+ ***********************************************************/
+FrustumCuller::BOX_PLACE FrustumCuller::PlaceBox(const glm::vec3& boxMin, const glm::vec3& boxMax) const
+{
+	BOX_PLACE place = BOX_INSIDE;
+	for (int plane = 0; plane < 6; plane++)
+	{
+		bool bPositiveX = (m_planeX[plane] >= 0.0f);
+		bool bPositiveY = (m_planeY[plane] >= 0.0f);
+		bool bPositiveZ = (m_planeZ[plane] >= 0.0f);
+		float farthest = m_planeX[plane] * (bPositiveX ? boxMax.x : boxMin.x) +
+			m_planeY[plane] * (bPositiveY ? boxMax.y : boxMin.y) +
+			m_planeZ[plane] * (bPositiveZ ? boxMax.z : boxMin.z) + m_planeW[plane];
+		if (farthest < 0.0f)
+		{
+			return(BOX_OUTSIDE);
+		}
+		float nearest = m_planeX[plane] * (bPositiveX ? boxMin.x : boxMax.x) +
+			m_planeY[plane] * (bPositiveY ? boxMin.y : boxMax.y) +
+			m_planeZ[plane] * (bPositiveZ ? boxMin.z : boxMax.z) + m_planeW[plane];
+		if (nearest < 0.0f)
+		{
+			place = BOX_CROSSING;
+		}
+	}
+	return(place);
+}
@@ -0,0 +1,85 @@
+///////////////////////////////////////////////////////////////////////////////
+// frustumculler.h
+// ============
+// reject the objects outside the view before their draws are issued
+//
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "WorldBounds.h"
+#include "BoundsHierarchy.h"
+#include <glm/glm.hpp>
+#include <vector>
+#include <stdint.h>
+
+/***********************************************************
+ *  FrustumCuller
+ *
+ *  This class tests the world boxes of objects against the
+ *  six planes of the view frustum.  For every plane only the
+ *  box corner farthest along the plane normal is tested,
+ *  and the box arrays of WorldBounds let four boxes be
+ *  tested with each SSE instruction.
+ ***********************************************************/
+class FrustumCuller
+{
+public:
+    // objects tested since BeginFrame()
+    struct CULL_STATS
+    {
+        uint32_t tested;
+        uint32_t culled;    // objects outside the view
+        uint32_t nodesTested;   // tree nodes tested
+    };
+
+    // constructor
+    FrustumCuller();
+
+    // when false, every object is reported as visible
+    void SetEnabled(bool bEnabled) { m_bEnabled = bEnabled; }
+    bool IsEnabled() const { return m_bEnabled; }
+
+    // set the camera the objects are tested against
+    void SetViewTransform(const glm::mat4& view, const glm::mat4& projection);
+
+    // clear the stats for a new frame
+    void BeginFrame();
+    // test every object of the bounds, writing 1 for the objects
+    // in the view and 0 for the others - returns the number of
+    // objects in the view
+    GLuint CullObjects(const WorldBounds& bounds, std::vector<uint8_t>& visible);
+    // the same through a tree built over the bounds, testing the
+    // objects only where a node crosses the edge of the view
+    GLuint CullObjects(
+        const WorldBounds& bounds, const BoundsHierarchy& hierarchy,
+        std::vector<uint8_t>& visible);
+    // test one object of the bounds
+    bool IsObjectVisible(const WorldBounds& bounds, GLuint object);
+
+    // stats of the objects tested since BeginFrame()
+    const CULL_STATS& GetFrameStats() const { return m_frameStats; }
+
+private:
+    bool m_bEnabled;
+
+    // world space planes of the view frustum, pointing inside,
+    // with each component in an array of its own
+    float m_planeX[6];
+    float m_planeY[6];
+    float m_planeZ[6];
+    float m_planeW[6];
+
+    CULL_STATS m_frameStats;
+
+    // where a box is against the frustum
+    enum BOX_PLACE
+    {
+        BOX_OUTSIDE,
+        BOX_CROSSING,
+        BOX_INSIDE
+    };
+
+    // true when the box is at least partly inside the frustum
+    bool IsBoxInFrustum(const glm::vec3& boxMin, const glm::vec3& boxMax) const;
+    // whether the box is outside, crossing or inside the frustum
+    BOX_PLACE PlaceBox(const glm::vec3& boxMin, const glm::vec3& boxMax) const;
+};
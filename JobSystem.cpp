@@ -0,0 +1,166 @@
+///////////////////////////////////////////////////////////////////////////////
+// jobsystem.cpp
+// ============
+// run jobs on a pool of worker threads
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "JobSystem.h"
+
+/***********************************************************
+ *  JobSystem()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+JobSystem::JobSystem(unsigned int workerCount)
+{
+	m_unfinishedJobs = 0;
+	m_bStopping = false;
+
+	// the calling thread keeps a core of its own
+	if (workerCount == 0)
+	{
+		unsigned int cores = std::thread::hardware_concurrency();
+		workerCount = (cores > 1) ? cores - 1 : 1;
+	}
+
+	for (unsigned int i = 0; i < workerCount; i++)
+	{
+		m_workers.push_back(std::thread(&JobSystem::RunWorker, this));
+	}
+}
+
+/***********************************************************
+ *  ~JobSystem()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+JobSystem::~JobSystem()
+{
+	WaitForAll();
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_bStopping = true;
+	}
+	m_jobQueued.notify_all();
+
+	for (size_t i = 0; i < m_workers.size(); i++)
+	{
+		m_workers[i].join();
+	}
+}
+
+/***********************************************************
+ *  Submit()
+ *
+ *  This method is used for queueing a job.  The first idle
+ *  worker runs it, once no job of a higher priority is left.
+ ***********************************************************/
+void JobSystem::Submit(std::function<void()> job, JOB_PRIORITY priority)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_jobs[priority].push_back(job);
+		m_unfinishedJobs++;
+	}
+	m_jobQueued.notify_one();
+}
+
+/***********************************************************
+ *  WaitForAll()
+ *
+ *  This method is used for blocking the calling thread until
+ *  every job submitted so far has finished.
+ ***********************************************************/
+void JobSystem::WaitForAll()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_jobsFinished.wait(lock, [this]() { return(m_unfinishedJobs == 0); });
+}
+
+/***********************************************************
+ *  RunQueuedJob()
+ *
+ *  This method is used for running the next normal priority
+ *  job on the calling thread, so a thread waiting on jobs
+ *  helps with them instead of sleeping while the workers are
+ *  busy.  Low priority jobs are left to the workers, since
+ *  they may run for long.
+ ***********************************************************/
+bool JobSystem::RunQueuedJob()
+{
+	std::function<void()> job;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		if (m_jobs[NORMAL_PRIORITY].empty() == true)
+		{
+			return(false);
+		}
+		job = m_jobs[NORMAL_PRIORITY].front();
+		m_jobs[NORMAL_PRIORITY].pop_front();
+	}
+
+	job();
+	FinishJob();
+	return(true);
+}
+
+/***********************************************************
+ *  RunWorker()
+ *
+ *  This method is used for the loop of each worker thread,
+ *  which sleeps until a job is queued and runs it outside
+ *  the lock.
+ ***********************************************************/
+void JobSystem::RunWorker()
+{
+	while (true)
+	{
+		std::function<void()> job;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_jobQueued.wait(lock, [this]()
+			{
+				return((m_bStopping == true) ||
+					(m_jobs[NORMAL_PRIORITY].empty() == false) ||
+					(m_jobs[LOW_PRIORITY].empty() == false));
+			});
+
+			int priority = NORMAL_PRIORITY;
+			while ((priority < PRIORITY_COUNT) && (m_jobs[priority].empty() == true))
+			{
+				priority++;
+			}
+			if (priority == PRIORITY_COUNT)
+			{
+				return;
+			}
+			job = m_jobs[priority].front();
+			m_jobs[priority].pop_front();
+		}
+
+		job();
+		FinishJob();
+	}
+}
+
+/***********************************************************
+ *  FinishJob()
+ *
+ *  This method is used for counting a job as finished, and
+ *  waking the threads in WaitForAll() after the last one.
+ ***********************************************************/
+void JobSystem::FinishJob()
+{
+	bool bAllFinished = false;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_unfinishedJobs--;
+		bAllFinished = (m_unfinishedJobs == 0);
+	}
+	if (bAllFinished == true)
+	{
+		m_jobsFinished.notify_all();
+	}
+}
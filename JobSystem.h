@@ -0,0 +1,72 @@
+///////////////////////////////////////////////////////////////////////////////
+// jobsystem.h
+// ============
+// run jobs on a pool of worker threads
+//
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/***********************************************************
+ *  JobSystem
+ *
+ *  This class keeps a pool of worker threads that take jobs
+ *  from a shared queue in the order they were submitted, the
+ *  normal priority jobs before any low priority job, so long
+ *  background work does not hold up work a frame waits for.
+ *  The jobs must not call OpenGL, since the GL context only
+ *  belongs to the thread that created it - work for the GL
+ *  thread is handed back through a queue of its own.
+ ***********************************************************/
+class JobSystem
+{
+public:
+    // order the queued jobs are taken in
+    enum JOB_PRIORITY
+    {
+        NORMAL_PRIORITY,
+        LOW_PRIORITY,
+        PRIORITY_COUNT
+    };
+
+    // constructor - 0 starts one worker per core besides the
+    // calling thread
+    JobSystem(unsigned int workerCount = 0);
+    // destructor - finishes the queued jobs first
+    ~JobSystem();
+
+    // queue a job for the workers
+    void Submit(std::function<void()> job, JOB_PRIORITY priority = NORMAL_PRIORITY);
+    // wait until every submitted job has finished
+    void WaitForAll();
+    // run a queued normal priority job on the calling thread,
+    // for a thread that would otherwise wait for it - returns
+    // false when there is none
+    bool RunQueuedJob();
+
+    // number of worker threads
+    unsigned int GetWorkerCount() const { return (unsigned int)m_workers.size(); }
+
+private:
+    std::vector<std::thread> m_workers;
+    // queued jobs, by priority
+    std::deque<std::function<void()> > m_jobs[PRIORITY_COUNT];
+    // jobs queued or running
+    unsigned int m_unfinishedJobs;
+    bool m_bStopping;
+
+    std::mutex m_mutex;
+    std::condition_variable m_jobQueued;
+    std::condition_variable m_jobsFinished;
+
+    // take and run jobs until the system stops
+    void RunWorker();
+    // count a job as finished and wake the waiting threads when
+    // it was the last one
+    void FinishJob();
+};
@@ -0,0 +1,185 @@
+///////////////////////////////////////////////////////////////////////////////
+// lodselector.cpp
+// ============
+// choose the tessellation level of every draw from its size on the screen
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "LODSelector.h"
+
+#include <algorithm>
+#include <cmath>
+
+// declaration of global variables
+namespace
+{
+	// smallest on-screen diameter in pixels of each level
+	const float g_DefaultLevelPixelSizes[ShapeMeshes::LOD_LEVEL_COUNT] = { 240.0f, 100.0f, 40.0f, 0.0f };
+	// a size must move 15% past a threshold to change level
+	const float g_DefaultHysteresis = 0.15f;
+}
+
+/***********************************************************
+ *  LODSelector()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+LODSelector::LODSelector(ShapeMeshes* pMeshes)
+{
+	m_pMeshes = pMeshes;
+	m_bEnabled = true;
+	m_view = glm::mat4(1.0f);
+	m_projection = glm::mat4(1.0f);
+	m_viewportHeight = 1;
+	m_nextDraw = 0;
+	m_frameStats = LOD_STATS();
+	SetLevelThresholds(g_DefaultLevelPixelSizes, ShapeMeshes::LOD_LEVEL_COUNT, g_DefaultHysteresis);
+}
+
+/***********************************************************
+ *  SetViewTransform()
+ *
+ *  This method is used for setting the view and projection
+ *  of the frame, along with the viewport height the sizes
+ *  are measured in.
+ ***********************************************************/
+void LODSelector::SetViewTransform(
+	const glm::mat4& view,
+	const glm::mat4& projection,
+	int viewportHeight)
+{
+	m_view = view;
+	m_projection = projection;
+	m_viewportHeight = std::max(viewportHeight, 1);
+}
+
+/***********************************************************
+ *  SetLevelThresholds()
+ *
+ *  This method is used for setting the smallest on-screen
+ *  diameter of each level.  Levels past the passed in count
+ *  are never selected.
+ ***********************************************************/
+void LODSelector::SetLevelThresholds(const float* pPixelSizes, int count, float hysteresis)
+{
+	for (int level = 0; level < ShapeMeshes::LOD_LEVEL_COUNT; level++)
+	{
+		// the last level takes every size below the one before
+		m_levelPixelSizes[level] = (level < count - 1) ? pPixelSizes[level] : 0.0f;
+	}
+	m_hysteresis = hysteresis;
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for starting a new frame.  The draws
+ *  keep the levels of the previous frame by their order.
+ ***********************************************************/
+void LODSelector::BeginFrame()
+{
+	m_drawLevels.resize(m_nextDraw);
+	m_nextDraw = 0;
+	m_frameStats = LOD_STATS();
+}
+
+/***********************************************************
+ *  SelectLevel()
+ *
+ *  This method is used for choosing the tessellation level
+ *  of the next draw.  Starting from the level of the draw in
+ *  the previous frame, the draw moves to a finer level when
+ *  its size is past the threshold of that level plus the
+ *  margin, and to a coarser level when it is below its own
+ *  threshold minus the margin.
+ ***********************************************************/
+int LODSelector::SelectLevel(ShapeMeshes::MESH_ID meshID, const glm::mat4& model, bool bDrawn)
+{
+	if (NULL == m_pMeshes)
+	{
+		return(0);
+	}
+
+	int levelCount = m_pMeshes->GetLevelCount(meshID);
+	int level = 0;
+	if ((m_bEnabled == true) && (levelCount > 1))
+	{
+		float size = GetProjectedSize(meshID, model);
+
+		if ((m_nextDraw < m_drawLevels.size()) && (m_drawLevels[m_nextDraw].meshID == meshID))
+		{
+			level = std::min(m_drawLevels[m_nextDraw].level, levelCount - 1);
+			while ((level > 0) && (size >= m_levelPixelSizes[level - 1] * (1.0f + m_hysteresis)))
+			{
+				level--;
+			}
+			while ((level < levelCount - 1) && (size < m_levelPixelSizes[level] * (1.0f - m_hysteresis)))
+			{
+				level++;
+			}
+		}
+		else
+		{
+			// a new draw takes the level its size falls in
+			while ((level < levelCount - 1) && (size < m_levelPixelSizes[level]))
+			{
+				level++;
+			}
+		}
+	}
+
+	DRAW_LEVEL drawLevel;
+	drawLevel.meshID = meshID;
+	drawLevel.level = level;
+	if (m_nextDraw < m_drawLevels.size())
+	{
+		m_drawLevels[m_nextDraw] = drawLevel;
+	}
+	else
+	{
+		m_drawLevels.push_back(drawLevel);
+	}
+	m_nextDraw++;
+
+	if (bDrawn == false)
+	{
+		return(level);
+	}
+
+	GLuint levelTriangles = m_pMeshes->GetLevelTriangleCount(meshID, level);
+	m_frameStats.draws++;
+	m_frameStats.trianglesDrawn += levelTriangles;
+	if (level > 0)
+	{
+		m_frameStats.coarserDraws++;
+		m_frameStats.trianglesSaved += m_pMeshes->GetLevelTriangleCount(meshID, 0) - levelTriangles;
+	}
+
+	return(level);
+}
+
+/***********************************************************
+ *  GetProjectedSize()
+ *
+ *  This method is used for measuring the diameter in pixels
+ *  of the bounding sphere of a draw.  The clip space w of the
+ *  center is its distance for a perspective projection and 1
+ *  for an orthographic one, so both are handled alike.  A
+ *  sphere reaching the camera is treated as filling the view.
+ ***********************************************************/
+float LODSelector::GetProjectedSize(ShapeMeshes::MESH_ID meshID, const glm::mat4& model) const
+{
+	// the radius grows with the largest scale of the model
+	float scale = std::max(glm::length(glm::vec3(model[0])),
+		std::max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+	float radius = m_pMeshes->GetBoundingRadius(meshID) * scale;
+
+	glm::vec4 viewCenter = m_view * model[3];
+	float w = m_projection[2][3] * viewCenter.z + m_projection[3][3];
+	if (w <= radius * std::fabs(m_projection[2][3]))
+	{
+		return((float)m_viewportHeight);
+	}
+
+	return(radius * m_projection[1][1] * m_viewportHeight / w);
+}
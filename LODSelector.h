@@ -0,0 +1,94 @@
+///////////////////////////////////////////////////////////////////////////////
+// lodselector.h
+// ============
+// choose the tessellation level of every draw from its size on the screen
+//
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "ShapeMeshes.h"
+#include <glm/glm.hpp>
+#include <vector>
+#include <stdint.h>
+
+/***********************************************************
+ *  LODSelector
+ *
+ *  This class picks the tessellation level of each draw of
+ *  a frame from the projected screen height of the bounding
+ *  sphere of the mesh.  A draw only changes level once its
+ *  size has moved past the level threshold by a margin, so
+ *  objects near a threshold do not pop between levels from
+ *  one frame to the next.  Draws are told apart by their
+ *  order within the frame.
+ ***********************************************************/
+class LODSelector
+{
+public:
+    // triangle counts of the draws selected since BeginFrame()
+    struct LOD_STATS
+    {
+        uint32_t draws;             // draws a level was selected for
+        uint32_t coarserDraws;      // draws at a level above 0
+        uint32_t trianglesDrawn;    // triangles at the selected levels
+        uint32_t trianglesSaved;    // triangles not drawn versus level 0
+    };
+
+    // constructor
+    LODSelector(ShapeMeshes* pMeshes);
+
+    // when false, every draw is given level 0
+    void SetEnabled(bool bEnabled) { m_bEnabled = bEnabled; }
+    bool IsEnabled() const { return m_bEnabled; }
+
+    // set the camera the projected sizes are measured with
+    void SetViewTransform(
+        const glm::mat4& view,
+        const glm::mat4& projection,
+        int viewportHeight);
+
+    // set the smallest on-screen diameter in pixels of each
+    // level, from level 0 on, and the fraction a size must
+    // move past a threshold to change level
+    void SetLevelThresholds(const float* pPixelSizes, int count, float hysteresis);
+
+    // start a new frame - the draws are numbered from 0 again
+    // and the stats are cleared
+    void BeginFrame();
+    // choose the level of the next draw of the frame - a draw
+    // that is culled passes bDrawn as false, so it keeps its
+    // place in the draw order without counting in the stats
+    int SelectLevel(ShapeMeshes::MESH_ID meshID, const glm::mat4& model, bool bDrawn = true);
+
+    // stats of the drawn draws selected since BeginFrame()
+    const LOD_STATS& GetFrameStats() const { return m_frameStats; }
+
+private:
+    // level selected for a draw in the previous frame
+    struct DRAW_LEVEL
+    {
+        ShapeMeshes::MESH_ID meshID;
+        int level;
+    };
+
+    // pointer to the meshes the draws refer to
+    ShapeMeshes* m_pMeshes;
+    bool m_bEnabled;
+
+    // camera values the sizes are measured with
+    glm::mat4 m_view;
+    glm::mat4 m_projection;
+    int m_viewportHeight;
+
+    // smallest on-screen diameter of each level, and the
+    // fraction a size must move past it to change level
+    float m_levelPixelSizes[ShapeMeshes::LOD_LEVEL_COUNT];
+    float m_hysteresis;
+
+    // levels of the previous frame, by draw order
+    std::vector<DRAW_LEVEL> m_drawLevels;
+    size_t m_nextDraw;
+    LOD_STATS m_frameStats;
+
+    // diameter in pixels of the bounding sphere of a draw
+    float GetProjectedSize(ShapeMeshes::MESH_ID meshID, const glm::mat4& model) const;
+};
@@ -0,0 +1,384 @@
+///////////////////////////////////////////////////////////////////////////////
+// lightbuffer.cpp
+// ============
+// manage the scene light sources and upload the changed ones to the shader
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "LightBuffer.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+// declaration of global variables
+namespace
+{
+	// uniform block holding the light records - the shader declares
+	//
+	//   struct Light { vec4 position; vec4 ambientColor; vec4 diffuseColor; vec4 specularColor; };
+	//   layout(std140) uniform LightBlock { int lightCount; Light lights[N]; };
+	//
+	// where position.w is the focal strength and ambientColor.w is
+	// the specular intensity
+	const char* g_LightBlockName = "LightBlock";
+	// the light count is padded to 16 bytes before the array
+	const GLintptr g_LightBlockHeaderSize = 16;
+
+	/***********************************************************
+	 *  CountTrailingZeros()
+	 *
+	 *  Index of the lowest set bit of a non-zero dirty word.
+	 ***********************************************************/
+	int CountTrailingZeros(uint64_t bits)
+	{
+#ifdef _MSC_VER
+		unsigned long index = 0;
+		_BitScanForward64(&index, bits);
+		return((int)index);
+#else
+		return(__builtin_ctzll(bits));
+#endif
+	}
+}
+
+/***********************************************************
+ *  LightBuffer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+LightBuffer::LightBuffer(ShaderManager* pShaderManager, GLuint bindingPoint)
+{
+	m_pShaderManager = pShaderManager;
+	m_bindingPoint = bindingPoint;
+	m_lightBuffer = 0;
+	m_bUseLightBlock = false;
+	m_capacity = 0;
+	m_bCountDirty = false;
+	m_lastUploadCount = 0;
+}
+
+/***********************************************************
+ *  ~LightBuffer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+LightBuffer::~LightBuffer()
+{
+	if (m_lightBuffer != 0)
+	{
+		glDeleteBuffers(1, &m_lightBuffer);
+		m_lightBuffer = 0;
+	}
+	m_pShaderManager = NULL;
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used for connecting to the light block of
+ *  the shader.  Shaders without the block get the lights
+ *  through the lightSources[] uniforms instead, limited to
+ *  the array size that the shader declares.
+ ***********************************************************/
+void LightBuffer::Initialize()
+{
+	m_bUseLightBlock = false;
+	m_capacity = 0;
+	m_lightUniforms.clear();
+
+	if (NULL == m_pShaderManager)
+	{
+		return;
+	}
+
+	GLint blockSize = 0;
+	if (m_pShaderManager->BindUniformBlock(g_LightBlockName, m_bindingPoint, &blockSize) == true)
+	{
+		m_capacity = (int)((blockSize - g_LightBlockHeaderSize) / (GLint)sizeof(LIGHT_BLOCK_ENTRY));
+
+		if (m_lightBuffer == 0)
+		{
+			glGenBuffers(1, &m_lightBuffer);
+		}
+		glBindBuffer(GL_UNIFORM_BUFFER, m_lightBuffer);
+		glBufferData(GL_UNIFORM_BUFFER, blockSize, NULL, GL_DYNAMIC_DRAW);
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+		glBindBufferBase(GL_UNIFORM_BUFFER, m_bindingPoint, m_lightBuffer);
+		m_bUseLightBlock = true;
+	}
+	else
+	{
+		// resolve the lightSources[] elements the shader declares
+		while (true)
+		{
+			std::string element = "lightSources[" + std::to_string(m_lightUniforms.size()) + "].";
+			LIGHT_UNIFORMS uniforms;
+			uniforms.position = m_pShaderManager->GetUniformHandle((element + "position").c_str());
+			if (uniforms.position.IsValid() == false)
+			{
+				break;
+			}
+			uniforms.ambientColor = m_pShaderManager->GetUniformHandle((element + "ambientColor").c_str());
+			uniforms.diffuseColor = m_pShaderManager->GetUniformHandle((element + "diffuseColor").c_str());
+			uniforms.specularColor = m_pShaderManager->GetUniformHandle((element + "specularColor").c_str());
+			uniforms.focalStrength = m_pShaderManager->GetUniformHandle((element + "focalStrength").c_str());
+			uniforms.specularIntensity = m_pShaderManager->GetUniformHandle((element + "specularIntensity").c_str());
+			m_lightUniforms.push_back(uniforms);
+		}
+		m_capacity = (int)m_lightUniforms.size();
+	}
+
+	if ((int)m_lights.size() > m_capacity)
+	{
+		std::cout << "Shader addresses " << m_capacity << " lights, but "
+			<< m_lights.size() << " are defined" << std::endl;
+	}
+
+	// everything the shader can see has to be sent again
+	m_dirtyBits.assign((m_capacity + 63) / 64, 0);
+	for (int slot = 0; slot < m_capacity; slot++)
+	{
+		MarkDirty(slot);
+	}
+	m_bCountDirty = true;
+	m_uploadEntries.reserve(m_capacity);
+}
+
+/***********************************************************
+ *  AddLight()
+ *
+ *  This method is used for adding a light source to the
+ *  scene.  The returned ID stays valid until the light
+ *  is removed.
+ ***********************************************************/
+int LightBuffer::AddLight(const LIGHT_SOURCE& light)
+{
+	int lightID = -1;
+	if (m_freeLightIDs.size() > 0)
+	{
+		lightID = m_freeLightIDs.back();
+		m_freeLightIDs.pop_back();
+	}
+	else
+	{
+		lightID = (int)m_lightSlots.size();
+		m_lightSlots.push_back(-1);
+	}
+
+	int slot = (int)m_lights.size();
+	m_lights.push_back(light);
+	m_slotLightIDs.push_back(lightID);
+	m_lightSlots[lightID] = slot;
+
+	MarkDirty(slot);
+	m_bCountDirty = true;
+
+	return(lightID);
+}
+
+/***********************************************************
+ *  SetLight()
+ *
+ *  This method is used for replacing the values of a light.
+ ***********************************************************/
+void LightBuffer::SetLight(int lightID, const LIGHT_SOURCE& light)
+{
+	if ((lightID < 0) || (lightID >= (int)m_lightSlots.size()) || (m_lightSlots[lightID] < 0))
+	{
+		return;
+	}
+
+	int slot = m_lightSlots[lightID];
+	m_lights[slot] = light;
+	MarkDirty(slot);
+}
+
+/***********************************************************
+ *  MoveLight()
+ *
+ *  This method is used for changing the position of a light.
+ ***********************************************************/
+void LightBuffer::MoveLight(int lightID, const glm::vec3& position)
+{
+	if ((lightID < 0) || (lightID >= (int)m_lightSlots.size()) || (m_lightSlots[lightID] < 0))
+	{
+		return;
+	}
+
+	int slot = m_lightSlots[lightID];
+	m_lights[slot].position = position;
+	MarkDirty(slot);
+}
+
+/***********************************************************
+ *  RemoveLight()
+ *
+ *  This method is used for removing a light.  The last light
+ *  is moved into the freed slot so the lights stay packed,
+ *  which dirties just those two slots.
+ ***********************************************************/
+void LightBuffer::RemoveLight(int lightID)
+{
+	if ((lightID < 0) || (lightID >= (int)m_lightSlots.size()) || (m_lightSlots[lightID] < 0))
+	{
+		return;
+	}
+
+	int slot = m_lightSlots[lightID];
+	int lastSlot = (int)m_lights.size() - 1;
+	if (slot != lastSlot)
+	{
+		m_lights[slot] = m_lights[lastSlot];
+		m_slotLightIDs[slot] = m_slotLightIDs[lastSlot];
+		m_lightSlots[m_slotLightIDs[slot]] = slot;
+		MarkDirty(slot);
+	}
+	m_lights.pop_back();
+	m_slotLightIDs.pop_back();
+
+	// the vacated slot is cleared for shaders that always
+	// loop over every lightSources[] element
+	MarkDirty(lastSlot);
+	m_bCountDirty = true;
+
+	m_lightSlots[lightID] = -1;
+	m_freeLightIDs.push_back(lightID);
+}
+
+/***********************************************************
+ *  GetLight()
+ *
+ *  This method is used for getting the values of a light.
+ ***********************************************************/
+const LightBuffer::LIGHT_SOURCE* LightBuffer::GetLight(int lightID) const
+{
+	if ((lightID < 0) || (lightID >= (int)m_lightSlots.size()) || (m_lightSlots[lightID] < 0))
+	{
+		return(NULL);
+	}
+
+	return(&m_lights[m_lightSlots[lightID]]);
+}
+
+/***********************************************************
+ *  MarkDirty()
+ *
+ *  This method is used for flagging a packed slot so it is
+ *  sent by the next upload.  Slots the shader cannot address
+ *  are ignored.
+ ***********************************************************/
+void LightBuffer::MarkDirty(int slot)
+{
+	if ((slot < 0) || (slot >= m_capacity))
+	{
+		return;
+	}
+
+	m_dirtyBits[slot / 64] |= (uint64_t)1 << (slot % 64);
+}
+
+/***********************************************************
+ *  UploadChangedLights()
+ *
+ *  This method is used for sending the dirty lights to the
+ *  shader.  Neighbouring dirty slots are sent together, so
+ *  the cost follows the number of changed lights rather than
+ *  the number of lights in the scene.
+ ***********************************************************/
+void LightBuffer::UploadChangedLights()
+{
+	m_lastUploadCount = 0;
+	if (m_capacity == 0)
+	{
+		return;
+	}
+
+	if (m_bUseLightBlock == true)
+	{
+		glBindBuffer(GL_UNIFORM_BUFFER, m_lightBuffer);
+		if (m_bCountDirty == true)
+		{
+			GLint lightCount = ((int)m_lights.size() < m_capacity) ? (GLint)m_lights.size() : m_capacity;
+			glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(GLint), &lightCount);
+		}
+	}
+	m_bCountDirty = false;
+
+	for (size_t word = 0; word < m_dirtyBits.size(); word++)
+	{
+		uint64_t bits = m_dirtyBits[word];
+		while (bits != 0)
+		{
+			// find the run of consecutive dirty slots
+			int first = CountTrailingZeros(bits);
+			uint64_t remaining = ~(bits >> first);
+			int length = (remaining == 0) ? (64 - first) : CountTrailingZeros(remaining);
+
+			UploadSlots((int)(word * 64) + first, (int)(word * 64) + first + length - 1);
+
+			if (first + length >= 64)
+			{
+				bits = 0;
+			}
+			else
+			{
+				bits &= ~((((uint64_t)1 << length) - 1) << first);
+			}
+		}
+		m_dirtyBits[word] = 0;
+	}
+
+	if (m_bUseLightBlock == true)
+	{
+		glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	}
+}
+
+/***********************************************************
+ *  UploadSlots()
+ *
+ *  This method is used for writing a run of packed slots into
+ *  the light block or the lightSources[] uniforms.  Slots past
+ *  the last light are written as an unlit black light.
+ ***********************************************************/
+void LightBuffer::UploadSlots(int firstSlot, int lastSlot)
+{
+	LIGHT_SOURCE blackLight = {};
+	int slotCount = lastSlot - firstSlot + 1;
+
+	if (m_bUseLightBlock == true)
+	{
+		m_uploadEntries.resize(slotCount);
+		for (int i = 0; i < slotCount; i++)
+		{
+			int slot = firstSlot + i;
+			const LIGHT_SOURCE& light = (slot < (int)m_lights.size()) ? m_lights[slot] : blackLight;
+			m_uploadEntries[i].position = glm::vec4(light.position, light.focalStrength);
+			m_uploadEntries[i].ambientColor = glm::vec4(light.ambientColor, light.specularIntensity);
+			m_uploadEntries[i].diffuseColor = glm::vec4(light.diffuseColor, 0.0f);
+			m_uploadEntries[i].specularColor = glm::vec4(light.specularColor, 0.0f);
+		}
+		glBufferSubData(
+			GL_UNIFORM_BUFFER,
+			g_LightBlockHeaderSize + firstSlot * sizeof(LIGHT_BLOCK_ENTRY),
+			slotCount * sizeof(LIGHT_BLOCK_ENTRY),
+			m_uploadEntries.data());
+	}
+	else
+	{
+		for (int slot = firstSlot; slot <= lastSlot; slot++)
+		{
+			const LIGHT_SOURCE& light = (slot < (int)m_lights.size()) ? m_lights[slot] : blackLight;
+			const LIGHT_UNIFORMS& uniforms = m_lightUniforms[slot];
+			m_pShaderManager->setVec3Value(uniforms.position, light.position);
+			m_pShaderManager->setVec3Value(uniforms.ambientColor, light.ambientColor);
+			m_pShaderManager->setVec3Value(uniforms.diffuseColor, light.diffuseColor);
+			m_pShaderManager->setVec3Value(uniforms.specularColor, light.specularColor);
+			m_pShaderManager->setFloatValue(uniforms.focalStrength, light.focalStrength);
+			m_pShaderManager->setFloatValue(uniforms.specularIntensity, light.specularIntensity);
+		}
+	}
+
+	m_lastUploadCount += slotCount;
+}
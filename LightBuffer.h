@@ -0,0 +1,119 @@
+///////////////////////////////////////////////////////////////////////////////
+// lightbuffer.h
+// ============
+// manage the scene light sources and upload the changed ones to the shader
+//
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "ShaderManager.h"
+#include <vector>
+#include <stdint.h>
+
+/***********************************************************
+ *  LightBuffer
+ *
+ *  This class keeps the table of light sources for the
+ *  scene.  Lights can be added, moved and removed at any
+ *  time; each change marks the light dirty and only dirty
+ *  lights are sent to the shader on the next upload.
+ ***********************************************************/
+class LightBuffer
+{
+public:
+    struct LIGHT_SOURCE
+    {
+        glm::vec3 position;
+        glm::vec3 ambientColor;
+        glm::vec3 diffuseColor;
+        glm::vec3 specularColor;
+        float focalStrength;
+        float specularIntensity;
+    };
+
+    // constructor
+    LightBuffer(ShaderManager* pShaderManager, GLuint bindingPoint);
+    // destructor
+    ~LightBuffer();
+
+    // connect to the light block declared by the shader, or to
+    // the lightSources[] uniforms when there is no block
+    void Initialize();
+
+    // add a light - returns the ID used to change it later
+    int AddLight(const LIGHT_SOURCE& light);
+    // replace all of the values of a light
+    void SetLight(int lightID, const LIGHT_SOURCE& light);
+    // change only the position of a light
+    void MoveLight(int lightID, const glm::vec3& position);
+    // remove a light from the scene
+    void RemoveLight(int lightID);
+    // get the current values of a light, or NULL
+    const LIGHT_SOURCE* GetLight(int lightID) const;
+
+    // number of lights in the scene
+    int GetLightCount() const { return (int)m_lights.size(); }
+    // number of lights the shader can address
+    int GetLightCapacity() const { return m_capacity; }
+    // number of light records sent by the last upload
+    uint32_t GetLastUploadCount() const { return m_lastUploadCount; }
+
+    // send the lights changed since the last upload to the
+    // shader - called once per frame
+    void UploadChangedLights();
+
+private:
+    // std140 layout of one light record in the light block
+    struct LIGHT_BLOCK_ENTRY
+    {
+        glm::vec4 position;         // w = focal strength
+        glm::vec4 ambientColor;     // w = specular intensity
+        glm::vec4 diffuseColor;
+        glm::vec4 specularColor;
+    };
+
+    // uniform handles for one lightSources[] element when the
+    // shader has no light block
+    struct LIGHT_UNIFORMS
+    {
+        UniformHandle position;
+        UniformHandle ambientColor;
+        UniformHandle diffuseColor;
+        UniformHandle specularColor;
+        UniformHandle focalStrength;
+        UniformHandle specularIntensity;
+    };
+
+    // pointer to shader manager object
+    ShaderManager* m_pShaderManager;
+    // uniform buffer binding point of the light block
+    GLuint m_bindingPoint;
+    // uniform buffer holding the light block
+    GLuint m_lightBuffer;
+    // true when the shader reads lights from the light block
+    bool m_bUseLightBlock;
+    // number of lights the shader can address
+    int m_capacity;
+
+    // lights packed in shader order
+    std::vector<LIGHT_SOURCE> m_lights;
+    // light ID of each packed light, and packed slot of each ID
+    std::vector<int> m_slotLightIDs;
+    std::vector<int> m_lightSlots;
+    // light IDs released by removed lights
+    std::vector<int> m_freeLightIDs;
+    // one bit per packed slot that must be uploaded
+    std::vector<uint64_t> m_dirtyBits;
+    // the light count in the block header must be uploaded
+    bool m_bCountDirty;
+    uint32_t m_lastUploadCount;
+
+    // fallback uniform handles
+    std::vector<LIGHT_UNIFORMS> m_lightUniforms;
+    // staging records for one upload, kept to avoid reallocating
+    std::vector<LIGHT_BLOCK_ENTRY> m_uploadEntries;
+
+    // mark a packed slot for upload
+    void MarkDirty(int slot);
+    // write packed slots [firstSlot, lastSlot] into the shader
+    void UploadSlots(int firstSlot, int lastSlot);
+};
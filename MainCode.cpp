@@ -1,5 +1,6 @@
 #include <iostream>         // error handling and output
 #include <cstdlib>          // EXIT_FAILURE
+#include <cstring>          // strcmp
 
 #include <GL/glew.h>        // GLEW library
 #include "GLFW/glfw3.h"     // GLFW library
@@ -13,6 +14,7 @@
 #include "ViewManager.h"
 #include "ShapeMeshes.h"
 #include "ShaderManager.h"
+#include "BenchmarkManager.h"
 
 // Namespace for declaring global variables
 namespace
@@ -85,6 +87,15 @@ int main(int argc, char* argv[])
 	g_SceneManager = new SceneManager(g_ShaderManager);
 	g_SceneManager->PrepareScene();
 
+	// when launched with "--bench <name>" run the benchmark
+	// and exit instead of showing the interactive scene
+	if ((argc > 2) && (strcmp(argv[1], "--bench") == 0))
+	{
+		BenchmarkManager benchmarkManager(g_ShaderManager);
+		benchmarkManager.RunBenchmark(argv[2]);
+		glfwSetWindowShouldClose(g_Window, true);
+	}
+
 	// loop will keep running until the application is closed 
 	// or until an error has occurred
 	while (!glfwWindowShouldClose(g_Window))
@@ -98,6 +109,11 @@ int main(int argc, char* argv[])
 
 		// convert from 3D object space to 2D view
 		g_ViewManager->PrepareSceneView();
+		// choose the mesh levels for the same camera
+		g_SceneManager->SetViewTransform(
+			g_ViewManager->GetViewMatrix(),
+			g_ViewManager->GetProjectionMatrix(),
+			g_ViewManager->GetViewportHeight());
 
 		// refresh the 3D scene
 		g_SceneManager->RenderScene();
@@ -0,0 +1,45 @@
+///////////////////////////////////////////////////////////////////////////////
+// mappedfile.h
+// ============
+// map a file into memory for reading
+//
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <stddef.h>
+
+/***********************************************************
+ *  MappedFile
+ *
+ *  This class maps a whole file read only into the address
+ *  space, so its bytes are paged in by the operating system
+ *  as they are read instead of being copied into a buffer.
+ ***********************************************************/
+class MappedFile
+{
+public:
+    // constructor
+    MappedFile();
+    // destructor - unmaps the file
+    ~MappedFile();
+
+    // map the file - returns false when it cannot be opened or
+    // is empty
+    bool Open(const char* filename);
+    // unmap the file
+    void Close();
+
+    bool IsOpen() const { return (NULL != m_pData); }
+    const unsigned char* GetData() const { return m_pData; }
+    size_t GetSize() const { return m_size; }
+
+private:
+    const unsigned char* m_pData;
+    size_t m_size;
+    // handles of the file and its mapping on Windows
+    void* m_fileHandle;
+    void* m_mappingHandle;
+
+    // a mapping can not be shared
+    MappedFile(const MappedFile&);
+    MappedFile& operator=(const MappedFile&);
+};
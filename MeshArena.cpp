@@ -0,0 +1,423 @@
+///////////////////////////////////////////////////////////////////////////////
+// mesharena.cpp
+// ============
+// pack the vertex and index data of many meshes into shared GPU buffers
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MeshArena.h"
+
+namespace
+{
+	// smallest buffer allocation, so the few basic shapes
+	// fit without growing
+	const GLsizeiptr g_MinimumBufferBytes = 256 * 1024;
+}
+
+GLuint MeshArena::s_boundVAO = 0;
+
+/***********************************************************
+ *  MeshArena()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+MeshArena::MeshArena(const VertexLayout& layout)
+	: m_layout(layout)
+{
+	m_vertexStride = layout.GetStride(VERTEX_BINDING);
+	m_vao = 0;
+	m_vertexBuffer = 0;
+	m_indexBuffer = 0;
+	m_vertexBytesUsed = 0;
+	m_vertexBytesCapacity = 0;
+	m_indexBytesUsed = 0;
+	m_indexBytesCapacity = 0;
+}
+
+/***********************************************************
+ *  ~MeshArena()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+MeshArena::~MeshArena()
+{
+	if (m_vao != 0)
+	{
+		if (s_boundVAO == m_vao)
+		{
+			glBindVertexArray(0);
+			s_boundVAO = 0;
+		}
+		glDeleteVertexArrays(1, &m_vao);
+	}
+	if (m_vertexBuffer != 0)
+	{
+		glDeleteBuffers(1, &m_vertexBuffer);
+	}
+	if (m_indexBuffer != 0)
+	{
+		glDeleteBuffers(1, &m_indexBuffer);
+	}
+}
+
+/***********************************************************
+ *  AddMesh()
+ *
+ *  This method is used for adding the data of a mesh to the
+ *  arena buffers, in the space of a removed mesh when one is
+ *  large enough and at the end of the buffers otherwise.  The
+ *  returned range is what the draw calls use to find the mesh.
+ ***********************************************************/
+MeshArena::MESH_RANGE MeshArena::AddMesh(
+	const void* pVertices, GLsizei vertexCount,
+	const GLuint* pIndices, GLsizei indexCount)
+{
+	if (m_vao == 0)
+	{
+		CreateVAO();
+	}
+
+	GLsizeiptr vertexBytes = (GLsizeiptr)vertexCount * m_vertexStride;
+	GLsizeiptr indexBytes = (GLsizeiptr)indexCount * sizeof(GLuint);
+
+	// a grown buffer is attached to the VAO in place of the old
+	// one, and the attribute formats stay as they are
+	GLsizeiptr vertexOffset = AllocateBlock(m_freeVertexBlocks, m_vertexBytesUsed, vertexBytes);
+	if (vertexOffset + vertexBytes > m_vertexBytesUsed)
+	{
+		GLuint oldVertexBuffer = m_vertexBuffer;
+		ReserveBuffer(m_vertexBuffer, m_vertexBytesCapacity, m_vertexBytesUsed, vertexOffset + vertexBytes);
+		m_vertexBytesUsed = vertexOffset + vertexBytes;
+		if (oldVertexBuffer != m_vertexBuffer)
+		{
+			m_layout.BindBuffer(m_vao, VERTEX_BINDING, m_vertexBuffer);
+		}
+	}
+	glNamedBufferSubData(m_vertexBuffer, vertexOffset, vertexBytes, pVertices);
+
+	GLsizeiptr indexOffset = m_indexBytesUsed;
+	if (indexCount > 0)
+	{
+		indexOffset = AllocateBlock(m_freeIndexBlocks, m_indexBytesUsed, indexBytes);
+		if (indexOffset + indexBytes > m_indexBytesUsed)
+		{
+			GLuint oldIndexBuffer = m_indexBuffer;
+			ReserveBuffer(m_indexBuffer, m_indexBytesCapacity, m_indexBytesUsed, indexOffset + indexBytes);
+			m_indexBytesUsed = indexOffset + indexBytes;
+			if (oldIndexBuffer != m_indexBuffer)
+			{
+				glVertexArrayElementBuffer(m_vao, m_indexBuffer);
+			}
+		}
+		glNamedBufferSubData(m_indexBuffer, indexOffset, indexBytes, pIndices);
+	}
+
+	MESH_RANGE range;
+	range.baseVertex = (GLint)(vertexOffset / m_vertexStride);
+	range.firstIndex = (GLuint)(indexOffset / sizeof(GLuint));
+	range.vertexCount = vertexCount;
+	range.indexCount = indexCount;
+	return(range);
+}
+
+/***********************************************************
+ *  RemoveMesh()
+ *
+ *  This method is used for freeing the space of a mesh.  The
+ *  other meshes stay where they are, so their ranges remain
+ *  valid.  A buffer that is mostly free afterwards is moved
+ *  into a smaller one, and an empty arena gives up its
+ *  buffers and its VAO until the next mesh is added.
+ ***********************************************************/
+void MeshArena::RemoveMesh(const MESH_RANGE& range)
+{
+	if (m_vao == 0)
+	{
+		return;
+	}
+
+	GLuint oldVertexBuffer = m_vertexBuffer;
+	FreeBlock(m_freeVertexBlocks, m_vertexBytesUsed,
+		(GLsizeiptr)range.baseVertex * m_vertexStride, (GLsizeiptr)range.vertexCount * m_vertexStride);
+	ShrinkBuffer(m_vertexBuffer, m_vertexBytesCapacity, m_vertexBytesUsed);
+
+	GLuint oldIndexBuffer = m_indexBuffer;
+	if (range.indexCount > 0)
+	{
+		FreeBlock(m_freeIndexBlocks, m_indexBytesUsed,
+			(GLsizeiptr)range.firstIndex * sizeof(GLuint), (GLsizeiptr)range.indexCount * sizeof(GLuint));
+		ShrinkBuffer(m_indexBuffer, m_indexBytesCapacity, m_indexBytesUsed);
+	}
+
+	if ((m_vertexBuffer == 0) && (m_indexBuffer == 0))
+	{
+		if (s_boundVAO == m_vao)
+		{
+			glBindVertexArray(0);
+			s_boundVAO = 0;
+		}
+		glDeleteVertexArrays(1, &m_vao);
+		m_vao = 0;
+		return;
+	}
+
+	if ((oldVertexBuffer != m_vertexBuffer) && (m_vertexBuffer != 0))
+	{
+		m_layout.BindBuffer(m_vao, VERTEX_BINDING, m_vertexBuffer);
+	}
+	if (oldIndexBuffer != m_indexBuffer)
+	{
+		glVertexArrayElementBuffer(m_vao, m_indexBuffer);
+	}
+}
+
+/***********************************************************
+ *  Bind()
+ *
+ *  This method is used for making the arena VAO current.
+ ***********************************************************/
+void MeshArena::Bind()
+{
+	if (s_boundVAO != m_vao)
+	{
+		glBindVertexArray(m_vao);
+		s_boundVAO = m_vao;
+	}
+}
+
+/***********************************************************
+ *  BindVertexBuffer()
+ *
+ *  This method is used for attaching a buffer to a binding
+ *  of the vertex layout other than the arena vertices.
+ ***********************************************************/
+void MeshArena::BindVertexBuffer(GLuint bindingIndex, GLuint buffer)
+{
+	BUFFER_BINDING binding;
+	binding.bindingIndex = bindingIndex;
+	binding.buffer = buffer;
+
+	size_t i = 0;
+	while ((i < m_bufferBindings.size()) && (m_bufferBindings[i].bindingIndex != bindingIndex))
+	{
+		i++;
+	}
+	if (i < m_bufferBindings.size())
+	{
+		m_bufferBindings[i] = binding;
+	}
+	else
+	{
+		m_bufferBindings.push_back(binding);
+	}
+
+	if (m_vao == 0)
+	{
+		CreateVAO();
+		return;
+	}
+
+	m_layout.BindBuffer(m_vao, bindingIndex, buffer);
+}
+
+/***********************************************************
+ *  CreateVAO()
+ *
+ *  This method is used for creating the arena VAO with the
+ *  attribute formats of the vertex layout.  A VAO made again
+ *  after the arena was emptied gets the buffers attached with
+ *  BindVertexBuffer() back.
+ ***********************************************************/
+void MeshArena::CreateVAO()
+{
+	glCreateVertexArrays(1, &m_vao);
+	m_layout.Apply(m_vao);
+
+	if (m_vertexBuffer != 0)
+	{
+		m_layout.BindBuffer(m_vao, VERTEX_BINDING, m_vertexBuffer);
+	}
+	if (m_indexBuffer != 0)
+	{
+		glVertexArrayElementBuffer(m_vao, m_indexBuffer);
+	}
+	for (size_t i = 0; i < m_bufferBindings.size(); i++)
+	{
+		m_layout.BindBuffer(m_vao, m_bufferBindings[i].bindingIndex, m_bufferBindings[i].buffer);
+	}
+}
+
+/***********************************************************
+ *  AllocateBlock()
+ *
+ *  This method is used for finding room for a block.  The
+ *  first free block large enough is taken, and what is left
+ *  of it stays free.  Without one, the block goes at the
+ *  used end of the buffer.
+ ***********************************************************/
+GLsizeiptr MeshArena::AllocateBlock(
+	std::vector<FREE_BLOCK>& freeBlocks, GLsizeiptr used, GLsizeiptr bytes)
+{
+	for (size_t i = 0; i < freeBlocks.size(); i++)
+	{
+		if (freeBlocks[i].bytes >= bytes)
+		{
+			GLsizeiptr offset = freeBlocks[i].offset;
+			freeBlocks[i].offset += bytes;
+			freeBlocks[i].bytes -= bytes;
+			if (freeBlocks[i].bytes == 0)
+			{
+				freeBlocks.erase(freeBlocks.begin() + i);
+			}
+			return(offset);
+		}
+	}
+	return(used);
+}
+
+/***********************************************************
+ *  FreeBlock()
+ *
+ *  This method is used for giving a block back.  The free
+ *  blocks are kept sorted and merged, so a free block never
+ *  touches another one, and free space at the used end is
+ *  taken off the used size instead of being kept as a block.
+ ***********************************************************/
+void MeshArena::FreeBlock(
+	std::vector<FREE_BLOCK>& freeBlocks, GLsizeiptr& used,
+	GLsizeiptr offset, GLsizeiptr bytes)
+{
+	if (bytes <= 0)
+	{
+		return;
+	}
+
+	size_t i = 0;
+	while ((i < freeBlocks.size()) && (freeBlocks[i].offset < offset))
+	{
+		i++;
+	}
+
+	FREE_BLOCK block;
+	block.offset = offset;
+	block.bytes = bytes;
+	freeBlocks.insert(freeBlocks.begin() + i, block);
+
+	// merge with the next block, then with the previous one
+	if ((i + 1 < freeBlocks.size()) && (freeBlocks[i].offset + freeBlocks[i].bytes == freeBlocks[i + 1].offset))
+	{
+		freeBlocks[i].bytes += freeBlocks[i + 1].bytes;
+		freeBlocks.erase(freeBlocks.begin() + i + 1);
+	}
+	if ((i > 0) && (freeBlocks[i - 1].offset + freeBlocks[i - 1].bytes == freeBlocks[i].offset))
+	{
+		freeBlocks[i - 1].bytes += freeBlocks[i].bytes;
+		freeBlocks.erase(freeBlocks.begin() + i);
+	}
+
+	if ((freeBlocks.empty() == false) && (freeBlocks.back().offset + freeBlocks.back().bytes >= used))
+	{
+		used = freeBlocks.back().offset;
+		freeBlocks.pop_back();
+	}
+}
+
+/***********************************************************
+ *  GetFreeBytes()
+ *
+ *  This method is used for adding up the free blocks.
+ ***********************************************************/
+GLsizeiptr MeshArena::GetFreeBytes(const std::vector<FREE_BLOCK>& freeBlocks)
+{
+	GLsizeiptr freeBytes = 0;
+	for (size_t i = 0; i < freeBlocks.size(); i++)
+	{
+		freeBytes += freeBlocks[i].bytes;
+	}
+	return(freeBytes);
+}
+
+/***********************************************************
+ *  ReserveBuffer()
+ *
+ *  This method is used for growing a buffer to at least the
+ *  required size.  The capacity doubles so that appending
+ *  many meshes only reallocates a few times, and the data
+ *  already stored is copied on the GPU.
+ ***********************************************************/
+void MeshArena::ReserveBuffer(
+	GLuint& buffer, GLsizeiptr& capacity,
+	GLsizeiptr used, GLsizeiptr required)
+{
+	if ((buffer != 0) && (required <= capacity))
+	{
+		return;
+	}
+
+	GLsizeiptr newCapacity = (capacity > g_MinimumBufferBytes) ? capacity : g_MinimumBufferBytes;
+	while (newCapacity < required)
+	{
+		newCapacity *= 2;
+	}
+
+	GLuint newBuffer = 0;
+	glCreateBuffers(1, &newBuffer);
+	glNamedBufferData(newBuffer, newCapacity, NULL, GL_STATIC_DRAW);
+
+	if (buffer != 0)
+	{
+		if (used > 0)
+		{
+			glCopyNamedBufferSubData(buffer, newBuffer, 0, 0, used);
+		}
+		glDeleteBuffers(1, &buffer);
+	}
+
+	buffer = newBuffer;
+	capacity = newCapacity;
+}
+
+/***********************************************************
+ *  ShrinkBuffer()
+ *
+ *  This method is used for halving the capacity of a buffer
+ *  while at most a quarter of it is used, so a buffer does
+ *  not grow and shrink over and over around one size.  The
+ *  capacity never goes below the smallest allocation until
+ *  nothing is used, and then the buffer is deleted.
+ ***********************************************************/
+void MeshArena::ShrinkBuffer(
+	GLuint& buffer, GLsizeiptr& capacity, GLsizeiptr used)
+{
+	if (buffer == 0)
+	{
+		return;
+	}
+
+	if (used == 0)
+	{
+		glDeleteBuffers(1, &buffer);
+		buffer = 0;
+		capacity = 0;
+		return;
+	}
+
+	GLsizeiptr newCapacity = capacity;
+	while ((newCapacity / 2 >= g_MinimumBufferBytes) && (used <= newCapacity / 4))
+	{
+		newCapacity /= 2;
+	}
+	if (newCapacity == capacity)
+	{
+		return;
+	}
+
+	GLuint newBuffer = 0;
+	glCreateBuffers(1, &newBuffer);
+	glNamedBufferData(newBuffer, newCapacity, NULL, GL_STATIC_DRAW);
+	glCopyNamedBufferSubData(buffer, newBuffer, 0, 0, used);
+	glDeleteBuffers(1, &buffer);
+
+	buffer = newBuffer;
+	capacity = newCapacity;
+}
@@ -0,0 +1,139 @@
+///////////////////////////////////////////////////////////////////////////////
+// mesharena.h
+// ============
+// pack the vertex and index data of many meshes into shared GPU buffers
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include "VertexLayout.h"
+
+#include <vector>
+
+/***********************************************************
+ *  MeshArena
+ *
+ *  This class appends the interleaved vertices and the
+ *  indices of every added mesh into one vertex buffer and
+ *  one index buffer, both owned by a single VAO.  Each mesh
+ *  is addressed by its base vertex and first index, so
+ *  different meshes draw without switching VAOs.  The VAO
+ *  gets its attribute formats from the vertex layout once,
+ *  and only the buffer bindings change when a buffer grows.
+ *  Removed meshes leave free blocks that later meshes reuse,
+ *  so the meshes still stored keep their ranges, and the
+ *  buffers shrink once their end is free.
+ ***********************************************************/
+class MeshArena
+{
+public:
+	// location of a mesh inside the arena buffers
+	struct MESH_RANGE
+	{
+		GLint baseVertex;	// first vertex of the mesh
+		GLuint firstIndex;	// first index of the mesh
+		GLsizei vertexCount;
+		GLsizei indexCount;
+	};
+
+	// binding of the vertex layout the arena vertices are
+	// attached to
+	static const GLuint VERTEX_BINDING = 0;
+
+	// constructor - the stride of the vertex binding of the
+	// layout is the size of one arena vertex
+	MeshArena(const VertexLayout& layout);
+	// destructor
+	~MeshArena();
+
+	// append a mesh to the arena - meshes drawn with glDrawArrays
+	// pass no indices
+	MESH_RANGE AddMesh(
+		const void* pVertices, GLsizei vertexCount,
+		const GLuint* pIndices, GLsizei indexCount);
+	// free the space of a mesh added before - the buffers are
+	// deleted along with the VAO once the arena is empty
+	void RemoveMesh(const MESH_RANGE& range);
+
+	// make the arena VAO current, skipping the call when it
+	// already is
+	void Bind();
+	// attach a buffer to another binding of the vertex layout,
+	// such as the per-instance values
+	void BindVertexBuffer(GLuint bindingIndex, GLuint buffer);
+
+	// buffer objects - the buffers change when the arena grows,
+	// and the VAO is pointed at the new ones
+	GLuint GetVAO() const { return m_vao; }
+	GLuint GetVertexBuffer() const { return m_vertexBuffer; }
+	GLuint GetIndexBuffer() const { return m_indexBuffer; }
+
+	// bytes of vertex data stored in the arena
+	GLsizeiptr GetVertexBytes() const { return m_vertexBytesUsed - GetFreeBytes(m_freeVertexBlocks); }
+	// bytes of GPU memory held by the vertex and index buffers
+	GLsizeiptr GetBufferBytes() const { return m_vertexBytesCapacity + m_indexBytesCapacity; }
+
+private:
+	// unused bytes between the stored meshes
+	struct FREE_BLOCK
+	{
+		GLsizeiptr offset;
+		GLsizeiptr bytes;
+	};
+
+	// buffer attached to a binding other than the arena vertices
+	struct BUFFER_BINDING
+	{
+		GLuint bindingIndex;
+		GLuint buffer;
+	};
+
+	VertexLayout m_layout;
+	GLsizei m_vertexStride;
+
+	GLuint m_vao;
+	GLuint m_vertexBuffer;
+	GLuint m_indexBuffer;
+
+	GLsizeiptr m_vertexBytesUsed;
+	GLsizeiptr m_vertexBytesCapacity;
+	GLsizeiptr m_indexBytesUsed;
+	GLsizeiptr m_indexBytesCapacity;
+	// free blocks below the used end of each buffer, by offset
+	std::vector<FREE_BLOCK> m_freeVertexBlocks;
+	std::vector<FREE_BLOCK> m_freeIndexBlocks;
+	// attached with BindVertexBuffer(), kept for a new VAO
+	std::vector<BUFFER_BINDING> m_bufferBindings;
+
+	// VAO bound by the last Bind() of any arena
+	static GLuint s_boundVAO;
+
+	// create the VAO and set the attribute formats on it,
+	// attaching the buffers the arena already has
+	void CreateVAO();
+
+	// find room for a block in the free blocks of a buffer, or
+	// at its used end - returns the offset of the block
+	static GLsizeiptr AllocateBlock(
+		std::vector<FREE_BLOCK>& freeBlocks, GLsizeiptr used, GLsizeiptr bytes);
+	// give a block back, merging it with the free blocks next
+	// to it and moving the used end down when it is the last one
+	static void FreeBlock(
+		std::vector<FREE_BLOCK>& freeBlocks, GLsizeiptr& used,
+		GLsizeiptr offset, GLsizeiptr bytes);
+	// bytes in the free blocks of a buffer
+	static GLsizeiptr GetFreeBytes(const std::vector<FREE_BLOCK>& freeBlocks);
+
+	// make sure a buffer can hold the required bytes, moving
+	// the used part into a larger buffer when it cannot
+	void ReserveBuffer(
+		GLuint& buffer, GLsizeiptr& capacity,
+		GLsizeiptr used, GLsizeiptr required);
+	// move the used part of a buffer into a smaller buffer when
+	// most of it is free, deleting it when nothing is used
+	void ShrinkBuffer(
+		GLuint& buffer, GLsizeiptr& capacity, GLsizeiptr used);
+};
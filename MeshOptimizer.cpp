@@ -0,0 +1,413 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshoptimizer.cpp
+// ============
+// reorder indexed triangle meshes for the GPU vertex cache and fetch
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MeshOptimizer.h"
+
+#include <glm/glm.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+// declaration of global variables
+namespace
+{
+	// vertex scoring constants of Forsyth's linear speed vertex
+	// cache optimization, tuned for an LRU cache of 32 entries
+	const int g_ForsythCacheSize = 32;
+	const float g_CacheDecayPower = 1.5f;
+	const float g_LastTriangleScore = 0.75f;
+	const float g_ValenceBoostScale = 2.0f;
+	const float g_ValenceBoostPower = 0.5f;
+
+	// FIFO cache size used to measure the cache efficiency, a
+	// conservative size for the post-transform cache of GPUs
+	const GLuint g_AnalysisCacheSize = 16;
+
+	/***********************************************************
+	 *  VertexScore()
+	 *
+	 *  Forsyth score of a vertex - vertices used by the last
+	 *  triangle or near the front of the cache score high, and
+	 *  vertices with few triangles left get a boost so they are
+	 *  finished off instead of being left behind.
+	 ***********************************************************/
+	float VertexScore(int cachePosition, GLuint remainingTriangles)
+	{
+		if (remainingTriangles == 0)
+		{
+			return(-1.0f);
+		}
+
+		float score = 0.0f;
+		if (cachePosition >= 0)
+		{
+			if (cachePosition < 3)
+			{
+				score = g_LastTriangleScore;
+			}
+			else
+			{
+				float scaler = 1.0f / (g_ForsythCacheSize - 3);
+				score = powf(1.0f - (cachePosition - 3) * scaler, g_CacheDecayPower);
+			}
+		}
+
+		score += g_ValenceBoostScale * powf((float)remainingTriangles, -g_ValenceBoostPower);
+		return(score);
+	}
+}
+
+/***********************************************************
+ *  MeshOptimizer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+MeshOptimizer::MeshOptimizer()
+{
+	m_bOptimizeOverdraw = false;
+}
+
+/***********************************************************
+ *  OptimizeTriangles()
+ *
+ *  This method is used for reordering the triangles of one
+ *  range of the index list.
+ ***********************************************************/
+void MeshOptimizer::OptimizeTriangles(
+	std::vector<GLuint>& indices, GLuint firstIndex, GLuint nIndices,
+	const std::vector<GLfloat>& vertices, GLuint floatsPerVertex)
+{
+	if ((nIndices < 6) || (firstIndex + nIndices > indices.size()))
+	{
+		return;
+	}
+
+	GLuint vertexCount = (GLuint)(vertices.size() / floatsPerVertex);
+	OptimizeVertexCache(&indices[firstIndex], nIndices, vertexCount);
+
+	if (m_bOptimizeOverdraw == true)
+	{
+		OptimizeOverdraw(&indices[firstIndex], nIndices, vertices, floatsPerVertex);
+	}
+}
+
+/***********************************************************
+ *  OptimizeVertexCache()
+ *
+ *  This method is used for reordering triangles with Tom
+ *  Forsyth's algorithm.  Each step emits the remaining
+ *  triangle with the highest score, where the score of a
+ *  triangle is the sum of the scores of its vertices, and
+ *  only the triangles touching the simulated cache have to
+ *  be rescored after each step.
+ ***********************************************************/
+void MeshOptimizer::OptimizeVertexCache(
+	GLuint* pIndices, GLuint nIndices, GLuint vertexCount)
+{
+	GLuint nTriangles = nIndices / 3;
+
+	// triangles using each vertex, packed per vertex
+	std::vector<GLuint> adjacencyOffsets(vertexCount + 1, 0);
+	for (GLuint i = 0; i < nTriangles * 3; i++)
+	{
+		adjacencyOffsets[pIndices[i] + 1]++;
+	}
+	for (GLuint vertex = 0; vertex < vertexCount; vertex++)
+	{
+		adjacencyOffsets[vertex + 1] += adjacencyOffsets[vertex];
+	}
+	std::vector<GLuint> adjacency(nTriangles * 3);
+	std::vector<GLuint> fillOffsets(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+	for (GLuint i = 0; i < nTriangles * 3; i++)
+	{
+		adjacency[fillOffsets[pIndices[i]]++] = i / 3;
+	}
+
+	std::vector<GLuint> remainingTriangles(vertexCount);
+	std::vector<int> cachePositions(vertexCount, -1);
+	std::vector<float> vertexScores(vertexCount);
+	for (GLuint vertex = 0; vertex < vertexCount; vertex++)
+	{
+		remainingTriangles[vertex] = adjacencyOffsets[vertex + 1] - adjacencyOffsets[vertex];
+		vertexScores[vertex] = VertexScore(-1, remainingTriangles[vertex]);
+	}
+
+	std::vector<float> triangleScores(nTriangles);
+	std::vector<bool> triangleEmitted(nTriangles, false);
+	int bestTriangle = 0;
+	for (GLuint triangle = 0; triangle < nTriangles; triangle++)
+	{
+		const GLuint* pCorners = &pIndices[triangle * 3];
+		triangleScores[triangle] = vertexScores[pCorners[0]] + vertexScores[pCorners[1]] + vertexScores[pCorners[2]];
+		if (triangleScores[triangle] > triangleScores[bestTriangle])
+		{
+			bestTriangle = (int)triangle;
+		}
+	}
+
+	std::vector<GLuint> output;
+	output.reserve(nTriangles * 3);
+	std::vector<GLuint> cache;
+	std::vector<GLuint> newCache;
+	GLuint nextUnemitted = 0;
+
+	while (bestTriangle >= 0)
+	{
+		const GLuint* pCorners = &pIndices[bestTriangle * 3];
+		output.insert(output.end(), pCorners, pCorners + 3);
+		triangleEmitted[bestTriangle] = true;
+
+		// the emitted triangle moves to the front of the cache
+		newCache.assign(pCorners, pCorners + 3);
+		for (GLuint corner = 0; corner < 3; corner++)
+		{
+			remainingTriangles[pCorners[corner]]--;
+		}
+		for (size_t entry = 0; entry < cache.size(); entry++)
+		{
+			if ((cache[entry] != pCorners[0]) && (cache[entry] != pCorners[1]) && (cache[entry] != pCorners[2]))
+			{
+				newCache.push_back(cache[entry]);
+			}
+		}
+
+		// rescore the cached vertices, including the ones that
+		// just fell out of the cache, and their triangles
+		for (size_t entry = 0; entry < newCache.size(); entry++)
+		{
+			GLuint vertex = newCache[entry];
+			cachePositions[vertex] = (entry < (size_t)g_ForsythCacheSize) ? (int)entry : -1;
+			vertexScores[vertex] = VertexScore(cachePositions[vertex], remainingTriangles[vertex]);
+		}
+		for (size_t entry = 0; entry < newCache.size(); entry++)
+		{
+			GLuint vertex = newCache[entry];
+			for (GLuint adjacent = adjacencyOffsets[vertex]; adjacent < adjacencyOffsets[vertex + 1]; adjacent++)
+			{
+				GLuint triangle = adjacency[adjacent];
+				if (triangleEmitted[triangle] == false)
+				{
+					const GLuint* pTriangle = &pIndices[triangle * 3];
+					triangleScores[triangle] = vertexScores[pTriangle[0]] + vertexScores[pTriangle[1]] + vertexScores[pTriangle[2]];
+				}
+			}
+		}
+
+		if (newCache.size() > (size_t)g_ForsythCacheSize)
+		{
+			newCache.resize(g_ForsythCacheSize);
+		}
+		cache.swap(newCache);
+
+		// the next triangle is the best one touching the cache
+		bestTriangle = -1;
+		float bestScore = -1.0f;
+		for (size_t entry = 0; entry < cache.size(); entry++)
+		{
+			GLuint vertex = cache[entry];
+			for (GLuint adjacent = adjacencyOffsets[vertex]; adjacent < adjacencyOffsets[vertex + 1]; adjacent++)
+			{
+				GLuint triangle = adjacency[adjacent];
+				if ((triangleEmitted[triangle] == false) && (triangleScores[triangle] > bestScore))
+				{
+					bestScore = triangleScores[triangle];
+					bestTriangle = (int)triangle;
+				}
+			}
+		}
+
+		// dead end - continue with the next triangle not emitted
+		if (bestTriangle < 0)
+		{
+			while ((nextUnemitted < nTriangles) && (triangleEmitted[nextUnemitted] == true))
+			{
+				nextUnemitted++;
+			}
+			if (nextUnemitted < nTriangles)
+			{
+				bestTriangle = (int)nextUnemitted;
+			}
+		}
+	}
+
+	std::copy(output.begin(), output.end(), pIndices);
+}
+
+/***********************************************************
+ *  OptimizeOverdraw()
+ *
+ *  This method is used for splitting the cache ordered
+ *  triangles into clusters wherever the cache restarts, and
+ *  sorting the clusters so those facing away from the mesh
+ *  center are drawn first.  Those clusters are the likely
+ *  visible ones, so later triangles fail the depth test more
+ *  often.  The vertex normals are used instead of the winding
+ *  order, which is not consistent across the basic shapes.
+ ***********************************************************/
+void MeshOptimizer::OptimizeOverdraw(
+	GLuint* pIndices, GLuint nIndices,
+	const std::vector<GLfloat>& vertices, GLuint floatsPerVertex)
+{
+	struct CLUSTER
+	{
+		GLuint firstIndex;
+		GLuint nIndices;
+		float sortKey;
+	};
+
+	GLuint nTriangles = nIndices / 3;
+	std::vector<CLUSTER> clusters;
+	std::vector<GLuint> fifo;
+
+	// a triangle that misses on all of its vertices starts a cluster
+	for (GLuint triangle = 0; triangle < nTriangles; triangle++)
+	{
+		GLuint misses = 0;
+		for (GLuint corner = 0; corner < 3; corner++)
+		{
+			GLuint vertex = pIndices[triangle * 3 + corner];
+			if (std::find(fifo.begin(), fifo.end(), vertex) == fifo.end())
+			{
+				fifo.push_back(vertex);
+				if (fifo.size() > g_AnalysisCacheSize)
+				{
+					fifo.erase(fifo.begin());
+				}
+				misses++;
+			}
+		}
+
+		if ((misses == 3) || (clusters.empty() == true))
+		{
+			CLUSTER cluster = { triangle * 3, 0, 0.0f };
+			clusters.push_back(cluster);
+		}
+		clusters.back().nIndices += 3;
+	}
+
+	if (clusters.size() < 2)
+	{
+		return;
+	}
+
+	glm::vec3 meshCenter(0.0f);
+	for (GLuint i = 0; i < nTriangles * 3; i++)
+	{
+		const GLfloat* pVertex = &vertices[pIndices[i] * floatsPerVertex];
+		meshCenter += glm::vec3(pVertex[0], pVertex[1], pVertex[2]);
+	}
+	meshCenter /= (float)(nTriangles * 3);
+
+	for (size_t i = 0; i < clusters.size(); i++)
+	{
+		glm::vec3 center(0.0f);
+		glm::vec3 normal(0.0f);
+		for (GLuint index = clusters[i].firstIndex; index < clusters[i].firstIndex + clusters[i].nIndices; index++)
+		{
+			const GLfloat* pVertex = &vertices[pIndices[index] * floatsPerVertex];
+			center += glm::vec3(pVertex[0], pVertex[1], pVertex[2]);
+			normal += glm::vec3(pVertex[3], pVertex[4], pVertex[5]);
+		}
+		center /= (float)clusters[i].nIndices;
+		clusters[i].sortKey = glm::dot(center - meshCenter, normal);
+	}
+
+	std::stable_sort(clusters.begin(), clusters.end(),
+		[](const CLUSTER& a, const CLUSTER& b) { return(a.sortKey > b.sortKey); });
+
+	std::vector<GLuint> output;
+	output.reserve(nTriangles * 3);
+	for (size_t i = 0; i < clusters.size(); i++)
+	{
+		output.insert(output.end(), pIndices + clusters[i].firstIndex, pIndices + clusters[i].firstIndex + clusters[i].nIndices);
+	}
+	std::copy(output.begin(), output.end(), pIndices);
+}
+
+/***********************************************************
+ *  OptimizeVertexFetch()
+ *
+ *  This method is used for moving the vertices into the
+ *  order in which the index list first uses them.  Vertices
+ *  no index uses are kept at the end.
+ ***********************************************************/
+void MeshOptimizer::OptimizeVertexFetch(
+	std::vector<GLfloat>& vertices, std::vector<GLuint>& indices,
+	GLuint floatsPerVertex)
+{
+	GLuint vertexCount = (GLuint)(vertices.size() / floatsPerVertex);
+	const GLuint unused = 0xFFFFFFFF;
+	std::vector<GLuint> remap(vertexCount, unused);
+	GLuint nextVertex = 0;
+
+	for (size_t i = 0; i < indices.size(); i++)
+	{
+		if (remap[indices[i]] == unused)
+		{
+			remap[indices[i]] = nextVertex++;
+		}
+		indices[i] = remap[indices[i]];
+	}
+	for (GLuint vertex = 0; vertex < vertexCount; vertex++)
+	{
+		if (remap[vertex] == unused)
+		{
+			remap[vertex] = nextVertex++;
+		}
+	}
+
+	std::vector<GLfloat> reordered(vertices.size());
+	for (GLuint vertex = 0; vertex < vertexCount; vertex++)
+	{
+		std::copy(vertices.begin() + vertex * floatsPerVertex,
+			vertices.begin() + (vertex + 1) * floatsPerVertex,
+			reordered.begin() + remap[vertex] * floatsPerVertex);
+	}
+	vertices.swap(reordered);
+}
+
+/***********************************************************
+ *  AnalyzeVertexCache()
+ *
+ *  This method is used for counting the vertices a FIFO
+ *  post-transform cache would have to transform for the
+ *  index list.  ACMR is the count per triangle, from 3.0
+ *  for no reuse down to about 0.5 for a regular grid, and
+ *  ATVR is the count per vertex, where 1.0 is the best.
+ ***********************************************************/
+MeshOptimizer::CACHE_STATS MeshOptimizer::AnalyzeVertexCache(
+	const std::vector<GLuint>& indices, GLuint vertexCount) const
+{
+	CACHE_STATS stats = { 0.0f, 0.0f };
+	if ((indices.size() < 3) || (vertexCount == 0))
+	{
+		return(stats);
+	}
+
+	// cache timestamp of every vertex, so a vertex is cached
+	// while fewer than the cache size misses came after it
+	std::vector<GLuint> missStamps(vertexCount, 0);
+	GLuint misses = 0;
+	GLuint usedVertices = 0;
+	for (size_t i = 0; i < indices.size(); i++)
+	{
+		GLuint vertex = indices[i];
+		if (missStamps[vertex] == 0)
+		{
+			usedVertices++;
+		}
+		if ((missStamps[vertex] == 0) || (misses - missStamps[vertex] >= g_AnalysisCacheSize))
+		{
+			misses++;
+			missStamps[vertex] = misses;
+		}
+	}
+
+	stats.ACMR = (float)misses / (float)(indices.size() / 3);
+	stats.ATVR = (float)misses / (float)usedVertices;
+	return(stats);
+}
@@ -0,0 +1,65 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshoptimizer.h
+// ============
+// reorder indexed triangle meshes for the GPU vertex cache and fetch
+//
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <GL/glew.h>
+#include <vector>
+
+/***********************************************************
+ *  MeshOptimizer
+ *
+ *  This class reorders the triangles and vertices of an
+ *  indexed triangle list so that the GPU transforms fewer
+ *  vertices and reads the vertex buffer in order.  It works
+ *  only on the CPU side data, so it can also be run offline
+ *  on mesh files.
+ ***********************************************************/
+class MeshOptimizer
+{
+public:
+    // vertex cache efficiency of an index list
+    struct CACHE_STATS
+    {
+        float ACMR;     // transformed vertices per triangle
+        float ATVR;     // transformed vertices per mesh vertex
+    };
+
+    // constructor
+    MeshOptimizer();
+
+    // when true, triangle clusters are also sorted to draw the
+    // outward facing parts of the mesh first
+    void SetOptimizeOverdraw(bool bOptimize) { m_bOptimizeOverdraw = bOptimize; }
+
+    // reorder the triangles of indices [firstIndex, firstIndex +
+    // nIndices) for the vertex cache, then for overdraw when it
+    // is enabled - the range is reordered on its own, so optional
+    // mesh parts keep their index ranges
+    void OptimizeTriangles(
+        std::vector<GLuint>& indices, GLuint firstIndex, GLuint nIndices,
+        const std::vector<GLfloat>& vertices, GLuint floatsPerVertex);
+
+    // renumber the vertices in the order the indices first use
+    // them, so the vertex buffer is read front to back
+    void OptimizeVertexFetch(
+        std::vector<GLfloat>& vertices, std::vector<GLuint>& indices,
+        GLuint floatsPerVertex);
+
+    // simulate a FIFO vertex cache over the index list
+    CACHE_STATS AnalyzeVertexCache(
+        const std::vector<GLuint>& indices, GLuint vertexCount) const;
+
+private:
+    bool m_bOptimizeOverdraw;
+
+    // Forsyth linear speed vertex cache ordering
+    void OptimizeVertexCache(
+        GLuint* pIndices, GLuint nIndices, GLuint vertexCount);
+    // sort the cache friendly triangle clusters front to back
+    void OptimizeOverdraw(
+        GLuint* pIndices, GLuint nIndices,
+        const std::vector<GLfloat>& vertices, GLuint floatsPerVertex);
+};
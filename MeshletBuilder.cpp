@@ -0,0 +1,329 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshletbuilder.cpp
+// ============
+// split indexed triangle meshes into small clusters with culling bounds
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MeshletBuilder.h"
+
+#include <algorithm>
+#include <cmath>
+
+// declaration of global variables
+namespace
+{
+	// marks a vertex that the current meshlet does not use yet
+	const GLuint g_UnusedVertex = 0xFFFFFFFF;
+	// offset of the normal within a vertex
+	const GLuint g_NormalOffset = 3;
+	// cutoff of a cone that can never be culled
+	const float g_NoConeCutoff = 1.0f;
+	// how much farther a triangle turned away from the meshlet
+	// normals counts while growing a meshlet - without it, the
+	// meshlets of thin tubes wrap around the tube and face every
+	// way
+	const float g_ConeWeight = 8.0f;
+
+	/***********************************************************
+	 *  GetPosition()
+	 *
+	 *  Position of a vertex of the float vertex data.
+	 ***********************************************************/
+	glm::vec3 GetPosition(const std::vector<GLfloat>& vertices, GLuint floatsPerVertex, GLuint vertex)
+	{
+		const GLfloat* pVertex = &vertices[vertex * floatsPerVertex];
+		return(glm::vec3(pVertex[0], pVertex[1], pVertex[2]));
+	}
+
+	/***********************************************************
+	 *  GetNormal()
+	 *
+	 *  Normal of a vertex of the float vertex data.
+	 ***********************************************************/
+	glm::vec3 GetNormal(const std::vector<GLfloat>& vertices, GLuint floatsPerVertex, GLuint vertex)
+	{
+		const GLfloat* pVertex = &vertices[vertex * floatsPerVertex + g_NormalOffset];
+		return(glm::vec3(pVertex[0], pVertex[1], pVertex[2]));
+	}
+
+	/***********************************************************
+	 *  GetFaceNormal()
+	 *
+	 *  Unit normal of a triangle, turned to the side of its
+	 *  vertex normals, or zero for a triangle without an area.
+	 ***********************************************************/
+	glm::vec3 GetFaceNormal(const std::vector<GLfloat>& vertices, GLuint floatsPerVertex, const GLuint* pCorners)
+	{
+		glm::vec3 p0 = GetPosition(vertices, floatsPerVertex, pCorners[0]);
+		glm::vec3 p1 = GetPosition(vertices, floatsPerVertex, pCorners[1]);
+		glm::vec3 p2 = GetPosition(vertices, floatsPerVertex, pCorners[2]);
+		glm::vec3 faceNormal = glm::cross(p1 - p0, p2 - p0);
+		float area = glm::length(faceNormal);
+		if (area <= 0.0f)
+		{
+			return(glm::vec3(0.0f));
+		}
+		faceNormal /= area;
+
+		glm::vec3 vertexNormals = GetNormal(vertices, floatsPerVertex, pCorners[0]) +
+			GetNormal(vertices, floatsPerVertex, pCorners[1]) +
+			GetNormal(vertices, floatsPerVertex, pCorners[2]);
+		if (glm::dot(faceNormal, vertexNormals) < 0.0f)
+		{
+			faceNormal = -faceNormal;
+		}
+		return(faceNormal);
+	}
+}
+
+/***********************************************************
+ *  MeshletBuilder()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+MeshletBuilder::MeshletBuilder()
+{
+}
+
+/***********************************************************
+ *  BuildMeshlets()
+ *
+ *  This method is used for splitting a range of triangles
+ *  into meshlets.  Each meshlet starts from the first
+ *  triangle not yet taken, in the vertex cache order, and
+ *  grows over the triangles sharing its vertices - those
+ *  adding the fewest new vertices first, then those closest
+ *  to the meshlet and facing its way - until the next one
+ *  would go past the vertex or triangle limit.  Growing over
+ *  neighbours keeps the spheres of the meshlets small and
+ *  their normals close together.  The triangles of the range
+ *  are then rewritten meshlet after meshlet.
+ ***********************************************************/
+void MeshletBuilder::BuildMeshlets(
+	std::vector<GLuint>& indices, GLuint firstIndex, GLuint nIndices,
+	const std::vector<GLfloat>& vertices, GLuint floatsPerVertex,
+	std::vector<MESHLET>& meshlets) const
+{
+	GLuint vertexCount = (GLuint)(vertices.size() / floatsPerVertex);
+	GLuint triangleCount = nIndices / 3;
+	if ((triangleCount == 0) || (vertexCount == 0))
+	{
+		return;
+	}
+	const GLuint* pTriangles = &indices[firstIndex];
+
+	// triangles using each vertex, as offsets into one list
+	std::vector<GLuint> vertexTriangleStart(vertexCount + 1, 0);
+	for (GLuint index = 0; index < triangleCount * 3; index++)
+	{
+		vertexTriangleStart[pTriangles[index] + 1]++;
+	}
+	for (GLuint vertex = 0; vertex < vertexCount; vertex++)
+	{
+		vertexTriangleStart[vertex + 1] += vertexTriangleStart[vertex];
+	}
+	std::vector<GLuint> vertexTriangles(triangleCount * 3);
+	std::vector<GLuint> fillPosition(vertexTriangleStart.begin(), vertexTriangleStart.end() - 1);
+	for (GLuint index = 0; index < triangleCount * 3; index++)
+	{
+		vertexTriangles[fillPosition[pTriangles[index]]++] = index / 3;
+	}
+
+	std::vector<glm::vec3> centroids(triangleCount);
+	std::vector<glm::vec3> faceNormals(triangleCount);
+	for (GLuint triangle = 0; triangle < triangleCount; triangle++)
+	{
+		centroids[triangle] = (GetPosition(vertices, floatsPerVertex, pTriangles[triangle * 3]) +
+			GetPosition(vertices, floatsPerVertex, pTriangles[triangle * 3 + 1]) +
+			GetPosition(vertices, floatsPerVertex, pTriangles[triangle * 3 + 2])) / 3.0f;
+		faceNormals[triangle] = GetFaceNormal(vertices, floatsPerVertex, &pTriangles[triangle * 3]);
+	}
+
+	// meshlet that last used each vertex
+	std::vector<GLuint> vertexMeshlet(vertexCount, g_UnusedVertex);
+	std::vector<bool> bTriangleUsed(triangleCount, false);
+	std::vector<GLuint> orderedTriangles;
+	orderedTriangles.reserve(triangleCount * 3);
+	std::vector<GLuint> meshletVertices;
+	meshletVertices.reserve(MAX_MESHLET_VERTICES);
+
+	// vertices of a triangle the current meshlet does not use yet
+	auto countNewVertices = [&](GLuint triangle, GLuint meshletNumber)
+	{
+		const GLuint* pCorners = &pTriangles[triangle * 3];
+		GLuint newVertices = 0;
+		for (GLuint corner = 0; corner < 3; corner++)
+		{
+			bool bRepeated = (corner > 0) && (pCorners[corner] == pCorners[0]);
+			bRepeated = bRepeated || ((corner > 1) && (pCorners[corner] == pCorners[1]));
+			if ((vertexMeshlet[pCorners[corner]] != meshletNumber) && (bRepeated == false))
+			{
+				newVertices++;
+			}
+		}
+		return(newVertices);
+	};
+
+	GLuint nextSeed = 0;
+	GLuint meshletNumber = 0;
+	while (nextSeed < triangleCount)
+	{
+		if (bTriangleUsed[nextSeed] == true)
+		{
+			nextSeed++;
+			continue;
+		}
+
+		MESHLET meshlet = {};
+		meshlet.firstIndex = firstIndex + (GLuint)orderedTriangles.size();
+		meshletVertices.clear();
+		glm::vec3 centroidSum(0.0f);
+		glm::vec3 normalSum(0.0f);
+		GLuint triangle = nextSeed;
+
+		while (triangle != g_UnusedVertex)
+		{
+			bTriangleUsed[triangle] = true;
+			for (GLuint corner = 0; corner < 3; corner++)
+			{
+				GLuint vertex = pTriangles[triangle * 3 + corner];
+				if (vertexMeshlet[vertex] != meshletNumber)
+				{
+					vertexMeshlet[vertex] = meshletNumber;
+					meshletVertices.push_back(vertex);
+				}
+				orderedTriangles.push_back(vertex);
+			}
+			meshlet.nIndices += 3;
+			centroidSum += centroids[triangle];
+			normalSum += faceNormals[triangle];
+
+			if (meshlet.nIndices / 3 >= MAX_MESHLET_TRIANGLES)
+			{
+				break;
+			}
+
+			// best neighbour that still fits in the meshlet
+			glm::vec3 meshletCenter = centroidSum / (float)(meshlet.nIndices / 3);
+			glm::vec3 meshletNormal(0.0f);
+			if (glm::length(normalSum) > 0.0f)
+			{
+				meshletNormal = glm::normalize(normalSum);
+			}
+			GLuint bestTriangle = g_UnusedVertex;
+			GLuint bestNewVertices = 0;
+			float bestDistance = 0.0f;
+			for (size_t i = 0; i < meshletVertices.size(); i++)
+			{
+				GLuint vertex = meshletVertices[i];
+				for (GLuint j = vertexTriangleStart[vertex]; j < vertexTriangleStart[vertex + 1]; j++)
+				{
+					GLuint candidate = vertexTriangles[j];
+					if (bTriangleUsed[candidate] == true)
+					{
+						continue;
+					}
+
+					GLuint newVertices = countNewVertices(candidate, meshletNumber);
+					if (meshletVertices.size() + newVertices > MAX_MESHLET_VERTICES)
+					{
+						continue;
+					}
+
+					float distance = glm::length(centroids[candidate] - meshletCenter) *
+						(1.0f + g_ConeWeight * (1.0f - glm::dot(meshletNormal, faceNormals[candidate])));
+					if ((bestTriangle == g_UnusedVertex) || (newVertices < bestNewVertices) ||
+						((newVertices == bestNewVertices) && (distance < bestDistance)))
+					{
+						bestTriangle = candidate;
+						bestNewVertices = newVertices;
+						bestDistance = distance;
+					}
+				}
+			}
+			triangle = bestTriangle;
+		}
+
+		ComputeBounds(meshlet, orderedTriangles, firstIndex, vertices, floatsPerVertex);
+		meshlets.push_back(meshlet);
+		meshletNumber++;
+	}
+
+	std::copy(orderedTriangles.begin(), orderedTriangles.end(), indices.begin() + firstIndex);
+}
+
+/***********************************************************
+ *  ComputeBounds()
+ *
+ *  This method is used for finding the bounding sphere and
+ *  the normal cone of a meshlet.  The sphere is centered on
+ *  the box around the vertices.  The cone is built from the
+ *  face normals, turned to agree with the vertex normals so
+ *  the winding order of the triangles does not matter.  A
+ *  meshlet whose normals spread over more than a half sphere
+ *  always has a triangle facing the camera, so its cone is
+ *  given a cutoff that never culls.
+ ***********************************************************/
+void MeshletBuilder::ComputeBounds(
+	MESHLET& meshlet, const std::vector<GLuint>& triangles, GLuint firstIndex,
+	const std::vector<GLfloat>& vertices, GLuint floatsPerVertex) const
+{
+	const GLuint* pIndices = &triangles[meshlet.firstIndex - firstIndex];
+	GLuint nIndices = meshlet.nIndices;
+
+	glm::vec3 minimum = GetPosition(vertices, floatsPerVertex, pIndices[0]);
+	glm::vec3 maximum = minimum;
+	for (GLuint index = 0; index < nIndices; index++)
+	{
+		glm::vec3 position = GetPosition(vertices, floatsPerVertex, pIndices[index]);
+		minimum = glm::min(minimum, position);
+		maximum = glm::max(maximum, position);
+	}
+
+	meshlet.center = (minimum + maximum) * 0.5f;
+	meshlet.radius = 0.0f;
+	for (GLuint index = 0; index < nIndices; index++)
+	{
+		glm::vec3 position = GetPosition(vertices, floatsPerVertex, pIndices[index]);
+		meshlet.radius = std::max(meshlet.radius, glm::length(position - meshlet.center));
+	}
+
+	// outward face normals of the triangles with an area
+	std::vector<glm::vec3> faceNormals;
+	faceNormals.reserve(meshlet.nIndices / 3);
+	glm::vec3 normalSum(0.0f);
+	for (GLuint index = 0; index + 2 < nIndices; index += 3)
+	{
+		glm::vec3 faceNormal = GetFaceNormal(vertices, floatsPerVertex, &pIndices[index]);
+		if (glm::length(faceNormal) <= 0.0f)
+		{
+			continue;
+		}
+
+		faceNormals.push_back(faceNormal);
+		normalSum += faceNormal;
+	}
+
+	meshlet.coneAxis = glm::vec3(0.0f, 0.0f, 1.0f);
+	meshlet.coneCutoff = g_NoConeCutoff;
+	float axisLength = glm::length(normalSum);
+	if ((faceNormals.empty() == true) || (axisLength <= 0.0f))
+	{
+		return;
+	}
+
+	glm::vec3 axis = normalSum / axisLength;
+	float minimumDot = 1.0f;
+	for (size_t i = 0; i < faceNormals.size(); i++)
+	{
+		minimumDot = std::min(minimumDot, glm::dot(axis, faceNormals[i]));
+	}
+
+	meshlet.coneAxis = axis;
+	if (minimumDot > 0.0f)
+	{
+		// the cone test needs the sine of the half angle
+		meshlet.coneCutoff = sqrtf(1.0f - minimumDot * minimumDot);
+	}
+}
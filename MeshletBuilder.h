@@ -0,0 +1,61 @@
+///////////////////////////////////////////////////////////////////////////////
+// meshletbuilder.h
+// ============
+// split indexed triangle meshes into small clusters with culling bounds
+//
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+#include <vector>
+
+/***********************************************************
+ *  MeshletBuilder
+ *
+ *  This class splits the index list of a mesh into meshlets,
+ *  runs of consecutive triangles that use only a few vertices
+ *  between them.  Every meshlet gets a bounding sphere and a
+ *  cone holding the normals of its triangles, so a culling
+ *  pass can reject the meshlets that are off the screen or
+ *  face away from the camera without looking at triangles.
+ *  The triangles are reordered meshlet after meshlet, so
+ *  each one is drawn from a range of the index buffer.
+ ***********************************************************/
+class MeshletBuilder
+{
+public:
+    // largest meshlet, the sizes used by mesh shader pipelines
+    static const GLuint MAX_MESHLET_VERTICES = 64;
+    static const GLuint MAX_MESHLET_TRIANGLES = 124;
+
+    // one meshlet and its culling bounds, in mesh space
+    struct MESHLET
+    {
+        GLuint firstIndex;      // first index, relative to the mesh
+        GLuint nIndices;
+        glm::vec3 center;       // bounding sphere of the vertices
+        GLfloat radius;
+        glm::vec3 coneAxis;     // average direction of the normals
+        GLfloat coneCutoff;     // sine of the cone half angle, 1 when
+                                // the normals spread too far to cull
+    };
+
+    // constructor
+    MeshletBuilder();
+
+    // split the triangles of indices [firstIndex, firstIndex +
+    // nIndices) into meshlets and append them, reordering the
+    // triangles of the range so each meshlet is one run - the
+    // vertices start with a float position and a float normal
+    void BuildMeshlets(
+        std::vector<GLuint>& indices, GLuint firstIndex, GLuint nIndices,
+        const std::vector<GLfloat>& vertices, GLuint floatsPerVertex,
+        std::vector<MESHLET>& meshlets) const;
+
+private:
+    // bounding sphere and normal cone of a finished meshlet,
+    // read from the reordered triangles of the range
+    void ComputeBounds(
+        MESHLET& meshlet, const std::vector<GLuint>& triangles, GLuint firstIndex,
+        const std::vector<GLfloat>& vertices, GLuint floatsPerVertex) const;
+};
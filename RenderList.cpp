@@ -0,0 +1,286 @@
+///////////////////////////////////////////////////////////////////////////////
+// renderlist.cpp
+// ============
+// compile scene draws into indirect commands submitted with one draw call
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "RenderList.h"
+
+// declaration of global variables
+namespace
+{
+	const char* g_DrawBlockName = "DrawBlock";
+	const char* g_UseDrawListName = "bUseDrawList";
+}
+
+/***********************************************************
+ *  RenderList()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+RenderList::RenderList(ShaderManager* pShaderManager, ShapeMeshes* pMeshes, GLuint bindingPoint)
+{
+	m_pShaderManager = pShaderManager;
+	m_pMeshes = pMeshes;
+	m_bindingPoint = bindingPoint;
+	m_commandBuffer = 0;
+	m_drawBuffer = 0;
+	m_compiledCount = 0;
+	m_bCommandsChanged = false;
+}
+
+/***********************************************************
+ *  ~RenderList()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+RenderList::~RenderList()
+{
+	if (m_commandBuffer != 0)
+	{
+		glDeleteBuffers(1, &m_commandBuffer);
+		m_commandBuffer = 0;
+	}
+	if (m_drawBuffer != 0)
+	{
+		glDeleteBuffers(1, &m_drawBuffer);
+		m_drawBuffer = 0;
+	}
+	m_pShaderManager = NULL;
+	m_pMeshes = NULL;
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used for connecting to the draw block of
+ *  the shader.  Without the block the shader cannot tell the
+ *  draws of the list apart, so the caller has to draw the
+ *  objects one at a time instead.
+ ***********************************************************/
+bool RenderList::Initialize()
+{
+	if (NULL == m_pShaderManager)
+	{
+		return(false);
+	}
+
+	m_useDrawList = m_pShaderManager->GetUniformHandle(g_UseDrawListName);
+	return(m_pShaderManager->BindStorageBlock(g_DrawBlockName, m_bindingPoint));
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used for removing all of the added draws.
+ *  The compiled buffers are kept until the next compile.
+ ***********************************************************/
+void RenderList::Clear()
+{
+	m_commands.clear();
+	m_draws.clear();
+	m_meshIDs.clear();
+	m_usedMeshes.clear();
+}
+
+/***********************************************************
+ *  AddDraw()
+ *
+ *  This method is used for adding a draw of a whole mesh to
+ *  the list.  Every draw gets its own command, so the shader
+ *  finds its values at gl_DrawID in the draw block.
+ ***********************************************************/
+bool RenderList::AddDraw(ShapeMeshes::MESH_ID meshID, const DRAW_DATA& draw)
+{
+	if (NULL == m_pMeshes)
+	{
+		return(false);
+	}
+
+	// the range is only known once the mesh is loaded
+	m_pMeshes->PrefetchMesh(meshID);
+	ShapeMeshes::INDEXED_RANGE range;
+	if (m_pMeshes->GetIndexedRange(meshID, range) == false)
+	{
+		return(false);
+	}
+
+	DRAW_COMMAND command;
+	command.count = range.nIndices;
+	command.instanceCount = 1;
+	command.firstIndex = range.firstIndex;
+	command.baseVertex = range.baseVertex;
+	// instance 0 keeps the per-instance attributes in bounds
+	command.baseInstance = 0;
+
+	m_commands.push_back(command);
+	m_draws.push_back(draw);
+	m_meshIDs.push_back(meshID);
+	AddUsedMesh(meshID);
+	return(true);
+}
+
+/***********************************************************
+ *  AddDrawRange()
+ *
+ *  This method is used for adding a draw of a range of the
+ *  shared index buffer.  The draw is not tied to a mesh, so
+ *  SetDrawLevel() leaves it as it is.
+ ***********************************************************/
+void RenderList::AddDrawRange(
+	ShapeMeshes::MESH_ID meshID,
+	const ShapeMeshes::INDEXED_RANGE& range,
+	const DRAW_DATA& draw)
+{
+	DRAW_COMMAND command;
+	command.count = range.nIndices;
+	command.instanceCount = 1;
+	command.firstIndex = range.firstIndex;
+	command.baseVertex = range.baseVertex;
+	command.baseInstance = 0;
+
+	m_commands.push_back(command);
+	m_draws.push_back(draw);
+	m_meshIDs.push_back(ShapeMeshes::MESH_COUNT);
+	AddUsedMesh(meshID);
+}
+
+/***********************************************************
+ *  AddUsedMesh()
+ *
+ *  This method is used for adding a mesh to the meshes the
+ *  list marks as used when it is submitted.
+ ***********************************************************/
+void RenderList::AddUsedMesh(ShapeMeshes::MESH_ID meshID)
+{
+	for (size_t i = 0; i < m_usedMeshes.size(); i++)
+	{
+		if (m_usedMeshes[i] == meshID)
+		{
+			return;
+		}
+	}
+	m_usedMeshes.push_back(meshID);
+}
+
+/***********************************************************
+ *  Compile()
+ *
+ *  This method is used for writing the added draws into the
+ *  indirect command buffer and the draw block buffer.  The
+ *  list only has to be compiled again after it changes.
+ ***********************************************************/
+void RenderList::Compile()
+{
+	if (m_commandBuffer == 0)
+	{
+		glGenBuffers(1, &m_commandBuffer);
+	}
+	if (m_drawBuffer == 0)
+	{
+		glGenBuffers(1, &m_drawBuffer);
+	}
+
+	m_compiledCount = (GLsizei)m_commands.size();
+	m_bCommandsChanged = false;
+
+	// the commands change when draws switch levels
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_commandBuffer);
+	glBufferData(GL_DRAW_INDIRECT_BUFFER, sizeof(DRAW_COMMAND) * m_commands.size(), m_commands.data(), GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, m_drawBuffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, sizeof(DRAW_DATA) * m_draws.size(), m_draws.data(), GL_STATIC_DRAW);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+}
+
+/***********************************************************
+ *  Submit()
+ *
+ *  This method is used for drawing every compiled draw with
+ *  one glMultiDrawElementsIndirect() call.
+ ***********************************************************/
+void RenderList::Submit()
+{
+	if ((NULL == m_pMeshes) || (m_compiledCount == 0))
+	{
+		return;
+	}
+
+	for (size_t i = 0; i < m_usedMeshes.size(); i++)
+	{
+		m_pMeshes->MarkMeshUsed(m_usedMeshes[i]);
+	}
+
+	m_pMeshes->BindMeshArena();
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_commandBuffer);
+	if (m_bCommandsChanged == true)
+	{
+		glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, sizeof(DRAW_COMMAND) * m_compiledCount, m_commands.data());
+		m_bCommandsChanged = false;
+	}
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, m_bindingPoint, m_drawBuffer);
+
+	if (NULL != m_pShaderManager)
+	{
+		m_pShaderManager->setBoolValue(m_useDrawList, true);
+	}
+
+	glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)0, m_compiledCount, 0);
+
+	if (NULL != m_pShaderManager)
+	{
+		m_pShaderManager->setBoolValue(m_useDrawList, false);
+	}
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+}
+
+/***********************************************************
+ *  SetDrawLevel()
+ *
+ *  This method is used for pointing a compiled draw at the
+ *  indices of another tessellation level of its mesh.  Only
+ *  draws that really change mark the commands for writing.
+ ***********************************************************/
+void RenderList::SetDrawLevel(GLsizei draw, int level)
+{
+	ShapeMeshes::INDEXED_RANGE range;
+	if ((NULL == m_pMeshes) || (draw >= m_compiledCount) ||
+		(m_pMeshes->GetIndexedRange(m_meshIDs[draw], level, range) == false))
+	{
+		return;
+	}
+
+	DRAW_COMMAND& command = m_commands[draw];
+	if ((command.firstIndex != range.firstIndex) || (command.baseVertex != range.baseVertex))
+	{
+		command.count = range.nIndices;
+		command.firstIndex = range.firstIndex;
+		command.baseVertex = range.baseVertex;
+		m_bCommandsChanged = true;
+	}
+}
+
+/***********************************************************
+ *  SetDrawVisible()
+ *
+ *  This method is used for hiding or showing a compiled
+ *  draw.  A hidden draw keeps its command with an instance
+ *  count of 0, so the draw values of the other draws stay
+ *  at their gl_DrawID and only the commands are written.
+ ***********************************************************/
+void RenderList::SetDrawVisible(GLsizei draw, bool bVisible)
+{
+	if (draw >= m_compiledCount)
+	{
+		return;
+	}
+
+	GLuint instanceCount = (bVisible == true) ? 1 : 0;
+	if (m_commands[draw].instanceCount != instanceCount)
+	{
+		m_commands[draw].instanceCount = instanceCount;
+		m_bCommandsChanged = true;
+	}
+}
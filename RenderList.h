@@ -0,0 +1,123 @@
+///////////////////////////////////////////////////////////////////////////////
+// renderlist.h
+// ============
+// compile scene draws into indirect commands submitted with one draw call
+//
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "ShaderManager.h"
+#include "ShapeMeshes.h"
+#include <vector>
+
+/***********************************************************
+ *  RenderList
+ *
+ *  This class collects the draws of a scene and compiles
+ *  them into a buffer of indirect draw commands plus a
+ *  storage buffer with the values of every draw.  The whole
+ *  list is then drawn with a single multi-draw call, so the
+ *  CPU cost of submitting it does not grow with the number
+ *  of objects.
+ ***********************************************************/
+class RenderList
+{
+public:
+    // values of one draw, read by the shader from the draw
+    // block with gl_DrawID:
+    //   struct DrawData { mat4 model; vec4 objectColor; vec2 UVscale; int materialIndex; int textureSlot; };
+    //   layout(std430) buffer DrawBlock { DrawData draws[]; };
+    // a texture slot of -1 draws with the object color, and when
+    // the shader has a texture table the slot is the index of the
+    // texture in the table
+    struct DRAW_DATA
+    {
+        glm::mat4 model;
+        glm::vec4 objectColor;
+        glm::vec2 UVscale;
+        GLint materialIndex;
+        GLint textureSlot;
+    };
+
+    // constructor
+    RenderList(ShaderManager* pShaderManager, ShapeMeshes* pMeshes, GLuint bindingPoint);
+    // destructor
+    ~RenderList();
+
+    // connect to the draw block - returns false when the shader
+    // does not declare it
+    bool Initialize();
+
+    // remove all of the added draws
+    void Clear();
+    // add a draw of a whole mesh, loading the mesh when it is not
+    // resident - returns false when the mesh cannot be drawn from
+    // the shared index buffer
+    bool AddDraw(ShapeMeshes::MESH_ID meshID, const DRAW_DATA& draw);
+    // add a draw of a range of the shared index buffer taken from
+    // a mesh, such as its visible meshlets - the draw keeps its
+    // range when levels are set
+    void AddDrawRange(
+        ShapeMeshes::MESH_ID meshID,
+        const ShapeMeshes::INDEXED_RANGE& range,
+        const DRAW_DATA& draw);
+    // write the added draws into the command and draw buffers
+    void Compile();
+    // draw the compiled list with one call - the meshes of the
+    // list are marked as used, so they are not evicted while the
+    // list is drawn
+    void Submit();
+
+    // switch a compiled draw to another tessellation level of
+    // its mesh - the commands are written again on the next
+    // submit, and a level without indices keeps the draw as is
+    void SetDrawLevel(GLsizei draw, int level);
+    // keep a compiled draw in the list but draw no instances of
+    // it while it is hidden, such as when it is out of the view
+    void SetDrawVisible(GLsizei draw, bool bVisible);
+
+    // number of draws added since the last clear
+    GLsizei GetDrawCount() const { return (GLsizei)m_commands.size(); }
+    // mesh and values of an added draw - draws of an index range
+    // report MESH_COUNT
+    ShapeMeshes::MESH_ID GetDrawMesh(GLsizei draw) const { return m_meshIDs[draw]; }
+    const DRAW_DATA& GetDrawData(GLsizei draw) const { return m_draws[draw]; }
+
+private:
+    // layout of one record in the GL_DRAW_INDIRECT_BUFFER
+    struct DRAW_COMMAND
+    {
+        GLuint count;
+        GLuint instanceCount;
+        GLuint firstIndex;
+        GLint baseVertex;
+        GLuint baseInstance;
+    };
+
+    // pointer to shader manager object
+    ShaderManager* m_pShaderManager;
+    // pointer to the meshes the draws refer to
+    ShapeMeshes* m_pMeshes;
+    // storage buffer binding point of the draw block
+    GLuint m_bindingPoint;
+
+    // indirect command buffer and draw block buffer
+    GLuint m_commandBuffer;
+    GLuint m_drawBuffer;
+    // number of draws written by the last compile
+    GLsizei m_compiledCount;
+    // true when commands changed since they were written
+    bool m_bCommandsChanged;
+
+    // added draws, kept until the next clear
+    std::vector<DRAW_COMMAND> m_commands;
+    std::vector<DRAW_DATA> m_draws;
+    std::vector<ShapeMeshes::MESH_ID> m_meshIDs;
+    // every mesh the added draws take indices from, once
+    std::vector<ShapeMeshes::MESH_ID> m_usedMeshes;
+
+    // remember that a draw takes indices from the mesh
+    void AddUsedMesh(ShapeMeshes::MESH_ID meshID);
+
+    // tells the shader to read the draw block
+    UniformHandle m_useDrawList;
+};
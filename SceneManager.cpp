@@ -16,6 +16,7 @@
 #endif
 
 #include <glm/gtx/transform.hpp>
+#include <algorithm>
 
 // declaration of global variables
 namespace
@@ -23,8 +24,48 @@ namespace
 	const char* g_ModelName = "model";
 	const char* g_ColorValueName = "objectColor";
 	const char* g_TextureValueName = "objectTexture";
+	const char* g_TextureIndexName = "objectTextureIndex";
 	const char* g_UseTextureName = "bUseTexture";
 	const char* g_UseLightingName = "bUseLighting";
+	const char* g_UVScaleName = "UVscale";
+	const char* g_ViewPositionName = "viewPosition";
+	const char* g_MaterialIndexName = "materialIndex";
+	const char* g_UseInstancingName = "bUseInstancing";
+	const char* g_UseDrawListName = "bUseDrawList";
+
+	// storage block holding the table of object materials, after
+	// the draw block and the texture block
+	const char* g_MaterialBlockName = "MaterialBlock";
+	const GLuint g_MaterialBlockBinding = 2;
+	// uniform block holding the scene light sources
+	const GLuint g_LightBlockBinding = 1;
+	// storage block holding the values of every render list draw
+	const char* g_DrawBlockName = "DrawBlock";
+	const GLuint g_DrawBlockBinding = 0;
+	// bytes of draw values the objects drawn one at a time can
+	// stream in one frame
+	const GLsizeiptr g_DrawStreamRegionSize = 256 * 1024;
+	// frames a mesh stays loaded after the scene last drew it
+	const GLuint g_MeshEvictionFrames = 600;
+	// directory of the block compressed textures cooked from the
+	// scene images, next to the executable whatever the working
+	// directory is
+	const char* g_TextureCacheDirectory = "texture_cache";
+	// textures bound to their own slot for shaders without the
+	// texture table
+	const int g_MaxTextureSlots = 16;
+	// slots the texture table samples the textures it has no
+	// array for from - the rest of the 16 units a shader is sure
+	// to have are left for the arrays
+	const int g_MaxTableTextureSlots = 8;
+	// storage block holding the texture table, and the first
+	// texture unit of its texture arrays, after the table slots
+	const GLuint g_TextureBlockBinding = 1;
+	const GLuint g_FirstTextureArrayUnit = 8;
+	// meshes the scene draws, generated before the first frame
+	const ShapeMeshes::MESH_ID g_SceneMeshes[] = {
+		ShapeMeshes::BOX_MESH, ShapeMeshes::SPHERE_MESH, ShapeMeshes::PLANE_MESH
+	};
 }
 
 /***********************************************************
@@ -35,14 +76,36 @@ namespace
 SceneManager::SceneManager(ShaderManager *pShaderManager)
 {
 	m_pShaderManager = pShaderManager;
-	m_basicMeshes = new ShapeMeshes();
-	//added this to make it work
-	for (int i = 0; i < 16; i++)
-	{
-		m_textureIDs[i].tag = "/0";
-		m_textureIDs[i].ID = -1;
-	}
-	m_loadedTextures = 0;
+	// the packed vertices halve the vertex fetch bandwidth
+	m_basicMeshes = new ShapeMeshes(ShapeMeshes::PACKED_VERTEX_FORMAT);
+	m_pLightBuffer = new LightBuffer(pShaderManager, g_LightBlockBinding);
+	m_pRenderList = new RenderList(pShaderManager, m_basicMeshes, g_DrawBlockBinding);
+	m_pLODSelector = new LODSelector(m_basicMeshes);
+	m_pJobSystem = new JobSystem();
+	m_pDrawStream = new StreamBuffer(g_DrawStreamRegionSize);
+	m_pObjectBounds = new WorldBounds();
+	m_pObjectHierarchy = new BoundsHierarchy();
+	m_pFrustumCuller = new FrustumCuller();
+	m_pClusterCuller = new ClusterCuller(m_basicMeshes);
+	m_pClusterList = new RenderList(pShaderManager, m_basicMeshes, g_DrawBlockBinding);
+	m_pTextureCache = new TextureCache((TextureCache::GetExecutableDirectory() + g_TextureCacheDirectory).c_str());
+	m_pTextureLoader = new TextureLoader(m_pJobSystem);
+	m_pTextureLoader->SetTextureCache(m_pTextureCache);
+	m_pTextureTable = new TextureTable(pShaderManager, g_TextureBlockBinding, g_FirstTextureArrayUnit);
+	m_pTagInterner = new TagInterner();
+	m_materialBuffer = 0;
+	m_bUseMaterialBlock = false;
+	m_bUseRenderList = false;
+	m_bRecordRenderList = false;
+	m_bRenderListEnabled = true;
+	m_bClusterCulling = true;
+	m_bStreamDraws = false;
+	m_drawDataAlignment = 1;
+	m_modelMatrix = glm::mat4(1.0f);
+
+	ResolveShaderUniforms();
+	ResolveSceneTags();
+	m_bUseTextureTable = m_pTextureTable->Initialize();
 }
 
 /***********************************************************
@@ -53,98 +116,162 @@ SceneManager::SceneManager(ShaderManager *pShaderManager)
 SceneManager::~SceneManager()
 {
 	m_pShaderManager = NULL;
+	if (m_materialBuffer != 0)
+	{
+		glDeleteBuffers(1, &m_materialBuffer);
+		m_materialBuffer = 0;
+	}
+	delete m_pRenderList;
+	m_pRenderList = NULL;
+	delete m_pClusterList;
+	m_pClusterList = NULL;
+	delete m_pClusterCuller;
+	m_pClusterCuller = NULL;
+	delete m_pLODSelector;
+	m_pLODSelector = NULL;
 	delete m_basicMeshes;
 	m_basicMeshes = NULL;
+	delete m_pLightBuffer;
+	m_pLightBuffer = NULL;
+	// the loader waits for its decodes, which run on the workers
+	delete m_pTextureLoader;
+	m_pTextureLoader = NULL;
+	delete m_pTextureCache;
+	m_pTextureCache = NULL;
+	delete m_pTextureTable;
+	m_pTextureTable = NULL;
+	delete m_pJobSystem;
+	m_pJobSystem = NULL;
+	delete m_pDrawStream;
+	m_pDrawStream = NULL;
+	delete m_pObjectBounds;
+	m_pObjectBounds = NULL;
+	delete m_pFrustumCuller;
+	m_pFrustumCuller = NULL;
+	delete m_pObjectHierarchy;
+	m_pObjectHierarchy = NULL;
+	delete m_pTagInterner;
+	m_pTagInterner = NULL;
 }
 
 /***********************************************************
- *  CreateGLTexture()
+ *  ResolveShaderUniforms()
  *
- *  This method is used for loading textures from image files,
- *  configuring the texture mapping parameters in OpenGL,
- *  generating the mipmaps, and loading the read texture into
- *  the next available texture slot in memory.
+ *  This method is used for resolving the uniform handles
+ *  that are set for every drawn object, so the render loop
+ *  does not have to look up uniforms by name.
  ***********************************************************/
-bool SceneManager::CreateGLTexture(const char* filename, std::string tag)
+void SceneManager::ResolveShaderUniforms()
 {
-	int width = 0;
-	int height = 0;
-	int colorChannels = 0;
-	GLuint textureID = 0;
-
-	// indicate to always flip images vertically when loaded
-	stbi_set_flip_vertically_on_load(true);
-
-	// try to parse the image data from the specified image file
-	unsigned char* image = stbi_load(
-		filename,
-		&width,
-		&height,
-		&colorChannels,
-		0);
-
-	// if the image was successfully read from the image file
-	if (image)
-	{
-		std::cout << "Successfully loaded image:" << filename << ", width:" << width << ", height:" << height << ", channels:" << colorChannels << std::endl;
-
-		glGenTextures(1, &textureID);
-		glBindTexture(GL_TEXTURE_2D, textureID);
-
-		// set the texture wrapping parameters
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-		// set texture filtering parameters
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-		// if the loaded image is in RGB format
-		if (colorChannels == 3)
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, image);
-		// if the loaded image is in RGBA format - it supports transparency
-		else if (colorChannels == 4)
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image);
-		else
-		{
-			std::cout << "Not implemented to handle image with " << colorChannels << " channels" << std::endl;
-			return false;
-		}
-
-		// generate the texture mipmaps for mapping textures to lower resolutions
-		glGenerateMipmap(GL_TEXTURE_2D);
+	if (NULL == m_pShaderManager)
+	{
+		return;
+	}
 
-		// free the image data from local memory
-		stbi_image_free(image);
-		glBindTexture(GL_TEXTURE_2D, 0); // Unbind the texture
+	m_uniforms.model = m_pShaderManager->GetUniformHandle(g_ModelName);
+	m_uniforms.objectColor = m_pShaderManager->GetUniformHandle(g_ColorValueName);
+	m_uniforms.objectTexture = m_pShaderManager->GetUniformHandle(g_TextureValueName);
+	m_uniforms.objectTextureIndex = m_pShaderManager->GetUniformHandle(g_TextureIndexName);
+	m_uniforms.useTexture = m_pShaderManager->GetUniformHandle(g_UseTextureName);
+	m_uniforms.UVscale = m_pShaderManager->GetUniformHandle(g_UVScaleName);
+	m_uniforms.viewPosition = m_pShaderManager->GetUniformHandle(g_ViewPositionName);
+	m_uniforms.materialAmbientColor = m_pShaderManager->GetUniformHandle("material.ambientColor");
+	m_uniforms.materialAmbientStrength = m_pShaderManager->GetUniformHandle("material.ambientStrength");
+	m_uniforms.materialDiffuseColor = m_pShaderManager->GetUniformHandle("material.diffuseColor");
+	m_uniforms.materialSpecularColor = m_pShaderManager->GetUniformHandle("material.specularColor");
+	m_uniforms.materialShininess = m_pShaderManager->GetUniformHandle("material.shininess");
+	m_uniforms.materialIndex = m_pShaderManager->GetUniformHandle(g_MaterialIndexName);
+	m_uniforms.useInstancing = m_pShaderManager->GetUniformHandle(g_UseInstancingName);
+	m_uniforms.useDrawList = m_pShaderManager->GetUniformHandle(g_UseDrawListName);
+}
 
-		// register the loaded texture and associate it with the special tag string
-		m_textureIDs[m_loadedTextures].ID = textureID;
-		m_textureIDs[m_loadedTextures].tag = tag;
-		m_loadedTextures++;
+/***********************************************************
+ *  ResolveSceneTags()
+ *
+ *  This method is used for interning the texture and material
+ *  tags drawn by the scene once, so the render loop selects
+ *  them by ID without hashing or comparing strings.  The tags
+ *  get their IDs before the textures and materials are
+ *  defined, which map the same IDs to their slots and indices.
+ ***********************************************************/
+void SceneManager::ResolveSceneTags()
+{
+	m_sceneTags.woodTexture = m_pTagInterner->Intern("wood_texture");
+	m_sceneTags.waterTexture = m_pTagInterner->Intern("water_texture");
+	m_sceneTags.lipTexture = m_pTagInterner->Intern("lip_texture");
+	m_sceneTags.carpetTexture = m_pTagInterner->Intern("carpet_texture");
+	m_sceneTags.handleTexture = m_pTagInterner->Intern("handle_texture");
+	m_sceneTags.glassMaterial = m_pTagInterner->Intern("glass");
+	m_sceneTags.woodMaterial = m_pTagInterner->Intern("wood");
+	m_sceneTags.metalMaterial = m_pTagInterner->Intern("metal");
+	m_sceneTags.carpetMaterial = m_pTagInterner->Intern("carpet");
+}
 
-		return true;
+/***********************************************************
+ *  CreateGLTexture()
+ *
+ *  This method is used for creating a texture in the next
+ *  available texture slot and loading its image file.  The
+ *  image is read on the worker threads while the texture
+ *  shows a placeholder - mapped as compressed mip levels from
+ *  the texture cache, or decoded and cooked into the cache
+ *  the first time - and the texture loader swaps the image
+ *  in on a later frame, keeping the same texture so the slot
+ *  never has to be bound again.
+ ***********************************************************/
+bool SceneManager::CreateGLTexture(const char* filename, std::string tag)
+{
+	GLuint textureID = m_pTextureLoader->RequestTexture(filename);
+
+	// register the texture and associate it with the special tag string
+	TEXTURE_INFO textureInfo;
+	textureInfo.ID = textureID;
+	textureInfo.tag = tag;
+	textureInfo.tableIndex = -1;
+	if (m_bUseTextureTable == true)
+	{
+		// the textures bound to a slot can be sampled from it
+		// when the table has no array left for them
+		GLint textureSlot = ((int)m_textureIDs.size() < g_MaxTableTextureSlots) ? (GLint)m_textureIDs.size() : -1;
+		textureInfo.tableIndex = m_pTextureTable->AddTexture(textureID, textureSlot);
 	}
+	m_textureIDs.push_back(textureInfo);
 
-	std::cout << "Could not load image:" << filename << std::endl;
+	// the first texture loaded with a tag keeps it
+	TagInterner::TAG_ID tagID = m_pTagInterner->Intern(tag);
+	if (GetTextureSlot(tagID) < 0)
+	{
+		SetTagValue(m_textureSlotsByTag, tagID, (int)m_textureIDs.size() - 1);
+	}
 
-	// Error loading the image
-	return false;
+	return true;
 }
 
 /***********************************************************
  *  BindGLTextures()
  *
  *  This method is used for binding the loaded textures to
- *  OpenGL texture memory slots.  There are up to 16 slots.
+ *  OpenGL texture memory slots.  There are up to 16 slots,
+ *  used by shaders without the texture table, and with it the
+ *  first 8 are used by the textures the table has no array
+ *  left for.
  ***********************************************************/
 void SceneManager::BindGLTextures()
 {
-	for (int i = 0; i < m_loadedTextures; i++)
+	// the units after the table slots hold the texture arrays
+	int maxSlots = (m_bUseTextureTable == true) ? g_MaxTableTextureSlots : g_MaxTextureSlots;
+	int slotCount = std::min((int)m_textureIDs.size(), maxSlots);
+	for (int i = 0; i < slotCount; i++)
 	{
 		// bind textures on corresponding texture units
 		glActiveTexture(GL_TEXTURE0 + i);
 		glBindTexture(GL_TEXTURE_2D, m_textureIDs[i].ID);
 	}
+
+	if (m_bUseTextureTable == true)
+	{
+		SetDrawTextureSamplers();
+	}
 }
 
 /***********************************************************
@@ -155,36 +282,47 @@ void SceneManager::BindGLTextures()
  ***********************************************************/
 void SceneManager::DestroyGLTextures()
 {
-	for (int i = 0; i < m_loadedTextures; i++)
+	for (int i = 0; i < (int)m_textureIDs.size(); i++)
 	{
 		glGenTextures(1, &m_textureIDs[i].ID);
 	}
 }
 
 /***********************************************************
- *  FindTextureID()
+ *  ReleaseTableTexture()
  *
- *  This method is used for getting an ID for the previously
- *  loaded texture bitmap associated with the passed in tag.
+ *  This method is used for deleting a texture whose image
+ *  was copied into a layer of the texture table, as it is
+ *  only sampled from the layer.  Its slot is left without a
+ *  texture.
  ***********************************************************/
-int SceneManager::FindTextureID(std::string tag)
+void SceneManager::ReleaseTableTexture(GLuint textureID)
 {
-	int textureID = -1;
-	int index = 0;
-	bool bFound = false;
-
-	while ((index < m_loadedTextures) && (bFound == false))
+	for (size_t i = 0; i < m_textureIDs.size(); i++)
 	{
-		if (m_textureIDs[index].tag.compare(tag) == 0)
+		if (m_textureIDs[i].ID == textureID)
 		{
-			textureID = m_textureIDs[index].ID;
-			bFound = true;
+			glDeleteTextures(1, &m_textureIDs[i].ID);
+			m_textureIDs[i].ID = 0;
+			return;
 		}
-		else
-			index++;
 	}
+}
 
-	return(textureID);
+/***********************************************************
+ *  FindTextureID()
+ *
+ *  This method is used for getting an ID for the previously
+ *  loaded texture bitmap associated with the passed in tag.
+ ***********************************************************/
+int SceneManager::FindTextureID(const std::string& tag)
+{
+	int textureSlot = FindTextureSlot(tag);
+	if (textureSlot < 0)
+	{
+		return(-1);
+	}
+	return(m_textureIDs[textureSlot].ID);
 }
 
 /***********************************************************
@@ -193,24 +331,42 @@ int SceneManager::FindTextureID(std::string tag)
  *  This method is used for getting a slot index for the previously
  *  loaded texture bitmap associated with the passed in tag.
  ***********************************************************/
-int SceneManager::FindTextureSlot(std::string tag)
+int SceneManager::FindTextureSlot(const std::string& tag)
 {
-	int textureSlot = -1;
-	int index = 0;
-	bool bFound = false;
+	return(GetTextureSlot(m_pTagInterner->Find(tag)));
+}
 
-	while ((index < m_loadedTextures) && (bFound == false))
+/***********************************************************
+ *  GetTextureSlot()
+ *
+ *  This method is used for getting the slot index of the
+ *  texture loaded with an interned tag, or -1.
+ ***********************************************************/
+int SceneManager::GetTextureSlot(TagInterner::TAG_ID tagID) const
+{
+	if (tagID >= m_textureSlotsByTag.size())
 	{
-		if (m_textureIDs[index].tag.compare(tag) == 0)
-		{
-			textureSlot = index;
-			bFound = true;
-		}
-		else
-			index++;
+		return(-1);
 	}
+	return(m_textureSlotsByTag[tagID]);
+}
 
-	return(textureSlot);
+/***********************************************************
+ *  GetDrawTexture()
+ *
+ *  This method is used for getting the value a draw selects
+ *  the texture of an interned tag with - the index of its
+ *  texture table entry, or its slot when the shader has no
+ *  texture table.
+ ***********************************************************/
+int SceneManager::GetDrawTexture(TagInterner::TAG_ID tagID) const
+{
+	int textureSlot = GetTextureSlot(tagID);
+	if ((m_bUseTextureTable == false) || (textureSlot < 0))
+	{
+		return(textureSlot);
+	}
+	return(m_textureIDs[textureSlot].tableIndex);
 }
 
 /***********************************************************
@@ -219,33 +375,133 @@ int SceneManager::FindTextureSlot(std::string tag)
  *  This method is used for getting a material from the previously
  *  defined materials list that is associated with the passed in tag.
  ***********************************************************/
-bool SceneManager::FindMaterial(std::string tag, OBJECT_MATERIAL& material)
+bool SceneManager::FindMaterial(const std::string& tag, OBJECT_MATERIAL& material)
 {
-	if (m_objectMaterials.size() == 0)
+	int index = FindMaterialIndex(tag);
+	if (index < 0)
 	{
 		return(false);
 	}
 
-	int index = 0;
-	bool bFound = false;
-	while ((index < m_objectMaterials.size()) && (bFound == false))
+	material.ambientColor = m_objectMaterials[index].ambientColor;
+	material.ambientStrength = m_objectMaterials[index].ambientStrength;
+	material.diffuseColor = m_objectMaterials[index].diffuseColor;
+	material.specularColor = m_objectMaterials[index].specularColor;
+	material.shininess = m_objectMaterials[index].shininess;
+
+	return(true);
+}
+
+/***********************************************************
+ *  FindMaterialIndex()
+ *
+ *  This method is used for getting the index of a material in
+ *  the previously defined materials list that is associated
+ *  with the passed in tag.
+ ***********************************************************/
+int SceneManager::FindMaterialIndex(const std::string& tag)
+{
+	return(GetMaterialIndex(m_pTagInterner->Find(tag)));
+}
+
+/***********************************************************
+ *  GetMaterialIndex()
+ *
+ *  This method is used for getting the index of the material
+ *  defined with an interned tag, or -1.
+ ***********************************************************/
+int SceneManager::GetMaterialIndex(TagInterner::TAG_ID tagID) const
+{
+	if (tagID >= m_materialIndicesByTag.size())
 	{
-		if (m_objectMaterials[index].tag.compare(tag) == 0)
-		{
-			bFound = true;
-			material.ambientColor = m_objectMaterials[index].ambientColor;
-			material.ambientStrength = m_objectMaterials[index].ambientStrength;
-			material.diffuseColor = m_objectMaterials[index].diffuseColor;
-			material.specularColor = m_objectMaterials[index].specularColor;
-			material.shininess = m_objectMaterials[index].shininess;
-		}
-		else
+		return(-1);
+	}
+	return(m_materialIndicesByTag[tagID]);
+}
+
+/***********************************************************
+ *  SetTagValue()
+ *
+ *  This method is used for storing the value of a tag ID in a
+ *  table indexed by tag, growing the table with -1 for the
+ *  tags that have no value.
+ ***********************************************************/
+void SceneManager::SetTagValue(std::vector<int>& values, TagInterner::TAG_ID tagID, int value)
+{
+	if (tagID >= values.size())
+	{
+		values.resize(tagID + 1, -1);
+	}
+	values[tagID] = value;
+}
+
+/***********************************************************
+ *  UploadObjectMaterials()
+ *
+ *  This method is used for packing all the defined materials
+ *  into a std430 storage buffer once, so that each draw only
+ *  selects its material by index.  The shader code declares:
+ *
+ *    struct Material { vec4 ambient; vec4 diffuse; vec4 specular; };
+ *    layout(std430) buffer MaterialBlock { Material materials[]; };
+ *    uniform int materialIndex;
+ *
+ *  where ambient.a holds the ambient strength and specular.a
+ *  holds the shininess.  The array is sized by the buffer, so
+ *  the table holds any number of materials.  Shaders without
+ *  the block keep using the individual material uniforms.
+ ***********************************************************/
+void SceneManager::UploadObjectMaterials()
+{
+	// std430 layout of one entry of the materials array
+	struct MATERIAL_BLOCK_ENTRY
+	{
+		glm::vec4 ambient;
+		glm::vec4 diffuse;
+		glm::vec4 specular;
+	};
+
+	// the material indices are final once the materials are
+	// packed, so the tags are mapped to them here - the first
+	// material defined with a tag keeps it
+	m_materialIndicesByTag.clear();
+	for (int index = 0; index < (int)m_objectMaterials.size(); index++)
+	{
+		TagInterner::TAG_ID tagID = m_pTagInterner->Intern(m_objectMaterials[index].tag);
+		if (GetMaterialIndex(tagID) < 0)
 		{
-			index++;
+			SetTagValue(m_materialIndicesByTag, tagID, index);
 		}
 	}
 
-	return(true);
+	m_bUseMaterialBlock = false;
+	if ((NULL == m_pShaderManager) || (m_objectMaterials.size() == 0))
+	{
+		return;
+	}
+
+	if (m_pShaderManager->BindStorageBlock(g_MaterialBlockName, g_MaterialBlockBinding) == false)
+	{
+		return;
+	}
+
+	std::vector<MATERIAL_BLOCK_ENTRY> entries(m_objectMaterials.size());
+	for (size_t i = 0; i < m_objectMaterials.size(); i++)
+	{
+		const OBJECT_MATERIAL& material = m_objectMaterials[i];
+		entries[i].ambient = glm::vec4(material.ambientColor, material.ambientStrength);
+		entries[i].diffuse = glm::vec4(material.diffuseColor, 0.0f);
+		entries[i].specular = glm::vec4(material.specularColor, material.shininess);
+	}
+
+	if (m_materialBuffer == 0)
+	{
+		glCreateBuffers(1, &m_materialBuffer);
+	}
+	glNamedBufferData(m_materialBuffer, sizeof(MATERIAL_BLOCK_ENTRY) * entries.size(), entries.data(), GL_STATIC_DRAW);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, g_MaterialBlockBinding, m_materialBuffer);
+
+	m_bUseMaterialBlock = true;
 }
 
 /***********************************************************
@@ -279,11 +535,8 @@ void SceneManager::SetTransformations(
 	translation = glm::translate(positionXYZ);
 
 	modelView = translation * rotationX * rotationY * rotationZ * scale;
-
-	if (NULL != m_pShaderManager)
-	{
-		m_pShaderManager->setMat4Value(g_ModelName, modelView);
-	}
+	m_modelMatrix = modelView;
+	m_recordedDraw.model = modelView;
 }
 
 /***********************************************************
@@ -306,30 +559,32 @@ void SceneManager::SetShaderColor(
 	currentColor.b = blueColorValue;
 	currentColor.a = alphaValue;
 
-	if (NULL != m_pShaderManager)
-	{
-		m_pShaderManager->setIntValue(g_UseTextureName, false);
-		m_pShaderManager->setVec4Value(g_ColorValueName, currentColor);
-	}
+	m_recordedDraw.objectColor = currentColor;
+	m_recordedDraw.textureSlot = -1;
 }
 
 /***********************************************************
  *  SetShaderTexture()
  *
  *  This method is used for setting the texture data
- *  associated with the passed in ID into the shader.
+ *  associated with the passed in tag into the shader.
  ***********************************************************/
 void SceneManager::SetShaderTexture(
-	std::string textureTag)
+	const std::string& textureTag)
 {
-	if (NULL != m_pShaderManager)
-	{
-		m_pShaderManager->setIntValue(g_UseTextureName, true);
+	SetShaderTexture(m_pTagInterner->Find(textureTag));
+}
 
-		int textureID = -1;
-		textureID = FindTextureSlot(textureTag);
-		m_pShaderManager->setSampler2DValue(g_TextureValueName, textureID);
-	}
+/***********************************************************
+ *  SetShaderTexture()
+ *
+ *  This method is used for setting the texture data
+ *  associated with the passed in tag ID into the shader.
+ ***********************************************************/
+void SceneManager::SetShaderTexture(
+	TagInterner::TAG_ID textureTag)
+{
+	m_recordedDraw.textureSlot = GetDrawTexture(textureTag);
 }
 
 /***********************************************************
@@ -339,10 +594,24 @@ void SceneManager::SetShaderTexture(
  *  values into the shader.
  ***********************************************************/
 void SceneManager::SetTextureUVScale(float u, float v)
+{
+	m_recordedDraw.UVscale = glm::vec2(u, v);
+}
+
+/***********************************************************
+ *  SetShaderInstancing()
+ *
+ *  This method is used for telling the shader whether the
+ *  next draws are instanced.  Instanced draws take the model
+ *  matrix, UV scale and material index of every instance from
+ *  the instance data instead of the uniforms.
+ ***********************************************************/
+void SceneManager::SetShaderInstancing(
+	bool bUseInstancing)
 {
 	if (NULL != m_pShaderManager)
 	{
-		m_pShaderManager->setVec2Value("UVscale", glm::vec2(u, v));
+		m_pShaderManager->setBoolValue(m_uniforms.useInstancing, bUseInstancing);
 	}
 }
 
@@ -353,23 +622,340 @@ void SceneManager::SetTextureUVScale(float u, float v)
  *  into the shader.
  ***********************************************************/
 void SceneManager::SetShaderMaterial(
-	std::string materialTag)
+	const std::string& materialTag)
 {
-	if (m_objectMaterials.size() > 0)
+	SetShaderMaterial(FindMaterialIndex(materialTag));
+}
+
+/***********************************************************
+ *  SetShaderMaterial()
+ *
+ *  This method is used for passing the material values of an
+ *  interned tag into the shader.
+ ***********************************************************/
+void SceneManager::SetShaderMaterial(
+	TagInterner::TAG_ID materialTag)
+{
+	SetShaderMaterial(GetMaterialIndex(materialTag));
+}
+
+/***********************************************************
+ *  SetShaderMaterial()
+ *
+ *  This method is used for selecting a defined material by
+ *  its index for the next draw.
+ ***********************************************************/
+void SceneManager::SetShaderMaterial(
+	int materialIndex)
+{
+	if ((materialIndex < 0) || (materialIndex >= (int)m_objectMaterials.size()))
+	{
+		return;
+	}
+
+	m_recordedDraw.materialIndex = materialIndex;
+}
+
+/***********************************************************
+ *  BuildRenderList()
+ *
+ *  This method is used for recording the draws of the scene
+ *  into the render list.  The scene description in
+ *  RenderScene() is run once with the setters collecting the
+ *  draw values, and the recorded list replaces the per-object
+ *  drawing when every object could be recorded.
+ ***********************************************************/
+void SceneManager::BuildRenderList()
+{
+	m_bUseRenderList = false;
+
+	// the draw values select materials by index, which needs
+	// the material block
+	if ((m_bUseMaterialBlock == false) || (m_pRenderList->Initialize() == false))
+	{
+		return;
+	}
+
+	SetDrawTextureSamplers();
+	ResetRecordedDraw();
+
+	m_pRenderList->Clear();
+	m_pObjectBounds->Clear();
+	m_bUseRenderList = true;
+	m_bRecordRenderList = true;
+	RenderScene();
+	m_bRecordRenderList = false;
+
+	if (m_bUseRenderList == true)
+	{
+		m_pRenderList->Compile();
+	}
+	// the meshlet list shares the draw block of the render list
+	m_pClusterList->Initialize();
+	m_pObjectHierarchy->Build(*m_pObjectBounds);
+}
+
+/***********************************************************
+ *  InitializeDrawStream()
+ *
+ *  This method is used for letting the objects drawn one at
+ *  a time take their values from the draw block as well.
+ *  The values of each draw are written into the stream
+ *  buffer and the draw block is bound to them, so a draw
+ *  costs one bound range instead of a call per uniform.
+ ***********************************************************/
+void SceneManager::InitializeDrawStream()
+{
+	m_bStreamDraws = false;
+
+	// the draw values select materials by index, which needs
+	// the material block
+	if ((m_bUseMaterialBlock == false) ||
+		(m_pShaderManager->BindStorageBlock(g_DrawBlockName, g_DrawBlockBinding) == false) ||
+		(m_pDrawStream->Initialize() == false))
+	{
+		return;
+	}
+
+	GLint alignment = 1;
+	glGetIntegerv(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT, &alignment);
+	m_drawDataAlignment = (alignment > 1) ? alignment : 1;
+
+	SetDrawTextureSamplers();
+	m_bStreamDraws = true;
+}
+
+/***********************************************************
+ *  SetDrawTextureSamplers()
+ *
+ *  This method is used for pointing the objectTextures[]
+ *  array the shader samples the texture of a draw from at
+ *  the bound texture slots, one element per slot.  With the
+ *  texture table the draws select their texture by index,
+ *  and the table entries of textures that did not fit in a
+ *  texture array sample them through the first 8 samplers.
+ ***********************************************************/
+void SceneManager::SetDrawTextureSamplers()
+{
+	int maxSlots = (m_bUseTextureTable == true) ? g_MaxTableTextureSlots : g_MaxTextureSlots;
+	int slotCount = std::min((int)m_textureIDs.size(), maxSlots);
+	for (int slot = 0; slot < slotCount; slot++)
 	{
-		OBJECT_MATERIAL material;
-		bool bReturn = false;
+		m_pShaderManager->setSampler2DValue("objectTextures[" + std::to_string(slot) + "]", slot);
+	}
+}
+
+/***********************************************************
+ *  ResetRecordedDraw()
+ *
+ *  This method is used for setting the collected draw values
+ *  back to a white, untextured object at the origin.
+ ***********************************************************/
+void SceneManager::ResetRecordedDraw()
+{
+	m_recordedDraw.model = glm::mat4(1.0f);
+	m_recordedDraw.objectColor = glm::vec4(1.0f, 1.0f, 1.0f, 1.0f);
+	m_recordedDraw.UVscale = glm::vec2(1.0f, 1.0f);
+	m_recordedDraw.materialIndex = 0;
+	m_recordedDraw.textureSlot = -1;
+}
 
-		bReturn = FindMaterial(materialTag, material);
-		if (bReturn == true)
+/***********************************************************
+ *  SetDrawUniforms()
+ *
+ *  This method is used for passing collected draw values
+ *  into the per-object uniforms, for a draw that is not
+ *  streamed or did not fit in the draw stream.  With the
+ *  material block the material is a single index, otherwise
+ *  its values are passed into the shader.
+ ***********************************************************/
+void SceneManager::SetDrawUniforms(const RenderList::DRAW_DATA& draw)
+{
+	m_pShaderManager->setMat4Value(m_uniforms.model, draw.model);
+	if (draw.textureSlot < 0)
+	{
+		m_pShaderManager->setIntValue(m_uniforms.useTexture, false);
+		m_pShaderManager->setVec4Value(m_uniforms.objectColor, draw.objectColor);
+	}
+	else if (m_bUseTextureTable == true)
+	{
+		m_pShaderManager->setIntValue(m_uniforms.useTexture, true);
+		m_pShaderManager->setIntValue(m_uniforms.objectTextureIndex, draw.textureSlot);
+	}
+	else
+	{
+		m_pShaderManager->setIntValue(m_uniforms.useTexture, true);
+		m_pShaderManager->setSampler2DValue(m_uniforms.objectTexture, draw.textureSlot);
+	}
+	m_pShaderManager->setVec2Value(m_uniforms.UVscale, draw.UVscale);
+	if ((m_bUseMaterialBlock == true) || (draw.materialIndex >= (int)m_objectMaterials.size()))
+	{
+		m_pShaderManager->setIntValue(m_uniforms.materialIndex, draw.materialIndex);
+		return;
+	}
+
+	const OBJECT_MATERIAL& material = m_objectMaterials[draw.materialIndex];
+	m_pShaderManager->setVec3Value(m_uniforms.materialAmbientColor, material.ambientColor);
+	m_pShaderManager->setFloatValue(m_uniforms.materialAmbientStrength, material.ambientStrength);
+	m_pShaderManager->setVec3Value(m_uniforms.materialDiffuseColor, material.diffuseColor);
+	m_pShaderManager->setVec3Value(m_uniforms.materialSpecularColor, material.specularColor);
+	m_pShaderManager->setFloatValue(m_uniforms.materialShininess, material.shininess);
+}
+
+/***********************************************************
+ *  DrawShapeMesh()
+ *
+ *  This method is used for drawing a shape mesh with the
+ *  values collected by the setters.  While the render list
+ *  is recorded the draw is added to the list instead.  The
+ *  object is tested against the view before any of its
+ *  values reach the GPU - they are written into the draw
+ *  stream while draws are streamed, and passed into the
+ *  per-object uniforms otherwise.
+ ***********************************************************/
+void SceneManager::DrawShapeMesh(
+	ShapeMeshes::MESH_ID meshID)
+{
+	// the world bounds of every drawn object are kept, in the
+	// order of the draws
+	ShapeMeshes::MESH_BOUNDS meshBounds;
+	bool bHasBounds = false;
+	GLuint object = 0;
+	m_basicMeshes->PrefetchMesh(meshID);
+	if (m_basicMeshes->GetMeshBounds(meshID, meshBounds) == true)
+	{
+		object = m_pObjectBounds->Add(meshBounds, m_modelMatrix);
+		bHasBounds = true;
+	}
+
+	if (m_bRecordRenderList == true)
+	{
+		// meshes without indices are drawn one at a time
+		if (m_pRenderList->AddDraw(meshID, m_recordedDraw) == false)
 		{
-			m_pShaderManager->setVec3Value("material.ambientColor", material.ambientColor);
-			m_pShaderManager->setFloatValue("material.ambientStrength", material.ambientStrength);
-			m_pShaderManager->setVec3Value("material.diffuseColor", material.diffuseColor);
-			m_pShaderManager->setVec3Value("material.specularColor", material.specularColor);
-			m_pShaderManager->setFloatValue("material.shininess", material.shininess);
+			m_bUseRenderList = false;
 		}
+		return;
+	}
+
+	// the curved meshes are drawn at the level matching their
+	// size on the screen - every draw chooses its level, even
+	// outside the view, since the selector matches the levels
+	// of the last frame by draw order
+	bool bVisible = (bHasBounds == false) || (m_pFrustumCuller->IsObjectVisible(*m_pObjectBounds, object) == true);
+	int level = m_pLODSelector->SelectLevel(meshID, m_modelMatrix, bVisible);
+
+	// objects outside the view issue no GL call at all
+	if (bVisible == false)
+	{
+		return;
+	}
+
+	if (m_bStreamDraws == false)
+	{
+		SetDrawUniforms(m_recordedDraw);
+		m_basicMeshes->DrawMeshLevel(meshID, level);
+		return;
+	}
+
+	// a single draw reads draws[0] of the bound range, since
+	// gl_DrawID is 0
+	bool bStreamed = false;
+	GLintptr offset = m_pDrawStream->Write(&m_recordedDraw, sizeof(RenderList::DRAW_DATA), m_drawDataAlignment);
+	if (offset >= 0)
+	{
+		m_pDrawStream->BindRange(GL_SHADER_STORAGE_BUFFER, g_DrawBlockBinding, offset, sizeof(RenderList::DRAW_DATA));
+		bStreamed = true;
+	}
+	else
+	{
+		m_pShaderManager->setBoolValue(m_uniforms.useDrawList, false);
+		SetDrawUniforms(m_recordedDraw);
+	}
+
+	m_basicMeshes->DrawMeshLevel(meshID, level);
+
+	if (bStreamed == false)
+	{
+		m_pShaderManager->setBoolValue(m_uniforms.useDrawList, true);
+	}
+}
+
+/***********************************************************
+ *  SetViewTransform()
+ *
+ *  This method is used for passing the camera of the next
+ *  frame to the level selection.
+ ***********************************************************/
+void SceneManager::SetViewTransform(
+	const glm::mat4& view,
+	const glm::mat4& projection,
+	int viewportHeight)
+{
+	m_pLODSelector->SetViewTransform(view, projection, viewportHeight);
+	m_pFrustumCuller->SetViewTransform(view, projection);
+	m_pClusterCuller->SetViewTransform(view, projection);
+}
+
+/***********************************************************
+ *  PickObject()
+ *
+ *  This method is used for finding the object under a ray,
+ *  such as the one through the mouse position.  The objects
+ *  are tested by their world boxes.
+ ***********************************************************/
+int SceneManager::PickObject(const glm::vec3& origin, const glm::vec3& direction, float maxDistance) const
+{
+	GLuint object = 0;
+	float distance = 0.0f;
+	if ((m_pObjectHierarchy->GetObjectCount() != m_pObjectBounds->GetCount()) ||
+		(m_pObjectHierarchy->Raycast(*m_pObjectBounds, origin, direction, maxDistance, object, distance) == false))
+	{
+		return(-1);
+	}
+	return((int)object);
+}
+
+/***********************************************************
+ *  FindObjectsNear()
+ *
+ *  This method is used for finding the objects whose world
+ *  boxes reach within the distance of a point.
+ ***********************************************************/
+void SceneManager::FindObjectsNear(const glm::vec3& point, float distance, std::vector<GLuint>& objects) const
+{
+	if (m_pObjectHierarchy->GetObjectCount() != m_pObjectBounds->GetCount())
+	{
+		return;
 	}
+	m_pObjectHierarchy->FindWithinDistance(*m_pObjectBounds, point, distance, objects);
+}
+
+/***********************************************************
+ *  EnableRenderList()
+ *
+ *  This method is used for choosing between submitting the
+ *  recorded render list and drawing the scene description
+ *  object by object.  Scenes whose objects change every
+ *  frame are drawn object by object, with their values
+ *  streamed when the shader reads the draw block.
+ ***********************************************************/
+void SceneManager::EnableRenderList(bool bEnable)
+{
+	m_bRenderListEnabled = bEnable;
+}
+
+/***********************************************************
+ *  EnableClusterCulling()
+ *
+ *  This method is used for choosing between drawing only
+ *  the visible meshlets of the dense meshes and drawing the
+ *  whole meshes.  Only the draws of the render list are
+ *  split into meshlets.
+ ***********************************************************/
+void SceneManager::EnableClusterCulling(bool bEnable)
+{
+	m_bClusterCulling = bEnable;
 }
 
 /**************************************************************/
@@ -447,34 +1033,42 @@ void SceneManager::DefineObjectMaterials()
 
 void SceneManager::SetupSceneLights()
 {
-	
-		// Main overhead light - much brighter
-		m_pShaderManager->setVec3Value("lightSources[0].position", glm::vec3(0.0f, 5.0f, 2.0f));
-		m_pShaderManager->setVec3Value("lightSources[0].ambientColor", glm::vec3(1.0f, 1.0f, 1.0f));
-		m_pShaderManager->setVec3Value("lightSources[0].diffuseColor", glm::vec3(1.0f, 1.0f, 1.0f));
-		m_pShaderManager->setVec3Value("lightSources[0].specularColor", glm::vec3(1.0f, 1.0f, 1.0f));
-		m_pShaderManager->setFloatValue("lightSources[0].focalStrength", 16.0f);
-		m_pShaderManager->setFloatValue("lightSources[0].specularIntensity", 3.0f);
-
-		// Front light - adding strong frontal illumination
-		m_pShaderManager->setVec3Value("lightSources[1].position", glm::vec3(0.0f, 2.0f, 5.0f));
-		m_pShaderManager->setVec3Value("lightSources[1].ambientColor", glm::vec3(0.5f, 0.5f, 0.5f));
-		m_pShaderManager->setVec3Value("lightSources[1].diffuseColor", glm::vec3(1.0f, 1.0f, 1.0f));
-		m_pShaderManager->setVec3Value("lightSources[1].specularColor", glm::vec3(1.0f, 1.0f, 1.0f));
-		m_pShaderManager->setFloatValue("lightSources[1].focalStrength", 16.0f);
-		m_pShaderManager->setFloatValue("lightSources[1].specularIntensity", 2.0f);
-
-		// Add a third fill light from the opposite side see if this acually works
-		m_pShaderManager->setVec3Value("lightSources[2].position", glm::vec3(0.0f, 3.0f, -8.0f));
-		m_pShaderManager->setVec3Value("lightSources[2].ambientColor", glm::vec3(0.3f, 0.3f, 0.3f));
-		m_pShaderManager->setVec3Value("lightSources[2].diffuseColor", glm::vec3(0.7f, 0.7f, 0.7f));
-		m_pShaderManager->setVec3Value("lightSources[2].specularColor", glm::vec3(0.7f, 0.7f, 0.7f));
-		m_pShaderManager->setFloatValue("lightSources[2].focalStrength", 16.0f);
-		m_pShaderManager->setFloatValue("lightSources[2].specularIntensity", 1.0f);
-
-		// Make sure lighting is enabled
-		m_pShaderManager->setBoolValue("bUseLighting", true);
-	
+	LightBuffer::LIGHT_SOURCE light;
+
+	m_pLightBuffer->Initialize();
+
+	// Main overhead light - much brighter
+	light.position = glm::vec3(0.0f, 5.0f, 2.0f);
+	light.ambientColor = glm::vec3(1.0f, 1.0f, 1.0f);
+	light.diffuseColor = glm::vec3(1.0f, 1.0f, 1.0f);
+	light.specularColor = glm::vec3(1.0f, 1.0f, 1.0f);
+	light.focalStrength = 16.0f;
+	light.specularIntensity = 3.0f;
+	m_pLightBuffer->AddLight(light);
+
+	// Front light - adding strong frontal illumination
+	light.position = glm::vec3(0.0f, 2.0f, 5.0f);
+	light.ambientColor = glm::vec3(0.5f, 0.5f, 0.5f);
+	light.diffuseColor = glm::vec3(1.0f, 1.0f, 1.0f);
+	light.specularColor = glm::vec3(1.0f, 1.0f, 1.0f);
+	light.focalStrength = 16.0f;
+	light.specularIntensity = 2.0f;
+	m_pLightBuffer->AddLight(light);
+
+	// Add a third fill light from the opposite side see if this acually works
+	light.position = glm::vec3(0.0f, 3.0f, -8.0f);
+	light.ambientColor = glm::vec3(0.3f, 0.3f, 0.3f);
+	light.diffuseColor = glm::vec3(0.7f, 0.7f, 0.7f);
+	light.specularColor = glm::vec3(0.7f, 0.7f, 0.7f);
+	light.focalStrength = 16.0f;
+	light.specularIntensity = 1.0f;
+	m_pLightBuffer->AddLight(light);
+
+	// the lights are sent to the shader on the first frame
+	m_pLightBuffer->UploadChangedLights();
+
+	// Make sure lighting is enabled
+	m_pShaderManager->setBoolValue(g_UseLightingName, true);
 }
 
 void SceneManager::PrepareScene()
@@ -484,11 +1078,19 @@ void SceneManager::PrepareScene()
 	// in the rendered 3D scene
 	LoadSceneTextures();
 	DefineObjectMaterials();
+	UploadObjectMaterials();
 	SetupSceneLights();
 
-	m_basicMeshes->LoadBoxMesh();
-	m_basicMeshes->LoadSphereMesh();  // Add this line
-	m_basicMeshes->LoadPlaneMesh();  // Add plane for the floor 
+	// the meshes of the scene are generated on the worker
+	// threads, and any other mesh is loaded the first time it
+	// is drawn - the dense ones split into meshlets, so the
+	// parts of them outside the view or facing away are culled
+	m_basicMeshes->SetMeshletGeneration(true);
+	m_basicMeshes->LoadMeshes(g_SceneMeshes, sizeof(g_SceneMeshes) / sizeof(g_SceneMeshes[0]), *m_pJobSystem);
+	// draw the scene with one call when the shader supports it
+	BuildRenderList();
+	// objects drawn one at a time stream their values
+	InitializeDrawStream();
 	//texture for glass, then going to try and do water background
 	// Adding debug code because it was not loading
 	
@@ -502,8 +1104,100 @@ void SceneManager::PrepareScene()
  ***********************************************************/
 void SceneManager::RenderScene()
 {
-	// Add this near the start of RenderScene()
-	m_pShaderManager->setVec3Value("viewPosition", camera.Position.x, camera.Position.y, camera.Position.z);
+	if (m_bRecordRenderList == false)
+	{
+		// Add this near the start of RenderScene()
+		m_pShaderManager->setVec3Value(m_uniforms.viewPosition, camera.Position.x, camera.Position.y, camera.Position.z);
+		// send any lights that were added, moved or removed
+		m_pLightBuffer->UploadChangedLights();
+		// meshes the scene stopped drawing give back their space
+		m_basicMeshes->BeginFrame();
+		m_basicMeshes->EvictUnusedMeshes(g_MeshEvictionFrames);
+		// the draws of the frame choose their levels in order
+		m_pLODSelector->BeginFrame();
+		m_pFrustumCuller->BeginFrame();
+		// textures whose images were decoded since the last frame
+		// replace their placeholders
+		if (m_pTextureLoader->GetPendingCount() > 0)
+		{
+			m_pTextureLoader->UploadDecodedTextures();
+		}
+		// and the table entries point at the uploaded images
+		if (m_bUseTextureTable == true)
+		{
+			m_pTextureLoader->TakeUploadedTextures(m_uploadedTextures);
+			for (size_t i = 0; i < m_uploadedTextures.size(); i++)
+			{
+				if (m_pTextureTable->UpdateTexture(m_uploadedTextures[i]) == true)
+				{
+					ReleaseTableTexture(m_uploadedTextures[i]);
+				}
+			}
+			m_uploadedTextures.clear();
+		}
+
+		// every object below is drawn with blending on, so the
+		// recorded scene is submitted with the same state
+		if ((m_bUseRenderList == true) && (m_bRenderListEnabled == true))
+		{
+			glEnable(GL_BLEND);
+			glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+			// the recorded bounds match the draws one to one, and
+			// the draws outside the view are hidden
+			GLsizei drawCount = m_pRenderList->GetDrawCount();
+			bool bCullDraws = ((GLsizei)m_pObjectBounds->GetCount() == drawCount);
+			if (bCullDraws == true)
+			{
+				m_pFrustumCuller->CullObjects(*m_pObjectBounds, *m_pObjectHierarchy, m_visibleDraws);
+			}
+			// hidden draws still choose their level, so the levels
+			// of the last frame stay matched to the same draws
+			m_pClusterCuller->BeginFrame();
+			m_pClusterList->Clear();
+			for (GLsizei draw = 0; draw < drawCount; draw++)
+			{
+				bool bVisible = (bCullDraws == false) || (m_visibleDraws[draw] != 0);
+				ShapeMeshes::MESH_ID meshID = m_pRenderList->GetDrawMesh(draw);
+				const RenderList::DRAW_DATA& drawData = m_pRenderList->GetDrawData(draw);
+				int level = m_pLODSelector->SelectLevel(meshID, drawData.model, bVisible);
+
+				// the meshlets split the full detail level, so a
+				// visible draw at that level is replaced by its
+				// meshlets that pass the tests
+				const MeshletBuilder::MESHLET* pMeshlets = NULL;
+				GLuint nMeshlets = 0;
+				if ((m_bClusterCulling == true) && (bVisible == true) && (level == 0) &&
+					(m_basicMeshes->GetMeshlets(meshID, pMeshlets, nMeshlets) == true))
+				{
+					m_pClusterCuller->AddVisibleMeshlets(meshID, drawData, *m_pClusterList);
+					bVisible = false;
+				}
+				m_pRenderList->SetDrawVisible(draw, bVisible);
+				m_pRenderList->SetDrawLevel(draw, level);
+			}
+			m_pRenderList->Submit();
+			// the meshlets are drawn after the rest of the scene
+			if (m_pClusterList->GetDrawCount() > 0)
+			{
+				m_pClusterList->Compile();
+				m_pClusterList->Submit();
+			}
+			return;
+		}
+
+		// the objects below add their bounds again, and collect
+		// their values starting from the same values as a
+		// recording - streamed into the region of this frame, or
+		// passed into the uniforms when they are drawn
+		m_pObjectBounds->Clear();
+		ResetRecordedDraw();
+		if (m_bStreamDraws == true)
+		{
+			m_pDrawStream->BeginFrame();
+			m_pShaderManager->setBoolValue(m_uniforms.useDrawList, true);
+		}
+	}
+
 	float XrotationDegrees = 0.0f;
 	float YrotationDegrees = 10.0f;// I rotated this for a better perspective so it align more with picture
 	float ZrotationDegrees = 0.0f;
@@ -515,24 +1209,24 @@ void SceneManager::RenderScene()
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
 	//  outline for tank
-	 SetShaderTexture("lip_texture"); 
-	 SetShaderMaterial("metal");
+	 SetShaderTexture(m_sceneTags.lipTexture); 
+	 SetShaderMaterial(m_sceneTags.metalMaterial);
 	 SetTextureUVScale(0.5f, 0.5f);
 	//SetShaderColor(0.0f, 0.0f, 0.0f, 1.0f);  // Pure black color
 	glm::vec3 outlineScale = glm::vec3(5.1f, 2.1f, 1.1f);  // Slightly larger than tank
 	glm::vec3 outlinePosition = glm::vec3(0.0f, 2.0f, -0.1f);  // Same position as tank but slightly behind
 	SetTransformations(outlineScale, XrotationDegrees, YrotationDegrees, ZrotationDegrees, outlinePosition);
-	m_basicMeshes->DrawBoxMesh();
+	DrawShapeMesh(ShapeMeshes::BOX_MESH);
 
-	SetShaderTexture("water_texture");
-	SetShaderMaterial("glass");
+	SetShaderTexture(m_sceneTags.waterTexture);
+	SetShaderMaterial(m_sceneTags.glassMaterial);
 	// Use texture instead of color
 	SetTextureUVScale(3.0f, 2.0f);
 	//SetShaderColor(0.7f, 0.9f, 1.0f, 0.3f);  // Light blue color si I can seperate the top from bottom
 	glm::vec3 tankScale = glm::vec3(5.0f, 2.0f, 1.5f);// making it wider than taller to match pic, not sure i need this comment
 	glm::vec3 tankPosition = glm::vec3(0.0f, 2.0f, 0.0f);
 	SetTransformations(tankScale, XrotationDegrees, YrotationDegrees, ZrotationDegrees, tankPosition);
-	m_basicMeshes->DrawBoxMesh();
+	DrawShapeMesh(ShapeMeshes::BOX_MESH);
 	//added below to blend
 	glDisable(GL_BLEND);
 
@@ -540,62 +1234,74 @@ void SceneManager::RenderScene()
 	glEnable(GL_BLEND);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
-	SetShaderTexture("wood_texture");
-	SetShaderMaterial("wood");// Use texture instead of color
+	SetShaderTexture(m_sceneTags.woodTexture);
+	SetShaderMaterial(m_sceneTags.woodMaterial);// Use texture instead of color
 	SetTextureUVScale(3.0f, 2.0f);
 	//SetShaderColor(1.0f, 1.0f, 0.8f, 1.0f);  // Warm light color
 	glm::vec3 ovalScale = glm::vec3(1.0f, 0.3f, 0.8f);  // Stretched horizontally, compressed vertically just representing position and space
 	glm::vec3 ovalPosition = glm::vec3(0.0f, 4.0f, 0.0f);  // Positioned above the tank
 	SetTransformations(ovalScale, XrotationDegrees, YrotationDegrees, ZrotationDegrees, ovalPosition);
-	m_basicMeshes->DrawSphereMesh();
+	DrawShapeMesh(ShapeMeshes::SPHERE_MESH);
 
 	// Wooden stand (lower box)
-	SetShaderTexture("wood_texture");
-	SetShaderMaterial("wood");
+	SetShaderTexture(m_sceneTags.woodTexture);
+	SetShaderMaterial(m_sceneTags.woodMaterial);
 	SetTextureUVScale(0.5f, 0.5f);
 	//SetShaderColor(0.0f, 0.0f, 0.5f, 1.0f);  // Dark blue color to seperate the bottom
 	glm::vec3 standScale = glm::vec3(4.8f, 2.0f, 1.5f);
 	glm::vec3 standPosition = glm::vec3(0.0f, 0.0f, 0.0f);
 	SetTransformations(standScale, XrotationDegrees, YrotationDegrees, ZrotationDegrees, standPosition);
-	m_basicMeshes->DrawBoxMesh();
+	DrawShapeMesh(ShapeMeshes::BOX_MESH);
 
 	// Door in the middle of the stand
-	SetShaderTexture("lip_texture");  // different texture so the door can be seen
-	SetShaderMaterial("wood");
+	SetShaderTexture(m_sceneTags.lipTexture);  // different texture so the door can be seen
+	SetShaderMaterial(m_sceneTags.woodMaterial);
 	SetTextureUVScale(0.25f, 0.25f);   // Smaller UV scale for more detailed wood grain on the door
 	glm::vec3 doorScale = glm::vec3(1.6f, 1.0f, 0.1f);  // Make it thinner than the stand but proportional
 	glm::vec3 doorPosition = glm::vec3(0.0f, 0.0f, 0.75f);  // Position it  in front of the stand
 	SetTransformations(doorScale, XrotationDegrees, YrotationDegrees, 90.0f, doorPosition);
-	m_basicMeshes->DrawBoxMesh();
+	DrawShapeMesh(ShapeMeshes::BOX_MESH);
 
 	// Door handle (small sphere on right side of door)
-	SetShaderTexture("handle_texture");  // Using wood texture for the handle
-	SetShaderMaterial("metal");
+	SetShaderTexture(m_sceneTags.handleTexture);  // Using wood texture for the handle
+	SetShaderMaterial(m_sceneTags.metalMaterial);
 	SetTextureUVScale(0.1f, 0.1f);
 	glm::vec3 handleScale = glm::vec3(0.1f, 0.1f, 0.1f);  // Small sphere
 	glm::vec3 handlePosition = glm::vec3(-0.3f, 0.0f, 0.9f);  // Positioned right side of door, slightly more forward
 	SetTransformations(handleScale, XrotationDegrees, YrotationDegrees, ZrotationDegrees, handlePosition);
-	m_basicMeshes->DrawSphereMesh();  // Using sphere mesh for round handle
+	DrawShapeMesh(ShapeMeshes::SPHERE_MESH);  // Using sphere mesh for round handle
 
 	// Bottom lip/base
 	//// Medium blue creates transition between stand and floor
-	SetShaderTexture("lip_texture");
-	SetShaderMaterial("metal");
+	SetShaderTexture(m_sceneTags.lipTexture);
+	SetShaderMaterial(m_sceneTags.metalMaterial);
 	SetTextureUVScale(0.5f, 0.5f);
 	//SetShaderColor(0.2f, 0.2f, 0.8f, 1.0f);  // Different shade of blue
 	glm::vec3 lipScale = glm::vec3(5.2f, 0.2f, 1.7f);  // a little wider than finished will
 	// be but the third shape i added is just the base and will be adjusted....just added and extra step
 	glm::vec3 lipPosition = glm::vec3(0.0f, -1.0f, 0.0f);  // lip below the stand
 	SetTransformations(lipScale, XrotationDegrees, YrotationDegrees, ZrotationDegrees, lipPosition);
-	m_basicMeshes->DrawBoxMesh();
+	DrawShapeMesh(ShapeMeshes::BOX_MESH);
 
 	// Floor plane
-	SetShaderTexture("carpet_texture");
-	SetShaderMaterial("carpet");
+	SetShaderTexture(m_sceneTags.carpetTexture);
+	SetShaderMaterial(m_sceneTags.carpetMaterial);
 	SetTextureUVScale(4.0f, 4.0f);
 	//SetShaderColor(0.4f, 0.4f, 0.4f, 1.0f);  // Grey color for floor
 	glm::vec3 planeScale = glm::vec3(15.0f, 1.0f, 15.0f);  // Make it large enough for the scene
 	glm::vec3 planePosition = glm::vec3(0.0f, -1.2f, 0.0f);  // Slightly below the bottom lip
 	SetTransformations(planeScale, XrotationDegrees, YrotationDegrees, ZrotationDegrees, planePosition);
-	m_basicMeshes->DrawPlaneMesh();
+	DrawShapeMesh(ShapeMeshes::PLANE_MESH);
+
+	if (m_bRecordRenderList == false)
+	{
+		// the tree follows the objects as they move
+		m_pObjectHierarchy->Update(*m_pObjectBounds);
+
+		if (m_bStreamDraws == true)
+		{
+			m_pShaderManager->setBoolValue(m_uniforms.useDrawList, false);
+			m_pDrawStream->EndFrame();
+		}
+	}
 }
\ No newline at end of file
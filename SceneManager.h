@@ -9,6 +9,18 @@
 #pragma once
 #include "ShaderManager.h"
 #include "ShapeMeshes.h"
+#include "LightBuffer.h"
+#include "RenderList.h"
+#include "LODSelector.h"
+#include "JobSystem.h"
+#include "StreamBuffer.h"
+#include "WorldBounds.h"
+#include "FrustumCuller.h"
+#include "ClusterCuller.h"
+#include "BoundsHierarchy.h"
+#include "TextureLoader.h"
+#include "TextureTable.h"
+#include "TagInterner.h"
 #include "camera.h"
 #include <string>
 #include <vector>
@@ -35,10 +47,56 @@ public:
     void DefineObjectMaterials();
     void SetupSceneLights();
 
+    // access the scene lights for adding, moving and
+    // removing lights at runtime
+    LightBuffer* GetLightBuffer() { return m_pLightBuffer; }
+
+    // set the camera of the next frame, used for choosing the
+    // tessellation level of the curved meshes
+    void SetViewTransform(
+        const glm::mat4& view,
+        const glm::mat4& projection,
+        int viewportHeight);
+    // access the level selection for changing its thresholds
+    // and reading the triangles saved in the last frame
+    LODSelector* GetLODSelector() { return m_pLODSelector; }
+    // draw the scene with the recorded render list, or object
+    // by object when it changes every frame
+    void EnableRenderList(bool bEnable);
+    // access the draw stream for reading the writes of the last
+    // frame drawn object by object
+    const StreamBuffer* GetDrawStream() const { return m_pDrawStream; }
+    // access the world bounds of the drawn objects, in the order
+    // they are drawn - set when the render list is recorded, and
+    // every frame while the scene is drawn object by object
+    const WorldBounds* GetObjectBounds() const { return m_pObjectBounds; }
+    // access the texture loader for reading how many textures
+    // still show their placeholders
+    const TextureLoader* GetTextureLoader() const { return m_pTextureLoader; }
+    // access the view culling for switching it off and reading
+    // the objects culled in the last frame
+    FrustumCuller* GetFrustumCuller() { return m_pFrustumCuller; }
+    // draw the visible meshlets of the dense meshes drawn at full
+    // detail through the render list instead of the whole meshes
+    void EnableClusterCulling(bool bEnable);
+    // access the meshlet culling for reading the meshlets and
+    // triangles culled in the last frame
+    const ClusterCuller* GetClusterCuller() const { return m_pClusterCuller; }
+    // access the tree over the world bounds of the drawn objects
+    const BoundsHierarchy* GetObjectHierarchy() const { return m_pObjectHierarchy; }
+    // find the drawn object whose box the ray enters first -
+    // returns its index in draw order, or -1 when there is none
+    int PickObject(const glm::vec3& origin, const glm::vec3& direction, float maxDistance) const;
+    // find the drawn objects whose boxes are within the distance
+    // of the point, by their index in draw order
+    void FindObjectsNear(const glm::vec3& point, float distance, std::vector<GLuint>& objects) const;
+
     struct TEXTURE_INFO
     {
         std::string tag;
         uint32_t ID;
+        // entry of the texture in the texture table, or -1
+        GLint tableIndex;
     };
 
     struct OBJECT_MATERIAL
@@ -56,26 +114,162 @@ private:
     ShaderManager* m_pShaderManager;
     // pointer to basic shapes object
     ShapeMeshes* m_basicMeshes;
-    // total number of loaded textures
-    int m_loadedTextures;
     // loaded textures info
-    TEXTURE_INFO m_textureIDs[16];
+    std::vector<TEXTURE_INFO> m_textureIDs;
+    // scene light sources
+    LightBuffer* m_pLightBuffer;
     // defined object materials
     std::vector<OBJECT_MATERIAL> m_objectMaterials;
+    // storage buffer holding the table of all defined materials
+    GLuint m_materialBuffer;
+    // true when the shader reads materials from the material block
+    bool m_bUseMaterialBlock;
+    // list drawing the whole scene with one call, recorded
+    // once from the scene description
+    RenderList* m_pRenderList;
+    // true when the scene is drawn through the render list
+    bool m_bUseRenderList;
+    // true while the scene description is being recorded
+    bool m_bRecordRenderList;
+    // false when the scene is drawn object by object even though
+    // a render list was recorded
+    bool m_bRenderListEnabled;
+    // draw values collected by the setters, recorded, streamed
+    // or passed into the uniforms when the object is drawn
+    RenderList::DRAW_DATA m_recordedDraw;
+    // ring of draw values written by the objects drawn one at a
+    // time, read by the shader from the draw block
+    StreamBuffer* m_pDrawStream;
+    // true when the objects drawn one at a time stream their values
+    bool m_bStreamDraws;
+    // offset alignment of a bound storage buffer range
+    GLsizeiptr m_drawDataAlignment;
+    // chooses the tessellation level of every drawn mesh
+    LODSelector* m_pLODSelector;
+    // model matrix of the next draw, used to choose its level
+    // and to move the mesh bounds into world space
+    glm::mat4 m_modelMatrix;
+    // world bounds of the drawn objects
+    WorldBounds* m_pObjectBounds;
+    // tree over the world bounds, built when the render list is
+    // recorded and refit when the objects are drawn one at a time
+    BoundsHierarchy* m_pObjectHierarchy;
+    // rejects the objects outside the view before they are drawn
+    FrustumCuller* m_pFrustumCuller;
+    // result of culling the render list draws, one per draw
+    std::vector<uint8_t> m_visibleDraws;
+    // rejects the meshlets outside the view or facing away
+    ClusterCuller* m_pClusterCuller;
+    // list of the visible meshlets, built again every frame
+    // from the render list draws that were split into meshlets
+    RenderList* m_pClusterList;
+    // false when the dense meshes are drawn whole
+    bool m_bClusterCulling;
+    // worker threads generating the meshes of the scene and
+    // decoding its textures
+    JobSystem* m_pJobSystem;
+    // decodes the texture images and uploads them as they are
+    // ready
+    TextureLoader* m_pTextureLoader;
+    // block compressed mip chains cooked from the scene images
+    TextureCache* m_pTextureCache;
+    // table the shader finds the draw textures in by index
+    TextureTable* m_pTextureTable;
+    // true when the shader declares the texture table, so draws
+    // select their texture by table index instead of by slot
+    bool m_bUseTextureTable;
+    // textures uploaded by the loader, moved into the table
+    std::vector<GLuint> m_uploadedTextures;
+    // IDs of the texture and material tags
+    TagInterner* m_pTagInterner;
+    // texture slot and material index of every tag ID, -1 when
+    // the tag names no texture or material
+    std::vector<int> m_textureSlotsByTag;
+    std::vector<int> m_materialIndicesByTag;
     // camera object
     Camera camera;
 
+    // shader uniform handles resolved once when the scene
+    // manager is created, used by the per-object methods
+    struct SHADER_UNIFORMS
+    {
+        UniformHandle model;
+        UniformHandle objectColor;
+        UniformHandle objectTexture;
+        UniformHandle objectTextureIndex;
+        UniformHandle useTexture;
+        UniformHandle UVscale;
+        UniformHandle viewPosition;
+        UniformHandle materialAmbientColor;
+        UniformHandle materialAmbientStrength;
+        UniformHandle materialDiffuseColor;
+        UniformHandle materialSpecularColor;
+        UniformHandle materialShininess;
+        UniformHandle materialIndex;
+        UniformHandle useInstancing;
+        UniformHandle useDrawList;
+    };
+    SHADER_UNIFORMS m_uniforms;
+
+    // tags drawn by the scene, interned once when the scene is
+    // prepared so the render loop selects them by ID
+    struct SCENE_TAGS
+    {
+        TagInterner::TAG_ID woodTexture;
+        TagInterner::TAG_ID waterTexture;
+        TagInterner::TAG_ID lipTexture;
+        TagInterner::TAG_ID carpetTexture;
+        TagInterner::TAG_ID handleTexture;
+        TagInterner::TAG_ID glassMaterial;
+        TagInterner::TAG_ID woodMaterial;
+        TagInterner::TAG_ID metalMaterial;
+        TagInterner::TAG_ID carpetMaterial;
+    };
+    SCENE_TAGS m_sceneTags;
+
+    // resolve the shader uniform handles
+    void ResolveShaderUniforms();
+    // intern the tags drawn by the scene
+    void ResolveSceneTags();
+
     // load texture images and convert to OpenGL texture data
     bool CreateGLTexture(const char* filename, std::string tag);
     // bind loaded OpenGL textures to slots in memory
     void BindGLTextures();
     // free the loaded OpenGL textures
     void DestroyGLTextures();
+    // free a texture copied into the texture table
+    void ReleaseTableTexture(GLuint textureID);
     // find a loaded texture by tag
-    int FindTextureID(std::string tag);
-    int FindTextureSlot(std::string tag);
+    int FindTextureID(const std::string& tag);
+    int FindTextureSlot(const std::string& tag);
+    int GetTextureSlot(TagInterner::TAG_ID tagID) const;
+    // get the value a draw selects a loaded texture with - its
+    // table index, or its slot without the texture table
+    int GetDrawTexture(TagInterner::TAG_ID tagID) const;
     // find a defined material by tag
-    bool FindMaterial(std::string tag, OBJECT_MATERIAL& material);
+    bool FindMaterial(const std::string& tag, OBJECT_MATERIAL& material);
+    int FindMaterialIndex(const std::string& tag);
+    int GetMaterialIndex(TagInterner::TAG_ID tagID) const;
+    // remember the value of a tag ID in a table indexed by tag
+    static void SetTagValue(std::vector<int>& values, TagInterner::TAG_ID tagID, int value);
+    // pack the defined materials into the material storage buffer
+    void UploadObjectMaterials();
+    // record the scene draws into the render list
+    void BuildRenderList();
+    // prepare the objects drawn one at a time to stream their
+    // values into the draw block
+    void InitializeDrawStream();
+    // point the draw texture samplers at the texture slots
+    void SetDrawTextureSamplers();
+    // set the collected draw values back to their defaults
+    void ResetRecordedDraw();
+    // pass collected draw values into the per-object uniforms
+    void SetDrawUniforms(const RenderList::DRAW_DATA& draw);
+    // draw a shape mesh, or add it to the render list while
+    // recording
+    void DrawShapeMesh(
+        ShapeMeshes::MESH_ID meshID);
     // set the transformation values into the transform buffer
     void SetTransformations(
         glm::vec3 scaleXYZ,
@@ -91,11 +285,21 @@ private:
         float alphaValue);
     // set the texture data into the shader
     void SetShaderTexture(
-        std::string textureTag);
+        const std::string& textureTag);
+    void SetShaderTexture(
+        TagInterner::TAG_ID textureTag);
     // set the UV scale for the texture mapping
     void SetTextureUVScale(
         float u, float v);
+    // switch the shader between the model uniform and the
+    // per-instance values of the instanced draw methods
+    void SetShaderInstancing(
+        bool bUseInstancing);
     // set the object material into the shader
     void SetShaderMaterial(
-        std::string materialTag);
+        const std::string& materialTag);
+    void SetShaderMaterial(
+        TagInterner::TAG_ID materialTag);
+    void SetShaderMaterial(
+        int materialIndex);
 };
\ No newline at end of file
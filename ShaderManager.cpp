@@ -14,6 +14,40 @@ using namespace std;
 
 #include "ShaderManager.h"
 
+namespace
+{
+	/***********************************************************
+	 *  HashUniformName()
+	 *
+	 *  FNV-1a hash of a uniform name, used to index the
+	 *  uniform table.
+	 ***********************************************************/
+	uint32_t HashUniformName(const char* name)
+	{
+		uint32_t hash = 2166136261u;
+		while (*name != '\0')
+		{
+			hash ^= (unsigned char)(*name++);
+			hash *= 16777619u;
+		}
+		return(hash);
+	}
+}
+
+/***********************************************************
+ *  ShaderManager()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ShaderManager::ShaderManager()
+{
+	m_programID = 0;
+	m_uniformTableMask = 0;
+	m_uniformCount = 0;
+	m_bLegacyLookups = false;
+	ResetUniformStats();
+}
+
 /***********************************************************
  *  LoadShaders()
  *
@@ -113,7 +147,228 @@ GLuint ShaderManager::LoadShaders(const char * vertex_file_path,const char * fra
 	glDeleteShader(VertexShaderID);
 	glDeleteShader(FragmentShaderID);
 
+	// cache every active uniform location so that the setters
+	// never have to ask the driver while rendering
+	BuildUniformTable();
+
 	return ProgramID;
 }
 
+/***********************************************************
+ *  BuildUniformTable()
+ *
+ *  This method is called after the program has been linked
+ *  to introspect all of the active uniforms into the
+ *  uniform table.
+ ***********************************************************/
+void ShaderManager::BuildUniformTable()
+{
+	GLint uniformCount = 0;
+	GLint maxNameLength = 0;
+
+	glGetProgramiv(m_programID, GL_ACTIVE_UNIFORMS, &uniformCount);
+	glGetProgramiv(m_programID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxNameLength);
+
+	// keep the table at most half full so the probes stay short
+	uint32_t capacity = 16;
+	while (capacity < (uint32_t)uniformCount * 2)
+	{
+		capacity *= 2;
+	}
+	m_uniformTable.clear();
+	m_uniformTable.resize(capacity);
+	m_uniformTableMask = capacity - 1;
+	m_uniformCount = 0;
+	for (uint32_t i = 0; i < capacity; i++)
+	{
+		m_uniformTable[i].location = -1;
+	}
+
+	std::vector<char> nameBuffer(maxNameLength + 1);
+	for (GLint i = 0; i < uniformCount; i++)
+	{
+		GLsizei nameLength = 0;
+		GLint arraySize = 0;
+		GLenum type = GL_NONE;
+
+		glGetActiveUniform(m_programID, i, (GLsizei)nameBuffer.size(), &nameLength, &arraySize, &type, &nameBuffer[0]);
+		std::string name(&nameBuffer[0], nameLength);
 
+		// uniforms that live inside a uniform block have no location
+		GLint location = glGetUniformLocation(m_programID, name.c_str());
+		if (location < 0)
+		{
+			continue;
+		}
+		InsertUniform(name, location);
+
+		// arrays of basic types are reported once as "name[0]" - register
+		// the bare name and every element so they can all be looked up
+		if ((name.size() > 3) && (name.compare(name.size() - 3, 3, "[0]") == 0))
+		{
+			std::string baseName = name.substr(0, name.size() - 3);
+			InsertUniform(baseName, location);
+			for (GLint element = 1; element < arraySize; element++)
+			{
+				std::string elementName = baseName + "[" + std::to_string(element) + "]";
+				InsertUniform(elementName, glGetUniformLocation(m_programID, elementName.c_str()));
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  InsertUniform()
+ *
+ *  This method is used for adding a uniform location into
+ *  the uniform table under the passed in name.
+ ***********************************************************/
+void ShaderManager::InsertUniform(const std::string& name, GLint location)
+{
+	uint32_t hash = HashUniformName(name.c_str());
+	uint32_t slot = hash & m_uniformTableMask;
+
+	// element locations of large arrays can outgrow the table
+	// that was sized from the active uniform count
+	if ((m_uniformCount + 1) * 2 > (uint32_t)m_uniformTable.size())
+	{
+		std::vector<UNIFORM_ENTRY> oldTable;
+		oldTable.swap(m_uniformTable);
+		m_uniformTable.resize(oldTable.size() * 2);
+		m_uniformTableMask = (uint32_t)m_uniformTable.size() - 1;
+		m_uniformCount = 0;
+		for (size_t i = 0; i < m_uniformTable.size(); i++)
+		{
+			m_uniformTable[i].location = -1;
+		}
+		for (size_t i = 0; i < oldTable.size(); i++)
+		{
+			if (oldTable[i].location >= 0)
+			{
+				InsertUniform(oldTable[i].name, oldTable[i].location);
+			}
+		}
+		slot = hash & m_uniformTableMask;
+	}
+
+	while (m_uniformTable[slot].location >= 0)
+	{
+		if ((m_uniformTable[slot].hash == hash) && (m_uniformTable[slot].name == name))
+		{
+			m_uniformTable[slot].location = location;
+			return;
+		}
+		slot = (slot + 1) & m_uniformTableMask;
+	}
+
+	m_uniformTable[slot].hash = hash;
+	m_uniformTable[slot].location = location;
+	m_uniformTable[slot].name = name;
+	m_uniformCount++;
+}
+
+/***********************************************************
+ *  FindUniformLocation()
+ *
+ *  This method is used by the name based setters for getting
+ *  the location of a uniform from the uniform table.
+ ***********************************************************/
+UniformHandle ShaderManager::FindUniformLocation(const char* name) const
+{
+	if (m_bLegacyLookups == true)
+	{
+		m_uniformStats.locationQueries++;
+		return(UniformHandle(glGetUniformLocation(m_programID, name)));
+	}
+
+	m_uniformStats.tableLookups++;
+	if (m_uniformTable.size() == 0)
+	{
+		return(UniformHandle());
+	}
+
+	uint32_t hash = HashUniformName(name);
+	uint32_t slot = hash & m_uniformTableMask;
+	while (m_uniformTable[slot].location >= 0)
+	{
+		if ((m_uniformTable[slot].hash == hash) && (m_uniformTable[slot].name.compare(name) == 0))
+		{
+			return(UniformHandle(m_uniformTable[slot].location));
+		}
+		slot = (slot + 1) & m_uniformTableMask;
+	}
+
+	// inactive or misspelled uniforms resolve to -1, which
+	// OpenGL silently ignores just like before
+	return(UniformHandle());
+}
+
+/***********************************************************
+ *  GetUniformHandle()
+ *
+ *  This method is used for resolving a uniform name into a
+ *  handle once, so the per-object code can use the handle
+ *  based setters.
+ ***********************************************************/
+UniformHandle ShaderManager::GetUniformHandle(const char* name) const
+{
+	return(FindUniformLocation(name));
+}
+
+/***********************************************************
+ *  BindUniformBlock()
+ *
+ *  This method is used for connecting a uniform block that is
+ *  declared in the shader code to a uniform buffer binding
+ *  point.  Shaders that do not declare the block are left
+ *  untouched so the caller can fall back to plain uniforms.
+ ***********************************************************/
+bool ShaderManager::BindUniformBlock(const char* blockName, GLuint bindingPoint, GLint* pBlockSize) const
+{
+	GLuint blockIndex = glGetUniformBlockIndex(m_programID, blockName);
+	if (blockIndex == GL_INVALID_INDEX)
+	{
+		return(false);
+	}
+
+	glUniformBlockBinding(m_programID, blockIndex, bindingPoint);
+	if (NULL != pBlockSize)
+	{
+		glGetActiveUniformBlockiv(m_programID, blockIndex, GL_UNIFORM_BLOCK_DATA_SIZE, pBlockSize);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  BindStorageBlock()
+ *
+ *  This method is used for connecting a shader storage block
+ *  that is declared in the shader code to a storage buffer
+ *  binding point.
+ ***********************************************************/
+bool ShaderManager::BindStorageBlock(const char* blockName, GLuint bindingPoint) const
+{
+	GLuint blockIndex = glGetProgramResourceIndex(m_programID, GL_SHADER_STORAGE_BLOCK, blockName);
+	if (blockIndex == GL_INVALID_INDEX)
+	{
+		return(false);
+	}
+
+	glShaderStorageBlockBinding(m_programID, blockIndex, bindingPoint);
+
+	return(true);
+}
+
+/***********************************************************
+ *  ResetUniformStats()
+ *
+ *  This method is used for clearing the uniform traffic
+ *  counters, usually at the start of every frame.
+ ***********************************************************/
+void ShaderManager::ResetUniformStats()
+{
+	m_uniformStats.locationQueries = 0;
+	m_uniformStats.tableLookups = 0;
+	m_uniformStats.uniformUploads = 0;
+}
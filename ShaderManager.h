@@ -7,19 +7,64 @@
 #include <glm/gtc/type_ptr.hpp>
 
 #include <string>
+#include <vector>
 #include <fstream>
 #include <sstream>
 #include <iostream>
+#include <stdint.h>
+
+// handle to a uniform location that was resolved once from the
+// introspected uniform table - passing a handle to the setters
+// below avoids any string hashing or driver lookups per call
+struct UniformHandle
+{
+	GLint location;
+
+	UniformHandle() : location(-1) {}
+	explicit UniformHandle(GLint uniformLocation) : location(uniformLocation) {}
+
+	bool IsValid() const { return location >= 0; }
+};
 
 class ShaderManager
 {
 public:
+	// counters for the uniform traffic sent to the driver
+	struct UNIFORM_STATS
+	{
+		uint32_t locationQueries;	// glGetUniformLocation() calls
+		uint32_t tableLookups;		// name lookups into the uniform table
+		uint32_t uniformUploads;	// glUniform*() calls
+	};
+
 	unsigned int m_programID;
-	
+
+	ShaderManager();
+
 	GLuint LoadShaders(
-		const char* vertex_file_path, 
+		const char* vertex_file_path,
 		const char* fragment_file_path);
 
+	// resolve a uniform name into a handle - call once at setup time
+	UniformHandle GetUniformHandle(const char* name) const;
+
+	// attach the named uniform block to a buffer binding point -
+	// returns false when the program does not declare the block,
+	// otherwise the block data size in bytes is stored in pBlockSize
+	bool BindUniformBlock(const char* blockName, GLuint bindingPoint, GLint* pBlockSize = NULL) const;
+
+	// attach the named shader storage block to a buffer binding
+	// point - returns false when the program does not declare it
+	bool BindStorageBlock(const char* blockName, GLuint bindingPoint) const;
+
+	// when true, the name based setters query the driver for the
+	// location on every call instead of using the uniform table
+	void SetLegacyUniformLookups(bool bLegacy) { m_bLegacyLookups = bLegacy; }
+
+	// access and reset the uniform traffic counters
+	const UNIFORM_STATS& GetUniformStats() const { return m_uniformStats; }
+	void ResetUniformStats();
+
 	// activate the shader
 	// ------------------------------------------------------------------------
 	inline void use()
@@ -31,73 +76,161 @@ public:
 	// ------------------------------------------------------------------------
 	inline void setBoolValue(const std::string &name, bool value) const
 	{
-		glUniform1i(glGetUniformLocation(m_programID, name.c_str()), (int)value);
+		setIntValue(FindUniformLocation(name.c_str()), (int)value);
+	}
+	inline void setBoolValue(UniformHandle handle, bool value) const
+	{
+		setIntValue(handle, (int)value);
 	}
 
 	// ------------------------------------------------------------------------
 	inline void setIntValue(const std::string &name, int value) const
 	{
-		glUniform1i(glGetUniformLocation(m_programID, name.c_str()), value);
+		setIntValue(FindUniformLocation(name.c_str()), value);
+	}
+	inline void setIntValue(UniformHandle handle, int value) const
+	{
+		m_uniformStats.uniformUploads++;
+		glUniform1i(handle.location, value);
 	}
 
 	// ------------------------------------------------------------------------
 	inline void setFloatValue(const std::string &name, float value) const
 	{
-		glUniform1f(glGetUniformLocation(m_programID, name.c_str()), value);
+		setFloatValue(FindUniformLocation(name.c_str()), value);
+	}
+	inline void setFloatValue(UniformHandle handle, float value) const
+	{
+		m_uniformStats.uniformUploads++;
+		glUniform1f(handle.location, value);
 	}
 
 	// ------------------------------------------------------------------------
 	inline void setVec2Value(const std::string &name, const glm::vec2 &value) const
 	{
-		glUniform2fv(glGetUniformLocation(m_programID, name.c_str()), 1, &value[0]);
+		setVec2Value(FindUniformLocation(name.c_str()), value);
+	}
+	inline void setVec2Value(UniformHandle handle, const glm::vec2 &value) const
+	{
+		m_uniformStats.uniformUploads++;
+		glUniform2fv(handle.location, 1, &value[0]);
 	}
 
 	inline void setVec2Value(const std::string &name, float x, float y) const
 	{
-		glUniform2f(glGetUniformLocation(m_programID, name.c_str()), x, y);
+		setVec2Value(FindUniformLocation(name.c_str()), x, y);
+	}
+	inline void setVec2Value(UniformHandle handle, float x, float y) const
+	{
+		m_uniformStats.uniformUploads++;
+		glUniform2f(handle.location, x, y);
 	}
 
 	// ------------------------------------------------------------------------
 	inline void setVec3Value(const std::string &name, const glm::vec3 &value) const
 	{
-		glUniform3fv(glGetUniformLocation(m_programID, name.c_str()), 1, &value[0]);
+		setVec3Value(FindUniformLocation(name.c_str()), value);
+	}
+	inline void setVec3Value(UniformHandle handle, const glm::vec3 &value) const
+	{
+		m_uniformStats.uniformUploads++;
+		glUniform3fv(handle.location, 1, &value[0]);
 	}
 	inline void setVec3Value(const std::string &name, float x, float y, float z) const
 	{
-		glUniform3f(glGetUniformLocation(m_programID, name.c_str()), x, y, z);
+		setVec3Value(FindUniformLocation(name.c_str()), x, y, z);
+	}
+	inline void setVec3Value(UniformHandle handle, float x, float y, float z) const
+	{
+		m_uniformStats.uniformUploads++;
+		glUniform3f(handle.location, x, y, z);
 	}
 
 	// ------------------------------------------------------------------------
 	inline void setVec4Value(const std::string &name, const glm::vec4 &value) const
 	{
-		glUniform4fv(glGetUniformLocation(m_programID, name.c_str()), 1, &value[0]);
+		setVec4Value(FindUniformLocation(name.c_str()), value);
+	}
+	inline void setVec4Value(UniformHandle handle, const glm::vec4 &value) const
+	{
+		m_uniformStats.uniformUploads++;
+		glUniform4fv(handle.location, 1, &value[0]);
 	}
 	inline void setVec4Value(const std::string &name, float x, float y, float z, float w)
 	{
-		glUniform4f(glGetUniformLocation(m_programID, name.c_str()), x, y, z, w);
+		setVec4Value(FindUniformLocation(name.c_str()), x, y, z, w);
+	}
+	inline void setVec4Value(UniformHandle handle, float x, float y, float z, float w) const
+	{
+		m_uniformStats.uniformUploads++;
+		glUniform4f(handle.location, x, y, z, w);
 	}
 
 	// ------------------------------------------------------------------------
 	inline void setMat2Value(const std::string &name, const glm::mat2 &mat) const
 	{
-		glUniformMatrix2fv(glGetUniformLocation(m_programID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+		setMat2Value(FindUniformLocation(name.c_str()), mat);
+	}
+	inline void setMat2Value(UniformHandle handle, const glm::mat2 &mat) const
+	{
+		m_uniformStats.uniformUploads++;
+		glUniformMatrix2fv(handle.location, 1, GL_FALSE, &mat[0][0]);
 	}
 
 	// ------------------------------------------------------------------------
 	inline void setMat3Value(const std::string &name, const glm::mat3 &mat) const
 	{
-		glUniformMatrix3fv(glGetUniformLocation(m_programID, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+		setMat3Value(FindUniformLocation(name.c_str()), mat);
+	}
+	inline void setMat3Value(UniformHandle handle, const glm::mat3 &mat) const
+	{
+		m_uniformStats.uniformUploads++;
+		glUniformMatrix3fv(handle.location, 1, GL_FALSE, &mat[0][0]);
 	}
 
 	// ------------------------------------------------------------------------
 	inline void setMat4Value(const std::string &name, const glm::mat4 &mat) const
 	{
-		glUniformMatrix4fv(glGetUniformLocation(m_programID, name.c_str()), 1, GL_FALSE, glm::value_ptr(mat));
+		setMat4Value(FindUniformLocation(name.c_str()), mat);
+	}
+	inline void setMat4Value(UniformHandle handle, const glm::mat4 &mat) const
+	{
+		m_uniformStats.uniformUploads++;
+		glUniformMatrix4fv(handle.location, 1, GL_FALSE, glm::value_ptr(mat));
 	}
 
 	// ------------------------------------------------------------------------
 	inline void setSampler2DValue(const std::string& name, const int &value) const
 	{
-		glUniform1i(glGetUniformLocation(m_programID, name.c_str()), value);
+		setSampler2DValue(FindUniformLocation(name.c_str()), value);
+	}
+	inline void setSampler2DValue(UniformHandle handle, const int &value) const
+	{
+		m_uniformStats.uniformUploads++;
+		glUniform1i(handle.location, value);
 	}
-};
\ No newline at end of file
+
+private:
+	// one slot of the open addressing uniform table
+	struct UNIFORM_ENTRY
+	{
+		uint32_t hash;
+		GLint location;
+		std::string name;
+	};
+
+	// uniform table built from the linked program, indexed by
+	// the name hash with linear probing - the capacity is always
+	// a power of two so the probe wraps with a mask
+	std::vector<UNIFORM_ENTRY> m_uniformTable;
+	uint32_t m_uniformTableMask;
+	uint32_t m_uniformCount;
+	bool m_bLegacyLookups;
+	mutable UNIFORM_STATS m_uniformStats;
+
+	// introspect the active uniforms of the linked program
+	void BuildUniformTable();
+	void InsertUniform(const std::string& name, GLint location);
+	// look up a uniform location by name for the name based setters
+	UniformHandle FindUniformLocation(const char* name) const;
+};
@@ -9,13 +9,23 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "shapemeshes.h"
+#include "ShapeTables.h"
+#include "JobSystem.h"
 
 // GLM Math Header inclusions
 #include <glm/glm.hpp>
 #include <glm/gtx/transform.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <glm/gtc/packing.hpp>
 
 #include <vector>
+#include <map>
+#include <set>
+#include <utility>
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <iostream>
 
 namespace
 {
@@ -24,11 +34,99 @@ namespace
 	const GLuint g_FloatsPerVertex = 3;	// Number of coordinates per vertex
 	const GLuint g_FloatsPerNormal = 3;	// Number of values per vertex color
 	const GLuint g_FloatsPerUV = 2;		// Number of texture coordinate values
+
+	// first attribute location of the per-instance values
+	const GLuint g_InstanceModelLocation = 3;		// 4 locations, one per matrix column
+	const GLuint g_InstanceUVScaleLocation = 7;
+	const GLuint g_InstanceMaterialLocation = 8;
+	// buffer binding of the per-instance values in the arena VAO
+	const GLuint g_InstanceBinding = 1;
+	// instances the instance buffer holds before it first grows
+	const GLsizei g_InitialInstanceCapacity = 64;
+
+	// parts of the meshes with caps, in index order
+	const int g_BottomPart = 0;
+	const int g_TopPart = 1;
+	const int g_ConeSidesPart = 1;
+	const int g_CylinderSidesPart = 2;
+	// halves of the sphere mesh
+	const int g_TopHalfPart = 0;
+	const int g_BottomHalfPart = 1;
+	// halves of the torus mesh around the Z axis
+	const int g_FirstHalfPart = 0;
+	const int g_SecondHalfPart = 1;
+
+	// the sphere and its coarser levels, generated while the
+	// program is compiled
+	constexpr auto g_SphereTable = ShapeTables::MakeSphere<16, 16>();
+	constexpr auto g_SphereLevel1Table = ShapeTables::MakeSphere<12, 12>();
+	constexpr auto g_SphereLevel2Table = ShapeTables::MakeSphere<8, 8>();
+	constexpr auto g_SphereLevel3Table = ShapeTables::MakeSphere<6, 5>();
+	// tessellation of the coarser levels of the curved meshes,
+	// level 1 first
+	const int g_CylinderLevelSlices[] = { 18, 12, 8 };
+	const int g_TorusLevelMainSegments[] = { 20, 12, 8 };
+	const int g_TorusLevelTubeSegments[] = { 12, 8, 6 };
+	// top radius of the tapered cylinder
+	const float g_TaperedCylinderTopRadius = 0.5f;
+
+	// largest packing error accepted by the packing validation -
+	// half floats keep 11 bits for positions up to 2, the normals
+	// keep 10 bits and the UVs 16 bits inside 0 to 1
+	const float g_PositionTolerance = 1.0e-3f;
+	const float g_NormalTolerance = 2.0e-3f;
+	const float g_UVTolerance = 1.0e-4f;
+}
+
+ShapeMeshes::ShapeMeshes(VERTEX_FORMAT vertexFormat)
+	: m_meshArena(CreateVertexLayout(vertexFormat))
+{
+	m_vertexFormat = vertexFormat;
+	m_bValidatePacking = false;
+	m_instanceBuffer = 0;
+	m_instanceCapacity = 0;
+	m_bOptimizeMeshes = true;
+	m_bBuildMeshlets = false;
+	m_frameNumber = 0;
+	m_torusThickness = 0.2f;
+	m_bQueueUploads = false;
+
+	// meshes that are never loaded have nothing to draw
+	GLMesh emptyMesh = {};
+	m_BoxMesh = emptyMesh;
+	m_ConeMesh = emptyMesh;
+	m_CylinderMesh = emptyMesh;
+	m_PlaneMesh = emptyMesh;
+	m_PrismMesh = emptyMesh;
+	m_Pyramid3Mesh = emptyMesh;
+	m_Pyramid4Mesh = emptyMesh;
+	m_SphereMesh = emptyMesh;
+	m_TaperedCylinderMesh = emptyMesh;
+	m_TorusMesh = emptyMesh;
+	for (int meshID = 0; meshID < MESH_COUNT; meshID++)
+	{
+		for (int level = 0; level < LOD_LEVEL_COUNT - 1; level++)
+		{
+			m_meshLevels[meshID][level] = emptyMesh;
+		}
+		m_lastUsedFrame[meshID] = 0;
+	}
 }
 
-ShapeMeshes::ShapeMeshes()
+///////////////////////////////////////////////////
+//	AddTableToArena()
+//
+//	Append a mesh table generated while the program
+//  is compiled to the shared arena buffers.  The
+//  parts of the mesh are set by the caller.
+///////////////////////////////////////////////////
+template <class TABLE>
+void ShapeMeshes::AddTableToArena(
+	GLMesh& mesh, const TABLE& table)
 {
-	m_bMemoryLayoutDone = false;
+	mesh.nVertices = table.nVertices;
+	mesh.nIndices = table.nIndices;
+	AddMeshToArena(mesh, table.vertices.data(), table.indices.data());
 }
 
 ///////////////////////////////////////////////////
@@ -45,7 +143,7 @@ ShapeMeshes::ShapeMeshes()
 void ShapeMeshes::LoadBoxMesh()
 {
 	// Position and Color data
-	GLfloat verts[] = {
+	static constexpr GLfloat verts[] = {
 		//Positions				//Normals
 		// ------------------------------------------------------
 
@@ -87,7 +185,7 @@ void ShapeMeshes::LoadBoxMesh()
 	};
 
 	// Index data
-	GLuint indices[] = {
+	static constexpr GLuint indices[] = {
 		0,1,2,
 		0,3,2,
 		4,5,6,
@@ -105,21 +203,8 @@ void ShapeMeshes::LoadBoxMesh()
 	m_BoxMesh.nVertices = sizeof(verts) / (sizeof(verts[0]) * (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV));
 	m_BoxMesh.nIndices = sizeof(indices) / sizeof(indices[0]);
 
-	glGenVertexArrays(1, &m_BoxMesh.vao); // we can also generate multiple VAOs or buffers at the same time
-	glBindVertexArray(m_BoxMesh.vao);
-
-	// Create 2 buffers: first one for the vertex data; second one for the indices
-	glGenBuffers(2, m_BoxMesh.vbos);
-	glBindBuffer(GL_ARRAY_BUFFER, m_BoxMesh.vbos[0]); // Activates the buffer
-	glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW); // Sends vertex or coordinate data to the GPU
-
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_BoxMesh.vbos[1]); // Activates the buffer
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-
-	if (m_bMemoryLayoutDone == false)
-	{
-		SetShaderMemoryLayout();
-	}
+	// append the mesh to the shared arena buffers
+	AddMeshToArena(m_BoxMesh, verts, indices);
 }
 
 ///////////////////////////////////////////////////
@@ -129,7 +214,9 @@ void ShapeMeshes::LoadBoxMesh()
 //  store it in a VAO/VBO.  The normals and texture
 //  coordinates are also set.
 //
-//  Correct triangle drawing commands:
+//  The vertex data is laid out for these drawing
+//  commands, and converted into indexed triangles
+//  when it is loaded:
 //
 //	glDrawArrays(GL_TRIANGLE_FAN, 0, 36);		//bottom
 //	glDrawArrays(GL_TRIANGLE_STRIP, 36, 108);	//sides
@@ -289,21 +376,14 @@ void ShapeMeshes::LoadConeMesh()
 
 	// store vertex and index count
 	m_ConeMesh.nVertices = sizeof(verts) / (sizeof(verts[0]) * (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV));
-	m_ConeMesh.nIndices = 0;
-
-	// Create VAO
-	glGenVertexArrays(1, &m_ConeMesh.vao); // we can also generate multiple VAOs or buffers at the same time
-	glBindVertexArray(m_ConeMesh.vao);
 
-	// Create VBO
-	glGenBuffers(1, m_ConeMesh.vbos);
-	glBindBuffer(GL_ARRAY_BUFFER, m_ConeMesh.vbos[0]); // Activates the buffer
-	glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW); // Sends vertex or coordinate data to the GPU
-
-	if (m_bMemoryLayoutDone == false)
-	{
-		SetShaderMemoryLayout();
-	}
+	// convert the vertex data into indexed triangles in the
+	// shared arena buffers
+	const MESH_PART parts[] = {
+		{ GL_TRIANGLE_FAN, 0, 36 },		//bottom
+		{ GL_TRIANGLE_STRIP, 36, 108 },	//sides
+	};
+	AddPartsToArena(m_ConeMesh, verts, parts, sizeof(parts) / sizeof(parts[0]));
 }
 
 ///////////////////////////////////////////////////
@@ -313,7 +393,9 @@ void ShapeMeshes::LoadConeMesh()
 //  store it in a VAO/VBO.  The normals and texture
 //  coordinates are also set.
 //
-//  Correct triangle drawing commands:
+//  The vertex data is laid out for these drawing
+//  commands, and converted into indexed triangles
+//  when it is loaded:
 //
 //	glDrawArrays(GL_TRIANGLE_FAN, 0, 36);		//bottom
 //	glDrawArrays(GL_TRIANGLE_FAN, 36, 36);		//top
@@ -553,20 +635,20 @@ void ShapeMeshes::LoadCylinderMesh()
 
 	// store vertex and index count
 	m_CylinderMesh.nVertices = sizeof(verts) / (sizeof(verts[0]) * (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV));
-	m_CylinderMesh.nIndices = 0;
 
-	// Create VAO
-	glGenVertexArrays(1, &m_CylinderMesh.vao); // we can also generate multiple VAOs or buffers at the same time
-	glBindVertexArray(m_CylinderMesh.vao);
-
-	// Create VBO
-	glGenBuffers(1, m_CylinderMesh.vbos);
-	glBindBuffer(GL_ARRAY_BUFFER, m_CylinderMesh.vbos[0]); // Activates the buffer
-	glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW); // Sends vertex or coordinate data to the GPU
+	// convert the vertex data into indexed triangles in the
+	// shared arena buffers
+	const MESH_PART parts[] = {
+		{ GL_TRIANGLE_FAN, 0, 36 },		//bottom
+		{ GL_TRIANGLE_FAN, 36, 36 },		//top
+		{ GL_TRIANGLE_STRIP, 72, 146 },	//sides
+	};
+	AddPartsToArena(m_CylinderMesh, verts, parts, sizeof(parts) / sizeof(parts[0]));
 
-	if (m_bMemoryLayoutDone == false)
+	// generate the coarser levels for drawing at a distance
+	for (int level = 1; level < LOD_LEVEL_COUNT; level++)
 	{
-		SetShaderMemoryLayout();
+		AddCylinderLevel(m_meshLevels[CYLINDER_MESH][level - 1], g_CylinderLevelSlices[level - 1], 1.0f);
 	}
 }
 
@@ -584,7 +666,7 @@ void ShapeMeshes::LoadCylinderMesh()
 void ShapeMeshes::LoadPlaneMesh()
 {
 	// Vertex data
-	GLfloat verts[] = {
+	static constexpr GLfloat verts[] = {
 		// Vertex Positions		// Normals			// Texture coords	// Index
 		-1.0f, 0.0f, 1.0f,		0.0f, 1.0f, 0.0f,	0.0f, 0.0f,			//0
 		1.0f, 0.0f, 1.0f,		0.0f, 1.0f, 0.0f,	1.0f, 0.0f,			//1
@@ -593,7 +675,7 @@ void ShapeMeshes::LoadPlaneMesh()
 	};
 
 	// Index data
-	GLuint indices[] = {
+	static constexpr GLuint indices[] = {
 		0,1,2,
 		0,3,2
 	};
@@ -602,22 +684,8 @@ void ShapeMeshes::LoadPlaneMesh()
 	m_PlaneMesh.nVertices = sizeof(verts) / (sizeof(verts[0]) * (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV));
 	m_PlaneMesh.nIndices = sizeof(indices) / sizeof(indices[0]);
 
-	// Generate the VAO for the mesh
-	glGenVertexArrays(1, &m_PlaneMesh.vao);
-	glBindVertexArray(m_PlaneMesh.vao);	// activate the VAO
-
-	// Create VBOs for the mesh
-	glGenBuffers(2, m_PlaneMesh.vbos);
-	glBindBuffer(GL_ARRAY_BUFFER, m_PlaneMesh.vbos[0]); // Activates the buffer
-	glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW); // Sends data to the GPU
-
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_PlaneMesh.vbos[1]); // Activates the buffer
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-
-	if (m_bMemoryLayoutDone == false)
-	{
-		SetShaderMemoryLayout();
-	}
+	// append the mesh to the shared arena buffers
+	AddMeshToArena(m_PlaneMesh, verts, indices);
 }
 
 ///////////////////////////////////////////////////
@@ -627,14 +695,16 @@ void ShapeMeshes::LoadPlaneMesh()
 //  store it in a VAO/VBO.  The normals and texture
 //  coordinates are also set.
 //
-//	Correct triangle drawing command:
+//  The vertex data is laid out for these drawing
+//  commands, and converted into indexed triangles
+//  while the program is compiled:
 //
 //	glDrawArrays(GL_TRIANGLE_STRIP, 0, meshes.gPrismMesh.nVertices);
 ///////////////////////////////////////////////////
 void ShapeMeshes::LoadPrismMesh()
 {
 	// Vertex data
-	GLfloat verts[] = {
+	static constexpr GLfloat verts[] = {
 		//Positions				//Normals
 		// ------------------------------------------------------
 
@@ -682,20 +752,10 @@ void ShapeMeshes::LoadPrismMesh()
 
 	};
 
-	m_PrismMesh.nVertices = sizeof(verts) / (sizeof(verts[0]) * (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV));
-
-	glGenVertexArrays(1, &m_PrismMesh.vao); // we can also generate multiple VAOs or buffers at the same time
-	glBindVertexArray(m_PrismMesh.vao);
-
-	// Create 2 buffers: first one for the vertex data; second one for the indices
-	glGenBuffers(1, m_PrismMesh.vbos);
-	glBindBuffer(GL_ARRAY_BUFFER, m_PrismMesh.vbos[0]); // Activates the buffer
-	glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW); // Sends vertex or coordinate data to the GPU
-
-	if (m_bMemoryLayoutDone == false)
-	{
-		SetShaderMemoryLayout();
-	}
+	// the strip is converted into indexed triangles while the
+	// program is compiled
+	static constexpr auto table = ShapeTables::IndexStrip(verts);
+	AddTableToArena(m_PrismMesh, table);
 }
 
 ///////////////////////////////////////////////////
@@ -705,14 +765,16 @@ void ShapeMeshes::LoadPrismMesh()
 //  vertices and store it in a VAO/VBO.  The normals 
 //  and texture coordinates are also set.
 //
-//  Correct triangle drawing command:
+//  The vertex data is laid out for these drawing
+//  commands, and converted into indexed triangles
+//  while the program is compiled:
 //
 //	glDrawArrays(GL_TRIANGLE_STRIP, 0, gPyramid3Mesh.nVertices);
 ///////////////////////////////////////////////////
 void ShapeMeshes::LoadPyramid3Mesh()
 {
 	// Vertex data
-	GLfloat verts[] = {
+	static constexpr GLfloat verts[] = {
 		// Vertex Positions		// Normals			// Texture coords
 		//left side
 		0.0f, 0.5f, 0.0f,		-0.894427180f, 0.0f, -0.447213590f,	0.5f, 1.0f,		//top point	
@@ -736,20 +798,10 @@ void ShapeMeshes::LoadPyramid3Mesh()
 		-0.5f, -0.5f, 0.5f,		0.0f, -1.0f, 0.0f,	0.0f, 1.0f,     //front bottom left
 	};
 
-	// Calculate total defined vertices
-	m_Pyramid3Mesh.nVertices = sizeof(verts) / (sizeof(verts[0]) * (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV));
-
-	glGenVertexArrays(1, &m_Pyramid3Mesh.vao);				// Creates 1 VAO
-	glGenBuffers(1, m_Pyramid3Mesh.vbos);					// Creates 1 VBO
-	glBindVertexArray(m_Pyramid3Mesh.vao);					// Activates the VAO
-	glBindBuffer(GL_ARRAY_BUFFER, m_Pyramid3Mesh.vbos[0]);	// Activates the VBO
-	// Sends vertex or coordinate data to the GPU
-	glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW);
-
-	if (m_bMemoryLayoutDone == false)
-	{
-		SetShaderMemoryLayout();
-	}
+	// the strip is converted into indexed triangles while the
+	// program is compiled
+	static constexpr auto table = ShapeTables::IndexStrip(verts);
+	AddTableToArena(m_Pyramid3Mesh, table);
 }
 
 ///////////////////////////////////////////////////
@@ -759,14 +811,16 @@ void ShapeMeshes::LoadPyramid3Mesh()
 //  vertices and store it in a VAO/VBO.  The normals 
 //  and texture coordinates are also set.
 //
-//  Correct triangle drawing command:
+//  The vertex data is laid out for these drawing
+//  commands, and converted into indexed triangles
+//  while the program is compiled:
 //
 //	glDrawArrays(GL_TRIANGLE_STRIP, 0, meshes.gPyramid4Mesh.nVertices);
 ///////////////////////////////////////////////////
 void ShapeMeshes::LoadPyramid4Mesh()
 {
 	// Vertex data
-	GLfloat verts[] = {
+	static constexpr GLfloat verts[] = {
 		// Vertex Positions		// Normals			// Texture coords
 		//bottom side
 		-0.5f, -0.5f, 0.5f,		0.0f, -1.0f, 0.0f,	0.0f, 1.0f,     //front bottom left
@@ -799,28 +853,18 @@ void ShapeMeshes::LoadPyramid4Mesh()
 		0.0f, 0.5f, 0.0f,		0.0f, 0.0f, 1.0f,	0.5f, 1.0f,		//top point
 	};
 
-	// Calculate total defined vertices
-	m_Pyramid4Mesh.nVertices = sizeof(verts) / (sizeof(verts[0]) * (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV));
-
-	glGenVertexArrays(1, &m_Pyramid4Mesh.vao);				// Creates 1 VAO
-	glGenBuffers(1, m_Pyramid4Mesh.vbos);					// Creates 1 VBO
-	glBindVertexArray(m_Pyramid4Mesh.vao);					// Activates the VAO
-	glBindBuffer(GL_ARRAY_BUFFER, m_Pyramid4Mesh.vbos[0]);	// Activates the VBO
-	// Sends vertex or coordinate data to the GPU
-	glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW);
-
-	if (m_bMemoryLayoutDone == false)
-	{
-		SetShaderMemoryLayout();
-	}
+	// the strip is converted into indexed triangles while the
+	// program is compiled
+	static constexpr auto table = ShapeTables::IndexStrip(verts);
+	AddTableToArena(m_Pyramid4Mesh, table);
 }
 
 ///////////////////////////////////////////////////
 //	LoadSphereMesh()
 //
-//	Create a sphere mesh by specifying the vertices and 
-//  store it in a VAO/VBO.  The normals and texture
-//  coordinates are also set.
+//	Create a sphere mesh from the vertices generated
+//  while the program is compiled, along with its
+//  coarser levels, and store it in the arena.
 //
 //  Correct triangle drawing command:
 //
@@ -828,877 +872,21 @@ void ShapeMeshes::LoadPyramid4Mesh()
 ///////////////////////////////////////////////////
 void ShapeMeshes::LoadSphereMesh()
 {
-	GLfloat verts[] = {
-		// vertex data					// texture coords			// index
-		// top center point
-		0.0f, 1.0f, 0.0f,				0.5f, 1.0f,					//0
-		// ring 1
-		0.0f, 0.9808f, 0.1951f,			0.5f, 0.9375f,				//1
-		0.0747f, 0.9808f, 0.1802f,		0.51219375f, 0.9375f,		//2
-		0.1379f, 0.9808f, 0.1379f,		0.5243875f, 0.9375f,		//3
-		0.1802f, 0.9808f, 0.0747f,		0.53658125f, 0.9375f,		//4
-		0.1951f, 0.9808, 0.0f,			0.548775f, 0.9375f,			//5
-		0.1802f, 0.9808f, -0.0747f,		0.56096875f, 0.9375f,		//6
-		0.1379f, 0.9808f, -0.1379f,		0.5731625f, 0.9375f,		//7
-		0.0747f, 0.9808f, -0.1802f,		0.58535625f, 0.9375f,		//8
-		0.0f, 0.9808f, -0.1951f,		0.59755f, 0.9375f,			//9 - seam
-		0.0f, 0.9808f, -0.1951f,		0.40245f, 0.9375f,			//10 - seam
-		-0.0747f, 0.9808f, -0.1802f,	0.41464375f, 0.9375f,		//11
-		-0.1379f, 0.9808f, -0.1379f,	0.4268375f, 0.9375f,		//12
-		-0.1802f, 0.9808f, -0.0747f,	0.43903125f, 0.9375f,		//13
-		-0.1951f, 0.9808, 0.0f,			0.451225f, 0.9375f,			//14
-		-0.1802f, 0.9808f, 0.0747f,		0.46341875f, 0.9375f,		//15
-		-0.1379f, 0.9808f, 0.1379f,		0.4756125f, 0.9375f,		//16
-		-0.0747f, 0.9808f, 0.1802f,		0.48780625f, 0.9375f,		//17
-		// ring 2
-		0.0f, 0.9239f, 0.3827f,			0.5f, 0.875f,				//18
-		0.1464f, 0.9239f, 0.3536f,		0.52391875f, 0.875f,		//19
-		0.2706f, 0.9239f, 0.2706f,		0.5478375f, 0.875f,			//20
-		0.3536f, 0.9239f, 0.1464f,		0.57175625f, 0.875f,		//21
-		0.3827f, 0.9239f, 0.0f,			0.5956755f, 0.875f,			//22
-		0.3536f, 0.9239f, -0.1464f,		0.61959425f, 0.875f,		//23
-		0.2706f, 0.9239f, -0.2706f,		0.643513f, 0.875f,			//24
-		0.1464f, 0.9239f, -0.3536f,		0.66743175f, 0.875f,		//25
-		0.0f, 0.9239f, -0.3827f,		0.6913505f, 0.875f,			//26 - seam
-		0.0f, 0.9239f, -0.3827f,		0.3086495f, 0.875f,			//27 - seam
-		-0.1464f, 0.9239f, -0.3536f,	0.33256825f, 0.875f,		//28
-		-0.2706f, 0.9239f, -0.2706f,	0.356487f, 0.875f,			//29
-		-0.3536f, 0.9239f, -0.1464f,	0.38040575f, 0.875f,		//30
-		-0.3827f, 0.9239f, 0.0f,		0.4043245f, 0.875f,			//31
-		-0.3536f, 0.9239f, 0.1464f,		0.42824325f, 0.875f,		//32
-		-0.2706f, 0.9239f, 0.2706f,		0.452162f, 0.875f,			//33
-		-0.1464f, 0.9239f, 0.3536f,		0.47608075f, 0.875f,		//34
-		// ring 3
-		0.0f, 0.8315f, 0.5556f,			0.5f, 0.8125f,				//35
-		0.2126f, 0.8315f, 0.5133f,		0.534725f, 0.8125f,			//36
-		0.3928f, 0.8315f, 0.3928f,		0.56945f, 0.8125f,			//37
-		0.5133f, 0.8315f, 0.2126f,		0.604175f, 0.8125f,			//38
-		0.5556f, 0.8315f, 0.0f,			0.6389f, 0.8125f,			//39
-		0.5133f, 0.8315f, -0.2126f,		0.673625f, 0.8125f,			//40
-		0.3928f, 0.8315f, -0.3928f,		0.70835f, 0.8125f,			//41
-		0.2126f, 0.8315f, -0.5133f,		0.743075f, 0.8125f,			//42
-		0.0f, 0.8315f, -0.5556f,		0.7778f, 0.8125f,			//43 - seam
-		0.0f, 0.8315f, -0.5556f,		0.2222f, 0.8125f,			//44 - seam
-		-0.2126f, 0.8315f, -0.5133f,	0.256925f, 0.8125f,			//45
-		-0.3928f, 0.8315f, -0.3928f,	0.29165f, 0.8125f,			//46
-		-0.5133f, 0.8315f, -0.2126f,	0.326375f, 0.8125f,			//47
-		-0.5556f, 0.8315f, 0.0f,		0.3611f, 0.8125f,			//48
-		-0.5133f, 0.8315f, 0.2126f,		0.395825f, 0.8125f,			//49
-		-0.3928f, 0.8315f, 0.3928f,		0.43055f, 0.8125f,			//50
-		-0.2126f, 0.8315f, 0.5133f,		0.465275f, 0.8125f,			//51
-		// ring 4
-		0.0f, 0.7071f, 0.7071f,			0.5f, 0.75f,				//52
-		0.2706f, 0.7071f, 0.6533f,		0.54419375f, 0.75f,			//53
-		0.5f, 0.7071f, 0.5f,			0.5883875f, 0.75f,			//54
-		0.6533f, 0.7071f, 0.2706f,		0.63258125f, 0.75f,			//55
-		0.7071f, 0.7071f, 0.0f,			0.676775f, 0.75f,			//56
-		0.6533f, 0.7071f, -0.2706f,		0.72096875f, 0.75f,			//57
-		0.5f, 0.7071f, -0.5f,			0.7651625f, 0.75f,			//58
-		0.2706f, 0.7071f, -0.6533f,		0.80935625f, 0.75f,			//59
-		0.0f, 0.7071f, -0.7071f,		0.85355f, 0.75f,			//60 - seam
-		0.0f, 0.7071f, -0.7071f,		0.14645f, 0.75f,			//61 - seam
-		-0.2706f, 0.7071f, -0.6533f,	0.19064375f, 0.75f,			//62
-		-0.5f, 0.7071f, -0.5f,			0.2348375f, 0.75f,			//63
-		-0.6533f, 0.7071f, -0.2706f,	0.27903135f, 0.75f,			//64
-		-0.7071f, 0.7071f, 0.0f,		0.323225f, 0.75f,			//65
-		-0.6533f, 0.7071f, 0.2706f,		0.36741875f, 0.75f,			//66
-		-0.5f, 0.7071f, 0.5f,			0.4116125f, 0.75f,			//67
-		-0.2706f, 0.7071f, 0.6533f,		0.45580625f, 0.75f,			//68
-		// ring 5
-		0.0f, 0.5556f, 0.8315f,			0.5f, 0.6875f,				//69
-		0.3182f, 0.5556f, 0.7682f,		0.55196875f, 0.6875f,		//70
-		0.5879f, 0.5556f, 0.5879f,		0.6039375f, 0.6875f,		//71
-		0.7682f, 0.5556f, 0.3182f,		0.65590625f, 0.6875f,		//72
-		0.8315f, 0.5556f, 0.0f,			0.707875f, 0.6875f,			//73
-		0.7682f, 0.5556f, -0.3182f,		0.75984375f, 0.6875f,		//74
-		0.5879f, 0.5556f, -0.5879f,		0.8118125f, 0.6875f,		//75
-		0.3182f, 0.5556f, -0.7682f,		0.86378125f, 0.6875f,		//76
-		0.0f, 0.5556f, -0.8315f,		0.91575f, 0.6875f,			//77 - seam
-		0.0f, 0.5556f, -0.8315f,		0.08425f, 0.6875f,			//78 - seam
-		-0.3182f, 0.5556f, -0.7682f,	0.13621875f, 0.6875f,		//79
-		-0.5879f, 0.5556f, -0.5879f,	0.1881875f, 0.6875f,		//80
-		-0.7682f, 0.5556f, -0.3182f,	0.24015625f, 0.6875f,		//81
-		-0.8315f, 0.5556f, 0.0f,		0.292125f, 0.6875f,			//82
-		-0.7682f, 0.5556f, 0.3182f,		0.34409375f, 0.6875f,		//83
-		-0.5879f, 0.5556f, 0.5879f,		0.3960625f, 0.6875f,		//84
-		-0.3182f, 0.5556f, 0.7682f,		0.44803125f, 0.6875f,		//85
-		//ring 6
-		0.0f, 0.3827f, 0.9239f,			0.5f, 0.625f,				//86
-		0.3536f, 0.3827f, 0.8536f,		0.55774375f, 0.625f,		//87
-		0.6533f, 0.3827f, 0.6533f,		0.6154875f, 0.625f,			//88
-		0.8536f, 0.3827f, 0.3536f,		0.67323125f, 0.625f,		//89
-		0.9239f, 0.3827f, 0.0f,			0.730975f, 0.625f,			//90
-		0.8536f, 0.3827f, -0.3536f,		0.78871875f, 0.625f,		//91
-		0.6533f, 0.3827f, -0.6533f,		0.8464625f, 0.625f,			//92
-		0.3536f, 0.3827f, -0.8536f,		0.90420625f, 0.625f,		//93
-		0.0f, 0.3827f, -0.9239f,		0.96195f, 0.625f,			//94 - seam
-		0.0f, 0.3827f, -0.9239f,		0.03805f, 0.625f,			//95 - seam
-		-0.3536f, 0.3827f, -0.8536f,	0.09579375f, 0.625f,		//96
-		-0.6533f, 0.3827f, -0.6533f,	0.1535375f, 0.625f,			//97
-		-0.8536f, 0.3827f, -0.3536f,	0.21128125f, 0.625f,		//98
-		-0.9239f, 0.3827f, 0.0f,		0.269025f, 0.625f,			//99
-		-0.8536f, 0.3827f, 0.3536f,		0.32676875f, 0.625f,		//100
-		-0.6533f, 0.3827f, 0.6533f,		0.3845125f, 0.625f,			//101
-		-0.3536f, 0.3827f, 0.8536f,		0.44225625f, 0.625f,		//102
-		// ring 7
-		0.0f, 0.1951f, 0.9808f,			0.5f, 0.5625f,				//103
-		0.3753f, 0.1915f, 0.9061f,		0.5613f, 0.5625f,			//104
-		0.6935f, 0.1915f, 0.6935f,		0.6226f, 0.5625f,			//105
-		0.9061f, 0.1915f, 0.3753f,		0.6839f, 0.5625f,			//106
-		0.9808f, 0.1915f, 0.0f,			0.7452f, 0.5625f,			//107
-		0.9061f, 0.1915f, -0.3753f,		0.8065f, 0.5625f,			//108
-		0.6935f, 0.1915f, -0.6935f,		0.8678f, 0.5625f,			//109
-		0.3753f, 0.1915f, -0.9061f,		0.9291f, 0.5625f,			//110
-		0.0f, 0.1915f, -0.9808f,		0.9904f, 0.5625f,			//111 - seam
-		0.0f, 0.1915f, -0.9808f,		0.0096f, 0.5625f,			//112 - seam
-		-0.3753f, 0.1915f, -0.9061f,	0.0709f, 0.5625f,			//113
-		-0.6935f, 0.1915f, -0.6935f,	0.1322f, 0.5625f,			//114
-		-0.9061f, 0.1915f, -0.3753f,	0.1935f, 0.5625f,			//115
-		-0.9808f, 0.1915f, 0.0f,		0.2548f, 0.5625f,			//116
-		-0.9061f, 0.1915f, 0.3753f,		0.3161f, 0.5625f,			//117
-		-0.6935f, 0.1915f, 0.6935f,		0.3774f, 0.5625f,			//118
-		-0.3753f, 0.1915f, 0.9061f,		0.4387f, 0.5625f,			//119
-		// ring 8
-		0.0f, 0.0f, 1.0f,				0.5f, 0.5f,					//120
-		0.3827f, 0.0f, 0.9239f,			0.5625f, 0.5f,				//121
-		0.7071f, 0.0f, 0.7071f,			0.625f, 0.5f,				//122
-		0.9239f, 0.0f, 0.3827f,			0.6875f, 0.5f,				//123
-		1.0f, 0.0f, 0.0f,				0.75f, 0.5f,				//124
-		0.9239f, 0.0f, -0.3827f,		0.8125f, 0.5f,				//125
-		0.7071f, 0.0f, -0.7071f,		0.875f, 0.5f,				//126
-		0.3827f, 0.0f, -0.9239f,		0.9375f, 0.5f,				//127
-		0.0f, 0.0f, -1.0f,				1.0f, 0.5f,					//128 - seam
-		0.0f, 0.0f, -1.0f, 				0.0f, 0.5f,					//129 - seam
-		-0.3827f, 0.0f, -0.9239f,		0.0625f, 0.5f,				//130
-		-0.7071f, 0.0f, -0.7071f,		0.125f, 0.5f,				//131
-		-0.9239f, 0.0f, -0.3827f,		0.1875f, 0.5f,				//132
-		-1.0f, 0.0f, 0.0f,				0.25f, 0.5f,				//133
-		-0.9239f, 0.0f, 0.3827f,		0.3125f, 0.5f,				//134
-		-0.7071, 0.0, 0.7071f,			0.375f, 0.5f,				//135
-		-0.3827f, 0.0f, 0.9239f,		0.4375f, 0.5f,				//136
-		// ring 9
-		0.0f, -0.1915f, 0.9808f,		0.5f, 0.4375f,				//137
-		0.3753f, -0.1915f, 0.9061f,		0.5613f, 0.4375f,			//138
-		0.6935f, -0.1915f, 0.6935f,		0.6226f, 0.4375f,			//139
-		0.9061f, -0.1915f, 0.3753f,		0.6839f, 0.4375f,			//140
-		0.9808f, -0.1915f, 0.0f,		0.7452f, 0.4375f,			//141
-		0.9061f, -0.1915f, -0.3753f,	0.8065f, 0.4375f,			//142
-		0.6935f, -0.1915f, -0.6935f,	0.8678f, 0.4375f,			//143
-		0.3753f, -0.1915f, -0.9061f,	0.9261f, 0.4375f,			//144
-		0.0f, -0.1915f, -0.9808f,		0.9904f, 0.4375f,			//145 - seam
-		0.0f, -0.1915f, -0.9808f,		0.0096f, 0.4375f,			//146 - seam
-		-0.3753f, -0.1915f, -0.9061f,	0.0709f, 0.4375f,			//147
-		-0.6935f, -0.1915f, -0.6935f,	0.1322f, 0.4375f,			//148
-		-0.9061f, -0.1915f, -0.3753f,	0.1935f, 0.4375f,			//149
-		-0.9808f, -0.1915f, 0.0f,		0.2548f, 0.4375f,			//150
-		-0.9061f, -0.1915f, 0.3753f,	0.3161f, 0.4375f,			//151
-		-0.6935f, -0.1915f, 0.6935f,	0.3774f, 0.4375f,			//152
-		-0.3753f, -0.1915f, 0.9061f,	0.4387f, 0.4375f,			//153
-		// ring 10
-		0.0f, -0.3827f, 0.9239f,		0.5f, 0.375f,				//154
-		0.3536f, -0.3827f, 0.8536f,		0.55774375f, 0.375f,		//155
-		0.6533f, -0.3827f, 0.6533f,		0.6154875f, 0.375f,			//156
-		0.8536f, -0.3827f, 0.3536f,		0.67323125f, 0.375f,		//157
-		0.9239f, -0.3827f, 0.0f,		0.730975f, 0.375f,			//158
-		0.8536f, -0.3827f, -0.3536f,	0.78871875f, 0.375f,		//159
-		0.6533f, -0.3827f, -0.6533f,	0.8464625f, 0.375f,			//160
-		0.3536f, -0.3827f, -0.8536f,	0.90420625f, 0.375f,		//161
-		0.0f, -0.3827f, -0.9239f,		0.96195f, 0.375f,			//162 - seam
-		0.0f, -0.3827f, -0.9239f,		0.03805f, 0.375f,			//163 - seam
-		-0.3536f, -0.3827f, -0.8536f,	0.09579375f, 0.375f,		//164
-		-0.6533f, -0.3827f, -0.6533f,	0.1535375f, 0.375f,			//165
-		-0.8536f, -0.3827f, -0.3536f,	0.21128125f, 0.375f,		//166
-		-0.9239f, -0.3827f, 0.0f,		0.269025f, 0.375f,			//167
-		-0.8536f, -0.3827f, 0.3536f,	0.32676875f, 0.375f,		//168
-		-0.6533f, -0.3827f, 0.6533f,	0.3845125f, 0.375f,			//169
-		-0.3536f, -0.3827f, 0.8536f,	0.44225625f, 0.375f,		//170
-		// ring 11
-		0.0f, -0.5556f, 0.8315f,		0.5f, 0.3125f,				//171
-		0.3182f, -0.5556f, 0.7682f,		0.55196875f, 0.3125f,		//172
-		0.5879f, -0.5556f, 0.5879f,		0.6039375f, 0.3125f,		//173
-		0.7682f, -0.5556f, 0.3182f,		0.65590625f, 0.3125f,		//174
-		0.8315f, -0.5556f, 0.0f,		0.707875f, 0.3125f,			//175
-		0.7682f, -0.5556f, -0.3182f,	0.75984375f, 0.3125f,		//176
-		0.5879f, -0.5556f, -0.5879f,	0.8118125f, 0.3125f,		//177
-		0.3182f, -0.5556f, -0.7682f,	0.86378125f, 0.3125f,		//178
-		0.0f, -0.5556f, -0.8315f,		0.91575f, 0.3125f,			//179 - seam
-		0.0f, -0.5556f, -0.8315f,		0.08425f, 0.3125f,			//180 - seam
-		-0.3182f, -0.5556f, -0.7682f,	0.13621875f, 0.3125f,		//181
-		-0.5879f, 0.5556f, -0.5879f,	0.1881875f, 0.3125f,		//182
-		-0.7682f, -0.5556f, -0.3182f,	0.24015625f, 0.3125f,		//183
-		-0.8315f, -0.5556f, 0.0f,		0.292125f, 0.3125f,			//184
-		-0.7682f, -0.5556f, 0.3182f,	0.34409375f, 0.3125f,		//185
-		-0.5879f, -0.5556f, 0.5879f,	0.3960625f, 0.3125f,		//186
-		-0.3182f, -0.5556f, 0.7682f,	0.44803125f, 0.3125f,		//187
-		// ring 12
-		0.0f, -0.7071f, 0.7071f,		0.5f, 0.25f,				//188
-		0.2706f, -0.7071f, 0.6533f,		0.54419375f, 0.25f,			//189
-		0.5f, -0.7071f, 0.5f,			0.5883875f, 0.25f,			//190
-		0.6533f, -0.7071f, 0.2706f,		0.63258125f, 0.25f,			//191
-		0.7071f, -0.7071f, 0.0f,		0.676775f, 0.25f,			//192
-		0.6533f, -0.7071f, -0.2706f,	0.72096875f, 0.25f,			//193
-		0.5f, -0.7071f, -0.5f,			0.7651625f, 0.25f,			//194
-		0.2706f, -0.7071f, -0.6533f,	0.80935625f, 0.25f,			//195
-		0.0f, -0.7071f, -0.7071f,		0.85355f, 0.25f,			//196 - seam
-		0.0f, -0.7071f, -0.7071f,		0.14645f, 0.25f,			//197 - seam
-		-0.2706f, -0.7071f, -0.6533f,	0.19064375f, 0.25f,			//198
-		-0.5f, -0.7071f, -0.5f,			0.2348375f, 0.25f,			//199
-		-0.6533f, -0.7071f, -0.2706f,	0.27903135f, 0.25f,			//200
-		-0.7071f, -0.7071f, 0.0f,		0.323225f, 0.25f,			//201
-		-0.6533f, -0.7071f, 0.2706f,	0.36741875f, 0.25f,			//202
-		-0.5f, -0.7071f, 0.5f,			0.4116125f, 0.25f,			//203
-		-0.2706f, -0.7071f, 0.6533f,	0.45580625f, 0.25f,			//204
-		// ring 13
-		0.0f, -0.8315f, 0.5556f,		0.5f, 0.1875f,				//205
-		0.2126f, -0.8315f, 0.5133f,		0.534725f, 0.1875f,			//206
-		0.3928f, -0.8315f, 0.3928f,		0.56945f, 0.1875f,			//207
-		0.5133f, -0.8315f, 0.2126f,		0.604175f, 0.1875f,			//208
-		0.5556f, -0.8315f, 0.0f,		0.6389f, 0.1875f,			//209
-		0.5133f, -0.8315f, -0.2126f,	0.673625f, 0.1875f,			//210
-		0.3928f, -0.8315f, -0.3928f,	0.70835f, 0.1875f,			//211
-		0.2126f, -0.8315f, -0.5133f,	0.743075f, 0.1875f,			//212
-		0.0f, -0.8315f, -0.5556f,		0.7778f, 0.1875f,			//213 - seam
-		0.0f, -0.8315f, -0.5556f,		0.2222f, 0.1875f,			//214 - seam
-		-0.2126f, -0.8315f, -0.5133f,	0.256925f, 0.1875f,			//215
-		-0.3928f, -0.8315f, -0.3928f,	0.29165f, 0.1875f,			//216
-		-0.5133f, -0.8315f, -0.2126f,	0.326375f, 0.1875f,			//217
-		-0.5556f, -0.8315f, 0.0f,		0.3611f, 0.1875f,			//218
-		-0.5133f, -0.8315f, 0.2126f,	0.395825f, 0.1875f,			//219
-		-0.3928f, -0.8315f, 0.3928f,	0.43055f, 0.1875f,			//220
-		-0.2126f, -0.8315f, 0.5133f,	0.465275f, 0.1875f,			//221
-		// ring 14
-		0.0f, -0.9239f, 0.3827f,		0.5f, 0.125f,				//222
-		0.1464f, -0.9239f, 0.3536f,		0.52391875f, 0.125f,		//223
-		0.2706f, -0.9239f, 0.2706f,		0.5478375f, 0.125f,			//224
-		0.3536f, -0.9239f, 0.1464f,		0.57175625f, 0.125f,		//225
-		0.3827f, -0.9239f, 0.0f,		0.5956755f, 0.125f,			//226
-		0.3536f, -0.9239f, -0.1464f,	0.61959425f, 0.125f,		//227
-		0.2706f, -0.9239f, -0.2706f,	0.643513f, 0.125f,			//228
-		0.1464f, -0.9239f, -0.3536f,	0.66743175f, 0.125f,		//229
-		0.0f, -0.9239f, -0.3827f,		0.6913505f, 0.125f,			//230 - seam
-		0.0f, -0.9239f, -0.3827f,		0.3086495f, 0.125f,			//231 - seam
-		-0.1464f, -0.9239f, -0.3536f,	0.33256825f, 0.125f,		//232
-		-0.2706f, -0.9239f, -0.2706f,	0.356487f, 0.125f,			//233
-		-0.3536f, -0.9239f, -0.1464f,	0.38040575f, 0.125f,		//234
-		-0.3827f, -0.9239f, 0.0f,		0.4043245f, 0.125f,			//235
-		-0.3536f, -0.9239f, 0.1464f,	0.42824325f, 0.125f,		//236
-		-0.2706f, -0.9239f, 0.2706f,	0.452162f, 0.125f,			//237
-		-0.1464f, -0.9239f, 0.3536f,	0.47608075f, 0.125f,		//238
-		// ring 15
-		0.0f, -0.9808f, 0.1951f,		0.5f, 0.0625f,				//239
-		0.0747f, -0.9808f, 0.1802f,		0.51219375f, 0.0625f,		//240
-		0.1379f, -0.9808f, 0.1379f,		0.5243875f, 0.0625f,		//241
-		0.1802f, -0.9808f, 0.0747f,		0.53658125f, 0.0625f,		//242
-		0.1951f, -0.9808, 0.0f,			0.548775f, 0.0625f,			//243
-		0.1802f, -0.9808f, -0.0747f,	0.56096875f, 0.0625f,		//244
-		0.1379f, -0.9808f, -0.1379f,	0.5731625f, 0.0625f,		//245
-		0.0747f, -0.9808f, -0.1802f,	0.58535625f, 0.0625f,		//246
-		0.0f, -0.9808f, -0.1951f,		0.59755f, 0.0625f,			//247 - seam
-		0.0f, -0.9808f, -0.1951f,		0.40245f, 0.0625f,			//248 - seam
-		-0.0747f, -0.9808f, -0.1802f,	0.41464375f, 0.0625f,		//249
-		-0.1379f, -0.9808f, -0.1379f,	0.4268375f, 0.0625f,		//250
-		-0.1802f, -0.9808f, -0.0747f,	0.43903125f, 0.0625f,		//251
-		-0.1951f, -0.9808, 0.0f,		0.451225f, 0.0625f,			//252
-		-0.1802f, -0.9808f, 0.0747f,	0.46341875f, 0.0625f,		//253
-		-0.1379f, -0.9808f, 0.1379f,	0.4756125f, 0.0625f,		//254
-		-0.0747f, -0.9808f, 0.1802f,	0.48780625f, 0.0625f,		//255
-		// bottom center point
-		0.0f, -1.0f, 0.0f,				0.5f, 0.0f					//256
-	};
-
-	// index data
-	GLuint indices[] = {
-		//ring 1 - top
-		0,10,11,
-		0,11,12,
-		0,12,13,
-		0,13,14,
-		0,14,15,
-		0,15,16,
-		0,16,17,
-		0,17,1,
-		0,1,2,
-		0,2,3,
-		0,3,4,
-		0,4,5,
-		0,5,6,
-		0,6,7,
-		0,7,8,
-		0,8,9,
-		0,9,10,
-
-		// ring 1 to ring 2
-		10,27,28,
-		10,11,28,
-		11,28,29,
-		11,12,29,
-		12,29,30,
-		12,13,30,
-		13,30,31,
-		13,14,31,
-		14,31,32,
-		14,15,32,
-		15,32,33,
-		15,16,33,
-		16,33,34,
-		16,17,34,
-		17,34,18,
-		17,1,18,
-		1,18,19,
-		1,2,19,
-		2,19,20,
-		2,3,20,
-		3,20,21,
-		3,4,21,
-		4,21,22,
-		4,5,22,
-		5,22,23,
-		5,6,23,
-		6,23,24,
-		6,7,24,
-		7,24,25,
-		7,8,25,
-		8,25,26,
-		8,9,26,
-		9,26,27,
-		9,10,27,
-
-		// ring 2 to ring 3
-		27,44,45,
-		27,28,45,
-		28,45,46,
-		28,29,46,
-		29,46,47,
-		29,30,47,
-		30,47,48,
-		30,31,48,
-		31,48,49,
-		31,32,49,
-		32,49,50,
-		32,33,50,
-		33,50,51,
-		33,34,51,
-		34,51,35,
-		34,18,35,
-		18,35,36,
-		18,19,36,
-		19,36,37,
-		19,20,37,
-		20,37,38,
-		20,21,38,
-		21,38,39,
-		21,22,39,
-		22,39,40,
-		22,23,40,
-		23,40,41,
-		23,24,41,
-		24,41,42,
-		24,25,42,
-		25,42,43,
-		25,26,43,
-		26,43,44,
-		26,27,44,
-
-		// ring 3 to ring 4
-		44,61,62,
-		44,45,62,
-		45,62,63,
-		45,46,63,
-		46,63,64,
-		46,47,64,
-		47,64,65,
-		47,48,65,
-		48,65,66,
-		48,49,66,
-		49,66,67,
-		49,50,67,
-		50,67,68,
-		50,51,68,
-		51,68,52,
-		51,35,52,
-		35,52,53,
-		35,36,53,
-		36,53,54,
-		36,37,54,
-		37,54,55,
-		37,38,55,
-		38,55,56,
-		38,39,56,
-		39,56,57,
-		39,40,57,
-		40,57,58,
-		40,41,58,
-		41,58,59,
-		41,42,59,
-		42,59,60,
-		42,43,60,
-		43,60,61,
-		43,44,61,
-
-		// ring 4 to ring 5
-		61,78,79,
-		61,62,79,
-		62,79,80,
-		62,63,80,
-		63,80,81,
-		63,64,81,
-		64,81,82,
-		64,65,82,
-		65,82,83,
-		65,66,83,
-		66,83,84,
-		66,67,84,
-		67,84,85,
-		67,68,85,
-		68,85,69,
-		68,52,69,
-		52,69,70,
-		52,53,70,
-		53,70,71,
-		53,54,71,
-		54,71,72,
-		54,55,72,
-		55,72,73,
-		55,56,73,
-		56,73,74,
-		56,57,74,
-		57,74,75,
-		57,58,75,
-		58,75,76,
-		58,59,76,
-		59,76,77,
-		59,60,77,
-		60,77,78,
-		60,61,78,
-
-		// ring 5 to ring 6
-		78,95,96,
-		78,79,96,
-		79,96,97,
-		79,80,97,
-		80,97,98,
-		80,81,98,
-		81,98,99,
-		81,82,99,
-		82,99,100,
-		82,83,100,
-		83,100,101,
-		83,84,101,
-		84,101,102,
-		84,85,102,
-		85,102,86,
-		85,69,86,
-		69,86,87,
-		69,70,87,
-		70,87,88,
-		70,71,88,
-		71,88,89,
-		71,72,89,
-		72,89,90,
-		72,73,90,
-		73,90,91,
-		73,74,91,
-		74,91,92,
-		74,75,92,
-		75,92,93,
-		75,76,93,
-		76,93,94,
-		76,77,94,
-		77,94,95,
-		77,78,95,
-
-		// ring 6 to ring 7
-		95,112,113,
-		95,96,113,
-		96,113,114,
-		96,97,114,
-		97,114,115,
-		97,98,115,
-		98,115,116,
-		98,99,116,
-		99,116,117,
-		99,100,117,
-		100,117,118,
-		100,101,118,
-		101,118,119,
-		101,102,119,
-		102,119,103,
-		102,86,103,
-		86,103,104,
-		86,87,104,
-		87,104,105,
-		87,88,105,
-		88,105,106,
-		88,89,106,
-		89,106,107,
-		89,90,107,
-		90,107,108,
-		90,91,108,
-		91,108,109,
-		91,92,109,
-		92,109,110,
-		92,93,110,
-		93,110,111,
-		93,94,111,
-		94,111,112,
-		94,95,112,
-
-		// ring 7 to ring 8
-		112,129,130,
-		112,113,130,
-		113,130,131,
-		113,114,131,
-		114,131,132,
-		114,115,132,
-		115,132,133,
-		115,116,133,
-		116,133,134,
-		116,117,134,
-		117,134,135,
-		117,118,135,
-		118,135,136,
-		118,119,136,
-		119,136,120,
-		119,103,120,
-		103,120,121,
-		103,104,121,
-		104,121,122,
-		104,105,122,
-		105,122,123,
-		105,106,123,
-		106,123,124,
-		106,107,124,
-		107,124,125,
-		107,108,125,
-		108,125,126,
-		108,109,126,
-		109,126,127,
-		109,110,127,
-		110,127,128,
-		110,111,128,
-		111,128,129,
-		111,112,129,
-
-		// ring 8 to ring 9
-		129,146,147,
-		129,130,147,
-		130,147,148,
-		130,131,148,
-		131,148,149,
-		131,132,149,
-		132,149,150,
-		132,133,150,
-		133,150,151,
-		133,134,151,
-		134,151,152,
-		134,135,152,
-		135,152,153,
-		135,136,153,
-		136,153,137,
-		136,120,137,
-		120,137,138,
-		120,121,138,
-		121,138,139,
-		121,122,139,
-		122,139,140,
-		122,123,140,
-		123,140,141,
-		123,124,141,
-		124,141,142,
-		124,125,142,
-		125,142,143,
-		125,126,143,
-		126,143,144,
-		126,127,144,
-		127,144,145,
-		127,128,145,
-		128,145,146,
-		128,129,146,
-
-		// ring 9 to ring 10
-		146,163,164,
-		146,147,164,
-		147,164,165,
-		147,148,165,
-		148,165,166,
-		148,149,166,
-		149,166,167,
-		149,150,167,
-		150,167,168,
-		150,151,168,
-		151,168,169,
-		151,152,169,
-		152,169,170,
-		152,153,170,
-		153,170,154,
-		153,137,154,
-		137,154,155,
-		137,138,155,
-		138,155,156,
-		138,139,156,
-		139,156,157,
-		139,140,157,
-		140,157,158,
-		140,141,158,
-		141,158,159,
-		141,142,159,
-		142,159,160,
-		142,143,160,
-		143,160,161,
-		143,144,161,
-		144,161,162,
-		144,145,162,
-		145,162,163,
-		145,146,163,
-
-		// ring 10 to ring 11
-		163,180,181,
-		163,164,181,
-		164,181,182,
-		164,165,182,
-		165,182,183,
-		165,166,183,
-		166,183,184,
-		166,167,184,
-		167,184,185,
-		167,168,185,
-		168,185,186,
-		168,169,186,
-		169,186,187,
-		169,170,187,
-		170,187,171,
-		170,154,171,
-		154,171,172,
-		154,155,172,
-		155,172,173,
-		155,156,173,
-		156,173,174,
-		156,157,174,
-		157,174,175,
-		157,158,175,
-		158,175,176,
-		158,159,176,
-		159,176,177,
-		159,160,177,
-		160,177,178,
-		160,161,178,
-		161,178,179,
-		161,162,179,
-		162,179,180,
-		162,163,180,
-
-		// ring 11 to ring 12
-		180,197,198,
-		180,181,198,
-		181,198,199,
-		181,182,199,
-		182,199,200,
-		182,183,200,
-		183,200,201,
-		183,184,201,
-		184,201,202,
-		184,185,202,
-		185,202,203,
-		185,186,203,
-		186,203,204,
-		186,187,204,
-		187,204,188,
-		187,171,188,
-		171,188,189,
-		171,172,189,
-		172,189,190,
-		172,173,190,
-		173,190,191,
-		173,174,191,
-		174,191,192,
-		174,175,192,
-		175,192,193,
-		175,176,193,
-		176,193,194,
-		176,177,194,
-		177,194,195,
-		177,178,195,
-		178,195,196,
-		178,179,196,
-		179,196,197,
-		179,180,197,
-
-		// ring 12 to ring 13
-		197,214,215,
-		197,198,215,
-		198,215,216,
-		198,199,216,
-		199,216,217,
-		199,200,217,
-		200,217,218,
-		200,201,218,
-		201,218,219,
-		201,202,219,
-		202,219,220,
-		202,203,220,
-		203,220,221,
-		203,204,221,
-		204,221,205,
-		204,188,205,
-		188,205,206,
-		188,189,206,
-		189,206,207,
-		189,190,207,
-		190,207,208,
-		190,191,208,
-		191,208,209,
-		191,192,209,
-		192,209,210,
-		192,193,210,
-		193,210,211,
-		193,194,211,
-		194,211,212,
-		194,195,212,
-		195,212,213,
-		195,196,213,
-		196,213,214,
-		196,197,214,
-
-		// ring 13 to ring 14
-		214,231,232,
-		214,215,232,
-		215,232,233,
-		215,216,233,
-		216,233,234,
-		216,217,234,
-		217,234,235,
-		217,218,235,
-		218,235,236,
-		218,219,236,
-		219,236,237,
-		219,220,237,
-		220,237,238,
-		220,221,238,
-		221,238,222,
-		221,205,222,
-		205,222,223,
-		205,206,223,
-		206,223,224,
-		206,207,224,
-		207,224,225,
-		207,208,225,
-		208,225,226,
-		208,209,226,
-		209,226,227,
-		209,210,227,
-		210,227,228,
-		210,211,228,
-		211,228,229,
-		211,212,229,
-		212,229,230,
-		212,213,230,
-		213,230,231,
-		213,214,231,
-
-		// ring 14 to ring 15
-		231,248,249,
-		231,232,249,
-		232,249,250,
-		232,233,250,
-		233,250,251,
-		233,234,251,
-		234,251,252,
-		234,235,252,
-		235,252,253,
-		235,236,253,
-		236,253,254,
-		236,237,254,
-		237,254,255,
-		237,238,255,
-		238,255,239,
-		238,222,239,
-		222,239,240,
-		222,223,240,
-		223,240,241,
-		223,224,241,
-		224,241,242,
-		224,225,242,
-		225,242,243,
-		225,226,243,
-		226,243,244,
-		226,227,244,
-		227,244,245,
-		227,228,245,
-		228,245,246,
-		228,229,246,
-		229,246,247,
-		229,230,247,
-		230,247,248,
-		230,231,248,
-
-		// ring 15 - bottom
-		248,256,249,
-		249,256,250,
-		250,256,251,
-		251,256,252,
-		252,256,253,
-		253,256,254,
-		254,256,255,
-		255,256,239,
-		239,256,240,
-		240,256,241,
-		241,256,242,
-		242,256,243,
-		243,256,244,
-		244,256,245,
-		245,256,246,
-		246,256,247,
-		247,256,248
-	};
-
-	// total float values per each type
-	const GLuint floatsPerVertex = 3;
-	const GLuint floatsPerNormal = 3;
-	const GLuint floatsPerUV = 2;
-
-	// store vertex and index count
-	m_SphereMesh.nVertices = sizeof(verts) / (sizeof(verts[0]) * (floatsPerVertex));
-	m_SphereMesh.nIndices = sizeof(indices) / (sizeof(indices[0]));
-
-	glm::vec3 normal;
-	glm::vec3 vert;
-	glm::vec3 center(0.0f, 0.0f, 0.0f);
-	float u, v;
-	std::vector<GLfloat> combined_values;
-
-	// combine interleaved vertices, normals, and texture coords
-	for (int i = 0; i < sizeof(verts) / (sizeof(verts[0])); i += 5)
-	{
-		vert = glm::vec3(verts[i], verts[i + 1], verts[i + 2]);
-		normal = normalize(vert - center);
-		//u = atan2(normal.x, normal.z) / (2 * M_PI) + 0.5;
-		//v = normal.y * 0.5 + 0.5;
-		combined_values.push_back(vert.x);
-		combined_values.push_back(vert.y);
-		combined_values.push_back(vert.z);
-		combined_values.push_back(normal.x);
-		combined_values.push_back(normal.y);
-		combined_values.push_back(normal.z);
-		combined_values.push_back(verts[i + 3]);
-		combined_values.push_back(verts[i + 4]);
-	}
-
-	// Create VAO
-	glGenVertexArrays(1, &m_SphereMesh.vao); // we can also generate multiple VAOs or buffers at the same time
-	glBindVertexArray(m_SphereMesh.vao);
-
-	// Create VBOs
-	glGenBuffers(2, m_SphereMesh.vbos);
-	glBindBuffer(GL_ARRAY_BUFFER, m_SphereMesh.vbos[0]); // Activates the vertex buffer
-	glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * combined_values.size(), combined_values.data(), GL_STATIC_DRAW); // Sends vertex or coordinate data to the GPU
-
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_SphereMesh.vbos[1]); // Activates the index buffer
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
-
-	if (m_bMemoryLayoutDone == false)
-	{
-		SetShaderMemoryLayout();
-	}
+	// the half sphere draws the first half of the indices, so the
+	// halves are kept apart when the mesh is reordered
+	m_SphereMesh.parts[g_TopHalfPart].firstIndex = 0;
+	m_SphereMesh.parts[g_TopHalfPart].nIndices = g_SphereTable.nIndices / 2;
+	m_SphereMesh.parts[g_BottomHalfPart].firstIndex = g_SphereTable.nIndices / 2;
+	m_SphereMesh.parts[g_BottomHalfPart].nIndices = g_SphereTable.nIndices - (g_SphereTable.nIndices / 2);
+	m_SphereMesh.nParts = 2;
+
+	// append the mesh to the shared arena buffers
+	AddTableToArena(m_SphereMesh, g_SphereTable);
+
+	// the coarser levels for drawing at a distance
+	AddTableToArena(m_meshLevels[SPHERE_MESH][0], g_SphereLevel1Table);
+	AddTableToArena(m_meshLevels[SPHERE_MESH][1], g_SphereLevel2Table);
+	AddTableToArena(m_meshLevels[SPHERE_MESH][2], g_SphereLevel3Table);
 }
 
 ///////////////////////////////////////////////////
@@ -1708,10 +896,12 @@ void ShapeMeshes::LoadSphereMesh()
 //  vertices and store it in a VAO/VBO.  The normals 
 //  and texture coordinates are also set.
 //
-//  Correct triangle drawing commands:
+//  The vertex data is laid out for these drawing
+//  commands, and converted into indexed triangles
+//  when it is loaded:
 //
 //	glDrawArrays(GL_TRIANGLE_FAN, 0, 36);		//bottom
-//	glDrawArrays(GL_TRIANGLE_FAN, 36, 72);		//top
+//	glDrawArrays(GL_TRIANGLE_FAN, 36, 36);		//top
 //	glDrawArrays(GL_TRIANGLE_STRIP, 72, 146);	//sides
 ///////////////////////////////////////////////////
 void ShapeMeshes::LoadTaperedCylinderMesh()
@@ -1944,244 +1134,130 @@ void ShapeMeshes::LoadTaperedCylinderMesh()
 
 	// store vertex and index count
 	m_TaperedCylinderMesh.nVertices = sizeof(verts) / (sizeof(verts[0]) * (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV));
-	m_TaperedCylinderMesh.nIndices = 0;
-
-	// Create VAO
-	glGenVertexArrays(1, &m_TaperedCylinderMesh.vao); // we can also generate multiple VAOs or buffers at the same time
-	glBindVertexArray(m_TaperedCylinderMesh.vao);
 
-	// Create VBO
-	glGenBuffers(1, m_TaperedCylinderMesh.vbos);
-	glBindBuffer(GL_ARRAY_BUFFER, m_TaperedCylinderMesh.vbos[0]); // Activates the buffer
-	glBufferData(GL_ARRAY_BUFFER, sizeof(verts), verts, GL_STATIC_DRAW); // Sends vertex or coordinate data to the GPU
+	// convert the vertex data into indexed triangles in the
+	// shared arena buffers
+	const MESH_PART parts[] = {
+		{ GL_TRIANGLE_FAN, 0, 36 },		//bottom
+		{ GL_TRIANGLE_FAN, 36, 36 },		//top
+		{ GL_TRIANGLE_STRIP, 72, 146 },	//sides
+	};
+	AddPartsToArena(m_TaperedCylinderMesh, verts, parts, sizeof(parts) / sizeof(parts[0]));
 
-	if (m_bMemoryLayoutDone == false)
+	// generate the coarser levels for drawing at a distance
+	for (int level = 1; level < LOD_LEVEL_COUNT; level++)
 	{
-		SetShaderMemoryLayout();
+		AddCylinderLevel(m_meshLevels[TAPERED_CYLINDER_MESH][level - 1], g_CylinderLevelSlices[level - 1], g_TaperedCylinderTopRadius);
 	}
 }
 
 ///////////////////////////////////////////////////
 //	LoadTorusMesh()
 //
-//	Create a torus mesh by specifying the vertices and 
-//  store it in a VAO/VBO.  The normals and texture
-//  coordinates are also set.
+//	Create a torus mesh by generating the vertices
+//  and indices of its grid of main and tube segments
+//  and store it in a VAO/VBO.  The normals and
+//  texture coordinates are also set.
 //
 //	Correct triangle drawing command:
 //
-//	glDrawArrays(GL_TRIANGLES, 0, meshes.gTorusMesh.nVertices);
+//	glDrawElements(GL_TRIANGLES, meshes.gTorusMesh.nIndices, GL_UNSIGNED_INT, (void*)0);
 ///////////////////////////////////////////////////
 void ShapeMeshes::LoadTorusMesh(float thickness)
 {
 	int _mainSegments = 30;
 	int _tubeSegments = 30;
-	float _mainRadius = 1.0f;
 	float _tubeRadius = .1f;
 
 	if (thickness <= 1.0)
 	{
 		_tubeRadius = thickness;
 	}
+	m_torusThickness = thickness;
 
-	auto mainSegmentAngleStep = glm::radians(360.0f / float(_mainSegments));
-	auto tubeSegmentAngleStep = glm::radians(360.0f / float(_tubeSegments));
-
-	std::vector<glm::vec3> vertex_list;
-	std::vector<std::vector<glm::vec3>> segments_list;
-	std::vector<glm::vec2> texture_coords;
-	glm::vec3 center(0.0f, 0.0f, 0.0f);
-	glm::vec3 normal;
-	glm::vec3 vertex;
-	glm::vec2 text_coord;
-
-	// generate the torus vertices
-	auto currentMainSegmentAngle = 0.0f;
-	for (auto i = 0; i < _mainSegments; i++)
-	{
-		// Calculate sine and cosine of main segment angle
-		auto sinMainSegment = sin(currentMainSegmentAngle);
-		auto cosMainSegment = cos(currentMainSegmentAngle);
-		auto currentTubeSegmentAngle = 0.0f;
-		std::vector<glm::vec3> segment_points;
-		for (auto j = 0; j < _tubeSegments; j++)
-		{
-			// Calculate sine and cosine of tube segment angle
-			auto sinTubeSegment = sin(currentTubeSegmentAngle);
-			auto cosTubeSegment = cos(currentTubeSegmentAngle);
-
-			// Calculate vertex position on the surface of torus
-			auto surfacePosition = glm::vec3(
-				(_mainRadius + _tubeRadius * cosTubeSegment) * cosMainSegment,
-				(_mainRadius + _tubeRadius * cosTubeSegment) * sinMainSegment,
-				_tubeRadius * sinTubeSegment);
-
-			//vertex_list.push_back(surfacePosition);
-			segment_points.push_back(surfacePosition);
+	AddTorusMesh(m_TorusMesh, _mainSegments, _tubeSegments, _tubeRadius);
 
-			// Update current tube angle
-			currentTubeSegmentAngle += tubeSegmentAngleStep;
-		}
-		segments_list.push_back(segment_points);
-		segment_points.clear();
-
-		// Update main segment angle
-		currentMainSegmentAngle += mainSegmentAngleStep;
+	// generate the coarser levels for drawing at a distance
+	for (int level = 1; level < LOD_LEVEL_COUNT; level++)
+	{
+		AddTorusMesh(m_meshLevels[TORUS_MESH][level - 1], g_TorusLevelMainSegments[level - 1], g_TorusLevelTubeSegments[level - 1], _tubeRadius);
 	}
+}
 
-	float horizontalStep = 1.0 / _mainSegments;
-	float verticalStep = 1.0 / _tubeSegments;
-	float u = 0.0;
-	float v = 0.0;
+///////////////////////////////////////////////////
+//	LoadMeshes()
+//
+//	Generate the listed meshes along with their
+//  levels on the worker threads of the job system,
+//  one job per mesh.  The generated data comes back
+//  through the upload queue, and this thread uploads
+//  each mesh as soon as it is ready, while the
+//  workers go on with the others.  With no upload
+//  ready this thread generates a queued mesh itself,
+//  so the meshes are not held up by workers busy with
+//  other work.  The meshes must not be drawn from
+//  another thread meanwhile.
+///////////////////////////////////////////////////
+void ShapeMeshes::LoadMeshes(
+	const MESH_ID* pMeshIDs, int meshCount, JobSystem& jobSystem)
+{
+	bool bRequested[MESH_COUNT] = {};
+	int jobsLeft = 0;
 
-	// connect the various segments together, forming triangles
-	for (int i = 0; i < _mainSegments; i++)
+	m_bQueueUploads = true;
+	for (int i = 0; i < meshCount; i++)
 	{
-		for (int j = 0; j < _tubeSegments; j++)
+		MESH_ID meshID = pMeshIDs[i];
+		// two jobs must never generate the same mesh
+		if ((meshID < 0) || (meshID >= MESH_COUNT) || (bRequested[meshID] == true))
 		{
-			if (((i + 1) < _mainSegments) && ((j + 1) < _tubeSegments))
-			{
-				vertex_list.push_back(segments_list[i][j]);
-				texture_coords.push_back(glm::vec2(u, v));
-				vertex_list.push_back(segments_list[i][j + 1]);
-				texture_coords.push_back(glm::vec2(u, v + verticalStep));
-				vertex_list.push_back(segments_list[i + 1][j + 1]);
-				texture_coords.push_back(glm::vec2(u + horizontalStep, v + verticalStep));
-				vertex_list.push_back(segments_list[i][j]);
-				texture_coords.push_back(glm::vec2(u, v));
-				vertex_list.push_back(segments_list[i + 1][j]);
-				texture_coords.push_back(glm::vec2(u + horizontalStep, v));
-				vertex_list.push_back(segments_list[i + 1][j + 1]);
-				texture_coords.push_back(glm::vec2(u + horizontalStep, v - verticalStep));
-				vertex_list.push_back(segments_list[i][j]);
-				texture_coords.push_back(glm::vec2(u, v));
-			}
-			else
-			{
-				if (((i + 1) == _mainSegments) && ((j + 1) == _tubeSegments))
-				{
-					vertex_list.push_back(segments_list[i][j]);
-					texture_coords.push_back(glm::vec2(u, v));
-					vertex_list.push_back(segments_list[i][0]);
-					texture_coords.push_back(glm::vec2(u, 0));
-					vertex_list.push_back(segments_list[0][0]);
-					texture_coords.push_back(glm::vec2(0, 0));
-					vertex_list.push_back(segments_list[i][j]);
-					texture_coords.push_back(glm::vec2(u, v));
-					vertex_list.push_back(segments_list[0][j]);
-					texture_coords.push_back(glm::vec2(0, v));
-					vertex_list.push_back(segments_list[0][0]);
-					texture_coords.push_back(glm::vec2(0, 0));
-					vertex_list.push_back(segments_list[i][j]);
-					texture_coords.push_back(glm::vec2(u, v));
-				}
-				else if ((i + 1) == _mainSegments)
-				{
-					vertex_list.push_back(segments_list[i][j]);
-					texture_coords.push_back(glm::vec2(u, v));
-					vertex_list.push_back(segments_list[i][j + 1]);
-					texture_coords.push_back(glm::vec2(u, v + verticalStep));
-					vertex_list.push_back(segments_list[0][j + 1]);
-					texture_coords.push_back(glm::vec2(0, v + verticalStep));
-					vertex_list.push_back(segments_list[i][j]);
-					texture_coords.push_back(glm::vec2(u, v));
-					vertex_list.push_back(segments_list[0][j]);
-					texture_coords.push_back(glm::vec2(0, v));
-					vertex_list.push_back(segments_list[0][j + 1]);
-					texture_coords.push_back(glm::vec2(0, v + verticalStep));
-					vertex_list.push_back(segments_list[i][j]);
-					texture_coords.push_back(glm::vec2(u, v));
-				}
-				else if ((j + 1) == _tubeSegments)
-				{
-					vertex_list.push_back(segments_list[i][j]);
-					texture_coords.push_back(glm::vec2(u, v));
-					vertex_list.push_back(segments_list[i][0]);
-					texture_coords.push_back(glm::vec2(u, 0));
-					vertex_list.push_back(segments_list[i + 1][0]);
-					texture_coords.push_back(glm::vec2(u + horizontalStep, 0));
-					vertex_list.push_back(segments_list[i][j]);
-					texture_coords.push_back(glm::vec2(u, v));
-					vertex_list.push_back(segments_list[i + 1][j]);
-					texture_coords.push_back(glm::vec2(u + horizontalStep, v));
-					vertex_list.push_back(segments_list[i + 1][0]);
-					texture_coords.push_back(glm::vec2(u + horizontalStep, 0));
-					vertex_list.push_back(segments_list[i][j]);
-					texture_coords.push_back(glm::vec2(u, v));
-				}
-
-			}
-			v += verticalStep;
+			continue;
 		}
-		v = 0.0;
-		u += horizontalStep;
-	}
+		bRequested[meshID] = true;
+		jobsLeft++;
 
-	std::vector<GLfloat> combined_values;
+		jobSystem.Submit([this, meshID]()
+		{
+			LoadMesh(meshID);
+			PENDING_UPLOAD finished;
+			finished.pMesh = NULL;
+			QueueUpload(finished);
+		});
+	}
 
-	// combine interleaved vertices, normals, and texture coords
-	for (int i = 0; i < vertex_list.size(); i++)
+	while (jobsLeft > 0)
 	{
-		vertex = vertex_list[i];
-		normal = normalize(vertex);
-		if (vertex.x < 0)
-		{
-			if (normal.x > 0)
-				normal.x *= -1;
-		}
-		else if (vertex.x > 0)
+		bool bUploadReady = false;
 		{
-			if (normal.x < 0)
-				normal.x *= -1;
+			std::lock_guard<std::mutex> lock(m_uploadMutex);
+			bUploadReady = (m_pendingUploads.empty() == false);
 		}
-		if (vertex.y < 0)
+		if ((bUploadReady == false) && (jobSystem.RunQueuedJob() == true))
 		{
-			if (normal.y > 0)
-				normal.y *= -1;
+			continue;
 		}
-		else if (vertex.y > 0)
+
+		PENDING_UPLOAD upload;
 		{
-			if (normal.y < 0)
-				normal.y *= -1;
+			std::unique_lock<std::mutex> lock(m_uploadMutex);
+			m_uploadQueued.wait(lock, [this]() { return(m_pendingUploads.empty() == false); });
+			upload.pMesh = m_pendingUploads.front().pMesh;
+			upload.vertices.swap(m_pendingUploads.front().vertices);
+			upload.packedVertices.swap(m_pendingUploads.front().packedVertices);
+			upload.indices.swap(m_pendingUploads.front().indices);
+			m_pendingUploads.pop_front();
 		}
-		if (vertex.z < 0)
+
+		if (NULL == upload.pMesh)
 		{
-			if (normal.z > 0)
-				normal.z *= -1;
+			jobsLeft--;
 		}
-		else if (vertex.z > 0)
+		else
 		{
-			if (normal.z < 0)
-				normal.z *= -1;
+			UploadMesh(upload);
 		}
-		text_coord = texture_coords[i];
-		combined_values.push_back(vertex.x);
-		combined_values.push_back(vertex.y);
-		combined_values.push_back(vertex.z);
-		combined_values.push_back(normal.x);
-		combined_values.push_back(normal.y);
-		combined_values.push_back(normal.z);
-		combined_values.push_back(text_coord.x);
-		combined_values.push_back(text_coord.y);
-	}
-
-	// store vertex and index count
-	m_TorusMesh.nVertices = vertex_list.size();
-	m_TorusMesh.nIndices = 0;
-
-	// Create VAO
-	glGenVertexArrays(1, &m_TorusMesh.vao); // we can also generate multiple VAOs or buffers at the same time
-	glBindVertexArray(m_TorusMesh.vao);
-
-	// Create VBOs
-	glGenBuffers(1, m_TorusMesh.vbos);
-	glBindBuffer(GL_ARRAY_BUFFER, m_TorusMesh.vbos[0]); // Activates the buffer
-	glBufferData(GL_ARRAY_BUFFER, sizeof(GLfloat) * combined_values.size(), combined_values.data(), GL_STATIC_DRAW); // Sends vertex or coordinate data to the GPU
-
-	if (m_bMemoryLayoutDone == false)
-	{
-		SetShaderMemoryLayout();
 	}
+	m_bQueueUploads = false;
 }
 
 
@@ -2194,11 +1270,11 @@ void ShapeMeshes::LoadTorusMesh(float thickness)
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawBoxMesh()
 {
-	glBindVertexArray(m_BoxMesh.vao);
+	UseMesh(BOX_MESH);
 
-	glDrawElements(GL_TRIANGLES, m_BoxMesh.nIndices, GL_UNSIGNED_INT, (void*)0);
+	m_meshArena.Bind();
 
-	glBindVertexArray(0);
+	glDrawElementsBaseVertex(GL_TRIANGLES, m_BoxMesh.nIndices, GL_UNSIGNED_INT, (void*)(sizeof(GLuint) * m_BoxMesh.firstIndex), m_BoxMesh.baseVertex);
 }
 
 ///////////////////////////////////////////////////
@@ -2210,15 +1286,15 @@ void ShapeMeshes::DrawBoxMesh()
 void ShapeMeshes::DrawConeMesh(
 	bool bDrawBottom)
 {
-	glBindVertexArray(m_ConeMesh.vao);
+	UseMesh(CONE_MESH);
+
+	m_meshArena.Bind();
 
 	if (bDrawBottom == true)
 	{
-		glDrawArrays(GL_TRIANGLE_FAN, 0, 36);		//bottom
+		DrawMeshPart(m_ConeMesh, g_BottomPart);		//bottom
 	}
-	glDrawArrays(GL_TRIANGLE_STRIP, 36, 108);	//sides
-
-	glBindVertexArray(0);
+	DrawMeshPart(m_ConeMesh, g_ConeSidesPart);	//sides
 }
 
 ///////////////////////////////////////////////////
@@ -2232,22 +1308,22 @@ void ShapeMeshes::DrawCylinderMesh(
 	bool bDrawBottom,
 	bool bDrawSides)
 {
-	glBindVertexArray(m_CylinderMesh.vao);
+	UseMesh(CYLINDER_MESH);
+
+	m_meshArena.Bind();
 
 	if (bDrawBottom == true)
 	{
-		glDrawArrays(GL_TRIANGLE_FAN, 0, 36);	//bottom
+		DrawMeshPart(m_CylinderMesh, g_BottomPart);	//bottom
 	}
 	if (bDrawTop == true)
 	{
-		glDrawArrays(GL_TRIANGLE_FAN, 36, 36);	//top
+		DrawMeshPart(m_CylinderMesh, g_TopPart);	//top
 	}
 	if (bDrawSides == true)
 	{
-		glDrawArrays(GL_TRIANGLE_STRIP, 72, 146);	//sides
+		DrawMeshPart(m_CylinderMesh, g_CylinderSidesPart);	//sides
 	}
-
-	glBindVertexArray(0);
 }
 
 ///////////////////////////////////////////////////
@@ -2258,11 +1334,11 @@ void ShapeMeshes::DrawCylinderMesh(
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawPlaneMesh()
 {
-	glBindVertexArray(m_PlaneMesh.vao);
+	UseMesh(PLANE_MESH);
 
-	glDrawElements(GL_TRIANGLES, m_PlaneMesh.nIndices, GL_UNSIGNED_INT, (void*)0);
-	
-	glBindVertexArray(0);
+	m_meshArena.Bind();
+
+	glDrawElementsBaseVertex(GL_TRIANGLES, m_PlaneMesh.nIndices, GL_UNSIGNED_INT, (void*)(sizeof(GLuint) * m_PlaneMesh.firstIndex), m_PlaneMesh.baseVertex);
 }
 
 ///////////////////////////////////////////////////
@@ -2273,11 +1349,11 @@ void ShapeMeshes::DrawPlaneMesh()
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawPrismMesh()
 {
-	glBindVertexArray(m_PrismMesh.vao);
+	UseMesh(PRISM_MESH);
 
-	glDrawArrays(GL_TRIANGLE_STRIP, 0, m_PrismMesh.nVertices);
+	m_meshArena.Bind();
 
-	glBindVertexArray(0);
+	glDrawElementsBaseVertex(GL_TRIANGLES, m_PrismMesh.nIndices, GL_UNSIGNED_INT, (void*)(sizeof(GLuint) * m_PrismMesh.firstIndex), m_PrismMesh.baseVertex);
 }
 
 ///////////////////////////////////////////////////
@@ -2288,11 +1364,11 @@ void ShapeMeshes::DrawPrismMesh()
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawPyramid3Mesh()
 {
-	glBindVertexArray(m_Pyramid3Mesh.vao);
+	UseMesh(PYRAMID3_MESH);
 
-	glDrawArrays(GL_TRIANGLE_STRIP, 0, m_Pyramid3Mesh.nVertices);
+	m_meshArena.Bind();
 
-	glBindVertexArray(0);
+	glDrawElementsBaseVertex(GL_TRIANGLES, m_Pyramid3Mesh.nIndices, GL_UNSIGNED_INT, (void*)(sizeof(GLuint) * m_Pyramid3Mesh.firstIndex), m_Pyramid3Mesh.baseVertex);
 }
 
 ///////////////////////////////////////////////////
@@ -2303,11 +1379,11 @@ void ShapeMeshes::DrawPyramid3Mesh()
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawPyramid4Mesh()
 {
-	glBindVertexArray(m_Pyramid4Mesh.vao);
+	UseMesh(PYRAMID4_MESH);
 
-	glDrawArrays(GL_TRIANGLE_STRIP, 0, m_Pyramid4Mesh.nVertices);
+	m_meshArena.Bind();
 
-	glBindVertexArray(0);
+	glDrawElementsBaseVertex(GL_TRIANGLES, m_Pyramid4Mesh.nIndices, GL_UNSIGNED_INT, (void*)(sizeof(GLuint) * m_Pyramid4Mesh.firstIndex), m_Pyramid4Mesh.baseVertex);
 }
 
 ///////////////////////////////////////////////////
@@ -2318,11 +1394,11 @@ void ShapeMeshes::DrawPyramid4Mesh()
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawSphereMesh()
 {
-	glBindVertexArray(m_SphereMesh.vao);
+	UseMesh(SPHERE_MESH);
 
-	glDrawElements(GL_TRIANGLES, m_SphereMesh.nIndices, GL_UNSIGNED_INT, (void*)0);
+	m_meshArena.Bind();
 
-	glBindVertexArray(0);
+	glDrawElementsBaseVertex(GL_TRIANGLES, m_SphereMesh.nIndices, GL_UNSIGNED_INT, (void*)(sizeof(GLuint) * m_SphereMesh.firstIndex), m_SphereMesh.baseVertex);
 }
 
 ///////////////////////////////////////////////////
@@ -2333,11 +1409,11 @@ void ShapeMeshes::DrawSphereMesh()
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawHalfSphereMesh()
 {
-	glBindVertexArray(m_SphereMesh.vao);
+	UseMesh(SPHERE_MESH);
 
-	glDrawElements(GL_TRIANGLES, m_SphereMesh.nIndices/2, GL_UNSIGNED_INT, (void*)0);
+	m_meshArena.Bind();
 
-	glBindVertexArray(0);
+	DrawMeshPart(m_SphereMesh, g_TopHalfPart);
 }
 
 ///////////////////////////////////////////////////
@@ -2351,22 +1427,22 @@ void ShapeMeshes::DrawTaperedCylinderMesh(
 	bool bDrawBottom,
 	bool bDrawSides)
 {
-	glBindVertexArray(m_TaperedCylinderMesh.vao);
+	UseMesh(TAPERED_CYLINDER_MESH);
+
+	m_meshArena.Bind();
 
 	if (bDrawBottom == true)
 	{
-		glDrawArrays(GL_TRIANGLE_FAN, 0, 36);	//bottom
+		DrawMeshPart(m_TaperedCylinderMesh, g_BottomPart);	//bottom
 	}
 	if (bDrawTop == true)
 	{
-		glDrawArrays(GL_TRIANGLE_FAN, 36, 72);	//top
+		DrawMeshPart(m_TaperedCylinderMesh, g_TopPart);	//top
 	}
 	if (bDrawSides == true)
 	{
-		glDrawArrays(GL_TRIANGLE_STRIP, 72, 146);	//sides
+		DrawMeshPart(m_TaperedCylinderMesh, g_CylinderSidesPart);	//sides
 	}
-
-	glBindVertexArray(0);
 }
 
 ///////////////////////////////////////////////////
@@ -2377,11 +1453,11 @@ void ShapeMeshes::DrawTaperedCylinderMesh(
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawTorusMesh()
 {
-	glBindVertexArray(m_TorusMesh.vao);
+	UseMesh(TORUS_MESH);
 
-	glDrawArrays(GL_TRIANGLES, 0, m_TorusMesh.nVertices);
+	m_meshArena.Bind();
 
-	glBindVertexArray(0);
+	glDrawElementsBaseVertex(GL_TRIANGLES, m_TorusMesh.nIndices, GL_UNSIGNED_INT, (void*)(sizeof(GLuint) * m_TorusMesh.firstIndex), m_TorusMesh.baseVertex);
 }
 
 ///////////////////////////////////////////////////
@@ -2392,11 +1468,11 @@ void ShapeMeshes::DrawTorusMesh()
 ///////////////////////////////////////////////////
 void ShapeMeshes::DrawHalfTorusMesh()
 {
-	glBindVertexArray(m_TorusMesh.vao);
+	UseMesh(TORUS_MESH);
 
-	glDrawArrays(GL_TRIANGLES, 0, m_TorusMesh.nVertices/2);
+	m_meshArena.Bind();
 
-	glBindVertexArray(0);
+	DrawMeshPart(m_TorusMesh, g_FirstHalfPart);
 }
 
 glm::vec3 ShapeMeshes::CalculateTriangleNormal(glm::vec3 p0, glm::vec3 p1, glm::vec3 p2)
@@ -2427,21 +1503,1377 @@ glm::vec3 ShapeMeshes::CalculateTriangleNormal(glm::vec3 p0, glm::vec3 p1, glm::
 
 
 
-void ShapeMeshes::SetShaderMemoryLayout()
+///////////////////////////////////////////////////
+//	DrawMesh()
+//
+//	Draw the whole mesh with the given identifier.
+// 
+///////////////////////////////////////////////////
+void ShapeMeshes::DrawMesh(MESH_ID meshID)
+{
+	switch (meshID)
+	{
+	case BOX_MESH:
+		DrawBoxMesh();
+		break;
+	case CONE_MESH:
+		DrawConeMesh();
+		break;
+	case CYLINDER_MESH:
+		DrawCylinderMesh();
+		break;
+	case PLANE_MESH:
+		DrawPlaneMesh();
+		break;
+	case PRISM_MESH:
+		DrawPrismMesh();
+		break;
+	case PYRAMID3_MESH:
+		DrawPyramid3Mesh();
+		break;
+	case PYRAMID4_MESH:
+		DrawPyramid4Mesh();
+		break;
+	case SPHERE_MESH:
+		DrawSphereMesh();
+		break;
+	case TAPERED_CYLINDER_MESH:
+		DrawTaperedCylinderMesh();
+		break;
+	case TORUS_MESH:
+		DrawTorusMesh();
+		break;
+	default:
+		break;
+	}
+}
+
+///////////////////////////////////////////////////
+//	GetIndexedRange()
+//
+//	Get where the indices of the mesh are stored in
+//  the arena.  Meshes drawn with glDrawArrays have
+//  no index range.
+///////////////////////////////////////////////////
+bool ShapeMeshes::GetIndexedRange(MESH_ID meshID, INDEXED_RANGE& range) const
+{
+	const GLMesh* pMesh = GetMesh(meshID);
+	if ((NULL == pMesh) || (pMesh->nIndices == 0))
+	{
+		return(false);
+	}
+
+	range.nIndices = pMesh->nIndices;
+	range.firstIndex = pMesh->firstIndex;
+	range.baseVertex = pMesh->baseVertex;
+	return(true);
+}
+
+///////////////////////////////////////////////////
+//	SetMeshOptimization()
+//
+//	Choose how the meshes loaded afterwards are
+//  reordered.  Meshes already loaded keep their order.
+///////////////////////////////////////////////////
+void ShapeMeshes::SetMeshOptimization(bool bOptimize, bool bOptimizeOverdraw)
+{
+	m_bOptimizeMeshes = bOptimize;
+	m_meshOptimizer.SetOptimizeOverdraw(bOptimizeOverdraw);
+}
+
+///////////////////////////////////////////////////
+//	GetCacheStats()
+//
+//	Get the vertex cache use of an indexed mesh as
+//  it was generated and as it was uploaded.
+///////////////////////////////////////////////////
+bool ShapeMeshes::GetCacheStats(
+	MESH_ID meshID,
+	MeshOptimizer::CACHE_STATS& before,
+	MeshOptimizer::CACHE_STATS& after) const
+{
+	const GLMesh* pMesh = GetMesh(meshID);
+	if ((NULL == pMesh) || (pMesh->nIndices == 0))
+	{
+		return(false);
+	}
+
+	before = pMesh->cacheBefore;
+	after = pMesh->cacheAfter;
+	return(true);
+}
+
+///////////////////////////////////////////////////
+//	GetMeshlets()
+//
+//	Get the meshlets a mesh was split into when it
+//  was loaded.
+///////////////////////////////////////////////////
+bool ShapeMeshes::GetMeshlets(
+	MESH_ID meshID,
+	const MeshletBuilder::MESHLET*& pMeshlets,
+	GLuint& nMeshlets) const
+{
+	const GLMesh* pMesh = GetMesh(meshID);
+	if ((NULL == pMesh) || (pMesh->meshlets.empty() == true))
+	{
+		return(false);
+	}
+
+	pMeshlets = pMesh->meshlets.data();
+	nMeshlets = (GLuint)pMesh->meshlets.size();
+	return(true);
+}
+
+///////////////////////////////////////////////////
+//	GetPackingError()
+//
+//	Get the largest differences between the packed
+//  vertices of a mesh and its float vertices.
+///////////////////////////////////////////////////
+bool ShapeMeshes::GetPackingError(MESH_ID meshID, PACKING_ERROR& error) const
+{
+	const GLMesh* pMesh = GetMesh(meshID);
+	if ((NULL == pMesh) || (pMesh->packingError.checkedVertices == 0))
+	{
+		return(false);
+	}
+
+	error = pMesh->packingError;
+	return(true);
+}
+
+///////////////////////////////////////////////////
+//	GetMesh()
+//
+//	Find the mesh with the given identifier.
+// 
+///////////////////////////////////////////////////
+const ShapeMeshes::GLMesh* ShapeMeshes::GetMesh(MESH_ID meshID) const
+{
+	switch (meshID)
+	{
+	case BOX_MESH:
+		return(&m_BoxMesh);
+	case CONE_MESH:
+		return(&m_ConeMesh);
+	case CYLINDER_MESH:
+		return(&m_CylinderMesh);
+	case PLANE_MESH:
+		return(&m_PlaneMesh);
+	case PRISM_MESH:
+		return(&m_PrismMesh);
+	case PYRAMID3_MESH:
+		return(&m_Pyramid3Mesh);
+	case PYRAMID4_MESH:
+		return(&m_Pyramid4Mesh);
+	case SPHERE_MESH:
+		return(&m_SphereMesh);
+	case TAPERED_CYLINDER_MESH:
+		return(&m_TaperedCylinderMesh);
+	case TORUS_MESH:
+		return(&m_TorusMesh);
+	default:
+		return(NULL);
+	}
+}
+
+///////////////////////////////////////////////////
+//	GetMesh()
+//
+//	Find the mesh with the given identifier, for
+//  changing it.
+///////////////////////////////////////////////////
+ShapeMeshes::GLMesh* ShapeMeshes::GetMesh(MESH_ID meshID)
+{
+	return(const_cast<GLMesh*>(static_cast<const ShapeMeshes*>(this)->GetMesh(meshID)));
+}
+
+///////////////////////////////////////////////////
+//	LoadMesh()
+//
+//	Load the mesh with the given identifier.  The
+//  torus keeps the thickness it was last loaded
+//  with.
+///////////////////////////////////////////////////
+void ShapeMeshes::LoadMesh(MESH_ID meshID)
+{
+	switch (meshID)
+	{
+	case BOX_MESH:
+		LoadBoxMesh();
+		break;
+	case CONE_MESH:
+		LoadConeMesh();
+		break;
+	case CYLINDER_MESH:
+		LoadCylinderMesh();
+		break;
+	case PLANE_MESH:
+		LoadPlaneMesh();
+		break;
+	case PRISM_MESH:
+		LoadPrismMesh();
+		break;
+	case PYRAMID3_MESH:
+		LoadPyramid3Mesh();
+		break;
+	case PYRAMID4_MESH:
+		LoadPyramid4Mesh();
+		break;
+	case SPHERE_MESH:
+		LoadSphereMesh();
+		break;
+	case TAPERED_CYLINDER_MESH:
+		LoadTaperedCylinderMesh();
+		break;
+	case TORUS_MESH:
+		LoadTorusMesh(m_torusThickness);
+		break;
+	default:
+		break;
+	}
+}
+
+///////////////////////////////////////////////////
+//	UseMesh()
+//
+//	Load the mesh when it is not resident, and mark
+//  it as drawn in the current frame.
+///////////////////////////////////////////////////
+void ShapeMeshes::UseMesh(MESH_ID meshID)
+{
+	const GLMesh* pMesh = GetMesh(meshID);
+	if ((NULL != pMesh) && (pMesh->bResident == false))
+	{
+		LoadMesh(meshID);
+	}
+	MarkMeshUsed(meshID);
+}
+
+///////////////////////////////////////////////////
+//	PrefetchMesh()
+//
+//	Load the mesh ahead of its first draw.  A mesh
+//  that is prefetched counts as used in the current
+//  frame, so it is not evicted before it is drawn.
+///////////////////////////////////////////////////
+void ShapeMeshes::PrefetchMesh(MESH_ID meshID)
+{
+	UseMesh(meshID);
+}
+
+///////////////////////////////////////////////////
+//	IsMeshResident()
+//
+//	Check whether the mesh is loaded in the arena.
+///////////////////////////////////////////////////
+bool ShapeMeshes::IsMeshResident(MESH_ID meshID) const
+{
+	const GLMesh* pMesh = GetMesh(meshID);
+	return((NULL != pMesh) && (pMesh->bResident == true));
+}
+
+///////////////////////////////////////////////////
+//	MarkMeshUsed()
+//
+//	Remember that the mesh is drawn in the current
+//  frame.
+///////////////////////////////////////////////////
+void ShapeMeshes::MarkMeshUsed(MESH_ID meshID)
+{
+	if ((meshID >= 0) && (meshID < MESH_COUNT))
+	{
+		m_lastUsedFrame[meshID] = m_frameNumber;
+	}
+}
+
+///////////////////////////////////////////////////
+//	EvictUnusedMeshes()
+//
+//	Free the arena space of every resident mesh that
+//  was not used in the last unusedFrames frames.
+///////////////////////////////////////////////////
+int ShapeMeshes::EvictUnusedMeshes(GLuint unusedFrames)
+{
+	int evictedCount = 0;
+	for (int meshID = 0; meshID < MESH_COUNT; meshID++)
+	{
+		if ((IsMeshResident((MESH_ID)meshID) == true) &&
+			(m_frameNumber - m_lastUsedFrame[meshID] >= unusedFrames))
+		{
+			EvictMesh((MESH_ID)meshID);
+			evictedCount++;
+		}
+	}
+	return(evictedCount);
+}
+
+///////////////////////////////////////////////////
+//	EvictMesh()
+//
+//	Free the arena space of the mesh along with its
+//  tessellation levels.  The mesh is loaded again
+//  the next time it is drawn.
+///////////////////////////////////////////////////
+void ShapeMeshes::EvictMesh(MESH_ID meshID)
+{
+	GLMesh* pMesh = GetMesh(meshID);
+	if (NULL == pMesh)
+	{
+		return;
+	}
+
+	ReleaseMesh(*pMesh);
+	for (int level = 0; level < LOD_LEVEL_COUNT - 1; level++)
+	{
+		ReleaseMesh(m_meshLevels[meshID][level]);
+	}
+}
+
+///////////////////////////////////////////////////
+//	ReleaseMesh()
+//
+//	Give the arena space of one mesh back and leave
+//  the mesh empty apart from its bounds.
+///////////////////////////////////////////////////
+void ShapeMeshes::ReleaseMesh(GLMesh& mesh)
 {
-	// The following code defines the layout of the mesh data in memory - each mesh needs
-	// to have the same memory layout so that the data is retrieved properly by the shaders
+	if (mesh.bResident == true)
+	{
+		m_meshArena.RemoveMesh(mesh.arenaRange);
+	}
 
-	// Strides between vertex coordinates is 6 (x, y, z, r, g, b, a). A tightly packed stride is 0.
-	GLint stride = sizeof(float) * (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV);// The number of floats before each
+	// the bounds stay known for culling the mesh before it is
+	// loaded again
+	GLfloat boundingRadius = mesh.boundingRadius;
+	MESH_BOUNDS bounds = mesh.bounds;
+	bool bHasBounds = mesh.bHasBounds;
+	mesh = GLMesh();
+	mesh.boundingRadius = boundingRadius;
+	mesh.bounds = bounds;
+	mesh.bHasBounds = bHasBounds;
+}
 
-	// Create Vertex Attribute Pointers
-	glVertexAttribPointer(0, g_FloatsPerVertex, GL_FLOAT, GL_FALSE, stride, 0);
-	glEnableVertexAttribArray(0);
+///////////////////////////////////////////////////
+//	GetMeshLevel()
+//
+//	Find the mesh of the given tessellation level,
+//  or NULL when the level was not generated.
+///////////////////////////////////////////////////
+const ShapeMeshes::GLMesh* ShapeMeshes::GetMeshLevel(MESH_ID meshID, int level) const
+{
+	if (level == 0)
+	{
+		return(GetMesh(meshID));
+	}
+	if ((meshID < 0) || (meshID >= MESH_COUNT) || (level < 0) || (level >= LOD_LEVEL_COUNT))
+	{
+		return(NULL);
+	}
 
-	glVertexAttribPointer(1, g_FloatsPerNormal, GL_FLOAT, GL_FALSE, stride, (void*)(sizeof(float) * g_FloatsPerVertex));
-	glEnableVertexAttribArray(1);
+	const GLMesh* pMesh = &m_meshLevels[meshID][level - 1];
+	if (pMesh->nIndices == 0)
+	{
+		return(NULL);
+	}
+	return(pMesh);
+}
 
-	glVertexAttribPointer(2, g_FloatsPerUV, GL_FLOAT, GL_FALSE, stride, (void*)(sizeof(float) * (g_FloatsPerVertex + g_FloatsPerNormal)));
-	glEnableVertexAttribArray(2);
-}
\ No newline at end of file
+///////////////////////////////////////////////////
+//	GetLevelCount()
+//
+//	Get the number of tessellation levels the mesh
+//  can be drawn at, counting the loaded mesh.
+///////////////////////////////////////////////////
+int ShapeMeshes::GetLevelCount(MESH_ID meshID) const
+{
+	int levelCount = 1;
+	while ((levelCount < LOD_LEVEL_COUNT) && (NULL != GetMeshLevel(meshID, levelCount)))
+	{
+		levelCount++;
+	}
+	return(levelCount);
+}
+
+///////////////////////////////////////////////////
+//	GetLevelTriangleCount()
+//
+//	Get the number of triangles drawn for the whole
+//  mesh at the given tessellation level.
+///////////////////////////////////////////////////
+GLuint ShapeMeshes::GetLevelTriangleCount(MESH_ID meshID, int level) const
+{
+	const GLMesh* pMesh = GetMeshLevel(meshID, level);
+	if (NULL == pMesh)
+	{
+		return(0);
+	}
+
+	// meshes without indices are drawn as a triangle list
+	if (pMesh->nIndices == 0)
+	{
+		return(pMesh->nVertices / 3);
+	}
+	return(pMesh->nIndices / 3);
+}
+
+///////////////////////////////////////////////////
+//	GetBoundingRadius()
+//
+//	Get the radius of the sphere around the mesh
+//  origin that holds every vertex of the mesh.
+///////////////////////////////////////////////////
+GLfloat ShapeMeshes::GetBoundingRadius(MESH_ID meshID) const
+{
+	const GLMesh* pMesh = GetMesh(meshID);
+	if (NULL == pMesh)
+	{
+		return(0.0f);
+	}
+	return(pMesh->boundingRadius);
+}
+
+///////////////////////////////////////////////////
+//	GetMeshBounds()
+//
+//	Get the box and sphere around the vertices of
+//  the mesh, computed when it was generated.
+///////////////////////////////////////////////////
+bool ShapeMeshes::GetMeshBounds(MESH_ID meshID, MESH_BOUNDS& bounds) const
+{
+	const GLMesh* pMesh = GetMesh(meshID);
+	if ((NULL == pMesh) || (pMesh->bHasBounds == false))
+	{
+		return(false);
+	}
+
+	bounds = pMesh->bounds;
+	return(true);
+}
+
+///////////////////////////////////////////////////
+//	DrawMeshLevel()
+//
+//	Draw the whole mesh at the given tessellation
+//  level.  Level 0 is the loaded mesh, drawn by
+//  DrawMesh(), which also loads it when it is not
+//  resident - an evicted mesh has no levels, so it
+//  is drawn at level 0 until it is loaded again.
+///////////////////////////////////////////////////
+void ShapeMeshes::DrawMeshLevel(MESH_ID meshID, int level)
+{
+	const GLMesh* pMesh = GetMeshLevel(meshID, level);
+	if ((level == 0) || (NULL == pMesh))
+	{
+		DrawMesh(meshID);
+		return;
+	}
+
+	MarkMeshUsed(meshID);
+	m_meshArena.Bind();
+
+	glDrawElementsBaseVertex(GL_TRIANGLES, pMesh->nIndices, GL_UNSIGNED_INT, (void*)(sizeof(GLuint) * pMesh->firstIndex), pMesh->baseVertex);
+}
+
+///////////////////////////////////////////////////
+//	GetIndexedRange()
+//
+//	Get where the indices of the mesh at the given
+//  tessellation level are stored in the arena.
+///////////////////////////////////////////////////
+bool ShapeMeshes::GetIndexedRange(MESH_ID meshID, int level, INDEXED_RANGE& range) const
+{
+	const GLMesh* pMesh = GetMeshLevel(meshID, level);
+	if ((NULL == pMesh) || (pMesh->nIndices == 0))
+	{
+		return(false);
+	}
+
+	range.nIndices = pMesh->nIndices;
+	range.firstIndex = pMesh->firstIndex;
+	range.baseVertex = pMesh->baseVertex;
+	return(true);
+}
+
+///////////////////////////////////////////////////
+//	AddCylinderLevel()
+//
+//	Generate a cylinder from Y 0 to 1 with a bottom
+//  radius of 1 and the given top radius, made of
+//  the given number of slices.  The caps and the
+//  sides have their own vertices so the normals
+//  stay sharp at the rims.
+///////////////////////////////////////////////////
+void ShapeMeshes::AddCylinderLevel(
+	GLMesh& mesh, int slices, float topRadius)
+{
+	std::vector<GLfloat> vertices;
+	std::vector<GLuint> indices;
+	vertices.reserve((2 * (slices + 1) + 2 * (slices + 1)) * (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV));
+	indices.reserve(slices * 12);
+
+	auto addVertex = [&](glm::vec3 position, glm::vec3 normal, glm::vec2 uv)
+	{
+		vertices.push_back(position.x);
+		vertices.push_back(position.y);
+		vertices.push_back(position.z);
+		vertices.push_back(normal.x);
+		vertices.push_back(normal.y);
+		vertices.push_back(normal.z);
+		vertices.push_back(uv.x);
+		vertices.push_back(uv.y);
+	};
+
+	// the caps are a center vertex and a rim, facing down and up
+	for (int cap = 0; cap < 2; cap++)
+	{
+		float y = (float)cap;
+		float radius = (cap == 0) ? 1.0f : topRadius;
+		glm::vec3 normal(0.0f, (cap == 0) ? -1.0f : 1.0f, 0.0f);
+		GLuint center = (GLuint)(vertices.size() / (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV));
+
+		addVertex(glm::vec3(0.0f, y, 0.0f), normal, glm::vec2(0.5f, 0.5f));
+		for (int slice = 0; slice < slices; slice++)
+		{
+			float theta = (float)(2.0 * M_PI * slice / slices);
+			addVertex(glm::vec3(radius * cos(theta), y, radius * sin(theta)), normal,
+				glm::vec2(0.5f + 0.5f * cos(theta), 0.5f + 0.5f * sin(theta)));
+		}
+		for (int slice = 0; slice < slices; slice++)
+		{
+			GLuint rim = center + 1 + slice;
+			GLuint nextRim = center + 1 + ((slice + 1) % slices);
+			indices.push_back(center);
+			indices.push_back((cap == 0) ? rim : nextRim);
+			indices.push_back((cap == 0) ? nextRim : rim);
+		}
+	}
+
+	// the sides lean in by the difference of the radii
+	GLuint sides = (GLuint)(vertices.size() / (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV));
+	for (int slice = 0; slice <= slices; slice++)
+	{
+		float theta = (float)(2.0 * M_PI * slice / slices);
+		glm::vec3 normal = glm::normalize(glm::vec3(cos(theta), 1.0f - topRadius, sin(theta)));
+		float u = (float)slice / slices;
+		addVertex(glm::vec3(cos(theta), 0.0f, sin(theta)), normal, glm::vec2(u, 0.0f));
+		addVertex(glm::vec3(topRadius * cos(theta), 1.0f, topRadius * sin(theta)), normal, glm::vec2(u, 1.0f));
+	}
+	for (int slice = 0; slice < slices; slice++)
+	{
+		GLuint bottom = sides + slice * 2;
+		GLuint top = bottom + 1;
+		indices.push_back(bottom);
+		indices.push_back(top);
+		indices.push_back(bottom + 2);
+		indices.push_back(bottom + 2);
+		indices.push_back(top);
+		indices.push_back(top + 2);
+	}
+
+	mesh.nVertices = (GLuint)(vertices.size() / (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV));
+	mesh.nIndices = (GLuint)indices.size();
+	mesh.nParts = 0;
+	AddMeshToArena(mesh, std::move(vertices), std::move(indices));
+}
+
+///////////////////////////////////////////////////
+//	AddTorusMesh()
+//
+//	Generate a torus around the Z axis with a main
+//  radius of 1 and the given tube radius, made of
+//  a grid of main and tube segments.  The vertices
+//  and indices are written in one pass into buffers
+//  sized up front.  The first row and column of the
+//  grid are repeated so the texture wraps cleanly at
+//  the seams, and the two halves of the torus are
+//  kept as mesh parts.
+///////////////////////////////////////////////////
+void ShapeMeshes::AddTorusMesh(
+	GLMesh& mesh, int mainSegments, int tubeSegments, float tubeRadius)
+{
+	const GLuint floatsPerMeshVertex = g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV;
+	const GLuint rowVertices = tubeSegments + 1;
+
+	std::vector<GLfloat> vertices((mainSegments + 1) * rowVertices * floatsPerMeshVertex);
+	std::vector<GLuint> indices(mainSegments * tubeSegments * 6);
+	GLfloat* pVertex = vertices.data();
+	GLuint* pIndex = indices.data();
+
+	for (int mainSegment = 0; mainSegment <= mainSegments; mainSegment++)
+	{
+		float theta = (float)(2.0 * M_PI * mainSegment / mainSegments);
+		float sinMainSegment = sin(theta);
+		float cosMainSegment = cos(theta);
+		for (int tubeSegment = 0; tubeSegment <= tubeSegments; tubeSegment++)
+		{
+			float phi = (float)(2.0 * M_PI * tubeSegment / tubeSegments);
+			glm::vec3 normal(cos(phi) * cosMainSegment, cos(phi) * sinMainSegment, sin(phi));
+			glm::vec3 position = glm::vec3(cosMainSegment, sinMainSegment, 0.0f) + tubeRadius * normal;
+			*pVertex++ = position.x;
+			*pVertex++ = position.y;
+			*pVertex++ = position.z;
+			*pVertex++ = normal.x;
+			*pVertex++ = normal.y;
+			*pVertex++ = normal.z;
+			*pVertex++ = (float)mainSegment / mainSegments;
+			*pVertex++ = (float)tubeSegment / tubeSegments;
+
+			// the quad between this vertex and the next row
+			if ((mainSegment < mainSegments) && (tubeSegment < tubeSegments))
+			{
+				GLuint current = mainSegment * rowVertices + tubeSegment;
+				GLuint next = current + rowVertices;
+				*pIndex++ = current;
+				*pIndex++ = next;
+				*pIndex++ = current + 1;
+				*pIndex++ = current + 1;
+				*pIndex++ = next;
+				*pIndex++ = next + 1;
+			}
+		}
+	}
+
+	mesh.nVertices = (mainSegments + 1) * rowVertices;
+	mesh.nIndices = (GLuint)indices.size();
+	// the quads are written one main segment at a time
+	mesh.parts[g_FirstHalfPart].firstIndex = 0;
+	mesh.parts[g_FirstHalfPart].nIndices = (mainSegments / 2) * tubeSegments * 6;
+	mesh.parts[g_SecondHalfPart].firstIndex = mesh.parts[g_FirstHalfPart].nIndices;
+	mesh.parts[g_SecondHalfPart].nIndices = mesh.nIndices - mesh.parts[g_FirstHalfPart].nIndices;
+	mesh.nParts = 2;
+	AddMeshToArena(mesh, std::move(vertices), std::move(indices));
+}
+
+///////////////////////////////////////////////////
+//	AddMeshToArena()
+//
+//	Append static mesh data to the shared arena
+//  buffers.  The data is copied once into vectors
+//  the arena code can reorder and hand on.
+///////////////////////////////////////////////////
+void ShapeMeshes::AddMeshToArena(
+	GLMesh& mesh, const GLfloat* pVertices, const GLuint* pIndices)
+{
+	const GLuint floatsPerMeshVertex = g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV;
+
+	std::vector<GLfloat> vertices(pVertices, pVertices + mesh.nVertices * floatsPerMeshVertex);
+	std::vector<GLuint> indices;
+	if (NULL != pIndices)
+	{
+		indices.assign(pIndices, pIndices + mesh.nIndices);
+	}
+	AddMeshToArena(mesh, std::move(vertices), std::move(indices));
+}
+
+///////////////////////////////////////////////////
+//	AddMeshToArena()
+//
+//	Append the vertices and indices of the mesh to
+//  the shared arena buffers and remember where they
+//  start.  The vectors are taken over, so generated
+//  data is not copied again on its way to the
+//  upload.  Indexed meshes are first reordered for
+//  the vertex cache, split into meshlets when they
+//  are built, and reordered for the vertex fetch,
+//  and the vertices are packed when the packed
+//  vertex format is used.  The data is uploaded at
+//  once, or queued for the GL thread when the mesh
+//  is generated on a worker thread.
+///////////////////////////////////////////////////
+void ShapeMeshes::AddMeshToArena(
+	GLMesh& mesh, std::vector<GLfloat>&& vertices, std::vector<GLuint>&& indices)
+{
+	const GLuint floatsPerMeshVertex = g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV;
+	const GLfloat* pVertices = vertices.data();
+
+	mesh.boundingRadius = 0.0f;
+	mesh.bounds.boxMin = glm::vec3(0.0f);
+	mesh.bounds.boxMax = glm::vec3(0.0f);
+	for (GLuint vertex = 0; vertex < mesh.nVertices; vertex++)
+	{
+		const GLfloat* pPosition = &pVertices[vertex * floatsPerMeshVertex];
+		glm::vec3 position(pPosition[0], pPosition[1], pPosition[2]);
+		mesh.boundingRadius = std::max(mesh.boundingRadius, glm::length(position));
+		mesh.bounds.boxMin = (vertex == 0) ? position : glm::min(mesh.bounds.boxMin, position);
+		mesh.bounds.boxMax = (vertex == 0) ? position : glm::max(mesh.bounds.boxMax, position);
+	}
+	// the sphere around the box center is tighter than the one
+	// around the origin for most shapes that sit on their base,
+	// but not for the cone, so the smaller one is kept
+	mesh.bounds.sphereCenter = (mesh.bounds.boxMin + mesh.bounds.boxMax) * 0.5f;
+	mesh.bounds.sphereRadius = 0.0f;
+	for (GLuint vertex = 0; vertex < mesh.nVertices; vertex++)
+	{
+		const GLfloat* pPosition = &pVertices[vertex * floatsPerMeshVertex];
+		mesh.bounds.sphereRadius = std::max(mesh.bounds.sphereRadius,
+			glm::length(glm::vec3(pPosition[0], pPosition[1], pPosition[2]) - mesh.bounds.sphereCenter));
+	}
+	if (mesh.boundingRadius < mesh.bounds.sphereRadius)
+	{
+		mesh.bounds.sphereCenter = glm::vec3(0.0f);
+		mesh.bounds.sphereRadius = mesh.boundingRadius;
+	}
+	mesh.bHasBounds = true;
+	if (indices.empty() == false)
+	{
+		mesh.cacheBefore = m_meshOptimizer.AnalyzeVertexCache(indices, mesh.nVertices);
+
+		if (m_bOptimizeMeshes == true)
+		{
+			// every part is reordered within its own range
+			if (mesh.nParts == 0)
+			{
+				m_meshOptimizer.OptimizeTriangles(indices, 0, mesh.nIndices, vertices, floatsPerMeshVertex);
+			}
+			for (GLuint part = 0; part < mesh.nParts; part++)
+			{
+				m_meshOptimizer.OptimizeTriangles(indices, mesh.parts[part].firstIndex, mesh.parts[part].nIndices, vertices, floatsPerMeshVertex);
+			}
+		}
+
+		// a mesh that fits in one meshlet gains nothing from the
+		// split, and the meshlets do not cross the parts
+		mesh.meshlets.clear();
+		if ((m_bBuildMeshlets == true) && (mesh.nIndices / 3 > MeshletBuilder::MAX_MESHLET_TRIANGLES))
+		{
+			if (mesh.nParts == 0)
+			{
+				m_meshletBuilder.BuildMeshlets(indices, 0, mesh.nIndices, vertices, floatsPerMeshVertex, mesh.meshlets);
+			}
+			for (GLuint part = 0; part < mesh.nParts; part++)
+			{
+				m_meshletBuilder.BuildMeshlets(indices, mesh.parts[part].firstIndex, mesh.parts[part].nIndices, vertices, floatsPerMeshVertex, mesh.meshlets);
+			}
+		}
+
+		if (m_bOptimizeMeshes == true)
+		{
+			m_meshOptimizer.OptimizeVertexFetch(vertices, indices, floatsPerMeshVertex);
+		}
+
+		mesh.cacheAfter = m_meshOptimizer.AnalyzeVertexCache(indices, mesh.nVertices);
+	}
+
+	PENDING_UPLOAD upload;
+	upload.pMesh = &mesh;
+	mesh.packingError = PACKING_ERROR();
+	if (m_vertexFormat == PACKED_VERTEX_FORMAT)
+	{
+		upload.packedVertices.resize(mesh.nVertices);
+		PackVertices(vertices, upload.packedVertices);
+		if (m_bValidatePacking == true)
+		{
+			ValidatePackedVertices(mesh, vertices, upload.packedVertices);
+		}
+	}
+	else
+	{
+		upload.vertices.swap(vertices);
+	}
+	upload.indices.swap(indices);
+
+	if (m_bQueueUploads == true)
+	{
+		QueueUpload(upload);
+	}
+	else
+	{
+		UploadMesh(upload);
+	}
+}
+
+///////////////////////////////////////////////////
+//	UploadMesh()
+//
+//	Append the generated vertices and indices of a
+//  mesh to the shared arena buffers and remember
+//  where they start.  A mesh that is loaded again
+//  replaces its old data, and a loaded mesh counts
+//  as used in the current frame.  The arena VAO
+//  keeps the memory layout when its buffers grow.
+///////////////////////////////////////////////////
+void ShapeMeshes::UploadMesh(PENDING_UPLOAD& upload)
+{
+	GLMesh& mesh = *upload.pMesh;
+	if (mesh.bResident == true)
+	{
+		m_meshArena.RemoveMesh(mesh.arenaRange);
+	}
+
+	MeshArena::MESH_RANGE range;
+	if (m_vertexFormat == PACKED_VERTEX_FORMAT)
+	{
+		range = m_meshArena.AddMesh(
+			upload.packedVertices.data(), mesh.nVertices, upload.indices.data(), mesh.nIndices);
+	}
+	else
+	{
+		range = m_meshArena.AddMesh(
+			upload.vertices.data(), mesh.nVertices, upload.indices.data(), mesh.nIndices);
+	}
+	mesh.baseVertex = range.baseVertex;
+	mesh.firstIndex = range.firstIndex;
+	mesh.arenaRange = range;
+	mesh.bResident = true;
+
+	for (int meshID = 0; meshID < MESH_COUNT; meshID++)
+	{
+		if (GetMesh((MESH_ID)meshID) == &mesh)
+		{
+			MarkMeshUsed((MESH_ID)meshID);
+		}
+	}
+
+	if (m_instanceBuffer == 0)
+	{
+		CreateInstanceBuffer();
+	}
+}
+
+///////////////////////////////////////////////////
+//	QueueUpload()
+//
+//	Hand the generated data of a mesh to the GL
+//  thread, which uploads it in LoadMeshes().
+///////////////////////////////////////////////////
+void ShapeMeshes::QueueUpload(PENDING_UPLOAD& upload)
+{
+	// notified under the lock, as LoadMeshes() may return as soon
+	// as it takes the last upload
+	std::lock_guard<std::mutex> lock(m_uploadMutex);
+	m_pendingUploads.push_back(PENDING_UPLOAD());
+	m_pendingUploads.back().pMesh = upload.pMesh;
+	m_pendingUploads.back().vertices.swap(upload.vertices);
+	m_pendingUploads.back().packedVertices.swap(upload.packedVertices);
+	m_pendingUploads.back().indices.swap(upload.indices);
+	m_uploadQueued.notify_one();
+}
+
+///////////////////////////////////////////////////
+//	PackVertices()
+//
+//	Convert float vertices into the packed vertex
+//  format.  The normals are normalized first, since
+//  their 10 bit components only reach from -1 to 1.
+///////////////////////////////////////////////////
+void ShapeMeshes::PackVertices(
+	const std::vector<GLfloat>& vertices,
+	std::vector<PACKED_VERTEX>& packedVertices)
+{
+	const GLuint floatsPerMeshVertex = g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV;
+
+	for (size_t vertex = 0; vertex < packedVertices.size(); vertex++)
+	{
+		const GLfloat* pVertex = &vertices[vertex * floatsPerMeshVertex];
+		PACKED_VERTEX& packed = packedVertices[vertex];
+
+		packed.position[0] = glm::packHalf1x16(pVertex[0]);
+		packed.position[1] = glm::packHalf1x16(pVertex[1]);
+		packed.position[2] = glm::packHalf1x16(pVertex[2]);
+		packed.position[3] = glm::packHalf1x16(1.0f);
+
+		glm::vec3 normal(pVertex[3], pVertex[4], pVertex[5]);
+		if (glm::length(normal) > 0.0f)
+		{
+			normal = glm::normalize(normal);
+		}
+		packed.normal = glm::packSnorm3x10_1x2(glm::vec4(normal, 0.0f));
+
+		packed.UV[0] = glm::packUnorm1x16(pVertex[6]);
+		packed.UV[1] = glm::packUnorm1x16(pVertex[7]);
+	}
+}
+
+///////////////////////////////////////////////////
+//	ValidatePackedVertices()
+//
+//	Decode the packed vertices again and record the
+//  largest difference to the float vertices.  The
+//  vertices outside the tolerance are reported, so
+//  meshes that do not fit the packed ranges are
+//  found when they are loaded.
+///////////////////////////////////////////////////
+void ShapeMeshes::ValidatePackedVertices(
+	GLMesh& mesh,
+	const std::vector<GLfloat>& vertices,
+	const std::vector<PACKED_VERTEX>& packedVertices)
+{
+	const GLuint floatsPerMeshVertex = g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV;
+	PACKING_ERROR& error = mesh.packingError;
+
+	for (size_t vertex = 0; vertex < packedVertices.size(); vertex++)
+	{
+		const GLfloat* pVertex = &vertices[vertex * floatsPerMeshVertex];
+		const PACKED_VERTEX& packed = packedVertices[vertex];
+
+		glm::vec3 position(pVertex[0], pVertex[1], pVertex[2]);
+		glm::vec3 decodedPosition(
+			glm::unpackHalf1x16(packed.position[0]),
+			glm::unpackHalf1x16(packed.position[1]),
+			glm::unpackHalf1x16(packed.position[2]));
+
+		glm::vec3 normal(pVertex[3], pVertex[4], pVertex[5]);
+		if (glm::length(normal) > 0.0f)
+		{
+			normal = glm::normalize(normal);
+		}
+		glm::vec3 decodedNormal = glm::vec3(glm::unpackSnorm3x10_1x2(packed.normal));
+
+		glm::vec2 UV(pVertex[6], pVertex[7]);
+		glm::vec2 decodedUV(
+			glm::unpackUnorm1x16(packed.UV[0]),
+			glm::unpackUnorm1x16(packed.UV[1]));
+
+		float positionError = glm::length(decodedPosition - position);
+		float normalError = glm::length(decodedNormal - normal);
+		float UVError = glm::length(decodedUV - UV);
+
+		error.position = std::max(error.position, positionError);
+		error.normal = std::max(error.normal, normalError);
+		error.UV = std::max(error.UV, UVError);
+		error.checkedVertices++;
+		if ((positionError > g_PositionTolerance) ||
+			(normalError > g_NormalTolerance) ||
+			(UVError > g_UVTolerance))
+		{
+			error.failedVertices++;
+		}
+	}
+
+	if (error.failedVertices > 0)
+	{
+		std::cout << "Packed vertices outside the tolerance: " << error.failedVertices
+			<< " of " << error.checkedVertices << " (position " << error.position
+			<< ", normal " << error.normal << ", UV " << error.UV << ")" << std::endl;
+	}
+}
+
+///////////////////////////////////////////////////
+//	AddPartsToArena()
+//
+//	Convert the strips and fans of the vertex data
+//  into one indexed triangle list, with the index
+//  range of every part recorded so the parts can be
+//  drawn on their own.  Identical vertices are
+//  stored once, and the zero area or repeated
+//  triangles of the strips are dropped.
+///////////////////////////////////////////////////
+void ShapeMeshes::AddPartsToArena(
+	GLMesh& mesh, const GLfloat* pVertices,
+	const MESH_PART* pParts, int nParts)
+{
+	const GLuint floatsPerMeshVertex = g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV;
+	typedef std::array<GLfloat, g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV> VERTEX_KEY;
+
+	std::map<VERTEX_KEY, GLuint> uniqueVertices;
+	std::vector<GLfloat> vertices;
+	std::vector<GLuint> indices;
+	// mesh index of each source vertex
+	std::vector<GLuint> remap(mesh.nVertices);
+
+	for (GLuint vertex = 0; vertex < mesh.nVertices; vertex++)
+	{
+		VERTEX_KEY key;
+		for (GLuint value = 0; value < floatsPerMeshVertex; value++)
+		{
+			key[value] = pVertices[vertex * floatsPerMeshVertex + value];
+		}
+
+		std::map<VERTEX_KEY, GLuint>::iterator found = uniqueVertices.find(key);
+		if (found == uniqueVertices.end())
+		{
+			GLuint index = (GLuint)uniqueVertices.size();
+			uniqueVertices[key] = index;
+			vertices.insert(vertices.end(), key.begin(), key.end());
+			remap[vertex] = index;
+		}
+		else
+		{
+			remap[vertex] = found->second;
+		}
+	}
+
+	// true when two corners of the triangle share a position
+	auto isDegenerate = [&](GLuint a, GLuint b, GLuint c)
+	{
+		const GLfloat* pA = &pVertices[a * floatsPerMeshVertex];
+		const GLfloat* pB = &pVertices[b * floatsPerMeshVertex];
+		const GLfloat* pC = &pVertices[c * floatsPerMeshVertex];
+		glm::vec3 posA(pA[0], pA[1], pA[2]);
+		glm::vec3 posB(pB[0], pB[1], pB[2]);
+		glm::vec3 posC(pC[0], pC[1], pC[2]);
+		return((posA == posB) || (posB == posC) || (posA == posC));
+	};
+
+	for (int part = 0; part < nParts; part++)
+	{
+		mesh.parts[part].firstIndex = (GLuint)indices.size();
+		std::set<std::array<GLuint, 3> > partTriangles;
+
+		GLuint first = pParts[part].firstVertex;
+		for (GLuint i = 0; i + 2 < pParts[part].nVertices; i++)
+		{
+			GLuint a, b, c;
+			if (pParts[part].mode == GL_TRIANGLE_FAN)
+			{
+				a = first;
+				b = first + i + 1;
+				c = first + i + 2;
+			}
+			else
+			{
+				// every other strip triangle is flipped to keep
+				// the winding order
+				a = first + i + (i % 2);
+				b = first + i + 1 - (i % 2);
+				c = first + i + 2;
+			}
+
+			if (isDegenerate(a, b, c) == true)
+			{
+				continue;
+			}
+
+			// strips that double back draw some triangles twice
+			std::array<GLuint, 3> corners = { remap[a], remap[b], remap[c] };
+			std::sort(corners.begin(), corners.end());
+			if (partTriangles.insert(corners).second == false)
+			{
+				continue;
+			}
+
+			indices.push_back(remap[a]);
+			indices.push_back(remap[b]);
+			indices.push_back(remap[c]);
+		}
+
+		mesh.parts[part].nIndices = (GLuint)indices.size() - mesh.parts[part].firstIndex;
+	}
+
+	mesh.nVertices = (GLuint)uniqueVertices.size();
+	mesh.nIndices = (GLuint)indices.size();
+	mesh.nParts = (GLuint)nParts;
+	AddMeshToArena(mesh, std::move(vertices), std::move(indices));
+}
+
+///////////////////////////////////////////////////
+//	DrawMeshPart()
+//
+//	Draw the indexed triangles of one mesh part.
+// 
+///////////////////////////////////////////////////
+void ShapeMeshes::DrawMeshPart(
+	const GLMesh& mesh, int part)
+{
+	GLuint firstIndex = mesh.firstIndex + mesh.parts[part].firstIndex;
+	glDrawElementsBaseVertex(GL_TRIANGLES, mesh.parts[part].nIndices, GL_UNSIGNED_INT, (void*)(sizeof(GLuint) * firstIndex), mesh.baseVertex);
+}
+
+///////////////////////////////////////////////////
+//	DrawMeshPartInstanced()
+//
+//	Draw the indexed triangles of one mesh part once
+//  for every instance.
+///////////////////////////////////////////////////
+void ShapeMeshes::DrawMeshPartInstanced(
+	const GLMesh& mesh, int part, GLsizei instanceCount)
+{
+	GLuint firstIndex = mesh.firstIndex + mesh.parts[part].firstIndex;
+	glDrawElementsInstancedBaseVertex(GL_TRIANGLES, mesh.parts[part].nIndices, GL_UNSIGNED_INT, (void*)(sizeof(GLuint) * firstIndex), instanceCount, mesh.baseVertex);
+}
+
+///////////////////////////////////////////////////
+//	CreateVertexLayout()
+//
+//	Describe the memory layout of the mesh vertices
+//  and of the per-instance values.  Each mesh has
+//  the same memory layout so that the data is
+//  retrieved properly by the shaders.  The instance
+//  values advance once per instance, so plain draw
+//  calls only ever read instance 0 while the shader
+//  uses the model uniform instead.
+///////////////////////////////////////////////////
+VertexLayout ShapeMeshes::CreateVertexLayout(
+	VERTEX_FORMAT vertexFormat)
+{
+	VertexLayout layout;
+
+	if (vertexFormat == PACKED_VERTEX_FORMAT)
+	{
+		// the normalized attributes are converted to floats
+		// by the GPU, so the shaders read either format
+		layout.AddBinding(MeshArena::VERTEX_BINDING, sizeof(PACKED_VERTEX));
+		layout.AddAttribute(0, g_FloatsPerVertex, GL_HALF_FLOAT, GL_FALSE, offsetof(PACKED_VERTEX, position), MeshArena::VERTEX_BINDING);
+		// packed 10 bit normals always have 4 components
+		layout.AddAttribute(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, offsetof(PACKED_VERTEX, normal), MeshArena::VERTEX_BINDING);
+		layout.AddAttribute(2, g_FloatsPerUV, GL_UNSIGNED_SHORT, GL_TRUE, offsetof(PACKED_VERTEX, UV), MeshArena::VERTEX_BINDING);
+	}
+	else
+	{
+		layout.AddBinding(MeshArena::VERTEX_BINDING, sizeof(float) * (g_FloatsPerVertex + g_FloatsPerNormal + g_FloatsPerUV));
+		layout.AddAttribute(0, g_FloatsPerVertex, GL_FLOAT, GL_FALSE, 0, MeshArena::VERTEX_BINDING);
+		layout.AddAttribute(1, g_FloatsPerNormal, GL_FLOAT, GL_FALSE, sizeof(float) * g_FloatsPerVertex, MeshArena::VERTEX_BINDING);
+		layout.AddAttribute(2, g_FloatsPerUV, GL_FLOAT, GL_FALSE, sizeof(float) * (g_FloatsPerVertex + g_FloatsPerNormal), MeshArena::VERTEX_BINDING);
+	}
+
+	// every mesh can also be drawn instanced
+	layout.AddBinding(g_InstanceBinding, sizeof(INSTANCE_DATA), 1);
+	// a mat4 attribute takes one location per column
+	for (GLuint column = 0; column < 4; column++)
+	{
+		layout.AddAttribute(g_InstanceModelLocation + column, 4, GL_FLOAT, GL_FALSE, sizeof(glm::vec4) * column, g_InstanceBinding);
+	}
+	layout.AddAttribute(g_InstanceUVScaleLocation, 2, GL_FLOAT, GL_FALSE, offsetof(INSTANCE_DATA, UVscale), g_InstanceBinding);
+	layout.AddIntegerAttribute(g_InstanceMaterialLocation, 1, GL_INT, offsetof(INSTANCE_DATA, materialIndex), g_InstanceBinding);
+
+	return(layout);
+}
+
+///////////////////////////////////////////////////
+//	CreateInstanceBuffer()
+//
+//	Create the shared instance buffer and attach it
+//  to the instance binding of the arena VAO.
+///////////////////////////////////////////////////
+void ShapeMeshes::CreateInstanceBuffer()
+{
+	// the buffer is never empty so plain draws stay in bounds
+	m_instanceCapacity = g_InitialInstanceCapacity;
+	glCreateBuffers(1, &m_instanceBuffer);
+	glNamedBufferData(m_instanceBuffer, sizeof(INSTANCE_DATA) * m_instanceCapacity, NULL, GL_STREAM_DRAW);
+
+	m_meshArena.BindVertexBuffer(g_InstanceBinding, m_instanceBuffer);
+}
+
+///////////////////////////////////////////////////
+//	UploadInstanceData()
+//
+//	Copy the instance data into the instance buffer.
+//  The buffer storage is orphaned first so the copy
+//  never waits on draws still reading the old data.
+///////////////////////////////////////////////////
+void ShapeMeshes::UploadInstanceData(
+	const INSTANCE_DATA* pInstances, GLsizei instanceCount)
+{
+	while (m_instanceCapacity < instanceCount)
+	{
+		m_instanceCapacity *= 2;
+	}
+	glNamedBufferData(m_instanceBuffer, sizeof(INSTANCE_DATA) * m_instanceCapacity, NULL, GL_STREAM_DRAW);
+	glNamedBufferSubData(m_instanceBuffer, 0, sizeof(INSTANCE_DATA) * instanceCount, pInstances);
+}
+
+///////////////////////////////////////////////////
+//	DrawBoxMeshInstanced()
+//
+//	Draw the box mesh once for every instance.
+// 
+///////////////////////////////////////////////////
+void ShapeMeshes::DrawBoxMeshInstanced(
+	const INSTANCE_DATA* pInstances, GLsizei instanceCount)
+{
+	UseMesh(BOX_MESH);
+
+	UploadInstanceData(pInstances, instanceCount);
+
+	m_meshArena.Bind();
+
+	glDrawElementsInstancedBaseVertex(GL_TRIANGLES, m_BoxMesh.nIndices, GL_UNSIGNED_INT, (void*)(sizeof(GLuint) * m_BoxMesh.firstIndex), instanceCount, m_BoxMesh.baseVertex);
+}
+
+///////////////////////////////////////////////////
+//	DrawConeMeshInstanced()
+//
+//	Draw the cone mesh once for every instance.
+// 
+///////////////////////////////////////////////////
+void ShapeMeshes::DrawConeMeshInstanced(
+	const INSTANCE_DATA* pInstances, GLsizei instanceCount,
+	bool bDrawBottom)
+{
+	UseMesh(CONE_MESH);
+
+	UploadInstanceData(pInstances, instanceCount);
+
+	m_meshArena.Bind();
+
+	if (bDrawBottom == true)
+	{
+		DrawMeshPartInstanced(m_ConeMesh, g_BottomPart, instanceCount);		//bottom
+	}
+	DrawMeshPartInstanced(m_ConeMesh, g_ConeSidesPart, instanceCount);	//sides
+}
+
+///////////////////////////////////////////////////
+//	DrawCylinderMeshInstanced()
+//
+//	Draw the cylinder mesh once for every instance.
+// 
+///////////////////////////////////////////////////
+void ShapeMeshes::DrawCylinderMeshInstanced(
+	const INSTANCE_DATA* pInstances, GLsizei instanceCount,
+	bool bDrawTop,
+	bool bDrawBottom,
+	bool bDrawSides)
+{
+	UseMesh(CYLINDER_MESH);
+
+	UploadInstanceData(pInstances, instanceCount);
+
+	m_meshArena.Bind();
+
+	if (bDrawBottom == true)
+	{
+		DrawMeshPartInstanced(m_CylinderMesh, g_BottomPart, instanceCount);	//bottom
+	}
+	if (bDrawTop == true)
+	{
+		DrawMeshPartInstanced(m_CylinderMesh, g_TopPart, instanceCount);	//top
+	}
+	if (bDrawSides == true)
+	{
+		DrawMeshPartInstanced(m_CylinderMesh, g_CylinderSidesPart, instanceCount);	//sides
+	}
+}
+
+///////////////////////////////////////////////////
+//	DrawPlaneMeshInstanced()
+//
+//	Draw the plane mesh once for every instance.
+// 
+///////////////////////////////////////////////////
+void ShapeMeshes::DrawPlaneMeshInstanced(
+	const INSTANCE_DATA* pInstances, GLsizei instanceCount)
+{
+	UseMesh(PLANE_MESH);
+
+	UploadInstanceData(pInstances, instanceCount);
+
+	m_meshArena.Bind();
+
+	glDrawElementsInstancedBaseVertex(GL_TRIANGLES, m_PlaneMesh.nIndices, GL_UNSIGNED_INT, (void*)(sizeof(GLuint) * m_PlaneMesh.firstIndex), instanceCount, m_PlaneMesh.baseVertex);
+}
+
+///////////////////////////////////////////////////
+//	DrawPrismMeshInstanced()
+//
+//	Draw the prism mesh once for every instance.
+// 
+///////////////////////////////////////////////////
+void ShapeMeshes::DrawPrismMeshInstanced(
+	const INSTANCE_DATA* pInstances, GLsizei instanceCount)
+{
+	UseMesh(PRISM_MESH);
+
+	UploadInstanceData(pInstances, instanceCount);
+
+	m_meshArena.Bind();
+
+	glDrawElementsInstancedBaseVertex(GL_TRIANGLES, m_PrismMesh.nIndices, GL_UNSIGNED_INT, (void*)(sizeof(GLuint) * m_PrismMesh.firstIndex), instanceCount, m_PrismMesh.baseVertex);
+}
+
+///////////////////////////////////////////////////
+//	DrawPyramid3MeshInstanced()
+//
+//	Draw the 3-sided pyramid mesh once for every
+//  instance.
+///////////////////////////////////////////////////
+void ShapeMeshes::DrawPyramid3MeshInstanced(
+	const INSTANCE_DATA* pInstances, GLsizei instanceCount)
+{
+	UseMesh(PYRAMID3_MESH);
+
+	UploadInstanceData(pInstances, instanceCount);
+
+	m_meshArena.Bind();
+
+	glDrawElementsInstancedBaseVertex(GL_TRIANGLES, m_Pyramid3Mesh.nIndices, GL_UNSIGNED_INT, (void*)(sizeof(GLuint) * m_Pyramid3Mesh.firstIndex), instanceCount, m_Pyramid3Mesh.baseVertex);
+}
+
+///////////////////////////////////////////////////
+//	DrawPyramid4MeshInstanced()
+//
+//	Draw the 4-sided pyramid mesh once for every
+//  instance.
+///////////////////////////////////////////////////
+void ShapeMeshes::DrawPyramid4MeshInstanced(
+	const INSTANCE_DATA* pInstances, GLsizei instanceCount)
+{
+	UseMesh(PYRAMID4_MESH);
+
+	UploadInstanceData(pInstances, instanceCount);
+
+	m_meshArena.Bind();
+
+	glDrawElementsInstancedBaseVertex(GL_TRIANGLES, m_Pyramid4Mesh.nIndices, GL_UNSIGNED_INT, (void*)(sizeof(GLuint) * m_Pyramid4Mesh.firstIndex), instanceCount, m_Pyramid4Mesh.baseVertex);
+}
+
+///////////////////////////////////////////////////
+//	DrawSphereMeshInstanced()
+//
+//	Draw the sphere mesh once for every instance.
+// 
+///////////////////////////////////////////////////
+void ShapeMeshes::DrawSphereMeshInstanced(
+	const INSTANCE_DATA* pInstances, GLsizei instanceCount)
+{
+	UseMesh(SPHERE_MESH);
+
+	UploadInstanceData(pInstances, instanceCount);
+
+	m_meshArena.Bind();
+
+	glDrawElementsInstancedBaseVertex(GL_TRIANGLES, m_SphereMesh.nIndices, GL_UNSIGNED_INT, (void*)(sizeof(GLuint) * m_SphereMesh.firstIndex), instanceCount, m_SphereMesh.baseVertex);
+}
+
+///////////////////////////////////////////////////
+//	DrawTaperedCylinderMeshInstanced()
+//
+//	Draw the tapered cylinder mesh once for every
+//  instance.
+///////////////////////////////////////////////////
+void ShapeMeshes::DrawTaperedCylinderMeshInstanced(
+	const INSTANCE_DATA* pInstances, GLsizei instanceCount,
+	bool bDrawTop,
+	bool bDrawBottom,
+	bool bDrawSides)
+{
+	UseMesh(TAPERED_CYLINDER_MESH);
+
+	UploadInstanceData(pInstances, instanceCount);
+
+	m_meshArena.Bind();
+
+	if (bDrawBottom == true)
+	{
+		DrawMeshPartInstanced(m_TaperedCylinderMesh, g_BottomPart, instanceCount);	//bottom
+	}
+	if (bDrawTop == true)
+	{
+		DrawMeshPartInstanced(m_TaperedCylinderMesh, g_TopPart, instanceCount);	//top
+	}
+	if (bDrawSides == true)
+	{
+		DrawMeshPartInstanced(m_TaperedCylinderMesh, g_CylinderSidesPart, instanceCount);	//sides
+	}
+}
+
+///////////////////////////////////////////////////
+//	DrawTorusMeshInstanced()
+//
+//	Draw the torus mesh once for every instance.
+// 
+///////////////////////////////////////////////////
+void ShapeMeshes::DrawTorusMeshInstanced(
+	const INSTANCE_DATA* pInstances, GLsizei instanceCount)
+{
+	UseMesh(TORUS_MESH);
+
+	UploadInstanceData(pInstances, instanceCount);
+
+	m_meshArena.Bind();
+
+	glDrawElementsInstancedBaseVertex(GL_TRIANGLES, m_TorusMesh.nIndices, GL_UNSIGNED_INT, (void*)(sizeof(GLuint) * m_TorusMesh.firstIndex), instanceCount, m_TorusMesh.baseVertex);
+}
@@ -14,6 +14,18 @@
 
 #include <glm/glm.hpp>
 
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+
+#include "MeshArena.h"
+#include "VertexLayout.h"
+#include "MeshOptimizer.h"
+#include "MeshletBuilder.h"
+
+class JobSystem;
+
 /***********************************************************
  *  ShapeMeshes
  *
@@ -23,20 +35,142 @@
 class ShapeMeshes
 {
 public:
-	// constructor
-	ShapeMeshes();
+	// layouts the mesh vertices can be stored with
+	enum VERTEX_FORMAT
+	{
+		FLOAT_VERTEX_FORMAT,	// 32 bytes - float position, normal and UV
+		PACKED_VERTEX_FORMAT	// 16 bytes - half float position, 2_10_10_10
+								// normal and unorm16 UV
+	};
+
+	// largest differences between the packed vertices of a mesh
+	// and the float values they were packed from
+	struct PACKING_ERROR
+	{
+		GLfloat position;
+		GLfloat normal;
+		GLfloat UV;
+		GLuint checkedVertices;
+		GLuint failedVertices;	// vertices outside the tolerance
+	};
+
+	// constructor - every mesh is stored with the vertex format
+	ShapeMeshes(VERTEX_FORMAT vertexFormat = FLOAT_VERTEX_FORMAT);
+
+	// per-instance values for the instanced draw methods - the
+	// shader reads them when it is told to draw instances:
+	//   layout(location = 3) in mat4 instanceModel;	(locations 3-6)
+	//   layout(location = 7) in vec2 instanceUVscale;
+	//   layout(location = 8) in int instanceMaterialIndex;
+	struct INSTANCE_DATA
+	{
+		glm::mat4 model;
+		glm::vec2 UVscale;
+		GLint materialIndex;
+		GLint padding;		// keeps the stride at 80 bytes
+	};
+
+	// identifiers for addressing the shape meshes by value
+	enum MESH_ID
+	{
+		BOX_MESH,
+		CONE_MESH,
+		CYLINDER_MESH,
+		PLANE_MESH,
+		PRISM_MESH,
+		PYRAMID3_MESH,
+		PYRAMID4_MESH,
+		SPHERE_MESH,
+		TAPERED_CYLINDER_MESH,
+		TORUS_MESH,
+		MESH_COUNT
+	};
+
+	// location of an indexed mesh in the shared arena buffers,
+	// as needed by indirect draw commands
+	struct INDEXED_RANGE
+	{
+		GLuint nIndices;
+		GLuint firstIndex;
+		GLint baseVertex;
+	};
+
+	// box and sphere holding every vertex of a mesh, in the space
+	// of the mesh - the sphere is centered on the box
+	struct MESH_BOUNDS
+	{
+		glm::vec3 boxMin;
+		glm::vec3 boxMax;
+		glm::vec3 sphereCenter;
+		GLfloat sphereRadius;
+	};
+
+	// tessellation levels a mesh can be drawn at - level 0 is
+	// the loaded mesh, and the curved meshes add coarser levels
+	static const int LOD_LEVEL_COUNT = 4;
 
 private:
 
+	// range of the indices of one optional mesh part, such as
+	// a cap or the sides, relative to the first mesh index
+	struct MESH_PART_RANGE
+	{
+		GLuint firstIndex;
+		GLuint nIndices;
+	};
+
 	// stores the GL data relative to a given mesh
 	struct GLMesh
 	{
-		GLuint vao;         // Handle for the vertex array object
-		GLuint vbos[2];     // Handles for the vertex buffer objects
+		GLint baseVertex;   // First vertex of the mesh in the arena
+		GLuint firstIndex;  // First index of the mesh in the arena
 		GLuint nVertices;	// Number of vertices for the mesh
 		GLuint nIndices;    // Number of indices for the mesh
+		MESH_PART_RANGE parts[3];	// index ranges of the mesh parts
+		GLuint nParts;      // Number of mesh parts, 0 for one part
+		MeshOptimizer::CACHE_STATS cacheBefore;	// Vertex cache use as generated
+		MeshOptimizer::CACHE_STATS cacheAfter;	// Vertex cache use as uploaded
+		GLfloat boundingRadius;	// Distance of the farthest vertex from the origin
+		MESH_BOUNDS bounds;	// Box and sphere around the vertices
+		bool bHasBounds;	// True once the mesh was generated
+		PACKING_ERROR packingError;	// Packed vertex error when validated
+		std::vector<MeshletBuilder::MESHLET> meshlets;	// Meshlets, when built
+		MeshArena::MESH_RANGE arenaRange;	// Space taken in the arena
+		bool bResident;		// True while the mesh is in the arena
 	};
 
+	// one vertex of the packed vertex format - the attributes
+	// are normalized by the GPU, so the shader still reads the
+	// same vec3 position, vec3 normal and vec2 UV
+	struct PACKED_VERTEX
+	{
+		GLushort position[4];	// half floats, the last one unused
+		GLuint normal;			// GL_INT_2_10_10_10_REV
+		GLushort UV[2];			// unorm16
+	};
+
+	// one strip or fan of the vertex data of a mesh, converted
+	// into indexed triangles when the mesh is loaded
+	struct MESH_PART
+	{
+		GLenum mode;		// GL_TRIANGLE_STRIP or GL_TRIANGLE_FAN
+		GLuint firstVertex;
+		GLuint nVertices;
+	};
+
+	// shared vertex and index buffers holding every mesh
+	MeshArena m_meshArena;
+	// layout of the vertices in the arena
+	VERTEX_FORMAT m_vertexFormat;
+	// true when packed vertices are checked against the floats
+	bool m_bValidatePacking;
+	// reorders the indexed meshes before they are uploaded
+	MeshOptimizer m_meshOptimizer;
+	bool m_bOptimizeMeshes;
+	// splits the indexed meshes into meshlets for culling
+	MeshletBuilder m_meshletBuilder;
+	bool m_bBuildMeshlets;
+
 	// the available 3D shapes
 	GLMesh m_BoxMesh;
 	GLMesh m_ConeMesh;
@@ -48,8 +182,39 @@ private:
 	GLMesh m_SphereMesh;
 	GLMesh m_TaperedCylinderMesh;
 	GLMesh m_TorusMesh;
+	// coarser tessellation levels of the curved meshes, from
+	// level 1 on - levels that were not generated have no indices
+	GLMesh m_meshLevels[MESH_COUNT][LOD_LEVEL_COUNT - 1];
+
+	// vertex buffer holding the per-instance values, shared by
+	// every mesh
+	GLuint m_instanceBuffer;
+	GLsizei m_instanceCapacity;
+
+	// frame counted by BeginFrame(), and the frame each mesh
+	// was last drawn or prefetched in
+	GLuint m_frameNumber;
+	GLuint m_lastUsedFrame[MESH_COUNT];
+	// tube thickness the torus is loaded with again after it
+	// was evicted
+	float m_torusThickness;
 
-	bool m_bMemoryLayoutDone;
+	// vertex data of a mesh generated on a worker thread, waiting
+	// for the GL thread to upload it - a NULL mesh marks the end
+	// of the job that generated the mesh
+	struct PENDING_UPLOAD
+	{
+		GLMesh* pMesh;
+		std::vector<GLfloat> vertices;
+		std::vector<PACKED_VERTEX> packedVertices;
+		std::vector<GLuint> indices;
+	};
+	// true while LoadMeshes() generates meshes on worker threads,
+	// so the generated data is queued instead of uploaded
+	bool m_bQueueUploads;
+	std::deque<PENDING_UPLOAD> m_pendingUploads;
+	std::mutex m_uploadMutex;
+	std::condition_variable m_uploadQueued;
 
 public:
 	// methods for loading the shape mesh data 
@@ -64,6 +229,11 @@ public:
 	void LoadSphereMesh();
 	void LoadTaperedCylinderMesh();
 	void LoadTorusMesh(float thickness = 0.2);
+	// generate the listed meshes and their levels in parallel on
+	// the worker threads, uploading each one from the calling GL
+	// thread as soon as it is generated
+	void LoadMeshes(
+		const MESH_ID* pMeshIDs, int meshCount, JobSystem& jobSystem);
 
 	// methods for drawing the shape mesh in the
 	// display window
@@ -87,6 +257,117 @@ public:
 	void DrawTorusMesh();
 	void DrawHalfTorusMesh();
 
+	// draw the whole shape mesh with the given identifier
+	void DrawMesh(MESH_ID meshID);
+
+	// the draw methods load a mesh that is not resident the first
+	// time it is drawn - load it ahead of its first draw instead
+	void PrefetchMesh(MESH_ID meshID);
+	// true while the mesh is loaded in the arena buffers
+	bool IsMeshResident(MESH_ID meshID) const;
+	// note that the mesh is drawn in the current frame, for draws
+	// issued by the caller from the arena ranges
+	void MarkMeshUsed(MESH_ID meshID);
+	// start a new frame for the residency tracking
+	void BeginFrame() { m_frameNumber++; }
+	// free the arena space of the meshes not drawn or prefetched
+	// in the last unusedFrames frames - returns the number of
+	// meshes evicted
+	int EvictUnusedMeshes(GLuint unusedFrames);
+	// free the arena space of a mesh and its tessellation levels -
+	// ranges and meshlets taken from it before are no longer valid
+	void EvictMesh(MESH_ID meshID);
+	// bytes of GPU memory held by the arena buffers
+	GLsizeiptr GetArenaBufferBytes() const { return m_meshArena.GetBufferBytes(); }
+
+	// get the arena range of an indexed mesh - returns false when
+	// the mesh is not loaded or is drawn without indices
+	bool GetIndexedRange(MESH_ID meshID, INDEXED_RANGE& range) const;
+	// make the arena VAO current for draws issued by the caller
+	void BindMeshArena() { m_meshArena.Bind(); }
+
+	// number of tessellation levels the mesh can be drawn at
+	int GetLevelCount(MESH_ID meshID) const;
+	// number of triangles drawn for the mesh at the given level
+	GLuint GetLevelTriangleCount(MESH_ID meshID, int level) const;
+	// radius of the sphere around the mesh origin that holds
+	// every vertex of the mesh
+	GLfloat GetBoundingRadius(MESH_ID meshID) const;
+	// get the box and sphere around the vertices of the mesh,
+	// which are kept when the mesh is evicted - returns false
+	// when the mesh was never loaded
+	bool GetMeshBounds(MESH_ID meshID, MESH_BOUNDS& bounds) const;
+	// draw the whole mesh at the given tessellation level
+	void DrawMeshLevel(MESH_ID meshID, int level);
+	// get the arena range of the mesh at the given tessellation
+	// level - returns false when the level cannot be drawn from
+	// the shared index buffer
+	bool GetIndexedRange(MESH_ID meshID, int level, INDEXED_RANGE& range) const;
+
+	// vertex format of the meshes and the vertex bytes stored
+	VERTEX_FORMAT GetVertexFormat() const { return m_vertexFormat; }
+	GLsizeiptr GetVertexBytes() const { return m_meshArena.GetVertexBytes(); }
+	// when true, the meshes loaded afterwards in the packed vertex
+	// format are decoded again and compared against their float
+	// values, reporting the vertices outside the tolerance
+	void SetPackingValidation(bool bValidate) { m_bValidatePacking = bValidate; }
+	// get the packing error of a validated mesh - returns false
+	// when the mesh was not loaded with packing validation
+	bool GetPackingError(MESH_ID meshID, PACKING_ERROR& error) const;
+
+	// choose how the meshes loaded afterwards are reordered for
+	// the vertex cache, and optionally for overdraw
+	void SetMeshOptimization(bool bOptimize, bool bOptimizeOverdraw = false);
+	// get the vertex cache use of a loaded indexed mesh before
+	// and after the optimization - returns false when the mesh
+	// is not loaded or is drawn without indices
+	bool GetCacheStats(
+		MESH_ID meshID,
+		MeshOptimizer::CACHE_STATS& before,
+		MeshOptimizer::CACHE_STATS& after) const;
+
+	// when true, the indexed meshes loaded afterwards that have
+	// more triangles than one meshlet holds are also split into
+	// meshlets with culling bounds
+	void SetMeshletGeneration(bool bBuild) { m_bBuildMeshlets = bBuild; }
+	// get the meshlets of a loaded mesh, with index ranges relative
+	// to the first index of the mesh - returns false when the mesh
+	// was not split into meshlets
+	bool GetMeshlets(
+		MESH_ID meshID,
+		const MeshletBuilder::MESHLET*& pMeshlets,
+		GLuint& nMeshlets) const;
+
+	// methods for drawing one copy of the shape mesh for every
+	// entry of the passed in instance data with a single call
+	void DrawBoxMeshInstanced(
+		const INSTANCE_DATA* pInstances, GLsizei instanceCount);
+	void DrawConeMeshInstanced(
+		const INSTANCE_DATA* pInstances, GLsizei instanceCount,
+		bool bDrawBottom = true);
+	void DrawCylinderMeshInstanced(
+		const INSTANCE_DATA* pInstances, GLsizei instanceCount,
+		bool bDrawTop = true,
+		bool bDrawBottom = true,
+		bool bDrawSides = true);
+	void DrawPlaneMeshInstanced(
+		const INSTANCE_DATA* pInstances, GLsizei instanceCount);
+	void DrawPrismMeshInstanced(
+		const INSTANCE_DATA* pInstances, GLsizei instanceCount);
+	void DrawPyramid3MeshInstanced(
+		const INSTANCE_DATA* pInstances, GLsizei instanceCount);
+	void DrawPyramid4MeshInstanced(
+		const INSTANCE_DATA* pInstances, GLsizei instanceCount);
+	void DrawSphereMeshInstanced(
+		const INSTANCE_DATA* pInstances, GLsizei instanceCount);
+	void DrawTaperedCylinderMeshInstanced(
+		const INSTANCE_DATA* pInstances, GLsizei instanceCount,
+		bool bDrawTop = true,
+		bool bDrawBottom = true,
+		bool bDrawSides = true);
+	void DrawTorusMeshInstanced(
+		const INSTANCE_DATA* pInstances, GLsizei instanceCount);
+
 
 private:
 
@@ -95,7 +376,84 @@ private:
 	glm::vec3 CalculateTriangleNormal(
 		glm::vec3 px, glm::vec3 py, glm::vec3 pz);
 
-	// called to set the memory layout 
-	// template for shader data
-	void SetShaderMemoryLayout();
+	// called to convert strip and fan vertex data into
+	// deduplicated indexed triangles in the arena
+	void AddPartsToArena(
+		GLMesh& mesh, const GLfloat* pVertices,
+		const MESH_PART* pParts, int nParts);
+
+	// called to draw one part of a mesh
+	void DrawMeshPart(
+		const GLMesh& mesh, int part);
+	void DrawMeshPartInstanced(
+		const GLMesh& mesh, int part, GLsizei instanceCount);
+
+	// called to find the mesh with the given identifier
+	const GLMesh* GetMesh(MESH_ID meshID) const;
+	GLMesh* GetMesh(MESH_ID meshID);
+	// called to load the mesh with the given identifier
+	void LoadMesh(MESH_ID meshID);
+	// called by the draw methods to load the mesh when it is
+	// not resident and mark it as drawn in this frame
+	void UseMesh(MESH_ID meshID);
+	// called to free the arena space of one mesh
+	void ReleaseMesh(GLMesh& mesh);
+	// called to find the mesh of the given tessellation level
+	const GLMesh* GetMeshLevel(MESH_ID meshID, int level) const;
+
+	// called to generate the coarser tessellation levels of the
+	// cylinders into the shared arena buffers
+	void AddCylinderLevel(
+		GLMesh& mesh, int slices, float topRadius);
+
+	// called to generate an indexed torus grid into the
+	// shared arena buffers
+	void AddTorusMesh(
+		GLMesh& mesh, int mainSegments, int tubeSegments, float tubeRadius);
+
+	// called to append the mesh data to the
+	// shared arena buffers - from static data, which is
+	// copied, or from generated vectors, which are taken
+	// over without another copy
+	void AddMeshToArena(
+		GLMesh& mesh, const GLfloat* pVertices, const GLuint* pIndices);
+	void AddMeshToArena(
+		GLMesh& mesh, std::vector<GLfloat>&& vertices, std::vector<GLuint>&& indices);
+	// called to upload generated mesh data to the shared arena
+	// buffers, on the GL thread
+	void UploadMesh(PENDING_UPLOAD& upload);
+	// called by the worker threads to hand generated mesh data
+	// to the GL thread
+	void QueueUpload(PENDING_UPLOAD& upload);
+	// called to append a table from ShapeTables to the
+	// shared arena buffers
+	template <class TABLE>
+	void AddTableToArena(
+		GLMesh& mesh, const TABLE& table);
+
+	// called to convert float vertices into the packed
+	// vertex format
+	void PackVertices(
+		const std::vector<GLfloat>& vertices,
+		std::vector<PACKED_VERTEX>& packedVertices);
+	// called to compare packed vertices with the float
+	// vertices they were packed from
+	void ValidatePackedVertices(
+		GLMesh& mesh,
+		const std::vector<GLfloat>& vertices,
+		const std::vector<PACKED_VERTEX>& packedVertices);
+
+	// called to describe the memory layout of the
+	// vertex format and the per-instance values
+	static VertexLayout CreateVertexLayout(
+		VERTEX_FORMAT vertexFormat);
+
+	// called to create the instance buffer and attach
+	// it to the arena VAO
+	void CreateInstanceBuffer();
+
+	// called to copy the instance data into
+	// the instance buffer
+	void UploadInstanceData(
+		const INSTANCE_DATA* pInstances, GLsizei instanceCount);
 };
\ No newline at end of file
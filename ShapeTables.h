@@ -0,0 +1,281 @@
+///////////////////////////////////////////////////////////////////////////////
+// shapetables.h
+// ============
+// generate the vertex and index tables of the fixed shapes at compile time
+//
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <GL/glew.h>
+#include <array>
+#include <cstddef>
+
+/***********************************************************
+ *  ShapeTables
+ *
+ *  These generators build the vertices and indices of the
+ *  shapes whose topology is fixed while the program is
+ *  compiled.  The results are constexpr tables already in
+ *  the layout the arena stores - a position, a normal and
+ *  texture coordinates per vertex, and indexed triangles -
+ *  so loading one of these shapes copies a table into the
+ *  arena without computing anything.
+ ***********************************************************/
+namespace ShapeTables
+{
+	// floats of one vertex: position, normal and texture coords
+	const GLuint FLOATS_PER_VERTEX = 8;
+
+	// vertices and indices of a mesh, with room for MaxVertices
+	// and MaxIndices of which the first nVertices and nIndices
+	// are used
+	template <GLuint MaxVertices, GLuint MaxIndices>
+	struct MESH_TABLE
+	{
+		std::array<GLfloat, MaxVertices * FLOATS_PER_VERTEX> vertices;
+		std::array<GLuint, MaxIndices> indices;
+		GLuint nVertices;
+		GLuint nIndices;
+	};
+
+	constexpr double PI = 3.14159265358979323846;
+
+	/***********************************************************
+	 *  Sine()
+	 *
+	 *  Sine of the angle in radians, from its Taylor series
+	 *  once the angle is brought within a half turn of zero.
+	 ***********************************************************/
+	constexpr double Sine(double angle)
+	{
+		double turns = angle / (2.0 * PI);
+		long long wholeTurns = (long long)(turns + ((turns >= 0.0) ? 0.5 : -0.5));
+		double x = angle - 2.0 * PI * (double)wholeTurns;
+
+		double sum = x;
+		double term = x;
+		for (int n = 1; n < 16; n++)
+		{
+			term *= -x * x / (double)((2 * n) * (2 * n + 1));
+			sum += term;
+		}
+		return(sum);
+	}
+
+	/***********************************************************
+	 *  Cosine()
+	 *
+	 *  Cosine of the angle in radians.
+	 ***********************************************************/
+	constexpr double Cosine(double angle)
+	{
+		return(Sine(angle + PI * 0.5));
+	}
+
+	/***********************************************************
+	 *  MakeSphere()
+	 *
+	 *  Generate a sphere of radius 1 from the given number of
+	 *  slices around the Y axis and stacks from the top to the
+	 *  bottom.  The poles are single vertices, and every ring
+	 *  repeats the vertex of the back slice, where the texture
+	 *  wraps.  The U coordinate runs from the front of each
+	 *  ring and is scaled by the ring radius.  The triangles
+	 *  are listed from the top down, so with an even number of
+	 *  stacks the first half of the indices is the top half.
+	 ***********************************************************/
+	template <GLuint Slices, GLuint Stacks>
+	constexpr MESH_TABLE<2 + (Stacks - 1) * (Slices + 1), 6 * Slices * (Stacks - 1)> MakeSphere()
+	{
+		static_assert(Slices >= 4 && Slices % 2 == 0, "the seam needs an even number of slices");
+		static_assert(Stacks >= 2, "a sphere needs at least one ring");
+
+		MESH_TABLE<2 + (Stacks - 1) * (Slices + 1), 6 * Slices * (Stacks - 1)> table{};
+		const GLuint ringVertices = Slices + 1;
+		const GLuint bottomPole = 1 + (Stacks - 1) * ringVertices;
+
+		double sliceSines[Slices] = {};
+		double sliceCosines[Slices] = {};
+		for (GLuint slice = 0; slice < Slices; slice++)
+		{
+			sliceSines[slice] = Sine(2.0 * PI * slice / Slices);
+			sliceCosines[slice] = Cosine(2.0 * PI * slice / Slices);
+		}
+
+		GLuint vertex = 0;
+		auto addVertex = [&](double x, double y, double z, double u, double v)
+		{
+			GLfloat* pVertex = &table.vertices[vertex * FLOATS_PER_VERTEX];
+			// the position on a unit sphere is also its normal
+			pVertex[0] = (GLfloat)x;
+			pVertex[1] = (GLfloat)y;
+			pVertex[2] = (GLfloat)z;
+			pVertex[3] = (GLfloat)x;
+			pVertex[4] = (GLfloat)y;
+			pVertex[5] = (GLfloat)z;
+			pVertex[6] = (GLfloat)u;
+			pVertex[7] = (GLfloat)v;
+			vertex++;
+		};
+
+		addVertex(0.0, 1.0, 0.0, 0.5, 1.0);
+		for (GLuint stack = 1; stack < Stacks; stack++)
+		{
+			double ringRadius = Sine(PI * stack / Stacks);
+			double y = Cosine(PI * stack / Stacks);
+			double v = 1.0 - (double)stack / Stacks;
+			for (GLuint position = 0; position < ringVertices; position++)
+			{
+				// the back slice is stored at both ends of the U range
+				GLuint slice = (position <= Slices / 2) ? position : position - 1;
+				double u = (position <= Slices / 2) ?
+					(double)slice / Slices : (double)slice / Slices - 1.0;
+				addVertex(
+					ringRadius * sliceSines[slice], y, ringRadius * sliceCosines[slice],
+					0.5 + ringRadius * u, v);
+			}
+		}
+		addVertex(0.0, -1.0, 0.0, 0.5, 0.0);
+
+		GLuint index = 0;
+		auto addTriangle = [&](GLuint a, GLuint b, GLuint c)
+		{
+			table.indices[index++] = a;
+			table.indices[index++] = b;
+			table.indices[index++] = c;
+		};
+
+		// the ring positions that follow each other around the ring,
+		// stepping over the copy of the back slice
+		for (GLuint stack = 0; stack < Stacks; stack++)
+		{
+			GLuint upperRing = (stack == 0) ? 0 : 1 + (stack - 1) * ringVertices;
+			GLuint lowerRing = 1 + stack * ringVertices;
+			for (GLuint position = 0; position < ringVertices; position++)
+			{
+				if (position == Slices / 2)
+				{
+					continue;
+				}
+				GLuint next = (position == Slices) ? 0 : position + 1;
+
+				if (stack == 0)
+				{
+					addTriangle(0, lowerRing + position, lowerRing + next);
+				}
+				else if (stack == Stacks - 1)
+				{
+					addTriangle(upperRing + position, bottomPole, upperRing + next);
+				}
+				else
+				{
+					addTriangle(upperRing + position, lowerRing + position, lowerRing + next);
+					addTriangle(upperRing + position, lowerRing + next, upperRing + next);
+				}
+			}
+		}
+
+		table.nVertices = vertex;
+		table.nIndices = index;
+		return(table);
+	}
+
+	/***********************************************************
+	 *  IndexStrip()
+	 *
+	 *  Convert the vertices of a triangle strip into indexed
+	 *  triangles.  Identical vertices are stored once, and the
+	 *  zero area or repeated triangles of the strip are
+	 *  dropped, the same way the strips loaded at run time are
+	 *  converted.
+	 ***********************************************************/
+	template <std::size_t Floats>
+	constexpr MESH_TABLE<Floats / FLOATS_PER_VERTEX, (Floats / FLOATS_PER_VERTEX - 2) * 3> IndexStrip(
+		const GLfloat (&strip)[Floats])
+	{
+		static_assert(Floats % FLOATS_PER_VERTEX == 0, "the strip holds whole vertices");
+		const GLuint nStripVertices = Floats / FLOATS_PER_VERTEX;
+
+		MESH_TABLE<Floats / FLOATS_PER_VERTEX, (Floats / FLOATS_PER_VERTEX - 2) * 3> table{};
+		GLuint remap[Floats / FLOATS_PER_VERTEX] = {};
+
+		for (GLuint vertex = 0; vertex < nStripVertices; vertex++)
+		{
+			GLuint found = table.nVertices;
+			for (GLuint unique = 0; (unique < table.nVertices) && (found == table.nVertices); unique++)
+			{
+				bool bSame = true;
+				for (GLuint value = 0; value < FLOATS_PER_VERTEX; value++)
+				{
+					if (table.vertices[unique * FLOATS_PER_VERTEX + value] != strip[vertex * FLOATS_PER_VERTEX + value])
+					{
+						bSame = false;
+					}
+				}
+				if (bSame == true)
+				{
+					found = unique;
+				}
+			}
+
+			if (found == table.nVertices)
+			{
+				for (GLuint value = 0; value < FLOATS_PER_VERTEX; value++)
+				{
+					table.vertices[found * FLOATS_PER_VERTEX + value] = strip[vertex * FLOATS_PER_VERTEX + value];
+				}
+				table.nVertices++;
+			}
+			remap[vertex] = found;
+		}
+
+		// true when the two strip vertices share a position
+		auto isSamePosition = [&](GLuint a, GLuint b)
+		{
+			return((strip[a * FLOATS_PER_VERTEX] == strip[b * FLOATS_PER_VERTEX]) &&
+				(strip[a * FLOATS_PER_VERTEX + 1] == strip[b * FLOATS_PER_VERTEX + 1]) &&
+				(strip[a * FLOATS_PER_VERTEX + 2] == strip[b * FLOATS_PER_VERTEX + 2]));
+		};
+
+		for (GLuint i = 0; i + 2 < nStripVertices; i++)
+		{
+			// every other strip triangle is flipped to keep the
+			// winding order
+			GLuint a = i + (i % 2);
+			GLuint b = i + 1 - (i % 2);
+			GLuint c = i + 2;
+			if (isSamePosition(a, b) || isSamePosition(b, c) || isSamePosition(a, c))
+			{
+				continue;
+			}
+
+			// strips that double back draw some triangles twice
+			bool bRepeated = false;
+			for (GLuint triangle = 0; triangle < table.nIndices; triangle += 3)
+			{
+				GLuint matches = 0;
+				for (GLuint corner = 0; corner < 3; corner++)
+				{
+					GLuint index = table.indices[triangle + corner];
+					if ((index == remap[a]) || (index == remap[b]) || (index == remap[c]))
+					{
+						matches++;
+					}
+				}
+				if (matches == 3)
+				{
+					bRepeated = true;
+				}
+			}
+			if (bRepeated == true)
+			{
+				continue;
+			}
+
+			table.indices[table.nIndices++] = remap[a];
+			table.indices[table.nIndices++] = remap[b];
+			table.indices[table.nIndices++] = remap[c];
+		}
+
+		return(table);
+	}
+}
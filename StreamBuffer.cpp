@@ -0,0 +1,203 @@
+///////////////////////////////////////////////////////////////////////////////
+// streambuffer.cpp
+// ============
+// stream the dynamic data of every frame through a persistently mapped buffer
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "StreamBuffer.h"
+
+#include <string.h>
+
+// declaration of global variables
+namespace
+{
+	// nanoseconds waited on a fence before checking it again
+	const GLuint64 g_FenceTimeout = 1000000;
+}
+
+/***********************************************************
+ *  StreamBuffer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+StreamBuffer::StreamBuffer(GLsizeiptr regionSize)
+{
+	m_buffer = 0;
+	m_pMapped = NULL;
+	m_regionSize = regionSize;
+	m_region = 0;
+	m_regionUsed = 0;
+	for (int i = 0; i < REGION_COUNT; i++)
+	{
+		m_fences[i] = NULL;
+	}
+	m_frameStats = STREAM_STATS();
+}
+
+/***********************************************************
+ *  ~StreamBuffer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+StreamBuffer::~StreamBuffer()
+{
+	for (int i = 0; i < REGION_COUNT; i++)
+	{
+		if (NULL != m_fences[i])
+		{
+			glDeleteSync(m_fences[i]);
+			m_fences[i] = NULL;
+		}
+	}
+	if (m_buffer != 0)
+	{
+		if (NULL != m_pMapped)
+		{
+			glUnmapNamedBuffer(m_buffer);
+			m_pMapped = NULL;
+		}
+		glDeleteBuffers(1, &m_buffer);
+		m_buffer = 0;
+	}
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used for creating the buffer with
+ *  immutable storage and mapping it once.  The mapping is
+ *  coherent, so the written data is seen by the GPU without
+ *  flushing it.
+ ***********************************************************/
+bool StreamBuffer::Initialize()
+{
+	if (NULL != m_pMapped)
+	{
+		return(true);
+	}
+	if ((GLEW_ARB_buffer_storage == GL_FALSE) || (m_regionSize <= 0))
+	{
+		return(false);
+	}
+
+	GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	glCreateBuffers(1, &m_buffer);
+	glNamedBufferStorage(m_buffer, m_regionSize * REGION_COUNT, NULL, flags);
+	m_pMapped = (GLubyte*)glMapNamedBufferRange(m_buffer, 0, m_regionSize * REGION_COUNT, flags);
+	if (NULL == m_pMapped)
+	{
+		glDeleteBuffers(1, &m_buffer);
+		m_buffer = 0;
+		return(false);
+	}
+
+	// the first frame begins by moving to region 0
+	m_region = REGION_COUNT - 1;
+	m_regionUsed = 0;
+	return(true);
+}
+
+/***********************************************************
+ *  BeginFrame()
+ *
+ *  This method is used for moving to the region of the next
+ *  frame.  The region was last written REGION_COUNT frames
+ *  ago, so its fence has usually passed and the wait returns
+ *  at once.
+ ***********************************************************/
+void StreamBuffer::BeginFrame()
+{
+	m_frameStats = STREAM_STATS();
+	if (NULL == m_pMapped)
+	{
+		return;
+	}
+
+	m_region = (m_region + 1) % REGION_COUNT;
+	m_regionUsed = 0;
+
+	GLsync fence = m_fences[m_region];
+	if (NULL == fence)
+	{
+		return;
+	}
+
+	GLenum result = glClientWaitSync(fence, 0, 0);
+	if ((result == GL_TIMEOUT_EXPIRED) || (result == GL_WAIT_FAILED))
+	{
+		m_frameStats.fenceWaits++;
+		// the first wait flushes the commands holding the fence
+		GLbitfield waitFlags = GL_SYNC_FLUSH_COMMANDS_BIT;
+		do
+		{
+			result = glClientWaitSync(fence, waitFlags, g_FenceTimeout);
+			waitFlags = 0;
+		} while (result == GL_TIMEOUT_EXPIRED);
+	}
+
+	glDeleteSync(fence);
+	m_fences[m_region] = NULL;
+}
+
+/***********************************************************
+ *  Write()
+ *
+ *  This method is used for copying data after the data
+ *  already written this frame.  The offset is rounded up to
+ *  the alignment, which must be a power of two - bound
+ *  ranges need the offset alignment of their target.
+ ***********************************************************/
+GLintptr StreamBuffer::Write(const void* pData, GLsizeiptr size, GLsizeiptr alignment)
+{
+	if (NULL == m_pMapped)
+	{
+		return(-1);
+	}
+
+	GLsizeiptr offset = m_regionUsed;
+	if (alignment > 1)
+	{
+		offset = (offset + alignment - 1) & ~(alignment - 1);
+	}
+	if (offset + size > m_regionSize)
+	{
+		m_frameStats.overflows++;
+		return(-1);
+	}
+
+	GLintptr bufferOffset = (GLintptr)m_region * m_regionSize + offset;
+	memcpy(m_pMapped + bufferOffset, pData, size);
+	m_regionUsed = offset + size;
+
+	m_frameStats.bytesWritten += size;
+	m_frameStats.writes++;
+	return(bufferOffset);
+}
+
+/***********************************************************
+ *  BindRange()
+ *
+ *  This method is used for binding written data to an
+ *  indexed binding point.
+ ***********************************************************/
+void StreamBuffer::BindRange(GLenum target, GLuint index, GLintptr offset, GLsizeiptr size) const
+{
+	glBindBufferRange(target, index, m_buffer, offset, size);
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used for placing a fence after the last
+ *  draw reading the region of the frame.
+ ***********************************************************/
+void StreamBuffer::EndFrame()
+{
+	if ((NULL == m_pMapped) || (m_regionUsed == 0))
+	{
+		return;
+	}
+
+	m_fences[m_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+}
@@ -0,0 +1,82 @@
+///////////////////////////////////////////////////////////////////////////////
+// streambuffer.h
+// ============
+// stream the dynamic data of every frame through a persistently mapped buffer
+//
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <GL/glew.h>
+
+/***********************************************************
+ *  StreamBuffer
+ *
+ *  This class keeps one buffer that stays mapped for its
+ *  whole life, split into a region per frame in flight.  The
+ *  data of a frame is written linearly into its region and
+ *  the shader reads it through bound ranges, so nothing is
+ *  copied by the driver.  A fence placed at the end of every
+ *  frame keeps a region from being written again until the
+ *  GPU has finished reading it.
+ ***********************************************************/
+class StreamBuffer
+{
+public:
+    // frames the CPU may run ahead of the GPU, plus the one
+    // being written
+    static const int REGION_COUNT = 3;
+
+    // writes of the current frame
+    struct STREAM_STATS
+    {
+        GLsizeiptr bytesWritten;
+        GLuint writes;
+        // writes that did not fit in the region
+        GLuint overflows;
+        // frames that had to wait for the GPU to free their region
+        GLuint fenceWaits;
+    };
+
+    // constructor - the region size is the most data one frame
+    // can write
+    StreamBuffer(GLsizeiptr regionSize);
+    // destructor
+    ~StreamBuffer();
+
+    // create and map the buffer - returns false when the driver
+    // has no persistent mapping
+    bool Initialize();
+
+    // move to the region of the next frame, waiting for the GPU
+    // when it is still reading that region
+    void BeginFrame();
+    // copy data into the region of the frame at the given
+    // alignment - returns the offset of the data in the buffer,
+    // or -1 when the region is full
+    GLintptr Write(const void* pData, GLsizeiptr size, GLsizeiptr alignment);
+    // bind written data to an indexed binding point, such as a
+    // storage block
+    void BindRange(GLenum target, GLuint index, GLintptr offset, GLsizeiptr size) const;
+    // mark the end of the reads of the frame
+    void EndFrame();
+
+    // true when the buffer is mapped and can be written
+    bool IsMapped() const { return (NULL != m_pMapped); }
+    // buffer holding every region
+    GLuint GetBuffer() const { return m_buffer; }
+    // most data one frame can write
+    GLsizeiptr GetRegionSize() const { return m_regionSize; }
+    // writes since the frame began
+    const STREAM_STATS& GetFrameStats() const { return m_frameStats; }
+
+private:
+    // persistently mapped buffer and its mapping
+    GLuint m_buffer;
+    GLubyte* m_pMapped;
+    GLsizeiptr m_regionSize;
+    // region of the current frame and the bytes written to it
+    int m_region;
+    GLsizeiptr m_regionUsed;
+    // fence of the last frame that wrote each region
+    GLsync m_fences[REGION_COUNT];
+    STREAM_STATS m_frameStats;
+};
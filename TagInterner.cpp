@@ -0,0 +1,148 @@
+///////////////////////////////////////////////////////////////////////////////
+// taginterner.cpp
+// ============
+// turn the string tags of textures and materials into compact integer IDs
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TagInterner.h"
+
+#include <string.h>
+
+// declaration of global variables
+namespace
+{
+	// slots of a new hash table
+	const size_t g_InitialSlotCount = 64;
+}
+
+/***********************************************************
+ *  TagInterner()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+TagInterner::TagInterner()
+{
+	m_slots.assign(g_InitialSlotCount, 0);
+}
+
+/***********************************************************
+ *  HashTag()
+ *
+ *  This method is used for hashing the tag characters with
+ *  32 bit FNV-1a.
+ ***********************************************************/
+uint32_t TagInterner::HashTag(const char* tag, size_t length)
+{
+	uint32_t hash = 2166136261u;
+	for (size_t i = 0; i < length; i++)
+	{
+		hash ^= (unsigned char)tag[i];
+		hash *= 16777619u;
+	}
+	return(hash);
+}
+
+/***********************************************************
+ *  FindSlot()
+ *
+ *  This method is used for probing the hash table from the
+ *  slot of the hash until the slot of the tag or an empty
+ *  slot is found.  The stored hashes are compared before the
+ *  strings, so other tags on the way are skipped without
+ *  touching their characters.
+ ***********************************************************/
+size_t TagInterner::FindSlot(const char* tag, size_t length, uint32_t hash) const
+{
+	size_t mask = m_slots.size() - 1;
+	size_t slot = hash & mask;
+	while (m_slots[slot] != 0)
+	{
+		uint32_t tagID = m_slots[slot] - 1;
+		if ((m_hashes[tagID] == hash) &&
+			(m_strings[tagID].size() == length) &&
+			(memcmp(m_strings[tagID].data(), tag, length) == 0))
+		{
+			break;
+		}
+		slot = (slot + 1) & mask;
+	}
+	return(slot);
+}
+
+/***********************************************************
+ *  Intern()
+ *
+ *  This method is used for getting the ID of a tag, giving
+ *  it the next ID when it has not been interned before.  The
+ *  table is kept at most half full, so probes stay short.
+ ***********************************************************/
+TagInterner::TAG_ID TagInterner::Intern(const std::string& tag)
+{
+	uint32_t hash = HashTag(tag.data(), tag.size());
+	size_t slot = FindSlot(tag.data(), tag.size(), hash);
+	if (m_slots[slot] != 0)
+	{
+		return((TAG_ID)(m_slots[slot] - 1));
+	}
+
+	TAG_ID tagID = (TAG_ID)m_strings.size();
+	m_strings.push_back(tag);
+	m_hashes.push_back(hash);
+	m_slots[slot] = (uint32_t)tagID + 1;
+
+	if (m_strings.size() * 2 > m_slots.size())
+	{
+		Grow();
+	}
+	return(tagID);
+}
+
+/***********************************************************
+ *  Find()
+ *
+ *  This method is used for getting the ID of an interned
+ *  tag without adding it.
+ ***********************************************************/
+TagInterner::TAG_ID TagInterner::Find(const std::string& tag) const
+{
+	return(Find(tag.data(), tag.size()));
+}
+
+/***********************************************************
+ *  Find()
+ *
+ *  This method is used for getting the ID of the interned
+ *  tag with the characters, such as part of a longer string,
+ *  without copying them into a string first.
+ ***********************************************************/
+TagInterner::TAG_ID TagInterner::Find(const char* tag, size_t length) const
+{
+	size_t slot = FindSlot(tag, length, HashTag(tag, length));
+	if (m_slots[slot] == 0)
+	{
+		return(INVALID_TAG);
+	}
+	return((TAG_ID)(m_slots[slot] - 1));
+}
+
+/***********************************************************
+ *  Grow()
+ *
+ *  This method is used for doubling the hash table and
+ *  inserting every tag again from its stored hash.
+ ***********************************************************/
+void TagInterner::Grow()
+{
+	m_slots.assign(m_slots.size() * 2, 0);
+	size_t mask = m_slots.size() - 1;
+	for (uint32_t tagID = 0; tagID < (uint32_t)m_strings.size(); tagID++)
+	{
+		size_t slot = m_hashes[tagID] & mask;
+		while (m_slots[slot] != 0)
+		{
+			slot = (slot + 1) & mask;
+		}
+		m_slots[slot] = tagID + 1;
+	}
+}
@@ -0,0 +1,62 @@
+///////////////////////////////////////////////////////////////////////////////
+// taginterner.h
+// ============
+// turn the string tags of textures and materials into compact integer IDs
+//
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+/***********************************************************
+ *  TagInterner
+ *
+ *  This class gives every distinct tag string a small
+ *  integer ID, numbered from 0 in the order the tags are
+ *  interned, so tables can be indexed by tag.  The strings
+ *  are found through a flat open addressing hash table that
+ *  stores the IDs and probes linearly, so a lookup hashes
+ *  the tag once and usually compares a single string.
+ ***********************************************************/
+class TagInterner
+{
+public:
+    // ID of an interned tag - a distinct type, so it is not
+    // mistaken for an index
+    enum TAG_ID : uint32_t
+    {
+        INVALID_TAG = 0xFFFFFFFF
+    };
+
+    // constructor
+    TagInterner();
+
+    // get the ID of the tag, interning it when it is new
+    TAG_ID Intern(const std::string& tag);
+    // get the ID of an interned tag, or INVALID_TAG
+    TAG_ID Find(const std::string& tag) const;
+    // get the ID of the interned tag with the characters, or
+    // INVALID_TAG - the characters need no terminating zero
+    TAG_ID Find(const char* tag, size_t length) const;
+
+    // string of an interned tag
+    const std::string& GetString(TAG_ID tagID) const { return m_strings[tagID]; }
+    // number of interned tags - every ID is below it
+    uint32_t GetCount() const { return (uint32_t)m_strings.size(); }
+
+private:
+    // tag strings and their hashes, by ID
+    std::vector<std::string> m_strings;
+    std::vector<uint32_t> m_hashes;
+    // hash table of ID + 1, 0 for an empty slot, with a power of
+    // two size
+    std::vector<uint32_t> m_slots;
+
+    // hash of the tag characters
+    static uint32_t HashTag(const char* tag, size_t length);
+    // slot holding the tag, or the empty slot it would go in
+    size_t FindSlot(const char* tag, size_t length, uint32_t hash) const;
+    // double the hash table and insert every tag again
+    void Grow();
+};
@@ -0,0 +1,698 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturecache.cpp
+// ============
+// cook texture images into block compressed mip chains kept on disk
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TextureCache.h"
+#include "stb_image.h"
+
+#include <algorithm>
+#include <limits.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#include <direct.h>
+#else
+#include <unistd.h>
+#endif
+
+// declaration of global variables
+namespace
+{
+	// "BTEX" at the start of every cache file
+	const uint32_t g_CacheMagic = 0x58455442;
+	// images are flipped when cooked, as they are when loaded
+	// for the texture coordinates of the meshes
+	const uint32_t g_CookFlipsImages = 1;
+
+	// header at the start of a cache file, followed by the mip
+	// levels and then the level data
+	struct CACHE_HEADER
+	{
+		uint32_t magic;
+		uint32_t version;
+		uint64_t key;
+		uint32_t format;
+		uint32_t width;
+		uint32_t height;
+		uint32_t levelCount;
+	};
+
+	/***********************************************************
+	 *  HashBytes()
+	 *
+	 *  Continue a 64 bit FNV-1a hash over the bytes.
+	 ***********************************************************/
+	uint64_t HashBytes(uint64_t hash, const void* pBytes, size_t size)
+	{
+		const unsigned char* pByte = (const unsigned char*)pBytes;
+		for (size_t i = 0; i < size; i++)
+		{
+			hash ^= pByte[i];
+			hash *= 0x100000001B3ull;
+		}
+		return(hash);
+	}
+
+	const uint64_t g_HashStart = 0xCBF29CE484222325ull;
+
+	/***********************************************************
+	 *  PackColor()
+	 *
+	 *  Round an RGB color to the 5:6:5 bits of a block endpoint.
+	 ***********************************************************/
+	uint16_t PackColor(const float* pColor)
+	{
+		int red = (int)(std::min(std::max(pColor[0], 0.0f), 255.0f) * 31.0f / 255.0f + 0.5f);
+		int green = (int)(std::min(std::max(pColor[1], 0.0f), 255.0f) * 63.0f / 255.0f + 0.5f);
+		int blue = (int)(std::min(std::max(pColor[2], 0.0f), 255.0f) * 31.0f / 255.0f + 0.5f);
+		return((uint16_t)((red << 11) | (green << 5) | blue));
+	}
+
+	/***********************************************************
+	 *  UnpackColor()
+	 *
+	 *  Expand a 5:6:5 endpoint to the 8 bit color the GPU
+	 *  decodes it to.
+	 ***********************************************************/
+	void UnpackColor(uint16_t packed, int* pColor)
+	{
+		int red = (packed >> 11) & 31;
+		int green = (packed >> 5) & 63;
+		int blue = packed & 31;
+		pColor[0] = (red << 3) | (red >> 2);
+		pColor[1] = (green << 2) | (green >> 4);
+		pColor[2] = (blue << 3) | (blue >> 2);
+	}
+
+	/***********************************************************
+	 *  HalveImage()
+	 *
+	 *  Average every 2x2 square of RGBA pixels into the next
+	 *  mip level.  An odd last row or column is averaged with
+	 *  itself.
+	 ***********************************************************/
+	void HalveImage(
+		const std::vector<unsigned char>& source, int width, int height,
+		std::vector<unsigned char>& level, int levelWidth, int levelHeight)
+	{
+		level.resize((size_t)levelWidth * levelHeight * 4);
+		for (int y = 0; y < levelHeight; y++)
+		{
+			int y0 = std::min(y * 2, height - 1);
+			int y1 = std::min(y * 2 + 1, height - 1);
+			for (int x = 0; x < levelWidth; x++)
+			{
+				int x0 = std::min(x * 2, width - 1);
+				int x1 = std::min(x * 2 + 1, width - 1);
+				for (int channel = 0; channel < 4; channel++)
+				{
+					int sum = source[((size_t)y0 * width + x0) * 4 + channel]
+						+ source[((size_t)y0 * width + x1) * 4 + channel]
+						+ source[((size_t)y1 * width + x0) * 4 + channel]
+						+ source[((size_t)y1 * width + x1) * 4 + channel];
+					level[((size_t)y * levelWidth + x) * 4 + channel] = (unsigned char)((sum + 2) / 4);
+				}
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  GetLevelData()
+ *
+ *  This method is used for getting the start of the level
+ *  data, in the cache file or the cooked bytes.
+ ***********************************************************/
+const unsigned char* TextureCache::COMPRESSED_TEXTURE::GetLevelData() const
+{
+	if (NULL != pCacheFile)
+	{
+		return(pCacheFile->GetData() + dataOffset);
+	}
+	return(cookedData.data());
+}
+
+/***********************************************************
+ *  GetDataSize()
+ *
+ *  This method is used for getting the bytes of every level.
+ ***********************************************************/
+size_t TextureCache::COMPRESSED_TEXTURE::GetDataSize() const
+{
+	if (levels.empty() == true)
+	{
+		return(0);
+	}
+	return((size_t)levels.back().offset + levels.back().size);
+}
+
+/***********************************************************
+ *  TextureCache()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+TextureCache::TextureCache(const char* directory)
+{
+	m_directory = directory;
+}
+
+/***********************************************************
+ *  GetCachePath()
+ *
+ *  This method is used for naming the cache file of an image
+ *  file after a hash of its path.  The time and settings are
+ *  kept in the file rather than in its name, so an image that
+ *  changes replaces its old cache file.
+ ***********************************************************/
+std::string TextureCache::GetCachePath(const char* filename) const
+{
+	uint64_t pathHash = HashBytes(g_HashStart, filename, strlen(filename));
+	char name[32];
+	snprintf(name, sizeof(name), "%016llx.btex", (unsigned long long)pathHash);
+	return(m_directory + "/" + name);
+}
+
+/***********************************************************
+ *  GetExecutableDirectory()
+ *
+ *  This method is used for finding the directory of the
+ *  running executable, so files kept next to it do not
+ *  depend on the working directory the program is started
+ *  from.
+ ***********************************************************/
+std::string TextureCache::GetExecutableDirectory()
+{
+	char path[4096];
+#ifdef _WIN32
+	DWORD length = GetModuleFileNameA(NULL, path, sizeof(path));
+	if ((length == 0) || (length >= sizeof(path)))
+	{
+		return(std::string());
+	}
+#else
+	ssize_t length = readlink("/proc/self/exe", path, sizeof(path) - 1);
+	if (length <= 0)
+	{
+		return(std::string());
+	}
+#endif
+	std::string directory(path, (size_t)length);
+
+	// everything up to the last separator, which is kept
+	size_t separator = directory.find_last_of("/\\");
+	if (separator == std::string::npos)
+	{
+		return(std::string());
+	}
+	return(directory.substr(0, separator + 1));
+}
+
+/***********************************************************
+ *  ComputeKey()
+ *
+ *  This method is used for hashing the image path, the time
+ *  it was written and its size together with the settings
+ *  the image is cooked with.
+ ***********************************************************/
+bool TextureCache::ComputeKey(const char* filename, uint64_t& key) const
+{
+	struct stat fileStat;
+	if (stat(filename, &fileStat) != 0)
+	{
+		return(false);
+	}
+
+	int64_t modifiedTime = (int64_t)fileStat.st_mtime;
+	int64_t fileSize = (int64_t)fileStat.st_size;
+	uint32_t version = CACHE_VERSION;
+
+	key = HashBytes(g_HashStart, filename, strlen(filename));
+	key = HashBytes(key, &modifiedTime, sizeof(modifiedTime));
+	key = HashBytes(key, &fileSize, sizeof(fileSize));
+	key = HashBytes(key, &version, sizeof(version));
+	key = HashBytes(key, &g_CookFlipsImages, sizeof(g_CookFlipsImages));
+	return(true);
+}
+
+/***********************************************************
+ *  LoadTexture()
+ *
+ *  This method is used for getting the compressed texture of
+ *  an image file - mapped from its cache file when the file
+ *  matches the key, otherwise decoded, cooked and written to
+ *  the cache file for the next load.
+ ***********************************************************/
+bool TextureCache::LoadTexture(const char* filename, COMPRESSED_TEXTURE& texture, bool& bCacheHit) const
+{
+	bCacheHit = false;
+	uint64_t key = 0;
+	if (ComputeKey(filename, key) == false)
+	{
+		return(false);
+	}
+
+	std::string cachePath = GetCachePath(filename);
+	if (ReadCacheFile(cachePath, key, texture) == true)
+	{
+		bCacheHit = true;
+		return(true);
+	}
+
+	// the flag is set for this thread only, as other threads may
+	// be decoding images at the same time
+	stbi_set_flip_vertically_on_load_thread(g_CookFlipsImages);
+	int width = 0;
+	int height = 0;
+	int channels = 0;
+	unsigned char* pPixels = DecodeImageFile(filename, width, height, channels, 4);
+	if (NULL == pPixels)
+	{
+		return(false);
+	}
+	CookTexture(pPixels, width, height, (channels == 4), texture);
+	stbi_image_free(pPixels);
+
+	// a texture that can not be written is still returned, and
+	// is cooked again next time
+	WriteCacheFile(cachePath, key, texture);
+	return(true);
+}
+
+/***********************************************************
+ *  ReleaseTexture()
+ *
+ *  This method is used for freeing the level data of a
+ *  texture.
+ ***********************************************************/
+void TextureCache::ReleaseTexture(COMPRESSED_TEXTURE& texture)
+{
+	delete texture.pCacheFile;
+	texture.pCacheFile = NULL;
+	texture.dataOffset = 0;
+	texture.cookedData.clear();
+	texture.cookedData.shrink_to_fit();
+	texture.levels.clear();
+}
+
+/***********************************************************
+ *  DecodeImageFile()
+ *
+ *  This method is used for decoding an image file straight
+ *  from its mapped bytes, rather than letting stb_image read
+ *  it through stdio into buffers of its own.  The mapping is
+ *  released as soon as the pixels are decoded.  The image is
+ *  flipped as set for the calling thread.
+ ***********************************************************/
+unsigned char* TextureCache::DecodeImageFile(
+	const char* filename, int& width, int& height, int& channels, int desiredChannels)
+{
+	MappedFile file;
+	// stb_image takes the size of the encoded image as an int
+	if ((file.Open(filename) == false) || (file.GetSize() > (size_t)INT_MAX))
+	{
+		return(NULL);
+	}
+	return(stbi_load_from_memory(file.GetData(), (int)file.GetSize(), &width, &height, &channels, desiredChannels));
+}
+
+/***********************************************************
+ *  ReadCacheFile()
+ *
+ *  This method is used for mapping a cache file and checking
+ *  that it was cooked from the same image with the same
+ *  settings and holds every level it lists.
+ ***********************************************************/
+bool TextureCache::ReadCacheFile(const std::string& cachePath, uint64_t key, COMPRESSED_TEXTURE& texture) const
+{
+	MappedFile* pFile = new MappedFile();
+	if (pFile->Open(cachePath.c_str()) == false)
+	{
+		delete pFile;
+		return(false);
+	}
+
+	CACHE_HEADER header;
+	bool bValid = (pFile->GetSize() >= sizeof(header));
+	if (bValid == true)
+	{
+		memcpy(&header, pFile->GetData(), sizeof(header));
+		bValid = (header.magic == g_CacheMagic) && (header.version == CACHE_VERSION)
+			&& (header.key == key) && (header.levelCount > 0) && (header.levelCount <= 32);
+	}
+
+	size_t dataOffset = sizeof(header) + (bValid ? header.levelCount : 0) * sizeof(MIP_LEVEL);
+	if ((bValid == true) && (pFile->GetSize() >= dataOffset))
+	{
+		texture.levels.resize(header.levelCount);
+		memcpy(texture.levels.data(), pFile->GetData() + sizeof(header), header.levelCount * sizeof(MIP_LEVEL));
+		for (uint32_t level = 0; level < header.levelCount; level++)
+		{
+			if ((size_t)texture.levels[level].offset + texture.levels[level].size > pFile->GetSize() - dataOffset)
+			{
+				bValid = false;
+			}
+		}
+	}
+	else
+	{
+		bValid = false;
+	}
+
+	if (bValid == false)
+	{
+		texture.levels.clear();
+		delete pFile;
+		return(false);
+	}
+
+	texture.format = header.format;
+	texture.width = header.width;
+	texture.height = header.height;
+	texture.cookedData.clear();
+	texture.pCacheFile = pFile;
+	texture.dataOffset = dataOffset;
+	return(true);
+}
+
+/***********************************************************
+ *  WriteCacheFile()
+ *
+ *  This method is used for writing a cooked texture to its
+ *  cache file, creating the cache directory if needed.  The
+ *  texture is written to a temporary file that then replaces
+ *  the cache file, so a reader never maps a file that is only
+ *  partly written, and an interrupted write leaves the old
+ *  cache file as it was.
+ ***********************************************************/
+bool TextureCache::WriteCacheFile(const std::string& cachePath, uint64_t key, const COMPRESSED_TEXTURE& texture) const
+{
+#ifdef _WIN32
+	_mkdir(m_directory.c_str());
+#else
+	mkdir(m_directory.c_str(), 0755);
+#endif
+
+	std::string tempPath = cachePath + ".tmp";
+	FILE* pFile = fopen(tempPath.c_str(), "wb");
+	if (NULL == pFile)
+	{
+		return(false);
+	}
+
+	CACHE_HEADER header;
+	header.magic = g_CacheMagic;
+	header.version = CACHE_VERSION;
+	header.key = key;
+	header.format = texture.format;
+	header.width = texture.width;
+	header.height = texture.height;
+	header.levelCount = (uint32_t)texture.levels.size();
+
+	bool bWritten = (fwrite(&header, sizeof(header), 1, pFile) == 1)
+		&& (fwrite(texture.levels.data(), sizeof(MIP_LEVEL), texture.levels.size(), pFile) == texture.levels.size())
+		&& (fwrite(texture.GetLevelData(), 1, texture.GetDataSize(), pFile) == texture.GetDataSize());
+	bWritten = (fclose(pFile) == 0) && (bWritten == true);
+
+	// rename() does not replace an existing file on Windows
+	if (bWritten == true)
+	{
+#ifdef _WIN32
+		bWritten = (MoveFileExA(tempPath.c_str(), cachePath.c_str(), MOVEFILE_REPLACE_EXISTING) != 0);
+#else
+		bWritten = (rename(tempPath.c_str(), cachePath.c_str()) == 0);
+#endif
+	}
+	if (bWritten == false)
+	{
+		remove(tempPath.c_str());
+	}
+	return(bWritten);
+}
+
+/***********************************************************
+ *  CookTexture()
+ *
+ *  This method is used for halving the image down to a
+ *  single pixel and encoding every level in 4x4 blocks.  The
+ *  edge blocks of levels whose size is not a multiple of 4
+ *  repeat the last row and column.
+ ***********************************************************/
+void TextureCache::CookTexture(
+	const unsigned char* pPixels, int width, int height, bool bAlpha,
+	COMPRESSED_TEXTURE& texture)
+{
+	ReleaseTexture(texture);
+	texture.format = (bAlpha == true) ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+	texture.width = (uint32_t)width;
+	texture.height = (uint32_t)height;
+	uint32_t blockBytes = (bAlpha == true) ? 16 : 8;
+
+	std::vector<unsigned char> image(pPixels, pPixels + (size_t)width * height * 4);
+	std::vector<unsigned char> nextImage;
+	int levelWidth = width;
+	int levelHeight = height;
+	while (true)
+	{
+		MIP_LEVEL level;
+		level.width = (uint32_t)levelWidth;
+		level.height = (uint32_t)levelHeight;
+		level.offset = (uint32_t)texture.cookedData.size();
+		int blocksWide = (levelWidth + 3) / 4;
+		int blocksHigh = (levelHeight + 3) / 4;
+		level.size = (uint32_t)(blocksWide * blocksHigh) * blockBytes;
+		texture.cookedData.resize(texture.cookedData.size() + level.size);
+		texture.levels.push_back(level);
+
+		unsigned char* pOutput = texture.cookedData.data() + level.offset;
+		unsigned char block[16 * 4];
+		for (int blockY = 0; blockY < blocksHigh; blockY++)
+		{
+			for (int blockX = 0; blockX < blocksWide; blockX++)
+			{
+				for (int pixel = 0; pixel < 16; pixel++)
+				{
+					int x = std::min(blockX * 4 + (pixel % 4), levelWidth - 1);
+					int y = std::min(blockY * 4 + (pixel / 4), levelHeight - 1);
+					memcpy(&block[pixel * 4], &image[((size_t)y * levelWidth + x) * 4], 4);
+				}
+				if (bAlpha == true)
+				{
+					EncodeAlphaBlock(block, pOutput);
+					pOutput += 8;
+				}
+				EncodeColorBlock(block, pOutput);
+				pOutput += 8;
+			}
+		}
+
+		if ((levelWidth == 1) && (levelHeight == 1))
+		{
+			break;
+		}
+		int nextWidth = std::max(levelWidth / 2, 1);
+		int nextHeight = std::max(levelHeight / 2, 1);
+		HalveImage(image, levelWidth, levelHeight, nextImage, nextWidth, nextHeight);
+		image.swap(nextImage);
+		levelWidth = nextWidth;
+		levelHeight = nextHeight;
+	}
+}
+
+/***********************************************************
+ *  EncodeColorBlock()
+ *
+ *  This method is used for encoding the colors of a block.
+ *  The endpoints are the two pixels farthest apart along the
+ *  main axis of the block colors, found by a few rounds of
+ *  power iteration on their covariance, and every pixel takes
+ *  the nearest of the four colors between them.  The first
+ *  endpoint is always the larger, which selects the four
+ *  color mode.
+ ***********************************************************/
+void TextureCache::EncodeColorBlock(const unsigned char* pBlock, unsigned char* pOutput)
+{
+	float mean[3] = { 0.0f, 0.0f, 0.0f };
+	for (int pixel = 0; pixel < 16; pixel++)
+	{
+		for (int channel = 0; channel < 3; channel++)
+		{
+			mean[channel] += pBlock[pixel * 4 + channel];
+		}
+	}
+	for (int channel = 0; channel < 3; channel++)
+	{
+		mean[channel] /= 16.0f;
+	}
+
+	float covariance[6] = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
+	for (int pixel = 0; pixel < 16; pixel++)
+	{
+		float red = pBlock[pixel * 4 + 0] - mean[0];
+		float green = pBlock[pixel * 4 + 1] - mean[1];
+		float blue = pBlock[pixel * 4 + 2] - mean[2];
+		covariance[0] += red * red;
+		covariance[1] += red * green;
+		covariance[2] += red * blue;
+		covariance[3] += green * green;
+		covariance[4] += green * blue;
+		covariance[5] += blue * blue;
+	}
+
+	float axis[3] = { 1.0f, 1.0f, 1.0f };
+	for (int iteration = 0; iteration < 4; iteration++)
+	{
+		float next[3];
+		next[0] = covariance[0] * axis[0] + covariance[1] * axis[1] + covariance[2] * axis[2];
+		next[1] = covariance[1] * axis[0] + covariance[3] * axis[1] + covariance[4] * axis[2];
+		next[2] = covariance[2] * axis[0] + covariance[4] * axis[1] + covariance[5] * axis[2];
+		float largest = std::max(std::max(fabsf(next[0]), fabsf(next[1])), fabsf(next[2]));
+		if (largest < 1e-6f)
+		{
+			break;
+		}
+		for (int channel = 0; channel < 3; channel++)
+		{
+			axis[channel] = next[channel] / largest;
+		}
+	}
+
+	int minPixel = 0;
+	int maxPixel = 0;
+	float minDot = 1e30f;
+	float maxDot = -1e30f;
+	for (int pixel = 0; pixel < 16; pixel++)
+	{
+		float dot = pBlock[pixel * 4 + 0] * axis[0] + pBlock[pixel * 4 + 1] * axis[1] + pBlock[pixel * 4 + 2] * axis[2];
+		if (dot < minDot)
+		{
+			minDot = dot;
+			minPixel = pixel;
+		}
+		if (dot > maxDot)
+		{
+			maxDot = dot;
+			maxPixel = pixel;
+		}
+	}
+
+	float maxColor[3];
+	float minColor[3];
+	for (int channel = 0; channel < 3; channel++)
+	{
+		maxColor[channel] = pBlock[maxPixel * 4 + channel];
+		minColor[channel] = pBlock[minPixel * 4 + channel];
+	}
+	uint16_t color0 = PackColor(maxColor);
+	uint16_t color1 = PackColor(minColor);
+	if (color0 < color1)
+	{
+		std::swap(color0, color1);
+	}
+
+	uint32_t indices = 0;
+	if (color0 != color1)
+	{
+		int palette[4][3];
+		UnpackColor(color0, palette[0]);
+		UnpackColor(color1, palette[1]);
+		for (int channel = 0; channel < 3; channel++)
+		{
+			palette[2][channel] = (2 * palette[0][channel] + palette[1][channel]) / 3;
+			palette[3][channel] = (palette[0][channel] + 2 * palette[1][channel]) / 3;
+		}
+
+		for (int pixel = 0; pixel < 16; pixel++)
+		{
+			int bestIndex = 0;
+			int bestError = 0x7FFFFFFF;
+			for (int index = 0; index < 4; index++)
+			{
+				int error = 0;
+				for (int channel = 0; channel < 3; channel++)
+				{
+					int difference = pBlock[pixel * 4 + channel] - palette[index][channel];
+					error += difference * difference;
+				}
+				if (error < bestError)
+				{
+					bestError = error;
+					bestIndex = index;
+				}
+			}
+			indices |= (uint32_t)bestIndex << (pixel * 2);
+		}
+	}
+
+	pOutput[0] = (unsigned char)color0;
+	pOutput[1] = (unsigned char)(color0 >> 8);
+	pOutput[2] = (unsigned char)color1;
+	pOutput[3] = (unsigned char)(color1 >> 8);
+	for (int byte = 0; byte < 4; byte++)
+	{
+		pOutput[4 + byte] = (unsigned char)(indices >> (byte * 8));
+	}
+}
+
+/***********************************************************
+ *  EncodeAlphaBlock()
+ *
+ *  This method is used for encoding the alpha of a block
+ *  between its largest and smallest alpha, with the eight
+ *  alpha values mode and three index bits per pixel.
+ ***********************************************************/
+void TextureCache::EncodeAlphaBlock(const unsigned char* pBlock, unsigned char* pOutput)
+{
+	int alpha0 = 0;
+	int alpha1 = 255;
+	for (int pixel = 0; pixel < 16; pixel++)
+	{
+		alpha0 = std::max(alpha0, (int)pBlock[pixel * 4 + 3]);
+		alpha1 = std::min(alpha1, (int)pBlock[pixel * 4 + 3]);
+	}
+
+	uint64_t indices = 0;
+	if (alpha0 != alpha1)
+	{
+		int palette[8];
+		palette[0] = alpha0;
+		palette[1] = alpha1;
+		for (int index = 2; index < 8; index++)
+		{
+			palette[index] = ((8 - index) * alpha0 + (index - 1) * alpha1) / 7;
+		}
+
+		for (int pixel = 0; pixel < 16; pixel++)
+		{
+			int bestIndex = 0;
+			int bestError = 256;
+			for (int index = 0; index < 8; index++)
+			{
+				int error = abs(pBlock[pixel * 4 + 3] - palette[index]);
+				if (error < bestError)
+				{
+					bestError = error;
+					bestIndex = index;
+				}
+			}
+			indices |= (uint64_t)bestIndex << (pixel * 3);
+		}
+	}
+
+	pOutput[0] = (unsigned char)alpha0;
+	pOutput[1] = (unsigned char)alpha1;
+	for (int byte = 0; byte < 6; byte++)
+	{
+		pOutput[2 + byte] = (unsigned char)(indices >> (byte * 8));
+	}
+}
@@ -0,0 +1,107 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturecache.h
+// ============
+// cook texture images into block compressed mip chains kept on disk
+//
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "MappedFile.h"
+#include <GL/glew.h>
+#include <string>
+#include <vector>
+#include <stdint.h>
+
+/***********************************************************
+ *  TextureCache
+ *
+ *  This class turns a texture image into the full chain of
+ *  mip levels, each encoded on the CPU in a block format the
+ *  GPU samples directly - BC1 for opaque images and BC3 for
+ *  images with alpha - and keeps the result in a cache file.
+ *  The cache file is keyed by the image path, its time and
+ *  size, and the cook settings, so a later load maps the file
+ *  and hands the levels to the GPU as they are, without
+ *  decoding the image or generating mipmaps.
+ ***********************************************************/
+class TextureCache
+{
+public:
+    // version of the cache files and of the encoder - changing
+    // it cooks every image again
+    static const uint32_t CACHE_VERSION = 1;
+
+    // one level of the mip chain
+    struct MIP_LEVEL
+    {
+        uint32_t width;
+        uint32_t height;
+        uint32_t offset;    // from the start of the level data
+        uint32_t size;
+    };
+
+    // a block compressed texture, either cooked in memory or
+    // read from a mapped cache file
+    struct COMPRESSED_TEXTURE
+    {
+        GLenum format;
+        uint32_t width;
+        uint32_t height;
+        std::vector<MIP_LEVEL> levels;
+        // level data of a cooked texture
+        std::vector<unsigned char> cookedData;
+        // cache file holding the level data from dataOffset on
+        MappedFile* pCacheFile;
+        size_t dataOffset;
+
+        COMPRESSED_TEXTURE() : format(0), width(0), height(0), pCacheFile(NULL), dataOffset(0) {}
+        // start of the level data
+        const unsigned char* GetLevelData() const;
+        // bytes of every level
+        size_t GetDataSize() const;
+    };
+
+    // constructor - the cache files are kept in the directory,
+    // which is created when the first file is written
+    TextureCache(const char* directory);
+
+    // read the texture of the image file from its cache file, or
+    // cook it and write the cache file when there is none or it
+    // is out of date - returns false when the image can not be
+    // read, and is safe to call from several threads
+    bool LoadTexture(const char* filename, COMPRESSED_TEXTURE& texture, bool& bCacheHit) const;
+    // free the level data or unmap the cache file
+    static void ReleaseTexture(COMPRESSED_TEXTURE& texture);
+    // decode an image file mapped into memory, with the same
+    // arguments and result as stbi_load
+    static unsigned char* DecodeImageFile(
+        const char* filename, int& width, int& height, int& channels, int desiredChannels);
+
+    // build the mip chain of the RGBA pixels and encode every
+    // level, as BC3 when bAlpha is true and as BC1 otherwise
+    static void CookTexture(
+        const unsigned char* pPixels, int width, int height, bool bAlpha,
+        COMPRESSED_TEXTURE& texture);
+    // encode a block of 4x4 RGBA pixels into 8 bytes of BC1
+    static void EncodeColorBlock(const unsigned char* pBlock, unsigned char* pOutput);
+    // encode the alpha of a block of 4x4 RGBA pixels into the
+    // first 8 bytes of a BC3 block
+    static void EncodeAlphaBlock(const unsigned char* pBlock, unsigned char* pOutput);
+
+    const std::string& GetDirectory() const { return m_directory; }
+    // path of the cache file of an image file
+    std::string GetCachePath(const char* filename) const;
+    // directory of the running executable, ending in a path
+    // separator, or an empty string when it is not known
+    static std::string GetExecutableDirectory();
+
+private:
+    std::string m_directory;
+
+    // key of the image file and the cook settings - returns false
+    // when the image file does not exist
+    bool ComputeKey(const char* filename, uint64_t& key) const;
+    // map the cache file when it holds the texture of the key
+    bool ReadCacheFile(const std::string& cachePath, uint64_t key, COMPRESSED_TEXTURE& texture) const;
+    // write a cooked texture to its cache file
+    bool WriteCacheFile(const std::string& cachePath, uint64_t key, const COMPRESSED_TEXTURE& texture) const;
+};
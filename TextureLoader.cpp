@@ -0,0 +1,415 @@
+///////////////////////////////////////////////////////////////////////////////
+// textureloader.cpp
+// ============
+// decode texture images on worker threads and upload them as they are ready
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TextureLoader.h"
+#include "JobSystem.h"
+#include "stb_image.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string.h>
+
+// declaration of global variables
+namespace
+{
+	// size and color of the placeholder shown while an image is
+	// decoded - a mid grey that does not stand out when lit
+	const int g_PlaceholderSize = 2;
+	const unsigned char g_PlaceholderValue = 128;
+
+	/***********************************************************
+	 *  ElapsedSeconds()
+	 *
+	 *  Seconds since the passed in start time.
+	 ***********************************************************/
+	double ElapsedSeconds(std::chrono::high_resolution_clock::time_point start)
+	{
+		std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+		return(elapsed.count());
+	}
+}
+
+/***********************************************************
+ *  TextureLoader()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+TextureLoader::TextureLoader(JobSystem* pJobSystem)
+{
+	m_pJobSystem = pJobSystem;
+	m_pTextureCache = NULL;
+	m_pixelBuffer = 0;
+	m_pendingCount = 0;
+	m_decodingCount = 0;
+	m_stats = LOAD_STATS();
+}
+
+/***********************************************************
+ *  ~TextureLoader()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+TextureLoader::~TextureLoader()
+{
+	// the decodes still running write into this loader
+	std::unique_lock<std::mutex> lock(m_decodedMutex);
+	m_imageDecoded.wait(lock, [this]() { return(m_decodingCount == 0); });
+	while (m_decodedImages.empty() == false)
+	{
+		stbi_image_free(m_decodedImages.front().pPixels);
+		TextureCache::ReleaseTexture(m_decodedImages.front().compressed);
+		m_decodedImages.pop_front();
+	}
+	lock.unlock();
+
+	if (m_pixelBuffer != 0)
+	{
+		glDeleteBuffers(1, &m_pixelBuffer);
+		m_pixelBuffer = 0;
+	}
+	m_pJobSystem = NULL;
+}
+
+/***********************************************************
+ *  SetTextureCache()
+ *
+ *  This method is used for loading the images requested from
+ *  now on through the cache of compressed textures.
+ ***********************************************************/
+void TextureLoader::SetTextureCache(const TextureCache* pCache)
+{
+	if ((NULL != pCache) && (GLEW_EXT_texture_compression_s3tc == false))
+	{
+		std::cout << "S3TC texture compression is not supported, textures are not cached" << std::endl;
+		pCache = NULL;
+	}
+	m_pTextureCache = pCache;
+}
+
+/***********************************************************
+ *  RequestTexture()
+ *
+ *  This method is used for creating a texture that shows the
+ *  placeholder right away and queueing the decode of its
+ *  image.  Without a job system the image is decoded and
+ *  uploaded before returning.
+ ***********************************************************/
+GLuint TextureLoader::RequestTexture(const char* filename)
+{
+	GLuint textureID = 0;
+	glGenTextures(1, &textureID);
+	SetPlaceholder(textureID);
+
+	m_stats.requested++;
+	m_pendingCount++;
+	{
+		std::lock_guard<std::mutex> lock(m_decodedMutex);
+		m_decodingCount++;
+	}
+
+	std::string file = filename;
+	if (NULL == m_pJobSystem)
+	{
+		DecodeImage(textureID, file);
+		UploadDecodedTextures();
+		return(textureID);
+	}
+
+	// a decode, and the cooking of a new image, can take long,
+	// so the work a frame waits for - like generating the scene
+	// meshes - is taken first
+	m_pJobSystem->Submit([this, textureID, file]() { DecodeImage(textureID, file); }, JobSystem::LOW_PRIORITY);
+	return(textureID);
+}
+
+/***********************************************************
+ *  DecodeImage()
+ *
+ *  This method is used for reading and decoding an image
+ *  file on a worker thread, from the mapped file, and
+ *  queueing the pixels for the GL thread.  The images are
+ *  flipped through the flag of the decoding thread, as a
+ *  flag shared by every thread would be written while other
+ *  threads read it.  The queue is notified under the lock,
+ *  as the loader may be destroyed as soon as the last decode
+ *  is counted as finished.
+ ***********************************************************/
+void TextureLoader::DecodeImage(GLuint textureID, const std::string& filename)
+{
+	DECODED_IMAGE image;
+	image.textureID = textureID;
+	image.filename = filename;
+	image.width = 0;
+	image.height = 0;
+	image.channels = 0;
+	image.pPixels = NULL;
+	image.bCompressed = false;
+	image.bCacheHit = false;
+
+	stbi_set_flip_vertically_on_load_thread(1);
+	auto start = std::chrono::high_resolution_clock::now();
+	if (NULL != m_pTextureCache)
+	{
+		image.bCompressed = m_pTextureCache->LoadTexture(filename.c_str(), image.compressed, image.bCacheHit);
+	}
+	else
+	{
+		image.pPixels = TextureCache::DecodeImageFile(filename.c_str(), image.width, image.height, image.channels, 0);
+	}
+	image.decodeSeconds = ElapsedSeconds(start);
+
+	std::lock_guard<std::mutex> lock(m_decodedMutex);
+	m_decodedImages.push_back(std::move(image));
+	m_decodingCount--;
+	m_imageDecoded.notify_all();
+}
+
+/***********************************************************
+ *  UploadDecodedTextures()
+ *
+ *  This method is used for uploading every image decoded
+ *  since the last call.  The queue is emptied under the lock
+ *  and the uploads are done outside it, so the workers are
+ *  not held up by the GL calls.
+ ***********************************************************/
+int TextureLoader::UploadDecodedTextures()
+{
+	std::deque<DECODED_IMAGE> images;
+	{
+		std::lock_guard<std::mutex> lock(m_decodedMutex);
+		images.swap(m_decodedImages);
+	}
+
+	for (size_t i = 0; i < images.size(); i++)
+	{
+		UploadImage(images[i]);
+	}
+	return((int)images.size());
+}
+
+/***********************************************************
+ *  FinishAll()
+ *
+ *  This method is used for blocking until every requested
+ *  texture shows its image, uploading each one as soon as
+ *  it is decoded.
+ ***********************************************************/
+void TextureLoader::FinishAll()
+{
+	while (m_pendingCount > 0)
+	{
+		{
+			std::unique_lock<std::mutex> lock(m_decodedMutex);
+			m_imageDecoded.wait(lock, [this]() { return(m_decodedImages.empty() == false); });
+		}
+		UploadDecodedTextures();
+	}
+}
+
+/***********************************************************
+ *  TakeUploadedTextures()
+ *
+ *  This method is used for handing over the textures whose
+ *  images replaced their placeholders since the last call.
+ ***********************************************************/
+void TextureLoader::TakeUploadedTextures(std::vector<GLuint>& textures)
+{
+	textures.insert(textures.end(), m_uploadedTextures.begin(), m_uploadedTextures.end());
+	m_uploadedTextures.clear();
+}
+
+/***********************************************************
+ *  SetPlaceholder()
+ *
+ *  This method is used for giving a new texture the small
+ *  placeholder image and the same sampling parameters as the
+ *  final image.  The texture bound to the active unit is
+ *  bound again afterwards.
+ ***********************************************************/
+void TextureLoader::SetPlaceholder(GLuint textureID)
+{
+	unsigned char pixels[g_PlaceholderSize * g_PlaceholderSize * 4];
+	memset(pixels, g_PlaceholderValue, sizeof(pixels));
+
+	GLint boundTexture = 0;
+	glGetIntegerv(GL_TEXTURE_BINDING_2D, &boundTexture);
+	glBindTexture(GL_TEXTURE_2D, textureID);
+
+	// set the texture wrapping parameters
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	// set texture filtering parameters
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, g_PlaceholderSize, g_PlaceholderSize, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+
+	glBindTexture(GL_TEXTURE_2D, boundTexture);
+}
+
+/***********************************************************
+ *  UploadImage()
+ *
+ *  This method is used for copying a decoded image into the
+ *  pixel buffer and specifying the texture from it.  Images
+ *  that failed to decode keep the placeholder.
+ ***********************************************************/
+void TextureLoader::UploadImage(DECODED_IMAGE& image)
+{
+	m_pendingCount--;
+	m_stats.decodeSeconds += image.decodeSeconds;
+
+	if (image.bCompressed == true)
+	{
+		UploadCompressedImage(image);
+		return;
+	}
+
+	if (NULL == image.pPixels)
+	{
+		std::cout << "Could not load image:" << image.filename << std::endl;
+		m_stats.failed++;
+		return;
+	}
+
+	GLenum internalFormat = GL_RGB8;
+	GLenum format = GL_RGB;
+	// if the loaded image is in RGBA format - it supports transparency
+	if (image.channels == 4)
+	{
+		internalFormat = GL_RGBA8;
+		format = GL_RGBA;
+	}
+	else if (image.channels != 3)
+	{
+		std::cout << "Not implemented to handle image with " << image.channels << " channels" << std::endl;
+		stbi_image_free(image.pPixels);
+		m_stats.failed++;
+		return;
+	}
+
+	auto start = std::chrono::high_resolution_clock::now();
+	GLsizeiptr imageBytes = (GLsizeiptr)image.width * image.height * image.channels;
+	bool bFilled = FillPixelBuffer(image.pPixels, imageBytes);
+	stbi_image_free(image.pPixels);
+	image.pPixels = NULL;
+	if (bFilled == false)
+	{
+		m_stats.failed++;
+		return;
+	}
+
+	GLint boundTexture = 0;
+	glGetIntegerv(GL_TEXTURE_BINDING_2D, &boundTexture);
+	glBindTexture(GL_TEXTURE_2D, image.textureID);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_pixelBuffer);
+	// rows of 3 channel images are not padded to 4 bytes
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+	glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, image.width, image.height, 0, format, GL_UNSIGNED_BYTE, (void*)0);
+	// generate the texture mipmaps for mapping textures to lower resolutions
+	glGenerateMipmap(GL_TEXTURE_2D);
+
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	glBindTexture(GL_TEXTURE_2D, boundTexture);
+
+	// the driver keeps the mip chain, down to a single pixel
+	int levelWidth = image.width;
+	int levelHeight = image.height;
+	while (true)
+	{
+		m_stats.textureBytes += (size_t)levelWidth * levelHeight * image.channels;
+		if ((levelWidth == 1) && (levelHeight == 1))
+		{
+			break;
+		}
+		levelWidth = std::max(levelWidth / 2, 1);
+		levelHeight = std::max(levelHeight / 2, 1);
+	}
+	m_uploadedTextures.push_back(image.textureID);
+	m_stats.uploaded++;
+	m_stats.uploadSeconds += ElapsedSeconds(start);
+}
+
+/***********************************************************
+ *  UploadCompressedImage()
+ *
+ *  This method is used for copying every compressed level,
+ *  straight from the mapped cache file when the texture was
+ *  cached, into the pixel buffer and specifying each level
+ *  from it, so no mipmaps are generated.
+ ***********************************************************/
+void TextureLoader::UploadCompressedImage(DECODED_IMAGE& image)
+{
+	if (image.bCacheHit == true)
+	{
+		m_stats.cacheHits++;
+	}
+	else
+	{
+		m_stats.cooked++;
+	}
+
+	auto start = std::chrono::high_resolution_clock::now();
+	const TextureCache::COMPRESSED_TEXTURE& compressed = image.compressed;
+	bool bFilled = FillPixelBuffer(compressed.GetLevelData(), (GLsizeiptr)compressed.GetDataSize());
+	if (bFilled == false)
+	{
+		TextureCache::ReleaseTexture(image.compressed);
+		m_stats.failed++;
+		return;
+	}
+
+	GLint boundTexture = 0;
+	glGetIntegerv(GL_TEXTURE_BINDING_2D, &boundTexture);
+	glBindTexture(GL_TEXTURE_2D, image.textureID);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_pixelBuffer);
+
+	for (size_t level = 0; level < compressed.levels.size(); level++)
+	{
+		const TextureCache::MIP_LEVEL& mipLevel = compressed.levels[level];
+		glCompressedTexImage2D(GL_TEXTURE_2D, (GLint)level, compressed.format,
+			(GLsizei)mipLevel.width, (GLsizei)mipLevel.height, 0,
+			(GLsizei)mipLevel.size, (void*)(uintptr_t)mipLevel.offset);
+	}
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, (GLint)compressed.levels.size() - 1);
+
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	glBindTexture(GL_TEXTURE_2D, boundTexture);
+
+	m_stats.textureBytes += compressed.GetDataSize();
+	TextureCache::ReleaseTexture(image.compressed);
+	m_uploadedTextures.push_back(image.textureID);
+	m_stats.uploaded++;
+	m_stats.uploadSeconds += ElapsedSeconds(start);
+}
+
+/***********************************************************
+ *  FillPixelBuffer()
+ *
+ *  This method is used for copying the bytes of an upload
+ *  into the pixel buffer.  The buffer is orphaned before
+ *  every copy, so the copy never waits for the previous
+ *  upload to be read by the driver.
+ ***********************************************************/
+bool TextureLoader::FillPixelBuffer(const void* pData, GLsizeiptr size)
+{
+	if (m_pixelBuffer == 0)
+	{
+		glCreateBuffers(1, &m_pixelBuffer);
+	}
+	glNamedBufferData(m_pixelBuffer, size, NULL, GL_STREAM_DRAW);
+	void* pMapped = glMapNamedBufferRange(m_pixelBuffer, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+	if (NULL == pMapped)
+	{
+		return(false);
+	}
+	memcpy(pMapped, pData, size);
+	glUnmapNamedBuffer(m_pixelBuffer);
+	return(true);
+}
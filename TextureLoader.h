@@ -0,0 +1,121 @@
+///////////////////////////////////////////////////////////////////////////////
+// textureloader.h
+// ============
+// decode texture images on worker threads and upload them as they are ready
+//
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "TextureCache.h"
+#include <GL/glew.h>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class JobSystem;
+
+/***********************************************************
+ *  TextureLoader
+ *
+ *  This class hands texture images to the worker threads to
+ *  be read and decoded, while the requested textures show a
+ *  small placeholder so the scene can be drawn at once.  The
+ *  GL thread uploads each decoded image into its texture
+ *  through a pixel buffer, so the texture keeps its ID and
+ *  slot and the image simply replaces the placeholder.
+ ***********************************************************/
+class TextureLoader
+{
+public:
+    // work done since the loader was created
+    struct LOAD_STATS
+    {
+        GLuint requested;
+        GLuint uploaded;
+        GLuint failed;          // images that could not be decoded
+        GLuint cacheHits;       // textures mapped from the cache
+        GLuint cooked;          // textures compressed and cached
+        size_t textureBytes;    // bytes of every uploaded level
+        double decodeSeconds;   // summed over the worker threads
+        double uploadSeconds;   // on the GL thread
+    };
+
+    // constructor - the images are decoded on the workers of the
+    // job system
+    TextureLoader(JobSystem* pJobSystem);
+    // destructor - waits for the images still being decoded
+    ~TextureLoader();
+
+    // load the images through the cache of compressed textures,
+    // or decode them every time when NULL - ignored when the GPU
+    // has no S3TC support
+    void SetTextureCache(const TextureCache* pCache);
+
+    // create a texture showing the placeholder and start decoding
+    // the image file - returns the texture, which shows the image
+    // once it is uploaded
+    GLuint RequestTexture(const char* filename);
+    // upload the images decoded so far - called on the GL thread,
+    // usually once per frame, and returns the number uploaded
+    int UploadDecodedTextures();
+    // wait for every requested image and upload it
+    void FinishAll();
+    // move the textures uploaded since the last call into the
+    // vector, for anything that copies or addresses their images
+    void TakeUploadedTextures(std::vector<GLuint>& textures);
+
+    // number of requested textures still showing the placeholder
+    GLuint GetPendingCount() const { return m_pendingCount; }
+    const LOAD_STATS& GetStats() const { return m_stats; }
+
+private:
+    // image decoded on a worker thread, waiting for the GL thread
+    // to upload it - either the pixels, NULL when decoding failed,
+    // or the compressed levels from the texture cache
+    struct DECODED_IMAGE
+    {
+        GLuint textureID;
+        std::string filename;
+        unsigned char* pPixels;
+        int width;
+        int height;
+        int channels;
+        bool bCompressed;
+        bool bCacheHit;
+        TextureCache::COMPRESSED_TEXTURE compressed;
+        double decodeSeconds;
+    };
+
+    // pointer to the job system running the decodes
+    JobSystem* m_pJobSystem;
+    // cache the images are loaded through, or NULL
+    const TextureCache* m_pTextureCache;
+    // pixel buffer the images are copied into for upload
+    GLuint m_pixelBuffer;
+    // textures requested and not uploaded yet, counted on the GL
+    // thread
+    GLuint m_pendingCount;
+    LOAD_STATS m_stats;
+    // textures uploaded and not taken yet
+    std::vector<GLuint> m_uploadedTextures;
+
+    // decoded images, and the decodes not finished yet
+    std::deque<DECODED_IMAGE> m_decodedImages;
+    GLuint m_decodingCount;
+    std::mutex m_decodedMutex;
+    std::condition_variable m_imageDecoded;
+
+    // decode one image file on a worker thread
+    void DecodeImage(GLuint textureID, const std::string& filename);
+    // fill the texture with the placeholder image
+    void SetPlaceholder(GLuint textureID);
+    // replace the placeholder of a texture with its decoded image
+    void UploadImage(DECODED_IMAGE& image);
+    // replace the placeholder of a texture with its compressed
+    // levels
+    void UploadCompressedImage(DECODED_IMAGE& image);
+    // copy the bytes into the orphaned pixel buffer - returns
+    // false when the buffer could not be mapped
+    bool FillPixelBuffer(const void* pData, GLsizeiptr size);
+};
@@ -0,0 +1,428 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturetable.cpp
+// ============
+// address every scene texture by an index the shader reads from a buffer
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TextureTable.h"
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <string.h>
+
+// declaration of global variables
+namespace
+{
+	const char* g_TextureBlockName = "TextureBlock";
+	const char* g_TextureArraysName = "objectTextureArrays";
+	const char* g_UseBindlessTexturesName = "bUseBindlessTextures";
+	// layers of a new texture array, doubled whenever it fills
+	const GLint g_InitialArrayLayers = 4;
+	// size and color of the placeholder entry
+	const GLsizei g_PlaceholderSize = 2;
+	const unsigned char g_PlaceholderValue = 128;
+	// most mip levels a texture can have
+	const GLint g_MaxTextureLevels = 32;
+}
+
+/***********************************************************
+ *  TextureTable()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+TextureTable::TextureTable(ShaderManager* pShaderManager, GLuint bindingPoint, GLuint firstTextureUnit)
+{
+	m_pShaderManager = pShaderManager;
+	m_bindingPoint = bindingPoint;
+	m_firstTextureUnit = firstTextureUnit;
+	m_maxArrays = 0;
+	m_mode = TEXTURE_ARRAYS;
+	m_bInitialized = false;
+	m_tableBuffer = 0;
+	m_placeholder = 0;
+	m_placeholderEntry.handle = 0;
+	m_placeholderEntry.arrayIndex = 0;
+	m_placeholderEntry.layer = 0;
+}
+
+/***********************************************************
+ *  ~TextureTable()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+TextureTable::~TextureTable()
+{
+	for (size_t i = 0; i < m_residentHandles.size(); i++)
+	{
+		glMakeTextureHandleNonResidentARB(m_residentHandles[i]);
+	}
+	m_residentHandles.clear();
+
+	for (size_t i = 0; i < m_arrays.size(); i++)
+	{
+		glDeleteTextures(1, &m_arrays[i].texture);
+	}
+	m_arrays.clear();
+
+	if (m_placeholder != 0)
+	{
+		glDeleteTextures(1, &m_placeholder);
+		m_placeholder = 0;
+	}
+	if (m_tableBuffer != 0)
+	{
+		glDeleteBuffers(1, &m_tableBuffer);
+		m_tableBuffer = 0;
+	}
+	m_pShaderManager = NULL;
+}
+
+/***********************************************************
+ *  Initialize()
+ *
+ *  This method is used for connecting to the texture block
+ *  and choosing bindless handles when the GPU supports them,
+ *  or texture arrays when it does not.  The arrays take the
+ *  texture units from the first one up to the number the GPU
+ *  has for a fragment shader.  The placeholder shown by
+ *  textures that are not uploaded yet is made the first
+ *  entry of either kind.
+ ***********************************************************/
+bool TextureTable::Initialize()
+{
+	if (m_bInitialized == true)
+	{
+		return(true);
+	}
+	if ((NULL == m_pShaderManager) ||
+		(m_pShaderManager->BindStorageBlock(g_TextureBlockName, m_bindingPoint) == false))
+	{
+		return(false);
+	}
+
+	m_mode = (GLEW_ARB_bindless_texture == true) ? BINDLESS_HANDLES : TEXTURE_ARRAYS;
+	if (m_mode == TEXTURE_ARRAYS)
+	{
+		GLint textureUnits = 0;
+		glGetIntegerv(GL_MAX_TEXTURE_IMAGE_UNITS, &textureUnits);
+		m_maxArrays = 0;
+		if (textureUnits > (GLint)m_firstTextureUnit)
+		{
+			m_maxArrays = (GLuint)textureUnits - m_firstTextureUnit;
+		}
+		if (m_maxArrays > MAX_TEXTURE_ARRAYS)
+		{
+			m_maxArrays = MAX_TEXTURE_ARRAYS;
+		}
+		// even the placeholder needs an array
+		if (m_maxArrays == 0)
+		{
+			return(false);
+		}
+	}
+
+	unsigned char pixels[g_PlaceholderSize * g_PlaceholderSize * 4];
+	memset(pixels, g_PlaceholderValue, sizeof(pixels));
+	glCreateTextures(GL_TEXTURE_2D, 1, &m_placeholder);
+	glTextureStorage2D(m_placeholder, 1, GL_RGBA8, g_PlaceholderSize, g_PlaceholderSize);
+	glTextureSubImage2D(m_placeholder, 0, 0, 0, g_PlaceholderSize, g_PlaceholderSize, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+
+	if (m_mode == BINDLESS_HANDLES)
+	{
+		m_placeholderEntry.handle = MakeHandleResident(m_placeholder);
+	}
+	else
+	{
+		AddLayer(m_placeholder, m_placeholderEntry);
+		for (GLuint i = 0; i < m_maxArrays; i++)
+		{
+			m_pShaderManager->setSampler2DValue(
+				std::string(g_TextureArraysName) + "[" + std::to_string(i) + "]", (int)(m_firstTextureUnit + i));
+		}
+	}
+	m_pShaderManager->setBoolValue(g_UseBindlessTexturesName, (m_mode == BINDLESS_HANDLES));
+
+	glCreateBuffers(1, &m_tableBuffer);
+	m_bInitialized = true;
+	UploadEntries();
+	return(true);
+}
+
+/***********************************************************
+ *  AddTexture()
+ *
+ *  This method is used for adding an entry for a texture,
+ *  pointing at the placeholder until the texture image is
+ *  uploaded.
+ ***********************************************************/
+GLint TextureTable::AddTexture(GLuint texture, GLint textureSlot)
+{
+	m_entries.push_back(m_placeholderEntry);
+	m_textures.push_back(texture);
+	m_textureSlots.push_back(textureSlot);
+	UploadEntries();
+	return((GLint)m_entries.size() - 1);
+}
+
+/***********************************************************
+ *  UpdateTexture()
+ *
+ *  This method is used for pointing the entry of a texture
+ *  at its uploaded image - its bindless handle, or a layer
+ *  of the array of its size and format holding a copy of
+ *  every mip level.  When every array is taken by other
+ *  sizes and formats the entry points at the texture slot
+ *  instead, and only a texture without a slot keeps the
+ *  placeholder.  A texture copied into a layer is forgotten,
+ *  as its name is free for other textures once the caller
+ *  deletes it.
+ ***********************************************************/
+bool TextureTable::UpdateTexture(GLuint texture)
+{
+	std::vector<GLuint>::iterator found = std::find(m_textures.begin(), m_textures.end(), texture);
+	if ((m_bInitialized == false) || (texture == 0) || (found == m_textures.end()))
+	{
+		return(false);
+	}
+	size_t index = found - m_textures.begin();
+	TEXTURE_ENTRY& entry = m_entries[index];
+	bool bCopied = false;
+
+	if (m_mode == BINDLESS_HANDLES)
+	{
+		// the texture is immutable once it has a handle
+		if (entry.handle == m_placeholderEntry.handle)
+		{
+			entry.handle = MakeHandleResident(texture);
+		}
+	}
+	else
+	{
+		TEXTURE_ENTRY layerEntry;
+		bCopied = AddLayer(texture, layerEntry);
+		if (bCopied == false)
+		{
+			if (m_textureSlots[index] < 0)
+			{
+				std::cout << "No texture array or texture slot left for texture " << texture << std::endl;
+				return(false);
+			}
+			layerEntry.handle = 0;
+			layerEntry.arrayIndex = -1;
+			layerEntry.layer = m_textureSlots[index];
+		}
+		else
+		{
+			m_textures[index] = 0;
+		}
+
+		bool bPlaceholder = (entry.arrayIndex == m_placeholderEntry.arrayIndex) &&
+			(entry.layer == m_placeholderEntry.layer);
+		if ((bPlaceholder == false) && (entry.arrayIndex >= 0))
+		{
+			ReleaseLayer(entry);
+		}
+		entry = layerEntry;
+	}
+	UploadEntries();
+	return(bCopied);
+}
+
+/***********************************************************
+ *  AddLayer()
+ *
+ *  This method is used for copying every mip level of a
+ *  texture into a free layer of the array matching its size,
+ *  format and number of levels, creating the array when
+ *  there is none yet.
+ ***********************************************************/
+bool TextureTable::AddLayer(GLuint texture, TEXTURE_ENTRY& entry)
+{
+	GLint width = 0;
+	GLint height = 0;
+	GLint internalFormat = 0;
+	glGetTextureLevelParameteriv(texture, 0, GL_TEXTURE_WIDTH, &width);
+	glGetTextureLevelParameteriv(texture, 0, GL_TEXTURE_HEIGHT, &height);
+	glGetTextureLevelParameteriv(texture, 0, GL_TEXTURE_INTERNAL_FORMAT, &internalFormat);
+	if ((width == 0) || (height == 0))
+	{
+		return(false);
+	}
+	GLint levels = 1;
+	while (levels < g_MaxTextureLevels)
+	{
+		GLint levelWidth = 0;
+		glGetTextureLevelParameteriv(texture, levels, GL_TEXTURE_WIDTH, &levelWidth);
+		if (levelWidth == 0)
+		{
+			break;
+		}
+		levels++;
+	}
+
+	GLuint arrayIndex = 0;
+	while ((arrayIndex < m_arrays.size()) &&
+		((m_arrays[arrayIndex].width != width) || (m_arrays[arrayIndex].height != height) ||
+		(m_arrays[arrayIndex].internalFormat != (GLenum)internalFormat) || (m_arrays[arrayIndex].levels != levels)))
+	{
+		arrayIndex++;
+	}
+	if (arrayIndex == m_arrays.size())
+	{
+		if (m_arrays.size() >= m_maxArrays)
+		{
+			return(false);
+		}
+		TEXTURE_ARRAY textureArray;
+		textureArray.texture = 0;
+		textureArray.width = width;
+		textureArray.height = height;
+		textureArray.internalFormat = (GLenum)internalFormat;
+		textureArray.levels = levels;
+		textureArray.layerCount = 0;
+		textureArray.layerCapacity = 0;
+		m_arrays.push_back(textureArray);
+	}
+
+	TEXTURE_ARRAY& textureArray = m_arrays[arrayIndex];
+	GLint layer = 0;
+	if (textureArray.freeLayers.empty() == false)
+	{
+		layer = textureArray.freeLayers.back();
+		textureArray.freeLayers.pop_back();
+	}
+	else
+	{
+		if (textureArray.layerCount == textureArray.layerCapacity)
+		{
+			GrowArray(arrayIndex);
+		}
+		layer = textureArray.layerCount;
+		textureArray.layerCount++;
+	}
+
+	for (GLint level = 0; level < levels; level++)
+	{
+		glCopyImageSubData(
+			texture, GL_TEXTURE_2D, level, 0, 0, 0,
+			textureArray.texture, GL_TEXTURE_2D_ARRAY, level, 0, 0, layer,
+			std::max(width >> level, 1), std::max(height >> level, 1), 1);
+	}
+
+	entry.handle = 0;
+	entry.arrayIndex = (GLint)arrayIndex;
+	entry.layer = layer;
+	return(true);
+}
+
+/***********************************************************
+ *  GetSlotTextureCount()
+ *
+ *  This method is used for counting the entries sampled from
+ *  their texture slot because no array was left for them.
+ ***********************************************************/
+GLuint TextureTable::GetSlotTextureCount() const
+{
+	GLuint count = 0;
+	for (size_t i = 0; i < m_entries.size(); i++)
+	{
+		if (m_entries[i].arrayIndex < 0)
+		{
+			count++;
+		}
+	}
+	return(count);
+}
+
+/***********************************************************
+ *  ReleaseLayer()
+ *
+ *  This method is used for letting a later texture reuse the
+ *  layer of an entry.
+ ***********************************************************/
+void TextureTable::ReleaseLayer(const TEXTURE_ENTRY& entry)
+{
+	m_arrays[entry.arrayIndex].freeLayers.push_back(entry.layer);
+}
+
+/***********************************************************
+ *  GrowArray()
+ *
+ *  This method is used for moving a texture array into new
+ *  storage with twice the layers, copying the layers in use,
+ *  and binding it to the texture unit of the array.
+ ***********************************************************/
+void TextureTable::GrowArray(GLuint arrayIndex)
+{
+	TEXTURE_ARRAY& textureArray = m_arrays[arrayIndex];
+	GLint capacity = std::max(textureArray.layerCapacity * 2, g_InitialArrayLayers);
+
+	GLuint texture = 0;
+	glCreateTextures(GL_TEXTURE_2D_ARRAY, 1, &texture);
+	glTextureStorage3D(texture, textureArray.levels, textureArray.internalFormat,
+		textureArray.width, textureArray.height, capacity);
+	// repeat the layers like the scene textures, and blend the
+	// copied mip levels, so distant surfaces do not shimmer
+	glTextureParameteri(texture, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTextureParameteri(texture, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTextureParameteri(texture, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+	glTextureParameteri(texture, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	if (textureArray.texture != 0)
+	{
+		for (GLint level = 0; level < textureArray.levels; level++)
+		{
+			glCopyImageSubData(
+				textureArray.texture, GL_TEXTURE_2D_ARRAY, level, 0, 0, 0,
+				texture, GL_TEXTURE_2D_ARRAY, level, 0, 0, 0,
+				std::max(textureArray.width >> level, 1), std::max(textureArray.height >> level, 1),
+				textureArray.layerCount);
+		}
+		glDeleteTextures(1, &textureArray.texture);
+	}
+	textureArray.texture = texture;
+	textureArray.layerCapacity = capacity;
+	glBindTextureUnit(m_firstTextureUnit + arrayIndex, texture);
+}
+
+/***********************************************************
+ *  MakeHandleResident()
+ *
+ *  This method is used for getting the bindless handle of a
+ *  texture and making it resident, so the shader can sample
+ *  it without it being bound to a unit.
+ ***********************************************************/
+GLuint64 TextureTable::MakeHandleResident(GLuint texture)
+{
+	GLuint64 handle = glGetTextureHandleARB(texture);
+	glMakeTextureHandleResidentARB(handle);
+	m_residentHandles.push_back(handle);
+	return(handle);
+}
+
+/***********************************************************
+ *  UploadEntries()
+ *
+ *  This method is used for sending every entry to the
+ *  texture block.  The table only changes while textures are
+ *  loading, so the whole table is sent each time.
+ ***********************************************************/
+void TextureTable::UploadEntries()
+{
+	if (m_bInitialized == false)
+	{
+		return;
+	}
+
+	if (m_entries.empty() == true)
+	{
+		glNamedBufferData(m_tableBuffer, sizeof(TEXTURE_ENTRY), &m_placeholderEntry, GL_DYNAMIC_DRAW);
+	}
+	else
+	{
+		glNamedBufferData(m_tableBuffer, m_entries.size() * sizeof(TEXTURE_ENTRY), m_entries.data(), GL_DYNAMIC_DRAW);
+	}
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, m_bindingPoint, m_tableBuffer);
+}
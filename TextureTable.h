@@ -0,0 +1,139 @@
+///////////////////////////////////////////////////////////////////////////////
+// texturetable.h
+// ============
+// address every scene texture by an index the shader reads from a buffer
+//
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "ShaderManager.h"
+#include <vector>
+#include <stdint.h>
+
+/***********************************************************
+ *  TextureTable
+ *
+ *  This class gives every texture an index into a table the
+ *  shader reads from a storage buffer, so a draw selects its
+ *  texture with an integer in its draw values instead of a
+ *  sampler uniform, and draws with different textures can be
+ *  submitted together.  With bindless textures each entry is
+ *  the handle of its texture.  Otherwise the textures are
+ *  copied into layers of texture arrays, one array for each
+ *  size and format, and each entry is an array and a layer.
+ *  A texture that finds no free array is sampled from the
+ *  texture slot it is bound to without the table, and its
+ *  entry has the array index -1 and the slot as its layer.
+ *  The slots and the arrays together fit in the 16 texture
+ *  units every GPU has for a fragment shader, and no more
+ *  arrays are used than the units after the slots allow.
+ *  The shader declares:
+ *    struct TextureEntry { uvec2 handle; int arrayIndex; int layer; };
+ *    layout(std430) buffer TextureBlock { TextureEntry textures[]; };
+ *    uniform sampler2DArray objectTextureArrays[8];
+ *    uniform sampler2D objectTextures[8];
+ *    uniform bool bUseBindlessTextures;
+ ***********************************************************/
+class TextureTable
+{
+public:
+    // texture arrays the shader can sample from
+    static const GLuint MAX_TEXTURE_ARRAYS = 8;
+
+    // how the entries address their textures
+    enum TABLE_MODE
+    {
+        BINDLESS_HANDLES,
+        TEXTURE_ARRAYS
+    };
+
+    // constructor - the arrays are bound to the texture units
+    // from firstTextureUnit on, after the texture slots
+    TextureTable(ShaderManager* pShaderManager, GLuint bindingPoint, GLuint firstTextureUnit);
+    // destructor
+    ~TextureTable();
+
+    // connect to the texture block declared by the shader and
+    // choose the mode - returns false when there is no block, or
+    // no texture unit is left for an array
+    bool Initialize();
+
+    // add a texture to the table, with the texture slot it is
+    // sampled from when it does not fit in an array, or -1 -
+    // returns its index, which shows a placeholder until
+    // UpdateTexture() is called
+    GLint AddTexture(GLuint texture, GLint textureSlot);
+    // point the entry of a texture at its current image, once
+    // the image is uploaded - a bindless texture can not be
+    // changed after this - returns true when the image was
+    // copied into an array, so the texture itself is no longer
+    // sampled and can be deleted
+    bool UpdateTexture(GLuint texture);
+
+    TABLE_MODE GetMode() const { return m_mode; }
+    GLuint GetTextureCount() const { return (GLuint)m_entries.size(); }
+    // texture arrays allocated, 0 with bindless textures
+    GLuint GetArrayCount() const { return (GLuint)m_arrays.size(); }
+    // texture arrays the texture units have room for
+    GLuint GetMaxArrayCount() const { return m_maxArrays; }
+    // textures sampled from their slot, as no array was left
+    GLuint GetSlotTextureCount() const;
+
+private:
+    // std430 layout of one entry in the texture block
+    struct TEXTURE_ENTRY
+    {
+        GLuint64 handle;
+        GLint arrayIndex;
+        GLint layer;
+    };
+
+    // array holding the textures of one size and format
+    struct TEXTURE_ARRAY
+    {
+        GLuint texture;
+        GLint width;
+        GLint height;
+        GLenum internalFormat;
+        GLint levels;
+        GLint layerCount;
+        GLint layerCapacity;
+        std::vector<GLint> freeLayers;
+    };
+
+    // pointer to shader manager object
+    ShaderManager* m_pShaderManager;
+    // storage buffer binding point of the texture block
+    GLuint m_bindingPoint;
+    GLuint m_firstTextureUnit;
+    // arrays bound from the first unit on, within the units the
+    // GPU has for a fragment shader
+    GLuint m_maxArrays;
+    TABLE_MODE m_mode;
+    bool m_bInitialized;
+
+    // storage buffer holding the entries
+    GLuint m_tableBuffer;
+    // entries in table order, and the texture and texture slot
+    // of each
+    std::vector<TEXTURE_ENTRY> m_entries;
+    std::vector<GLuint> m_textures;
+    std::vector<GLint> m_textureSlots;
+    // textures made resident through their bindless handles
+    std::vector<GLuint64> m_residentHandles;
+    std::vector<TEXTURE_ARRAY> m_arrays;
+    // texture shown by entries whose image is not uploaded yet
+    GLuint m_placeholder;
+    TEXTURE_ENTRY m_placeholderEntry;
+
+    // copy the texture into a layer of the array of its size and
+    // format - returns false when it has no free array
+    bool AddLayer(GLuint texture, TEXTURE_ENTRY& entry);
+    // give the layer of an entry back to its array
+    void ReleaseLayer(const TEXTURE_ENTRY& entry);
+    // move an array into new storage with room for more layers
+    void GrowArray(GLuint arrayIndex);
+    // make the handle of a texture resident - returns the handle
+    GLuint64 MakeHandleResident(GLuint texture);
+    // send the entries to the texture block
+    void UploadEntries();
+};
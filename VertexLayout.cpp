@@ -0,0 +1,133 @@
+///////////////////////////////////////////////////////////////////////////////
+// vertexlayout.cpp
+// ============
+// describe the vertex attributes of a mesh source and set them on VAOs
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "VertexLayout.h"
+
+/***********************************************************
+ *  VertexLayout()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+VertexLayout::VertexLayout()
+{
+}
+
+/***********************************************************
+ *  AddBinding()
+ *
+ *  This method is used for describing a buffer binding with
+ *  the stride of its vertices and how often they advance.
+ ***********************************************************/
+void VertexLayout::AddBinding(GLuint bindingIndex, GLsizei stride, GLuint divisor)
+{
+	BINDING binding;
+	binding.bindingIndex = bindingIndex;
+	binding.stride = stride;
+	binding.divisor = divisor;
+	m_bindings.push_back(binding);
+}
+
+/***********************************************************
+ *  AddAttribute()
+ *
+ *  This method is used for describing an attribute that the
+ *  shader reads as a float or a float vector.
+ ***********************************************************/
+void VertexLayout::AddAttribute(
+	GLuint location, GLint size, GLenum type, GLboolean bNormalized,
+	GLuint offset, GLuint bindingIndex)
+{
+	ATTRIBUTE attribute;
+	attribute.location = location;
+	attribute.size = size;
+	attribute.type = type;
+	attribute.bNormalized = bNormalized;
+	attribute.bInteger = false;
+	attribute.offset = offset;
+	attribute.bindingIndex = bindingIndex;
+	m_attributes.push_back(attribute);
+}
+
+/***********************************************************
+ *  AddIntegerAttribute()
+ *
+ *  This method is used for describing an attribute that the
+ *  shader reads as an int or an int vector.
+ ***********************************************************/
+void VertexLayout::AddIntegerAttribute(
+	GLuint location, GLint size, GLenum type,
+	GLuint offset, GLuint bindingIndex)
+{
+	ATTRIBUTE attribute;
+	attribute.location = location;
+	attribute.size = size;
+	attribute.type = type;
+	attribute.bNormalized = GL_FALSE;
+	attribute.bInteger = true;
+	attribute.offset = offset;
+	attribute.bindingIndex = bindingIndex;
+	m_attributes.push_back(attribute);
+}
+
+/***********************************************************
+ *  Apply()
+ *
+ *  This method is used for setting every attribute format
+ *  and binding divisor on the VAO with direct state access,
+ *  so the VAO does not have to be bound.
+ ***********************************************************/
+void VertexLayout::Apply(GLuint vao) const
+{
+	for (size_t i = 0; i < m_attributes.size(); i++)
+	{
+		const ATTRIBUTE& attribute = m_attributes[i];
+		if (attribute.bInteger == true)
+		{
+			glVertexArrayAttribIFormat(vao, attribute.location, attribute.size, attribute.type, attribute.offset);
+		}
+		else
+		{
+			glVertexArrayAttribFormat(vao, attribute.location, attribute.size, attribute.type, attribute.bNormalized, attribute.offset);
+		}
+		glVertexArrayAttribBinding(vao, attribute.location, attribute.bindingIndex);
+		glEnableVertexArrayAttrib(vao, attribute.location);
+	}
+
+	for (size_t i = 0; i < m_bindings.size(); i++)
+	{
+		glVertexArrayBindingDivisor(vao, m_bindings[i].bindingIndex, m_bindings[i].divisor);
+	}
+}
+
+/***********************************************************
+ *  BindBuffer()
+ *
+ *  This method is used for attaching a buffer to a binding
+ *  of the VAO.  The attributes reading through the binding
+ *  keep their formats.
+ ***********************************************************/
+void VertexLayout::BindBuffer(GLuint vao, GLuint bindingIndex, GLuint buffer, GLintptr offset) const
+{
+	glVertexArrayVertexBuffer(vao, bindingIndex, buffer, offset, GetStride(bindingIndex));
+}
+
+/***********************************************************
+ *  GetStride()
+ *
+ *  This method is used for getting the stride of a binding.
+ ***********************************************************/
+GLsizei VertexLayout::GetStride(GLuint bindingIndex) const
+{
+	for (size_t i = 0; i < m_bindings.size(); i++)
+	{
+		if (m_bindings[i].bindingIndex == bindingIndex)
+		{
+			return(m_bindings[i].stride);
+		}
+	}
+	return(0);
+}
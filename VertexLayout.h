@@ -0,0 +1,80 @@
+///////////////////////////////////////////////////////////////////////////////
+// vertexlayout.h
+// ============
+// describe the vertex attributes of a mesh source and set them on VAOs
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <vector>
+
+/***********************************************************
+ *  VertexLayout
+ *
+ *  This class describes where each vertex attribute is read
+ *  from - its format, its offset within the vertex, and the
+ *  buffer binding it reads through, along with the stride
+ *  and divisor of every binding.  The attribute formats are
+ *  set on a VAO once, and buffers are attached to the
+ *  bindings separately, so the buffers under a VAO can be
+ *  swapped without setting the attributes again.
+ ***********************************************************/
+class VertexLayout
+{
+public:
+	// one attribute read by the vertex shader
+	struct ATTRIBUTE
+	{
+		GLuint location;		// shader attribute location
+		GLint size;				// number of components
+		GLenum type;			// component type in the buffer
+		GLboolean bNormalized;	// integer components read as 0 to 1 or -1 to 1
+		bool bInteger;			// read as an int attribute instead of a float
+		GLuint offset;			// bytes from the start of the vertex
+		GLuint bindingIndex;	// buffer binding the attribute reads from
+	};
+
+	// one buffer binding of the VAO
+	struct BINDING
+	{
+		GLuint bindingIndex;
+		GLsizei stride;			// bytes between consecutive vertices
+		GLuint divisor;			// 0 advances per vertex, 1 per instance
+	};
+
+	// constructor
+	VertexLayout();
+
+	// describe a buffer binding of the layout
+	void AddBinding(GLuint bindingIndex, GLsizei stride, GLuint divisor = 0);
+	// describe an attribute read as a float, converted from the
+	// buffer type
+	void AddAttribute(
+		GLuint location, GLint size, GLenum type, GLboolean bNormalized,
+		GLuint offset, GLuint bindingIndex);
+	// describe an attribute read as an int
+	void AddIntegerAttribute(
+		GLuint location, GLint size, GLenum type,
+		GLuint offset, GLuint bindingIndex);
+
+	// set the attribute formats and binding divisors on the VAO -
+	// needed once per VAO
+	void Apply(GLuint vao) const;
+	// attach a buffer to a binding of the VAO, keeping the
+	// attribute formats
+	void BindBuffer(GLuint vao, GLuint bindingIndex, GLuint buffer, GLintptr offset = 0) const;
+
+	// stride of a binding, or 0 when the layout has no such binding
+	GLsizei GetStride(GLuint bindingIndex) const;
+
+	// described attributes and bindings
+	const std::vector<ATTRIBUTE>& GetAttributes() const { return m_attributes; }
+	const std::vector<BINDING>& GetBindings() const { return m_bindings; }
+
+private:
+	std::vector<ATTRIBUTE> m_attributes;
+	std::vector<BINDING> m_bindings;
+};
@@ -22,6 +22,7 @@ namespace
 	const int WINDOW_HEIGHT = 800;
 	const char* g_ViewName = "view";
 	const char* g_ProjectionName = "projection";
+	const char* g_ViewPositionName = "viewPosition";
 
 	// camera object used for viewing and interacting with
 	// the 3D scene
@@ -52,6 +53,9 @@ ViewManager::ViewManager(
 	// initialize the member variables
 	m_pShaderManager = pShaderManager;
 	m_pWindow = NULL;
+	m_bUniformsResolved = false;
+	m_viewMatrix = glm::mat4(1.0f);
+	m_projectionMatrix = glm::mat4(1.0f);
 	g_pCamera = new Camera();
 	// default camera view parameters
 	g_pCamera->Position = glm::vec3(0.0f, 5.0f, 12.0f);
@@ -248,14 +252,37 @@ void ViewManager::PrepareSceneView()
 	{
 		projection = glm::perspective(glm::radians(g_pCamera->Zoom), (GLfloat)WINDOW_WIDTH / (GLfloat)WINDOW_HEIGHT, 0.1f, 100.0f);
 	}
+	// keep the matrices for the scene level selection
+	m_viewMatrix = view;
+	m_projectionMatrix = projection;
+
 	// if the shader manager object is valid
 	if (NULL != m_pShaderManager)
 	{
+		if (m_bUniformsResolved == false)
+		{
+			m_viewHandle = m_pShaderManager->GetUniformHandle(g_ViewName);
+			m_projectionHandle = m_pShaderManager->GetUniformHandle(g_ProjectionName);
+			m_viewPositionHandle = m_pShaderManager->GetUniformHandle(g_ViewPositionName);
+			m_bUniformsResolved = true;
+		}
+
 		// set the view matrix into the shader for proper rendering
-		m_pShaderManager->setMat4Value(g_ViewName, view);
+		m_pShaderManager->setMat4Value(m_viewHandle, view);
 		// set the view matrix into the shader for proper rendering
-		m_pShaderManager->setMat4Value(g_ProjectionName, projection);
+		m_pShaderManager->setMat4Value(m_projectionHandle, projection);
 		// set the view position of the camera into the shader for proper rendering
-		m_pShaderManager->setVec3Value("viewPosition", g_pCamera->Position);
+		m_pShaderManager->setVec3Value(m_viewPositionHandle, g_pCamera->Position);
 	}
+}
+
+/***********************************************************
+ *  GetViewportHeight()
+ *
+ *  This method is used for getting the height in pixels of
+ *  the viewport the projection maps to.
+ ***********************************************************/
+int ViewManager::GetViewportHeight() const
+{
+	return(WINDOW_HEIGHT);
 }
\ No newline at end of file
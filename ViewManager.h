@@ -31,6 +31,15 @@ private:
 	ShaderManager* m_pShaderManager;
 	// active OpenGL display window
 	GLFWwindow* m_pWindow;
+	// shader uniform handles, resolved on the first prepared view
+	// since the shaders are loaded after this object is created
+	UniformHandle m_viewHandle;
+	UniformHandle m_projectionHandle;
+	UniformHandle m_viewPositionHandle;
+	bool m_bUniformsResolved;
+	// view and projection of the last prepared view
+	glm::mat4 m_viewMatrix;
+	glm::mat4 m_projectionMatrix;
 	// process keyboard events for interaction with the 3D scene
 	void ProcessKeyboardEvents();
 public:
@@ -39,4 +48,10 @@ public:
 
 	// prepare the conversion from 3D object display to 2D scene display
 	void PrepareSceneView();
+
+	// get the view and projection of the last prepared view, and
+	// the height in pixels of the viewport they map to
+	const glm::mat4& GetViewMatrix() const { return m_viewMatrix; }
+	const glm::mat4& GetProjectionMatrix() const { return m_projectionMatrix; }
+	int GetViewportHeight() const;
 };
\ No newline at end of file
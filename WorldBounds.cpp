@@ -0,0 +1,100 @@
+///////////////////////////////////////////////////////////////////////////////
+// worldbounds.cpp
+// ============
+// keep the world space bounds of the drawn objects in structure of arrays form
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "WorldBounds.h"
+
+#include <algorithm>
+
+/***********************************************************
+ *  WorldBounds()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+WorldBounds::WorldBounds()
+{
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used for removing every added object.  The
+ *  arrays keep their memory for the objects of the next frame.
+ ***********************************************************/
+void WorldBounds::Clear()
+{
+	m_minX.clear();
+	m_minY.clear();
+	m_minZ.clear();
+	m_maxX.clear();
+	m_maxY.clear();
+	m_maxZ.clear();
+	m_centerX.clear();
+	m_centerY.clear();
+	m_centerZ.clear();
+	m_radius.clear();
+}
+
+/***********************************************************
+ *  Add()
+ *
+ *  This method is used for adding the world space bounds of
+ *  an object.  The sphere center is moved by the model
+ *  matrix and its radius grows with the largest scale of the
+ *  matrix, so the sphere still holds the mesh under a scale
+ *  that differs per axis.
+ ***********************************************************/
+GLuint WorldBounds::Add(const ShapeMeshes::MESH_BOUNDS& meshBounds, const glm::mat4& model)
+{
+	glm::vec3 worldMin;
+	glm::vec3 worldMax;
+	TransformBox(meshBounds.boxMin, meshBounds.boxMax, model, worldMin, worldMax);
+
+	glm::vec3 center = glm::vec3(model * glm::vec4(meshBounds.sphereCenter, 1.0f));
+	float scale = std::max(glm::length(glm::vec3(model[0])),
+		std::max(glm::length(glm::vec3(model[1])), glm::length(glm::vec3(model[2]))));
+
+	GLuint object = GetCount();
+	m_minX.push_back(worldMin.x);
+	m_minY.push_back(worldMin.y);
+	m_minZ.push_back(worldMin.z);
+	m_maxX.push_back(worldMax.x);
+	m_maxY.push_back(worldMax.y);
+	m_maxZ.push_back(worldMax.z);
+	m_centerX.push_back(center.x);
+	m_centerY.push_back(center.y);
+	m_centerZ.push_back(center.z);
+	m_radius.push_back(meshBounds.sphereRadius * scale);
+	return(object);
+}
+
+/***********************************************************
+ *  TransformBox()
+ *
+ *  This method is used for finding the world box around a
+ *  transformed box with Arvo's method.  Each world axis
+ *  starts at the translation, and every element of the
+ *  matrix adds the smaller of its products with the box
+ *  minimum and maximum to the world minimum and the larger
+ *  one to the world maximum.
+ ***********************************************************/
+void WorldBounds::TransformBox(
+	const glm::vec3& boxMin, const glm::vec3& boxMax, const glm::mat4& model,
+	glm::vec3& worldMin, glm::vec3& worldMax)
+{
+	worldMin = glm::vec3(model[3]);
+	worldMax = worldMin;
+	for (int column = 0; column < 3; column++)
+	{
+		for (int row = 0; row < 3; row++)
+		{
+			float a = model[column][row] * boxMin[column];
+			float b = model[column][row] * boxMax[column];
+			worldMin[row] += std::min(a, b);
+			worldMax[row] += std::max(a, b);
+		}
+	}
+}
@@ -0,0 +1,73 @@
+///////////////////////////////////////////////////////////////////////////////
+// worldbounds.h
+// ============
+// keep the world space bounds of the drawn objects in structure of arrays form
+//
+///////////////////////////////////////////////////////////////////////////////
+#pragma once
+#include "ShapeMeshes.h"
+#include <glm/glm.hpp>
+#include <vector>
+
+/***********************************************************
+ *  WorldBounds
+ *
+ *  This class holds a box and a sphere in world space for
+ *  every added object, moved there from the mesh bounds with
+ *  the model matrix of the object.  Every component is kept
+ *  in an array of its own, so a culling pass reads the same
+ *  component of consecutive objects from consecutive floats
+ *  and can test several objects with one SIMD instruction.
+ ***********************************************************/
+class WorldBounds
+{
+public:
+    // constructor
+    WorldBounds();
+
+    // remove all of the added objects
+    void Clear();
+    // add the bounds of a mesh moved by the model matrix -
+    // returns the index of the object
+    GLuint Add(const ShapeMeshes::MESH_BOUNDS& meshBounds, const glm::mat4& model);
+
+    // move a box by the model matrix and return the box around
+    // the result, without transforming its eight corners
+    static void TransformBox(
+        const glm::vec3& boxMin, const glm::vec3& boxMax, const glm::mat4& model,
+        glm::vec3& worldMin, glm::vec3& worldMax);
+
+    // number of added objects
+    GLuint GetCount() const { return (GLuint)m_minX.size(); }
+    // box and sphere of an added object
+    glm::vec3 GetBoxMin(GLuint object) const { return glm::vec3(m_minX[object], m_minY[object], m_minZ[object]); }
+    glm::vec3 GetBoxMax(GLuint object) const { return glm::vec3(m_maxX[object], m_maxY[object], m_maxZ[object]); }
+    glm::vec3 GetSphereCenter(GLuint object) const { return glm::vec3(m_centerX[object], m_centerY[object], m_centerZ[object]); }
+    GLfloat GetSphereRadius(GLuint object) const { return m_radius[object]; }
+
+    // component arrays, GetCount() floats each
+    const GLfloat* GetMinX() const { return m_minX.data(); }
+    const GLfloat* GetMinY() const { return m_minY.data(); }
+    const GLfloat* GetMinZ() const { return m_minZ.data(); }
+    const GLfloat* GetMaxX() const { return m_maxX.data(); }
+    const GLfloat* GetMaxY() const { return m_maxY.data(); }
+    const GLfloat* GetMaxZ() const { return m_maxZ.data(); }
+    const GLfloat* GetCenterX() const { return m_centerX.data(); }
+    const GLfloat* GetCenterY() const { return m_centerY.data(); }
+    const GLfloat* GetCenterZ() const { return m_centerZ.data(); }
+    const GLfloat* GetRadius() const { return m_radius.data(); }
+
+private:
+    // world space boxes
+    std::vector<GLfloat> m_minX;
+    std::vector<GLfloat> m_minY;
+    std::vector<GLfloat> m_minZ;
+    std::vector<GLfloat> m_maxX;
+    std::vector<GLfloat> m_maxY;
+    std::vector<GLfloat> m_maxZ;
+    // world space spheres
+    std::vector<GLfloat> m_centerX;
+    std::vector<GLfloat> m_centerY;
+    std::vector<GLfloat> m_centerZ;
+    std::vector<GLfloat> m_radius;
+};